@@ -0,0 +1,233 @@
+﻿// Headless frame loop benchmark. Runs OpenXRTutorial with a generated stress scene against the mock runtime in
+// Benchmark/MockRuntime for a fixed number of frames and reports CPU and GPU frame time percentiles.
+//
+// Single run:  Ch08_OpenXRInputAndHaptics_Benchmark [--frames N] [--warmup N] [--refresh-rate HZ] [--width PX] [--height PX]
+//                  [--dynamic-resolution 0|1] [--foveation none|low|medium|high] [--msaa SAMPLES] [--record-threads N]
+//                  [--name NAME] [--objects N] [--meshes N] [--materials N] [--dynamic FRACTION] [--seed N] [--packed 0|1] [--lods 0|1]
+//                  [--stream 0|1] [--features BITS] [--mesh-cache DIR] [--json FILE] [--require-gpu-timings 0|1]
+// Suite:       Ch08_OpenXRInputAndHaptics_Benchmark --suite FILE [--frames N] [--warmup N] ...
+// Comparison:  Ch08_OpenXRInputAndHaptics_Benchmark --compare BASELINE_FILE CURRENT_FILE [--threshold PERCENT]
+//
+// Run it from the build directory so the compiled shaders are found. Without a GPU, point VK_ICD_FILENAMES at the
+// lavapipe ICD manifest. Setting XR_RUNTIME_JSON beforehand overrides the mock runtime. The comparison exits with
+// a non-zero code when a case regressed, which is what CI should check, and so does a run that measured no frames.
+// Dynamic resolution, foveation and multisampling are off by default so the cases are measured at a fixed resolution
+// and shading rate. --require-gpu-timings fails the run when the GPU profiler read back no non-zero frame times.
+// --mesh-cache keeps the generated meshes and their levels of detail in DIR, so only the first run builds them.
+
+#include <DebugOutput.h>
+#include "BenchmarkReport.h"
+#include "BenchmarkSuite.h"
+#include "../app/src/main/cpp/Application/OpenXRTutorial.h"
+#include "../app/src/main/cpp/Engine/Diagnostics/TraceLogMgr.h"
+#include "../app/src/main/cpp/Engine/Rendering/DrawListRecorder.h"
+#include "../app/src/main/cpp/OpenXR/OpenXRAttachmentMgr.h"
+#include "../app/src/main/cpp/OpenXR/OpenXRFoveationMgr.h"
+#include "../app/src/main/cpp/OpenXR/OpenXRResolutionMgr.h"
+#include "../app/src/main/cpp/Scenes/StressScene.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+namespace
+{
+    struct BenchmarkSettings
+    {
+        uint64_t frameCount = 600;
+        uint64_t warmupFrameCount = 60;
+        std::string refreshRate;
+        std::string viewWidth;
+        std::string viewHeight;
+        bool dynamicResolution = false;
+        FoveationLevel foveationLevel = FoveationLevel::NONE;
+        uint32_t sampleCount = 1;
+        uint32_t recordThreadCount = 0;  // 0 picks the backend maximum
+        StressSceneConfig scene;
+        std::string jsonPath;
+        bool requireGpuTimings = false;
+
+        std::string suitePath;
+        std::string baselinePath;
+        std::string comparePath;
+        double thresholdPercent = 10.0;
+
+        // Options forwarded to every case of a suite
+        std::string forwardedArguments;
+    };
+
+    void SetEnvironmentVariable(const char* name, const std::string& value, bool overwrite)
+    {
+        if (!overwrite && std::getenv(name)) return;
+#if defined(_WIN32)
+        _putenv_s(name, value.c_str());
+#else
+        setenv(name, value.c_str(), 1);
+#endif
+    }
+
+    bool ParseFoveationLevel(const std::string& value, FoveationLevel& level)
+    {
+        if (value == "none")
+            level = FoveationLevel::NONE;
+        else if (value == "low")
+            level = FoveationLevel::LOW;
+        else if (value == "medium")
+            level = FoveationLevel::MEDIUM;
+        else if (value == "high")
+            level = FoveationLevel::HIGH;
+        else
+            return false;
+        return true;
+    }
+
+    bool ParseArguments(int argc, char** argv, BenchmarkSettings& settings)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            const int valueCount = argument == "--compare" ? 2 : 1;
+            if (i + valueCount >= argc)
+            {
+                XR_TUT_LOG_ERROR("Missing value for " << argument);
+                return false;
+            }
+
+            const char* value = argv[++i];
+            const bool forwarded = argument == "--frames" || argument == "--warmup" || argument == "--refresh-rate" || argument == "--width" ||
+                                   argument == "--height" || argument == "--dynamic-resolution" || argument == "--foveation" ||
+                                   argument == "--msaa" || argument == "--record-threads" || argument == "--mesh-cache";
+            if (argument == "--frames")
+                settings.frameCount = std::strtoull(value, nullptr, 10);
+            else if (argument == "--warmup")
+                settings.warmupFrameCount = std::strtoull(value, nullptr, 10);
+            else if (argument == "--refresh-rate")
+                settings.refreshRate = value;
+            else if (argument == "--width")
+                settings.viewWidth = value;
+            else if (argument == "--height")
+                settings.viewHeight = value;
+            else if (argument == "--dynamic-resolution")
+                settings.dynamicResolution = std::atoi(value) != 0;
+            else if (argument == "--foveation")
+            {
+                if (!ParseFoveationLevel(value, settings.foveationLevel))
+                {
+                    XR_TUT_LOG_ERROR("Unknown foveation level " << value);
+                    return false;
+                }
+            }
+            else if (argument == "--msaa")
+                settings.sampleCount = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else if (argument == "--record-threads")
+                settings.recordThreadCount = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else if (argument == "--name")
+                settings.scene.name = value;
+            else if (argument == "--objects")
+                settings.scene.objectCount = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else if (argument == "--meshes")
+                settings.scene.uniqueMeshCount = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else if (argument == "--materials")
+                settings.scene.uniqueMaterialCount = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else if (argument == "--dynamic")
+                settings.scene.dynamicFraction = static_cast<float>(std::atof(value));
+            else if (argument == "--seed")
+                settings.scene.seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else if (argument == "--packed")
+                settings.scene.packedVertices = std::atoi(value) != 0;
+            else if (argument == "--lods")
+                settings.scene.generateLods = std::atoi(value) != 0;
+            else if (argument == "--stream")
+                settings.scene.streamMeshes = std::atoi(value) != 0;
+            else if (argument == "--features")
+                settings.scene.shaderFeatures = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+            else if (argument == "--mesh-cache")
+                settings.scene.meshCacheDirectory = value;
+            else if (argument == "--json")
+                settings.jsonPath = value;
+            else if (argument == "--require-gpu-timings")
+                settings.requireGpuTimings = std::atoi(value) != 0;
+            else if (argument == "--suite")
+                settings.suitePath = value;
+            else if (argument == "--compare")
+            {
+                settings.baselinePath = value;
+                settings.comparePath = argv[++i];
+            }
+            else if (argument == "--threshold")
+                settings.thresholdPercent = std::atof(value);
+            else
+            {
+                XR_TUT_LOG_ERROR("Unknown argument " << argument);
+                return false;
+            }
+
+            if (forwarded) settings.forwardedArguments += argument + " " + value + " ";
+        }
+
+        if (settings.frameCount == 0 || settings.warmupFrameCount >= settings.frameCount)
+        {
+            XR_TUT_LOG_ERROR("--frames must be larger than --warmup");
+            return false;
+        }
+        return true;
+    }
+
+    int RunBenchmark(const BenchmarkSettings& settings)
+    {
+        SetEnvironmentVariable("XR_RUNTIME_JSON", XR_BENCHMARK_RUNTIME_JSON, false);
+        if (!settings.refreshRate.empty()) SetEnvironmentVariable("XR_MOCK_REFRESH_RATE", settings.refreshRate, true);
+        if (!settings.viewWidth.empty()) SetEnvironmentVariable("XR_MOCK_VIEW_WIDTH", settings.viewWidth, true);
+        if (!settings.viewHeight.empty()) SetEnvironmentVariable("XR_MOCK_VIEW_HEIGHT", settings.viewHeight, true);
+
+        OpenXRResolutionMgr::SetEnabled(settings.dynamicResolution);
+        FoveationSettings foveationSettings = OpenXRFoveationMgr::GetSettings();
+        foveationSettings.level = settings.foveationLevel;
+        OpenXRFoveationMgr::SetSettings(foveationSettings);
+        OpenXRAttachmentMgr::SetSampleCount(settings.sampleCount);
+        DrawListRecorder::SetThreadCount(settings.recordThreadCount);
+
+        TraceLogMgr::Start();
+        {
+            OpenXRTutorial app(VULKAN);
+            app.SetScene(std::make_unique<StressScene>(settings.scene));
+            app.Run(settings.frameCount);
+        }
+        TraceLogMgr::Stop();
+
+        const BenchmarkResult result = BenchmarkReport::Collect(settings.scene, settings.warmupFrameCount);
+        BenchmarkReport::Print(result);
+
+        if (result.measuredFrameCount == 0)
+        {
+            XR_TUT_LOG_ERROR("No frames were measured, the session never ran");
+            return 1;
+        }
+        if (settings.requireGpuTimings && (result.gpuFrameMs.count == 0 || result.gpuFrameMs.p50 <= 0.0))
+        {
+            XR_TUT_LOG_ERROR("The GPU profiler read back no frame times");
+            return 1;
+        }
+        if (!settings.jsonPath.empty() && !BenchmarkReport::WriteJson(settings.jsonPath, {result}))
+        {
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchmarkSettings settings;
+    if (!ParseArguments(argc, argv, settings)) return 2;
+
+    if (!settings.baselinePath.empty())
+    {
+        return BenchmarkSuite::Compare(settings.baselinePath, settings.comparePath, settings.thresholdPercent) ? 0 : 1;
+    }
+    if (!settings.suitePath.empty())
+    {
+        return BenchmarkSuite::Run(argv[0], settings.forwardedArguments, settings.suitePath) ? 0 : 1;
+    }
+    return RunBenchmark(settings);
+}
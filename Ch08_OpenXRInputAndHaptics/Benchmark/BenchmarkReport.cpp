@@ -0,0 +1,210 @@
+﻿#include "BenchmarkReport.h"
+#include "../app/src/main/cpp/OpenXR/OpenXRFrameTimingMgr.h"
+#include "../app/src/main/cpp/Engine/Utils/Json.h"
+
+#include <DebugOutput.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    // Nearest-rank percentile of sorted values
+    double Percentile(const std::vector<double>& sortedValues, double percentile)
+    {
+        if (sortedValues.empty()) return 0.0;
+
+        size_t rank = static_cast<size_t>(percentile / 100.0 * static_cast<double>(sortedValues.size()) + 0.5);
+        rank = std::min(std::max(rank, static_cast<size_t>(1)), sortedValues.size());
+        return sortedValues[rank - 1];
+    }
+
+    void WriteSummary(std::ostream& stream, const char* name, const PercentileSummary& summary)
+    {
+        stream << "      \"" << name << "\": {\"count\": " << summary.count << ", \"p50\": " << summary.p50 << ", \"p90\": " << summary.p90
+               << ", \"p95\": " << summary.p95 << ", \"p99\": " << summary.p99 << ", \"max\": " << summary.max << "}";
+    }
+
+    PercentileSummary ReadSummary(const JsonValue& result, const char* name)
+    {
+        PercentileSummary summary;
+        const JsonValue* value = result.Find(name);
+        if (!value) return summary;
+
+        summary.count = static_cast<uint64_t>(value->GetNumber("count"));
+        summary.p50 = value->GetNumber("p50");
+        summary.p90 = value->GetNumber("p90");
+        summary.p95 = value->GetNumber("p95");
+        summary.p99 = value->GetNumber("p99");
+        summary.max = value->GetNumber("max");
+        return summary;
+    }
+
+    void PrintSummary(const char* label, const PercentileSummary& summary)
+    {
+        std::printf("  %-16s n=%-6llu p50=%7.3f p90=%7.3f p95=%7.3f p99=%7.3f max=%7.3f ms\n", label, static_cast<unsigned long long>(summary.count),
+                    summary.p50, summary.p90, summary.p95, summary.p99, summary.max);
+    }
+}
+
+PercentileSummary BenchmarkReport::Summarize(std::vector<double> values)
+{
+    std::sort(values.begin(), values.end());
+
+    PercentileSummary summary;
+    summary.count = values.size();
+    summary.p50 = Percentile(values, 50.0);
+    summary.p90 = Percentile(values, 90.0);
+    summary.p95 = Percentile(values, 95.0);
+    summary.p99 = Percentile(values, 99.0);
+    summary.max = values.empty() ? 0.0 : values.back();
+    return summary;
+}
+
+BenchmarkResult BenchmarkReport::Collect(const StressSceneConfig& scene, uint64_t warmupFrameCount)
+{
+    const int waitStage = static_cast<int>(FrameStage::WAIT);
+    const int endStage = static_cast<int>(FrameStage::END);
+
+    std::vector<FrameTimingRecord> frameRecords = OpenXRFrameTimingMgr::GetFrameRecords();
+    frameRecords.erase(std::remove_if(frameRecords.begin(), frameRecords.end(),
+                                      [warmupFrameCount](const FrameTimingRecord& record) { return record.frameIndex < warmupFrameCount; }),
+                       frameRecords.end());
+
+    BenchmarkResult result;
+    result.scene = scene;
+    result.measuredFrameCount = frameRecords.size();
+
+    // CPU time is measured from xrWaitFrame returning to xrEndFrame returning, so the wait for the display is excluded
+    std::vector<double> cpuTimesMs;
+    std::vector<double> frameIntervalsMs;
+    std::vector<int64_t> frameStartTimes;
+    for (size_t i = 0; i < frameRecords.size(); ++i)
+    {
+        const FrameTimingRecord& record = frameRecords[i];
+        const int64_t waitEnd = record.stageBegin[waitStage] + record.stageDuration[waitStage];
+        const int64_t frameEnd = record.stageBegin[endStage] + record.stageDuration[endStage];
+        cpuTimesMs.push_back(static_cast<double>(frameEnd - waitEnd) * 1e-6);
+        result.missedFrameCount += record.missedFrames;
+
+        if (i > 0)
+        {
+            frameIntervalsMs.push_back(static_cast<double>(waitEnd - frameStartTimes.back()) * 1e-6);
+        }
+        frameStartTimes.push_back(waitEnd);
+    }
+
+    // A frame renders one submission per view, so the GPU time of a frame is the sum of the top-level scopes
+    // that were submitted between its xrWaitFrame and the next one
+    std::vector<int64_t> gpuTimesNs(frameRecords.size(), 0);
+    for (const GpuTimingRecord& record : OpenXRFrameTimingMgr::GetGpuRecords())
+    {
+        if (record.depth != 0) continue;
+
+        auto it = std::upper_bound(frameStartTimes.begin(), frameStartTimes.end(), record.cpuBeginNs);
+        if (it == frameStartTimes.begin()) continue;
+        gpuTimesNs[static_cast<size_t>(it - frameStartTimes.begin() - 1)] += record.durationNs;
+    }
+    std::vector<double> gpuTimesMs;
+    for (int64_t gpuTimeNs : gpuTimesNs)
+    {
+        // Frames whose results were dropped or never read back are left out rather than counted as free
+        if (gpuTimeNs > 0) gpuTimesMs.push_back(static_cast<double>(gpuTimeNs) * 1e-6);
+    }
+
+    result.cpuFrameMs = Summarize(cpuTimesMs);
+    result.frameIntervalMs = Summarize(frameIntervalsMs);
+    result.gpuFrameMs = Summarize(gpuTimesMs);
+    return result;
+}
+
+void BenchmarkReport::Print(const BenchmarkResult& result)
+{
+    std::printf("%s: %llu frames measured, %llu display periods missed\n", result.scene.name.c_str(),
+                static_cast<unsigned long long>(result.measuredFrameCount), static_cast<unsigned long long>(result.missedFrameCount));
+    PrintSummary("CPU frame time", result.cpuFrameMs);
+    PrintSummary("Frame interval", result.frameIntervalMs);
+    PrintSummary("GPU frame time", result.gpuFrameMs);
+}
+
+bool BenchmarkReport::WriteJson(const std::string& filePath, const std::vector<BenchmarkResult>& results)
+{
+    std::ofstream file(filePath);
+    if (!file.is_open())
+    {
+        XR_TUT_LOG_ERROR("Failed to open benchmark results file: " << filePath);
+        return false;
+    }
+
+    file << "{\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult& result = results[i];
+        const StressSceneConfig& scene = result.scene;
+        file << "    {\n";
+        file << "      \"name\": \"" << scene.name << "\",\n";
+        file << "      \"scene\": {\"objects\": " << scene.objectCount << ", \"uniqueMeshes\": " << scene.uniqueMeshCount
+             << ", \"uniqueMaterials\": " << scene.uniqueMaterialCount << ", \"dynamicFraction\": " << scene.dynamicFraction << ", \"seed\": " << scene.seed
+             << ", \"packedVertices\": " << (scene.packedVertices ? 1 : 0)
+             << ", \"generateLods\": " << (scene.generateLods ? 1 : 0)
+             << ", \"streamMeshes\": " << (scene.streamMeshes ? 1 : 0) << ", \"shaderFeatures\": " << scene.shaderFeatures << "},\n";
+        file << "      \"measuredFrames\": " << result.measuredFrameCount << ",\n";
+        file << "      \"missedFrames\": " << result.missedFrameCount << ",\n";
+        WriteSummary(file, "cpuFrameMs", result.cpuFrameMs);
+        file << ",\n";
+        WriteSummary(file, "frameIntervalMs", result.frameIntervalMs);
+        file << ",\n";
+        WriteSummary(file, "gpuFrameMs", result.gpuFrameMs);
+        file << "\n    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    file << "  ]\n}\n";
+
+    return file.good();
+}
+
+bool BenchmarkReport::ReadJson(const std::string& filePath, std::vector<BenchmarkResult>& results)
+{
+    std::ifstream file(filePath);
+    if (!file.is_open())
+    {
+        XR_TUT_LOG_ERROR("Failed to open benchmark results file: " << filePath);
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string text = buffer.str();
+
+    JsonValue root;
+    const JsonValue* resultsValue = JsonValue::Parse(text.data(), text.size(), root) ? root.Find("results") : nullptr;
+    if (!resultsValue || !resultsValue->IsArray())
+    {
+        XR_TUT_LOG_ERROR("Malformed benchmark results file: " << filePath);
+        return false;
+    }
+
+    for (const JsonValue& value : resultsValue->array)
+    {
+        BenchmarkResult result;
+        result.scene.name = value.GetString("name");
+        if (const JsonValue* scene = value.Find("scene"))
+        {
+            result.scene.objectCount = static_cast<uint32_t>(scene->GetNumber("objects"));
+            result.scene.uniqueMeshCount = static_cast<uint32_t>(scene->GetNumber("uniqueMeshes"));
+            result.scene.uniqueMaterialCount = static_cast<uint32_t>(scene->GetNumber("uniqueMaterials"));
+            result.scene.dynamicFraction = static_cast<float>(scene->GetNumber("dynamicFraction"));
+            result.scene.seed = static_cast<uint32_t>(scene->GetNumber("seed"));
+            result.scene.packedVertices = scene->GetNumber("packedVertices") != 0.0;
+            result.scene.generateLods = scene->GetNumber("generateLods") != 0.0;
+            result.scene.streamMeshes = scene->GetNumber("streamMeshes") != 0.0;
+            result.scene.shaderFeatures = static_cast<uint32_t>(scene->GetNumber("shaderFeatures"));
+        }
+        result.measuredFrameCount = static_cast<uint64_t>(value.GetNumber("measuredFrames"));
+        result.missedFrameCount = static_cast<uint64_t>(value.GetNumber("missedFrames"));
+        result.cpuFrameMs = ReadSummary(value, "cpuFrameMs");
+        result.frameIntervalMs = ReadSummary(value, "frameIntervalMs");
+        result.gpuFrameMs = ReadSummary(value, "gpuFrameMs");
+        results.push_back(result);
+    }
+    return true;
+}
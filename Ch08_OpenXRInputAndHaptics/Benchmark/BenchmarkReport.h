@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include "../app/src/main/cpp/Scenes/StressSceneConfig.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct PercentileSummary
+{
+    uint64_t count = 0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+struct BenchmarkResult
+{
+    StressSceneConfig scene;
+    uint64_t measuredFrameCount = 0;
+    uint64_t missedFrameCount = 0;
+    PercentileSummary cpuFrameMs;
+    PercentileSummary frameIntervalMs;
+    PercentileSummary gpuFrameMs;
+};
+
+// Turns the frame timing records into percentiles and reads/writes them as JSON:
+// {"results": [{"name": ..., "scene": {...}, "cpuFrameMs": {"p50": ...}, ...}]}
+class BenchmarkReport
+{
+public:
+    // Summarizes the records of OpenXRFrameTimingMgr, skipping frames below warmupFrameCount
+    static BenchmarkResult Collect(const StressSceneConfig& scene, uint64_t warmupFrameCount);
+
+    static void Print(const BenchmarkResult& result);
+
+    static bool WriteJson(const std::string& filePath, const std::vector<BenchmarkResult>& results);
+    static bool ReadJson(const std::string& filePath, std::vector<BenchmarkResult>& results);
+
+private:
+    static PercentileSummary Summarize(std::vector<double> values);
+};
@@ -0,0 +1,141 @@
+﻿#include "BenchmarkSuite.h"
+
+#include <DebugOutput.h>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+namespace
+{
+    StressSceneConfig MakeCase(const char* name, uint32_t objectCount, uint32_t uniqueMeshCount, uint32_t uniqueMaterialCount, float dynamicFraction,
+                               bool packedVertices = false, bool generateLods = false)
+    {
+        StressSceneConfig config;
+        config.name = name;
+        config.objectCount = objectCount;
+        config.uniqueMeshCount = uniqueMeshCount;
+        config.uniqueMaterialCount = uniqueMaterialCount;
+        config.dynamicFraction = dynamicFraction;
+        config.packedVertices = packedVertices;
+        config.generateLods = generateLods;
+        return config;
+    }
+
+    std::string Quote(const std::string& argument)
+    {
+        return "\"" + argument + "\"";
+    }
+
+    // Returns true when current is worse than baseline by more than the threshold
+    bool CheckMetric(const std::string& caseName, const char* metricName, double baseline, double current, double thresholdPercent)
+    {
+        const double changePercent = baseline > 0.0 ? (current - baseline) / baseline * 100.0 : 0.0;
+        const bool regressed = changePercent > thresholdPercent && current - baseline > BenchmarkSuite::MIN_REGRESSION_MS;
+        std::printf("%-16s %-12s %9.3f %9.3f %+8.1f%% %s\n", caseName.c_str(), metricName, baseline, current, changePercent, regressed ? "REGRESSION" : "");
+        return regressed;
+    }
+}
+
+std::vector<StressSceneConfig> BenchmarkSuite::GetDefaultCases()
+{
+    // Each case varies one parameter from the 500 object reference case, except the meshes_64_* cases, which
+    // vary one parameter from meshes_64
+    return {
+        MakeCase("minimal", 5, 1, 1, 0.0f),
+        MakeCase("reference", 500, 8, 8, 0.25f),
+        MakeCase("objects_2000", 2000, 8, 8, 0.25f),
+        MakeCase("meshes_64", 500, 64, 8, 0.25f),
+        MakeCase("materials_64", 500, 8, 64, 0.25f),
+        MakeCase("static", 500, 8, 8, 0.0f),
+        MakeCase("dynamic", 500, 8, 8, 1.0f),
+        MakeCase("meshes_64_packed", 500, 64, 8, 0.25f, true),
+        MakeCase("meshes_64_lods", 500, 64, 8, 0.25f, false, true),
+    };
+}
+
+bool BenchmarkSuite::Run(const std::string& executablePath, const std::string& extraArguments, const std::string& outputPath)
+{
+    std::vector<BenchmarkResult> results;
+    bool succeeded = true;
+
+    for (const StressSceneConfig& config : GetDefaultCases())
+    {
+        const std::string caseOutputPath = outputPath + "." + config.name + ".json";
+
+        // A fresh process per case, so no OpenXR or Vulkan state leaks from one case into the next
+        std::ostringstream command;
+        command << Quote(executablePath) << " --name " << config.name << " --objects " << config.objectCount << " --meshes " << config.uniqueMeshCount
+                << " --materials " << config.uniqueMaterialCount << " --dynamic " << config.dynamicFraction << " --seed " << config.seed
+                << " --packed " << config.packedVertices << " --lods " << config.generateLods << " --stream " << config.streamMeshes
+                << " --features " << config.shaderFeatures << " --json " << Quote(caseOutputPath) << " " << extraArguments;
+#if defined(_WIN32)
+        // cmd.exe strips the outer pair of quotes
+        const std::string commandLine = Quote(command.str());
+#else
+        const std::string commandLine = command.str();
+#endif
+
+        XR_TUT_LOG("Running benchmark case " << config.name);
+        std::vector<BenchmarkResult> caseResults;
+        if (std::system(commandLine.c_str()) != 0 || !BenchmarkReport::ReadJson(caseOutputPath, caseResults) || caseResults.empty())
+        {
+            XR_TUT_LOG_ERROR("Benchmark case " << config.name << " failed");
+            succeeded = false;
+            continue;
+        }
+        std::remove(caseOutputPath.c_str());
+        results.push_back(caseResults.front());
+    }
+
+    return BenchmarkReport::WriteJson(outputPath, results) && succeeded;
+}
+
+bool BenchmarkSuite::Compare(const std::string& baselinePath, const std::string& currentPath, double thresholdPercent)
+{
+    std::vector<BenchmarkResult> baselineResults;
+    std::vector<BenchmarkResult> currentResults;
+    if (!BenchmarkReport::ReadJson(baselinePath, baselineResults) || !BenchmarkReport::ReadJson(currentPath, currentResults))
+    {
+        return false;
+    }
+
+    std::printf("%-16s %-12s %9s %9s %9s\n", "case", "metric", "baseline", "current", "change");
+
+    bool regressed = false;
+    for (const BenchmarkResult& current : currentResults)
+    {
+        const BenchmarkResult* baseline = nullptr;
+        for (const BenchmarkResult& result : baselineResults)
+        {
+            if (result.scene.name == current.scene.name) baseline = &result;
+        }
+        if (!baseline)
+        {
+            std::printf("%-16s not in the baseline, skipped\n", current.scene.name.c_str());
+            continue;
+        }
+
+        const std::string& name = current.scene.name;
+        regressed |= CheckMetric(name, "cpu p50", baseline->cpuFrameMs.p50, current.cpuFrameMs.p50, thresholdPercent);
+        regressed |= CheckMetric(name, "cpu p95", baseline->cpuFrameMs.p95, current.cpuFrameMs.p95, thresholdPercent);
+
+        // GPU timings are missing when the device has no timestamp support
+        if (baseline->gpuFrameMs.count > 0 && current.gpuFrameMs.count > 0)
+        {
+            regressed |= CheckMetric(name, "gpu p50", baseline->gpuFrameMs.p50, current.gpuFrameMs.p50, thresholdPercent);
+            regressed |= CheckMetric(name, "gpu p95", baseline->gpuFrameMs.p95, current.gpuFrameMs.p95, thresholdPercent);
+        }
+    }
+
+    for (const BenchmarkResult& baseline : baselineResults)
+    {
+        bool found = false;
+        for (const BenchmarkResult& current : currentResults)
+        {
+            found |= current.scene.name == baseline.scene.name;
+        }
+        if (!found) std::printf("%-16s missing from the current results\n", baseline.scene.name.c_str());
+    }
+
+    return !regressed;
+}
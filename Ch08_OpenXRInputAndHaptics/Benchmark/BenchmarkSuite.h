@@ -0,0 +1,22 @@
+﻿#pragma once
+
+#include "BenchmarkReport.h"
+
+#include <string>
+#include <vector>
+
+// Runs every stress scene case in its own benchmark process and compares result files against a baseline
+class BenchmarkSuite
+{
+public:
+    static std::vector<StressSceneConfig> GetDefaultCases();
+
+    // Runs each case as "<executablePath> <caseArguments> <extraArguments>" and writes all results to outputPath
+    static bool Run(const std::string& executablePath, const std::string& extraArguments, const std::string& outputPath);
+
+    // Returns false when a case is slower than the baseline by more than thresholdPercent
+    static bool Compare(const std::string& baselinePath, const std::string& currentPath, double thresholdPercent);
+
+    // Differences smaller than this are treated as noise whatever the relative change
+    static constexpr double MIN_REGRESSION_MS = 0.05;
+};
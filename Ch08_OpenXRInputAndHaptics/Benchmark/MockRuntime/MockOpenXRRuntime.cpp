@@ -0,0 +1,1108 @@
+﻿// Minimal OpenXR runtime for headless benchmarking. Loaded by the OpenXR loader through XR_RUNTIME_JSON, it
+// paces xrWaitFrame at a fixed refresh rate, reports synthetic head and controller motion and backs swapchains
+// with plain Vulkan images on the application's device (e.g. lavapipe). Nothing is ever displayed.
+//
+// Settings are read from the environment when the instance is created:
+//   XR_MOCK_REFRESH_RATE   display refresh rate in Hz (default 90)
+//   XR_MOCK_VIEW_WIDTH     recommended per-eye width in pixels (default 1024)
+//   XR_MOCK_VIEW_HEIGHT    recommended per-eye height in pixels (default 1024)
+//
+// The runtime assumes a single instance and session driven from one thread, which is all the benchmark needs.
+
+#include <vulkan/vulkan.h>
+
+#ifndef XR_USE_GRAPHICS_API_VULKAN
+#define XR_USE_GRAPHICS_API_VULKAN
+#endif
+#include <openxr/openxr.h>
+#include <openxr/openxr_platform.h>
+#include <openxr/openxr_loader_negotiation.h>
+#include <openxr/openxr_reflection.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+#define MOCK_RUNTIME_EXPORT __declspec(dllexport)
+#else
+#define MOCK_RUNTIME_EXPORT __attribute__((visibility("default")))
+#endif
+
+namespace
+{
+    struct MockSettings
+    {
+        int64_t displayPeriodNs = 11111111;
+        uint32_t viewWidth = 1024;
+        uint32_t viewHeight = 1024;
+    };
+
+    struct MockSession;
+
+    struct MockInstance
+    {
+        std::vector<std::string> paths{""};  // An XrPath is an index into this list, 0 being XR_NULL_PATH
+        std::unordered_map<std::string, XrPath> pathIds;
+        std::deque<XrEventDataBuffer> events;
+        XrPath interactionProfile = XR_NULL_PATH;
+        MockSession* session = nullptr;
+    };
+
+    struct MockSession
+    {
+        MockInstance* instance = nullptr;
+        XrSessionState state = XR_SESSION_STATE_UNKNOWN;
+        XrGraphicsBindingVulkanKHR graphicsBinding{};
+
+        int64_t vsyncEpoch = 0;
+        int64_t lastVsyncIndex = -1;
+        bool frameWaited = false;
+        bool frameBegun = false;
+        uint64_t submittedFrameCount = 0;
+        uint64_t hapticRequestCount = 0;
+    };
+
+    struct MockSwapchain
+    {
+        MockSession* session = nullptr;
+        std::vector<VkImage> images;
+        std::vector<VkDeviceMemory> memories;
+        uint32_t nextImageIndex = 0;
+        std::deque<uint32_t> acquiredImages;
+        uint32_t waitedCount = 0;
+    };
+
+    struct MockSpace
+    {
+        bool isActionSpace = false;
+        XrReferenceSpaceType referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+        XrPath subactionPath = XR_NULL_PATH;
+    };
+
+    struct MockActionSet
+    {
+        std::string name;
+    };
+
+    struct MockAction
+    {
+        MockActionSet* actionSet = nullptr;
+        XrActionType type = XR_ACTION_TYPE_BOOLEAN_INPUT;
+        std::string name;
+    };
+
+    MockSettings g_Settings;
+    MockInstance* g_Instance = nullptr;
+
+    const char* const SUPPORTED_EXTENSIONS[] = {XR_KHR_VULKAN_ENABLE_EXTENSION_NAME};
+    const int64_t SUPPORTED_SWAPCHAIN_FORMATS[] = {VK_FORMAT_R8G8B8A8_SRGB, VK_FORMAT_B8G8R8A8_SRGB, VK_FORMAT_R8G8B8A8_UNORM,
+                                                   VK_FORMAT_B8G8R8A8_UNORM, VK_FORMAT_D32_SFLOAT, VK_FORMAT_D16_UNORM};
+    const uint32_t SWAPCHAIN_IMAGE_COUNT = 3;
+    const uint32_t VIEW_COUNT = 2;
+    const float HALF_IPD = 0.032f;
+    const float HALF_FOV = 0.785f;
+    const double PI = 3.14159265358979323846;
+
+    template <typename HandleT, typename T>
+    HandleT ToHandle(T* object)
+    {
+        return (HandleT)(uintptr_t)object;
+    }
+
+    template <typename T, typename HandleT>
+    T* FromHandle(HandleT handle)
+    {
+        return (T*)(uintptr_t)handle;
+    }
+
+    int64_t GetTimeNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    double ReadEnvironmentNumber(const char* name, double defaultValue)
+    {
+        const char* value = std::getenv(name);
+        if (!value || !*value) return defaultValue;
+
+        const double number = std::atof(value);
+        return number > 0.0 ? number : defaultValue;
+    }
+
+    template <typename T>
+    const T* FindChained(const void* next, XrStructureType type)
+    {
+        for (const XrBaseInStructure* header = static_cast<const XrBaseInStructure*>(next); header; header = header->next)
+        {
+            if (header->type == type) return reinterpret_cast<const T*>(header);
+        }
+        return nullptr;
+    }
+
+    template <typename T>
+    T* FindChainedOutput(void* next, XrStructureType type)
+    {
+        for (XrBaseOutStructure* header = static_cast<XrBaseOutStructure*>(next); header; header = header->next)
+        {
+            if (header->type == type) return reinterpret_cast<T*>(header);
+        }
+        return nullptr;
+    }
+
+    // Two-call idiom: reports the required count and fills the output only when it is large enough
+    XrResult CheckCapacity(uint32_t capacityInput, uint32_t* countOutput, uint32_t requiredCount)
+    {
+        if (!countOutput) return XR_ERROR_VALIDATION_FAILURE;
+
+        *countOutput = requiredCount;
+        if (capacityInput != 0 && capacityInput < requiredCount) return XR_ERROR_SIZE_INSUFFICIENT;
+        return XR_SUCCESS;
+    }
+
+    XrResult WriteString(const std::string& value, uint32_t capacityInput, uint32_t* countOutput, char* buffer)
+    {
+        const uint32_t requiredCount = static_cast<uint32_t>(value.size() + 1);
+        const XrResult result = CheckCapacity(capacityInput, countOutput, requiredCount);
+        if (result == XR_SUCCESS && capacityInput != 0)
+        {
+            std::memcpy(buffer, value.c_str(), requiredCount);
+        }
+        return result;
+    }
+
+    void PushSessionState(MockSession* session, XrSessionState state)
+    {
+        session->state = state;
+
+        XrEventDataBuffer buffer{};
+        XrEventDataSessionStateChanged* event = reinterpret_cast<XrEventDataSessionStateChanged*>(&buffer);
+        event->type = XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED;
+        event->session = ToHandle<XrSession>(session);
+        event->state = state;
+        event->time = GetTimeNs();
+        session->instance->events.push_back(buffer);
+    }
+
+    bool IsSessionRunning(const MockSession* session)
+    {
+        return session->state >= XR_SESSION_STATE_SYNCHRONIZED && session->state <= XR_SESSION_STATE_STOPPING;
+    }
+
+    // Synthetic motion: the head looks slowly around and the controllers trace small circles in front of it
+
+    XrQuaternionf QuaternionFromYawPitch(float yaw, float pitch)
+    {
+        const float cy = std::cos(yaw * 0.5f), sy = std::sin(yaw * 0.5f);
+        const float cp = std::cos(pitch * 0.5f), sp = std::sin(pitch * 0.5f);
+        return {cy * sp, sy * cp, -sy * sp, cy * cp};
+    }
+
+    XrVector3f Rotate(const XrQuaternionf& q, const XrVector3f& v)
+    {
+        // v + 2 * cross(q.xyz, cross(q.xyz, v) + q.w * v)
+        const XrVector3f u{q.x, q.y, q.z};
+        const XrVector3f t{u.y * v.z - u.z * v.y + q.w * v.x, u.z * v.x - u.x * v.z + q.w * v.y, u.x * v.y - u.y * v.x + q.w * v.z};
+        return {v.x + 2.0f * (u.y * t.z - u.z * t.y), v.y + 2.0f * (u.z * t.x - u.x * t.z), v.z + 2.0f * (u.x * t.y - u.y * t.x)};
+    }
+
+    XrPosef GetHeadPose(XrTime time)
+    {
+        const double seconds = static_cast<double>(time) * 1e-9;
+        XrPosef pose{};
+        pose.orientation = QuaternionFromYawPitch(static_cast<float>(0.35 * std::sin(2.0 * PI * 0.2 * seconds)),
+                                                  static_cast<float>(0.1 * std::sin(2.0 * PI * 0.13 * seconds)));
+        pose.position = {static_cast<float>(0.02 * std::sin(2.0 * PI * 0.3 * seconds)), 0.0f, 0.0f};
+        return pose;
+    }
+
+    XrPosef GetHandPose(bool isLeft, XrTime time)
+    {
+        const double phase = 2.0 * PI * 0.5 * static_cast<double>(time) * 1e-9;
+        XrPosef pose{};
+        pose.orientation = {0.0f, 0.0f, 0.0f, 1.0f};
+        pose.position = {(isLeft ? -0.2f : 0.2f) + static_cast<float>(0.05 * std::cos(phase)), -0.3f + static_cast<float>(0.05 * std::sin(phase)), -0.4f};
+        return pose;
+    }
+
+    XrPosef GetSpacePose(const MockSpace* space, XrTime time)
+    {
+        if (space->isActionSpace)
+        {
+            const std::string& subactionPath = g_Instance->paths[static_cast<size_t>(space->subactionPath)];
+            return GetHandPose(subactionPath.find("left") != std::string::npos, time);
+        }
+        if (space->referenceSpaceType == XR_REFERENCE_SPACE_TYPE_VIEW)
+        {
+            return GetHeadPose(time);
+        }
+
+        XrPosef identity{};
+        identity.orientation.w = 1.0f;
+        return identity;
+    }
+
+    VkImageUsageFlags ToVulkanUsage(XrSwapchainUsageFlags usageFlags)
+    {
+        VkImageUsageFlags usage = 0;
+        if (usageFlags & XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT) usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        if (usageFlags & XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) usage |= VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        if (usageFlags & XR_SWAPCHAIN_USAGE_UNORDERED_ACCESS_BIT) usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+        if (usageFlags & XR_SWAPCHAIN_USAGE_TRANSFER_SRC_BIT) usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        if (usageFlags & XR_SWAPCHAIN_USAGE_TRANSFER_DST_BIT) usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        if (usageFlags & XR_SWAPCHAIN_USAGE_SAMPLED_BIT) usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+        return usage;
+    }
+
+    void DestroySwapchainImages(MockSwapchain* swapchain)
+    {
+        const VkDevice device = swapchain->session->graphicsBinding.device;
+        for (VkImage image : swapchain->images)
+        {
+            vkDestroyImage(device, image, nullptr);
+        }
+        for (VkDeviceMemory memory : swapchain->memories)
+        {
+            vkFreeMemory(device, memory, nullptr);
+        }
+        swapchain->images.clear();
+        swapchain->memories.clear();
+    }
+
+    // Instance
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockEnumerateApiLayerProperties(uint32_t propertyCapacityInput, uint32_t* propertyCountOutput, XrApiLayerProperties*)
+    {
+        return CheckCapacity(propertyCapacityInput, propertyCountOutput, 0);
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockEnumerateInstanceExtensionProperties(const char* layerName, uint32_t propertyCapacityInput,
+                                                                           uint32_t* propertyCountOutput, XrExtensionProperties* properties)
+    {
+        if (layerName) return XR_ERROR_API_LAYER_NOT_PRESENT;
+
+        const uint32_t extensionCount = static_cast<uint32_t>(sizeof(SUPPORTED_EXTENSIONS) / sizeof(SUPPORTED_EXTENSIONS[0]));
+        const XrResult result = CheckCapacity(propertyCapacityInput, propertyCountOutput, extensionCount);
+        if (result != XR_SUCCESS || propertyCapacityInput == 0) return result;
+
+        for (uint32_t i = 0; i < extensionCount; ++i)
+        {
+            std::strncpy(properties[i].extensionName, SUPPORTED_EXTENSIONS[i], XR_MAX_EXTENSION_NAME_SIZE - 1);
+            properties[i].extensionVersion = 1;
+        }
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockCreateInstance(const XrInstanceCreateInfo* createInfo, XrInstance* instance)
+    {
+        if (!createInfo || !instance) return XR_ERROR_VALIDATION_FAILURE;
+        if (g_Instance) return XR_ERROR_LIMIT_REACHED;
+
+        for (uint32_t i = 0; i < createInfo->enabledExtensionCount; ++i)
+        {
+            const char* requested = createInfo->enabledExtensionNames[i];
+            const bool supported = std::any_of(std::begin(SUPPORTED_EXTENSIONS), std::end(SUPPORTED_EXTENSIONS),
+                                               [requested](const char* name) { return std::strcmp(name, requested) == 0; });
+            if (!supported) return XR_ERROR_EXTENSION_NOT_PRESENT;
+        }
+
+        g_Settings.displayPeriodNs = static_cast<int64_t>(1e9 / ReadEnvironmentNumber("XR_MOCK_REFRESH_RATE", 90.0));
+        g_Settings.viewWidth = static_cast<uint32_t>(ReadEnvironmentNumber("XR_MOCK_VIEW_WIDTH", 1024.0));
+        g_Settings.viewHeight = static_cast<uint32_t>(ReadEnvironmentNumber("XR_MOCK_VIEW_HEIGHT", 1024.0));
+
+        g_Instance = new MockInstance();
+        *instance = ToHandle<XrInstance>(g_Instance);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockDestroyInstance(XrInstance instance)
+    {
+        MockInstance* mockInstance = FromHandle<MockInstance>(instance);
+        if (!mockInstance || mockInstance != g_Instance) return XR_ERROR_HANDLE_INVALID;
+
+        delete mockInstance;
+        g_Instance = nullptr;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetInstanceProperties(XrInstance, XrInstanceProperties* instanceProperties)
+    {
+        instanceProperties->runtimeVersion = XR_MAKE_VERSION(1, 0, 0);
+        std::strncpy(instanceProperties->runtimeName, "Mock Benchmark Runtime", XR_MAX_RUNTIME_NAME_SIZE - 1);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockPollEvent(XrInstance instance, XrEventDataBuffer* eventData)
+    {
+        MockInstance* mockInstance = FromHandle<MockInstance>(instance);
+        if (mockInstance->events.empty()) return XR_EVENT_UNAVAILABLE;
+
+        *eventData = mockInstance->events.front();
+        mockInstance->events.pop_front();
+        return XR_SUCCESS;
+    }
+
+#define MOCK_ENUM_NAME_CASE(name, value) \
+    case name:                           \
+        return #name;
+
+    const char* GetResultName(XrResult value)
+    {
+        switch (value)
+        {
+            XR_LIST_ENUM_XrResult(MOCK_ENUM_NAME_CASE)
+        default:
+            return nullptr;
+        }
+    }
+
+    const char* GetStructureTypeName(XrStructureType value)
+    {
+        switch (value)
+        {
+            XR_LIST_ENUM_XrStructureType(MOCK_ENUM_NAME_CASE)
+        default:
+            return nullptr;
+        }
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockResultToString(XrInstance, XrResult value, char buffer[XR_MAX_RESULT_STRING_SIZE])
+    {
+        const char* name = GetResultName(value);
+        if (name)
+        {
+            std::strncpy(buffer, name, XR_MAX_RESULT_STRING_SIZE - 1);
+            buffer[XR_MAX_RESULT_STRING_SIZE - 1] = '\0';
+        }
+        else
+        {
+            std::snprintf(buffer, XR_MAX_RESULT_STRING_SIZE, "XR_UNKNOWN_%s_%d", value < 0 ? "FAILURE" : "SUCCESS", static_cast<int>(value));
+        }
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockStructureTypeToString(XrInstance, XrStructureType value, char buffer[XR_MAX_STRUCTURE_NAME_SIZE])
+    {
+        const char* name = GetStructureTypeName(value);
+        if (name)
+        {
+            std::strncpy(buffer, name, XR_MAX_STRUCTURE_NAME_SIZE - 1);
+            buffer[XR_MAX_STRUCTURE_NAME_SIZE - 1] = '\0';
+        }
+        else
+        {
+            std::snprintf(buffer, XR_MAX_STRUCTURE_NAME_SIZE, "XR_UNKNOWN_STRUCTURE_TYPE_%d", static_cast<int>(value));
+        }
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockStringToPath(XrInstance instance, const char* pathString, XrPath* path)
+    {
+        MockInstance* mockInstance = FromHandle<MockInstance>(instance);
+        if (!pathString || pathString[0] != '/') return XR_ERROR_PATH_FORMAT_INVALID;
+
+        auto it = mockInstance->pathIds.find(pathString);
+        if (it == mockInstance->pathIds.end())
+        {
+            it = mockInstance->pathIds.emplace(pathString, static_cast<XrPath>(mockInstance->paths.size())).first;
+            mockInstance->paths.emplace_back(pathString);
+        }
+        *path = it->second;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockPathToString(XrInstance instance, XrPath path, uint32_t bufferCapacityInput, uint32_t* bufferCountOutput, char* buffer)
+    {
+        MockInstance* mockInstance = FromHandle<MockInstance>(instance);
+        if (path == XR_NULL_PATH || path >= mockInstance->paths.size()) return XR_ERROR_PATH_INVALID;
+
+        return WriteString(mockInstance->paths[static_cast<size_t>(path)], bufferCapacityInput, bufferCountOutput, buffer);
+    }
+
+    // System
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetSystem(XrInstance, const XrSystemGetInfo* getInfo, XrSystemId* systemId)
+    {
+        if (getInfo->formFactor != XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY) return XR_ERROR_FORM_FACTOR_UNSUPPORTED;
+
+        *systemId = 1;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetSystemProperties(XrInstance, XrSystemId systemId, XrSystemProperties* properties)
+    {
+        if (systemId != 1) return XR_ERROR_SYSTEM_INVALID;
+
+        properties->systemId = systemId;
+        properties->vendorId = 0;
+        std::strncpy(properties->systemName, "Mock Benchmark HMD", XR_MAX_SYSTEM_NAME_SIZE - 1);
+        properties->graphicsProperties.maxLayerCount = XR_MIN_COMPOSITION_LAYERS_SUPPORTED;
+        properties->graphicsProperties.maxSwapchainImageWidth = 4096;
+        properties->graphicsProperties.maxSwapchainImageHeight = 4096;
+        properties->trackingProperties.orientationTracking = XR_TRUE;
+        properties->trackingProperties.positionTracking = XR_TRUE;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockEnumerateViewConfigurations(XrInstance, XrSystemId, uint32_t viewConfigurationTypeCapacityInput,
+                                                                  uint32_t* viewConfigurationTypeCountOutput,
+                                                                  XrViewConfigurationType* viewConfigurationTypes)
+    {
+        const XrResult result = CheckCapacity(viewConfigurationTypeCapacityInput, viewConfigurationTypeCountOutput, 1);
+        if (result == XR_SUCCESS && viewConfigurationTypeCapacityInput != 0)
+        {
+            viewConfigurationTypes[0] = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
+        }
+        return result;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetViewConfigurationProperties(XrInstance, XrSystemId, XrViewConfigurationType viewConfigurationType,
+                                                                     XrViewConfigurationProperties* configurationProperties)
+    {
+        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+
+        configurationProperties->viewConfigurationType = viewConfigurationType;
+        configurationProperties->fovMutable = XR_FALSE;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockEnumerateViewConfigurationViews(XrInstance, XrSystemId, XrViewConfigurationType viewConfigurationType,
+                                                                      uint32_t viewCapacityInput, uint32_t* viewCountOutput, XrViewConfigurationView* views)
+    {
+        if (viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+
+        const XrResult result = CheckCapacity(viewCapacityInput, viewCountOutput, VIEW_COUNT);
+        if (result != XR_SUCCESS || viewCapacityInput == 0) return result;
+
+        for (uint32_t i = 0; i < VIEW_COUNT; ++i)
+        {
+            views[i].recommendedImageRectWidth = g_Settings.viewWidth;
+            views[i].maxImageRectWidth = std::min(g_Settings.viewWidth * 2, 4096u);
+            views[i].recommendedImageRectHeight = g_Settings.viewHeight;
+            views[i].maxImageRectHeight = std::min(g_Settings.viewHeight * 2, 4096u);
+            views[i].recommendedSwapchainSampleCount = 1;
+            views[i].maxSwapchainSampleCount = 4;
+        }
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockEnumerateEnvironmentBlendModes(XrInstance, XrSystemId, XrViewConfigurationType, uint32_t environmentBlendModeCapacityInput,
+                                                                     uint32_t* environmentBlendModeCountOutput,
+                                                                     XrEnvironmentBlendMode* environmentBlendModes)
+    {
+        const XrResult result = CheckCapacity(environmentBlendModeCapacityInput, environmentBlendModeCountOutput, 1);
+        if (result == XR_SUCCESS && environmentBlendModeCapacityInput != 0)
+        {
+            environmentBlendModes[0] = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
+        }
+        return result;
+    }
+
+    // XR_KHR_vulkan_enable
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetVulkanGraphicsRequirementsKHR(XrInstance, XrSystemId, XrGraphicsRequirementsVulkanKHR* graphicsRequirements)
+    {
+        graphicsRequirements->minApiVersionSupported = XR_MAKE_VERSION(1, 0, 0);
+        graphicsRequirements->maxApiVersionSupported = XR_MAKE_VERSION(1, 3, 0);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetVulkanExtensionsKHR(XrInstance, XrSystemId, uint32_t bufferCapacityInput, uint32_t* bufferCountOutput, char* buffer)
+    {
+        // Images are only ever created on the application's device, so no extensions are needed
+        return WriteString("", bufferCapacityInput, bufferCountOutput, buffer);
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetVulkanGraphicsDeviceKHR(XrInstance, XrSystemId, VkInstance vkInstance, VkPhysicalDevice* vkPhysicalDevice)
+    {
+        uint32_t physicalDeviceCount = 0;
+        vkEnumeratePhysicalDevices(vkInstance, &physicalDeviceCount, nullptr);
+        if (physicalDeviceCount == 0) return XR_ERROR_RUNTIME_FAILURE;
+
+        // The first device is used; point VK_ICD_FILENAMES at lavapipe to benchmark without a GPU
+        std::vector<VkPhysicalDevice> physicalDevices(physicalDeviceCount);
+        vkEnumeratePhysicalDevices(vkInstance, &physicalDeviceCount, physicalDevices.data());
+        *vkPhysicalDevice = physicalDevices[0];
+        return XR_SUCCESS;
+    }
+
+    // Session
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockCreateSession(XrInstance instance, const XrSessionCreateInfo* createInfo, XrSession* session)
+    {
+        MockInstance* mockInstance = FromHandle<MockInstance>(instance);
+        if (mockInstance->session) return XR_ERROR_LIMIT_REACHED;
+        if (createInfo->systemId != 1) return XR_ERROR_SYSTEM_INVALID;
+
+        const XrGraphicsBindingVulkanKHR* binding = FindChained<XrGraphicsBindingVulkanKHR>(createInfo->next, XR_TYPE_GRAPHICS_BINDING_VULKAN_KHR);
+        if (!binding || binding->device == VK_NULL_HANDLE) return XR_ERROR_GRAPHICS_DEVICE_INVALID;
+
+        MockSession* mockSession = new MockSession();
+        mockSession->instance = mockInstance;
+        mockSession->graphicsBinding = *binding;
+        mockSession->graphicsBinding.next = nullptr;
+        mockInstance->session = mockSession;
+
+        PushSessionState(mockSession, XR_SESSION_STATE_IDLE);
+        PushSessionState(mockSession, XR_SESSION_STATE_READY);
+
+        *session = ToHandle<XrSession>(mockSession);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockDestroySession(XrSession session)
+    {
+        MockSession* mockSession = FromHandle<MockSession>(session);
+        if (!mockSession) return XR_ERROR_HANDLE_INVALID;
+
+        mockSession->instance->session = nullptr;
+        delete mockSession;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockBeginSession(XrSession session, const XrSessionBeginInfo* beginInfo)
+    {
+        MockSession* mockSession = FromHandle<MockSession>(session);
+        if (mockSession->state != XR_SESSION_STATE_READY) return XR_ERROR_SESSION_NOT_READY;
+        if (beginInfo->primaryViewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+
+        // Nothing competes for the display, so the session goes straight to focused
+        PushSessionState(mockSession, XR_SESSION_STATE_SYNCHRONIZED);
+        PushSessionState(mockSession, XR_SESSION_STATE_VISIBLE);
+        PushSessionState(mockSession, XR_SESSION_STATE_FOCUSED);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockRequestExitSession(XrSession session)
+    {
+        MockSession* mockSession = FromHandle<MockSession>(session);
+        if (!IsSessionRunning(mockSession)) return XR_ERROR_SESSION_NOT_RUNNING;
+
+        PushSessionState(mockSession, XR_SESSION_STATE_VISIBLE);
+        PushSessionState(mockSession, XR_SESSION_STATE_SYNCHRONIZED);
+        PushSessionState(mockSession, XR_SESSION_STATE_STOPPING);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockEndSession(XrSession session)
+    {
+        MockSession* mockSession = FromHandle<MockSession>(session);
+        if (mockSession->state != XR_SESSION_STATE_STOPPING) return XR_ERROR_SESSION_NOT_STOPPING;
+
+        PushSessionState(mockSession, XR_SESSION_STATE_IDLE);
+        PushSessionState(mockSession, XR_SESSION_STATE_EXITING);
+        return XR_SUCCESS;
+    }
+
+    // Frame loop
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockWaitFrame(XrSession session, const XrFrameWaitInfo*, XrFrameState* frameState)
+    {
+        MockSession* mockSession = FromHandle<MockSession>(session);
+        if (!IsSessionRunning(mockSession)) return XR_ERROR_SESSION_NOT_RUNNING;
+
+        // Block until the next vsync the application hasn't used yet. An application that overran skips the
+        // vsyncs it missed, exactly like a real compositor would.
+        const int64_t period = g_Settings.displayPeriodNs;
+        const int64_t now = GetTimeNs();
+        if (mockSession->vsyncEpoch == 0)
+        {
+            mockSession->vsyncEpoch = now;
+        }
+        const int64_t nextVsyncIndex = (now - mockSession->vsyncEpoch + period - 1) / period;
+        const int64_t vsyncIndex = std::max(mockSession->lastVsyncIndex + 1, nextVsyncIndex);
+        const int64_t vsyncTime = mockSession->vsyncEpoch + vsyncIndex * period;
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(vsyncTime)));
+        mockSession->lastVsyncIndex = vsyncIndex;
+        mockSession->frameWaited = true;
+
+        // The frame started now is shown two refreshes later
+        frameState->predictedDisplayTime = vsyncTime + 2 * period;
+        frameState->predictedDisplayPeriod = period;
+        frameState->shouldRender = mockSession->state == XR_SESSION_STATE_VISIBLE || mockSession->state == XR_SESSION_STATE_FOCUSED;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockBeginFrame(XrSession session, const XrFrameBeginInfo*)
+    {
+        MockSession* mockSession = FromHandle<MockSession>(session);
+        if (!IsSessionRunning(mockSession)) return XR_ERROR_SESSION_NOT_RUNNING;
+        if (!mockSession->frameWaited) return XR_ERROR_CALL_ORDER_INVALID;
+
+        mockSession->frameWaited = false;
+        if (mockSession->frameBegun) return XR_FRAME_DISCARDED;
+
+        mockSession->frameBegun = true;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockEndFrame(XrSession session, const XrFrameEndInfo* frameEndInfo)
+    {
+        MockSession* mockSession = FromHandle<MockSession>(session);
+        if (!IsSessionRunning(mockSession)) return XR_ERROR_SESSION_NOT_RUNNING;
+        if (!mockSession->frameBegun) return XR_ERROR_CALL_ORDER_INVALID;
+        if (frameEndInfo->layerCount > XR_MIN_COMPOSITION_LAYERS_SUPPORTED) return XR_ERROR_LAYER_LIMIT_EXCEEDED;
+        if (frameEndInfo->environmentBlendMode != XR_ENVIRONMENT_BLEND_MODE_OPAQUE) return XR_ERROR_ENVIRONMENT_BLEND_MODE_UNSUPPORTED;
+
+        mockSession->frameBegun = false;
+        ++mockSession->submittedFrameCount;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockLocateViews(XrSession, const XrViewLocateInfo* viewLocateInfo, XrViewState* viewState, uint32_t viewCapacityInput,
+                                                  uint32_t* viewCountOutput, XrView* views)
+    {
+        if (viewLocateInfo->viewConfigurationType != XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO) return XR_ERROR_VIEW_CONFIGURATION_TYPE_UNSUPPORTED;
+
+        const XrResult result = CheckCapacity(viewCapacityInput, viewCountOutput, VIEW_COUNT);
+        if (result != XR_SUCCESS || viewCapacityInput == 0) return result;
+
+        const XrPosef headPose = GetHeadPose(viewLocateInfo->displayTime);
+        for (uint32_t i = 0; i < VIEW_COUNT; ++i)
+        {
+            const XrVector3f eyeOffset = Rotate(headPose.orientation, {i == 0 ? -HALF_IPD : HALF_IPD, 0.0f, 0.0f});
+            views[i].pose.orientation = headPose.orientation;
+            views[i].pose.position = {headPose.position.x + eyeOffset.x, headPose.position.y + eyeOffset.y, headPose.position.z + eyeOffset.z};
+            views[i].fov = {-HALF_FOV, HALF_FOV, HALF_FOV, -HALF_FOV};
+        }
+        viewState->viewStateFlags = XR_VIEW_STATE_ORIENTATION_VALID_BIT | XR_VIEW_STATE_POSITION_VALID_BIT | XR_VIEW_STATE_ORIENTATION_TRACKED_BIT |
+                                    XR_VIEW_STATE_POSITION_TRACKED_BIT;
+        return XR_SUCCESS;
+    }
+
+    // Spaces
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockEnumerateReferenceSpaces(XrSession, uint32_t spaceCapacityInput, uint32_t* spaceCountOutput, XrReferenceSpaceType* spaces)
+    {
+        const XrReferenceSpaceType referenceSpaces[] = {XR_REFERENCE_SPACE_TYPE_VIEW, XR_REFERENCE_SPACE_TYPE_LOCAL, XR_REFERENCE_SPACE_TYPE_STAGE};
+        const XrResult result = CheckCapacity(spaceCapacityInput, spaceCountOutput, 3);
+        if (result == XR_SUCCESS && spaceCapacityInput != 0)
+        {
+            std::copy(std::begin(referenceSpaces), std::end(referenceSpaces), spaces);
+        }
+        return result;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockCreateReferenceSpace(XrSession, const XrReferenceSpaceCreateInfo* createInfo, XrSpace* space)
+    {
+        MockSpace* mockSpace = new MockSpace();
+        mockSpace->referenceSpaceType = createInfo->referenceSpaceType;
+        *space = ToHandle<XrSpace>(mockSpace);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockCreateActionSpace(XrSession, const XrActionSpaceCreateInfo* createInfo, XrSpace* space)
+    {
+        MockSpace* mockSpace = new MockSpace();
+        mockSpace->isActionSpace = true;
+        mockSpace->subactionPath = createInfo->subactionPath;
+        *space = ToHandle<XrSpace>(mockSpace);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockDestroySpace(XrSpace space)
+    {
+        delete FromHandle<MockSpace>(space);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockLocateSpace(XrSpace space, XrSpace, XrTime time, XrSpaceLocation* location)
+    {
+        // Every base space is treated as LOCAL with an identity offset
+        const MockSpace* mockSpace = FromHandle<MockSpace>(space);
+        location->pose = GetSpacePose(mockSpace, time);
+        location->locationFlags = XR_SPACE_LOCATION_ORIENTATION_VALID_BIT | XR_SPACE_LOCATION_POSITION_VALID_BIT |
+                                  XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT | XR_SPACE_LOCATION_POSITION_TRACKED_BIT;
+
+        XrSpaceVelocity* velocity = FindChainedOutput<XrSpaceVelocity>(location->next, XR_TYPE_SPACE_VELOCITY);
+        if (velocity)
+        {
+            const XrDuration step = 1000000;
+            const XrPosef nextPose = GetSpacePose(mockSpace, time + step);
+            const float scale = 1e9f / static_cast<float>(step);
+            velocity->linearVelocity = {(nextPose.position.x - location->pose.position.x) * scale, (nextPose.position.y - location->pose.position.y) * scale,
+                                        (nextPose.position.z - location->pose.position.z) * scale};
+            velocity->angularVelocity = {0.0f, 0.0f, 0.0f};
+            velocity->velocityFlags = XR_SPACE_VELOCITY_LINEAR_VALID_BIT | XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+        }
+        return XR_SUCCESS;
+    }
+
+    // Swapchains
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockEnumerateSwapchainFormats(XrSession, uint32_t formatCapacityInput, uint32_t* formatCountOutput, int64_t* formats)
+    {
+        const uint32_t formatCount = static_cast<uint32_t>(sizeof(SUPPORTED_SWAPCHAIN_FORMATS) / sizeof(SUPPORTED_SWAPCHAIN_FORMATS[0]));
+        const XrResult result = CheckCapacity(formatCapacityInput, formatCountOutput, formatCount);
+        if (result == XR_SUCCESS && formatCapacityInput != 0)
+        {
+            std::copy(std::begin(SUPPORTED_SWAPCHAIN_FORMATS), std::end(SUPPORTED_SWAPCHAIN_FORMATS), formats);
+        }
+        return result;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockCreateSwapchain(XrSession session, const XrSwapchainCreateInfo* createInfo, XrSwapchain* swapchain)
+    {
+        MockSession* mockSession = FromHandle<MockSession>(session);
+        if (std::find(std::begin(SUPPORTED_SWAPCHAIN_FORMATS), std::end(SUPPORTED_SWAPCHAIN_FORMATS), createInfo->format) == std::end(SUPPORTED_SWAPCHAIN_FORMATS))
+        {
+            return XR_ERROR_SWAPCHAIN_FORMAT_UNSUPPORTED;
+        }
+
+        const VkDevice device = mockSession->graphicsBinding.device;
+        VkPhysicalDeviceMemoryProperties memoryProperties;
+        vkGetPhysicalDeviceMemoryProperties(mockSession->graphicsBinding.physicalDevice, &memoryProperties);
+
+        MockSwapchain* mockSwapchain = new MockSwapchain();
+        mockSwapchain->session = mockSession;
+
+        for (uint32_t i = 0; i < SWAPCHAIN_IMAGE_COUNT; ++i)
+        {
+            VkImageCreateInfo imageCI{};
+            imageCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageCI.flags = (createInfo->usageFlags & XR_SWAPCHAIN_USAGE_MUTABLE_FORMAT_BIT) ? VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT : 0;
+            imageCI.imageType = VK_IMAGE_TYPE_2D;
+            imageCI.format = static_cast<VkFormat>(createInfo->format);
+            imageCI.extent = {createInfo->width, createInfo->height, 1};
+            imageCI.mipLevels = std::max(createInfo->mipCount, 1u);
+            imageCI.arrayLayers = std::max(createInfo->arraySize, 1u) * std::max(createInfo->faceCount, 1u);
+            imageCI.samples = static_cast<VkSampleCountFlagBits>(std::max(createInfo->sampleCount, 1u));
+            imageCI.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageCI.usage = ToVulkanUsage(createInfo->usageFlags);
+            imageCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+            imageCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+            VkImage image = VK_NULL_HANDLE;
+            if (vkCreateImage(device, &imageCI, nullptr, &image) != VK_SUCCESS)
+            {
+                DestroySwapchainImages(mockSwapchain);
+                delete mockSwapchain;
+                return XR_ERROR_RUNTIME_FAILURE;
+            }
+            mockSwapchain->images.push_back(image);
+
+            VkMemoryRequirements memoryRequirements;
+            vkGetImageMemoryRequirements(device, image, &memoryRequirements);
+
+            uint32_t memoryTypeIndex = UINT32_MAX;
+            for (uint32_t typeIndex = 0; typeIndex < memoryProperties.memoryTypeCount; ++typeIndex)
+            {
+                const bool allowed = (memoryRequirements.memoryTypeBits & (1u << typeIndex)) != 0;
+                if (allowed && (memoryProperties.memoryTypes[typeIndex].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
+                {
+                    memoryTypeIndex = typeIndex;
+                    break;
+                }
+            }
+
+            VkMemoryAllocateInfo allocateInfo{};
+            allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            allocateInfo.allocationSize = memoryRequirements.size;
+            allocateInfo.memoryTypeIndex = memoryTypeIndex;
+
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            if (memoryTypeIndex == UINT32_MAX || vkAllocateMemory(device, &allocateInfo, nullptr, &memory) != VK_SUCCESS ||
+                vkBindImageMemory(device, image, memory, 0) != VK_SUCCESS)
+            {
+                if (memory != VK_NULL_HANDLE) vkFreeMemory(device, memory, nullptr);
+                DestroySwapchainImages(mockSwapchain);
+                delete mockSwapchain;
+                return XR_ERROR_RUNTIME_FAILURE;
+            }
+            mockSwapchain->memories.push_back(memory);
+        }
+
+        *swapchain = ToHandle<XrSwapchain>(mockSwapchain);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockDestroySwapchain(XrSwapchain swapchain)
+    {
+        MockSwapchain* mockSwapchain = FromHandle<MockSwapchain>(swapchain);
+        if (!mockSwapchain) return XR_ERROR_HANDLE_INVALID;
+
+        DestroySwapchainImages(mockSwapchain);
+        delete mockSwapchain;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockEnumerateSwapchainImages(XrSwapchain swapchain, uint32_t imageCapacityInput, uint32_t* imageCountOutput,
+                                                               XrSwapchainImageBaseHeader* images)
+    {
+        const MockSwapchain* mockSwapchain = FromHandle<MockSwapchain>(swapchain);
+        const uint32_t imageCount = static_cast<uint32_t>(mockSwapchain->images.size());
+        const XrResult result = CheckCapacity(imageCapacityInput, imageCountOutput, imageCount);
+        if (result != XR_SUCCESS || imageCapacityInput == 0) return result;
+
+        XrSwapchainImageVulkanKHR* vulkanImages = reinterpret_cast<XrSwapchainImageVulkanKHR*>(images);
+        for (uint32_t i = 0; i < imageCount; ++i)
+        {
+            if (vulkanImages[i].type != XR_TYPE_SWAPCHAIN_IMAGE_VULKAN_KHR) return XR_ERROR_VALIDATION_FAILURE;
+            vulkanImages[i].image = mockSwapchain->images[i];
+        }
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockAcquireSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageAcquireInfo*, uint32_t* index)
+    {
+        MockSwapchain* mockSwapchain = FromHandle<MockSwapchain>(swapchain);
+        if (mockSwapchain->acquiredImages.size() == mockSwapchain->images.size()) return XR_ERROR_CALL_ORDER_INVALID;
+
+        *index = mockSwapchain->nextImageIndex;
+        mockSwapchain->acquiredImages.push_back(*index);
+        mockSwapchain->nextImageIndex = (mockSwapchain->nextImageIndex + 1) % static_cast<uint32_t>(mockSwapchain->images.size());
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockWaitSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageWaitInfo*)
+    {
+        // Nothing reads the images back, so they are available as soon as they're acquired
+        MockSwapchain* mockSwapchain = FromHandle<MockSwapchain>(swapchain);
+        if (mockSwapchain->waitedCount >= mockSwapchain->acquiredImages.size()) return XR_ERROR_CALL_ORDER_INVALID;
+
+        ++mockSwapchain->waitedCount;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockReleaseSwapchainImage(XrSwapchain swapchain, const XrSwapchainImageReleaseInfo*)
+    {
+        MockSwapchain* mockSwapchain = FromHandle<MockSwapchain>(swapchain);
+        if (mockSwapchain->waitedCount == 0) return XR_ERROR_CALL_ORDER_INVALID;
+
+        mockSwapchain->acquiredImages.pop_front();
+        --mockSwapchain->waitedCount;
+        return XR_SUCCESS;
+    }
+
+    // Actions. Poses come from the synthetic motion above, the select button is pressed briefly every two seconds.
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockCreateActionSet(XrInstance, const XrActionSetCreateInfo* createInfo, XrActionSet* actionSet)
+    {
+        MockActionSet* mockActionSet = new MockActionSet();
+        mockActionSet->name = createInfo->actionSetName;
+        *actionSet = ToHandle<XrActionSet>(mockActionSet);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockDestroyActionSet(XrActionSet actionSet)
+    {
+        delete FromHandle<MockActionSet>(actionSet);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockCreateAction(XrActionSet actionSet, const XrActionCreateInfo* createInfo, XrAction* action)
+    {
+        MockAction* mockAction = new MockAction();
+        mockAction->actionSet = FromHandle<MockActionSet>(actionSet);
+        mockAction->type = createInfo->actionType;
+        mockAction->name = createInfo->actionName;
+        *action = ToHandle<XrAction>(mockAction);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockDestroyAction(XrAction action)
+    {
+        delete FromHandle<MockAction>(action);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockSuggestInteractionProfileBindings(XrInstance instance, const XrInteractionProfileSuggestedBinding* suggestedBindings)
+    {
+        MockInstance* mockInstance = FromHandle<MockInstance>(instance);
+        if (mockInstance->interactionProfile == XR_NULL_PATH)
+        {
+            mockInstance->interactionProfile = suggestedBindings->interactionProfile;
+        }
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockAttachSessionActionSets(XrSession session, const XrSessionActionSetsAttachInfo*)
+    {
+        MockSession* mockSession = FromHandle<MockSession>(session);
+
+        XrEventDataBuffer buffer{};
+        XrEventDataInteractionProfileChanged* event = reinterpret_cast<XrEventDataInteractionProfileChanged*>(&buffer);
+        event->type = XR_TYPE_EVENT_DATA_INTERACTION_PROFILE_CHANGED;
+        event->session = session;
+        mockSession->instance->events.push_back(buffer);
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockSyncActions(XrSession session, const XrActionsSyncInfo*)
+    {
+        const MockSession* mockSession = FromHandle<MockSession>(session);
+        return mockSession->state == XR_SESSION_STATE_FOCUSED ? XR_SUCCESS : XR_SESSION_NOT_FOCUSED;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetActionStateBoolean(XrSession, const XrActionStateGetInfo*, XrActionStateBoolean* state)
+    {
+        const int64_t phase = GetTimeNs() % 2000000000;
+        state->currentState = phase < 100000000 ? XR_TRUE : XR_FALSE;
+        state->changedSinceLastSync = XR_FALSE;
+        state->lastChangeTime = 0;
+        state->isActive = XR_TRUE;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetActionStateFloat(XrSession, const XrActionStateGetInfo*, XrActionStateFloat* state)
+    {
+        state->currentState = static_cast<float>(0.5 + 0.5 * std::sin(2.0 * PI * 0.5 * static_cast<double>(GetTimeNs()) * 1e-9));
+        state->changedSinceLastSync = XR_TRUE;
+        state->lastChangeTime = GetTimeNs();
+        state->isActive = XR_TRUE;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetActionStateVector2f(XrSession, const XrActionStateGetInfo*, XrActionStateVector2f* state)
+    {
+        state->currentState = {0.0f, 0.0f};
+        state->changedSinceLastSync = XR_FALSE;
+        state->lastChangeTime = 0;
+        state->isActive = XR_TRUE;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetActionStatePose(XrSession, const XrActionStateGetInfo*, XrActionStatePose* state)
+    {
+        state->isActive = XR_TRUE;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockApplyHapticFeedback(XrSession session, const XrHapticActionInfo*, const XrHapticBaseHeader*)
+    {
+        ++FromHandle<MockSession>(session)->hapticRequestCount;
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockStopHapticFeedback(XrSession, const XrHapticActionInfo*)
+    {
+        return XR_SUCCESS;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetCurrentInteractionProfile(XrSession session, XrPath, XrInteractionProfileState* interactionProfile)
+    {
+        interactionProfile->interactionProfile = FromHandle<MockSession>(session)->instance->interactionProfile;
+        return XR_SUCCESS;
+    }
+
+    // Dispatch
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function);
+
+#define MOCK_FUNCTION(name, implementation) {name, reinterpret_cast<PFN_xrVoidFunction>(implementation)}
+
+    const std::unordered_map<std::string, PFN_xrVoidFunction>& GetFunctionTable()
+    {
+        static const std::unordered_map<std::string, PFN_xrVoidFunction> functions = {
+            MOCK_FUNCTION("xrGetInstanceProcAddr", MockGetInstanceProcAddr),
+            MOCK_FUNCTION("xrEnumerateApiLayerProperties", MockEnumerateApiLayerProperties),
+            MOCK_FUNCTION("xrEnumerateInstanceExtensionProperties", MockEnumerateInstanceExtensionProperties),
+            MOCK_FUNCTION("xrCreateInstance", MockCreateInstance),
+            MOCK_FUNCTION("xrDestroyInstance", MockDestroyInstance),
+            MOCK_FUNCTION("xrGetInstanceProperties", MockGetInstanceProperties),
+            MOCK_FUNCTION("xrPollEvent", MockPollEvent),
+            MOCK_FUNCTION("xrResultToString", MockResultToString),
+            MOCK_FUNCTION("xrStructureTypeToString", MockStructureTypeToString),
+            MOCK_FUNCTION("xrStringToPath", MockStringToPath),
+            MOCK_FUNCTION("xrPathToString", MockPathToString),
+            MOCK_FUNCTION("xrGetSystem", MockGetSystem),
+            MOCK_FUNCTION("xrGetSystemProperties", MockGetSystemProperties),
+            MOCK_FUNCTION("xrEnumerateViewConfigurations", MockEnumerateViewConfigurations),
+            MOCK_FUNCTION("xrGetViewConfigurationProperties", MockGetViewConfigurationProperties),
+            MOCK_FUNCTION("xrEnumerateViewConfigurationViews", MockEnumerateViewConfigurationViews),
+            MOCK_FUNCTION("xrEnumerateEnvironmentBlendModes", MockEnumerateEnvironmentBlendModes),
+            MOCK_FUNCTION("xrGetVulkanGraphicsRequirementsKHR", MockGetVulkanGraphicsRequirementsKHR),
+            MOCK_FUNCTION("xrGetVulkanInstanceExtensionsKHR", MockGetVulkanExtensionsKHR),
+            MOCK_FUNCTION("xrGetVulkanDeviceExtensionsKHR", MockGetVulkanExtensionsKHR),
+            MOCK_FUNCTION("xrGetVulkanGraphicsDeviceKHR", MockGetVulkanGraphicsDeviceKHR),
+            MOCK_FUNCTION("xrCreateSession", MockCreateSession),
+            MOCK_FUNCTION("xrDestroySession", MockDestroySession),
+            MOCK_FUNCTION("xrBeginSession", MockBeginSession),
+            MOCK_FUNCTION("xrEndSession", MockEndSession),
+            MOCK_FUNCTION("xrRequestExitSession", MockRequestExitSession),
+            MOCK_FUNCTION("xrWaitFrame", MockWaitFrame),
+            MOCK_FUNCTION("xrBeginFrame", MockBeginFrame),
+            MOCK_FUNCTION("xrEndFrame", MockEndFrame),
+            MOCK_FUNCTION("xrLocateViews", MockLocateViews),
+            MOCK_FUNCTION("xrEnumerateReferenceSpaces", MockEnumerateReferenceSpaces),
+            MOCK_FUNCTION("xrCreateReferenceSpace", MockCreateReferenceSpace),
+            MOCK_FUNCTION("xrCreateActionSpace", MockCreateActionSpace),
+            MOCK_FUNCTION("xrDestroySpace", MockDestroySpace),
+            MOCK_FUNCTION("xrLocateSpace", MockLocateSpace),
+            MOCK_FUNCTION("xrEnumerateSwapchainFormats", MockEnumerateSwapchainFormats),
+            MOCK_FUNCTION("xrCreateSwapchain", MockCreateSwapchain),
+            MOCK_FUNCTION("xrDestroySwapchain", MockDestroySwapchain),
+            MOCK_FUNCTION("xrEnumerateSwapchainImages", MockEnumerateSwapchainImages),
+            MOCK_FUNCTION("xrAcquireSwapchainImage", MockAcquireSwapchainImage),
+            MOCK_FUNCTION("xrWaitSwapchainImage", MockWaitSwapchainImage),
+            MOCK_FUNCTION("xrReleaseSwapchainImage", MockReleaseSwapchainImage),
+            MOCK_FUNCTION("xrCreateActionSet", MockCreateActionSet),
+            MOCK_FUNCTION("xrDestroyActionSet", MockDestroyActionSet),
+            MOCK_FUNCTION("xrCreateAction", MockCreateAction),
+            MOCK_FUNCTION("xrDestroyAction", MockDestroyAction),
+            MOCK_FUNCTION("xrSuggestInteractionProfileBindings", MockSuggestInteractionProfileBindings),
+            MOCK_FUNCTION("xrAttachSessionActionSets", MockAttachSessionActionSets),
+            MOCK_FUNCTION("xrSyncActions", MockSyncActions),
+            MOCK_FUNCTION("xrGetActionStateBoolean", MockGetActionStateBoolean),
+            MOCK_FUNCTION("xrGetActionStateFloat", MockGetActionStateFloat),
+            MOCK_FUNCTION("xrGetActionStateVector2f", MockGetActionStateVector2f),
+            MOCK_FUNCTION("xrGetActionStatePose", MockGetActionStatePose),
+            MOCK_FUNCTION("xrApplyHapticFeedback", MockApplyHapticFeedback),
+            MOCK_FUNCTION("xrStopHapticFeedback", MockStopHapticFeedback),
+            MOCK_FUNCTION("xrGetCurrentInteractionProfile", MockGetCurrentInteractionProfile),
+        };
+        return functions;
+    }
+
+    XRAPI_ATTR XrResult XRAPI_CALL MockGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function)
+    {
+        if (!name || !function) return XR_ERROR_VALIDATION_FAILURE;
+        *function = nullptr;
+
+        // Without an instance only the functions needed to create one may be queried
+        if (instance == XR_NULL_HANDLE && std::strcmp(name, "xrEnumerateInstanceExtensionProperties") != 0 &&
+            std::strcmp(name, "xrEnumerateApiLayerProperties") != 0 && std::strcmp(name, "xrCreateInstance") != 0)
+        {
+            return XR_ERROR_HANDLE_INVALID;
+        }
+
+        const auto& functions = GetFunctionTable();
+        auto it = functions.find(name);
+        if (it == functions.end()) return XR_ERROR_FUNCTION_UNSUPPORTED;
+
+        *function = it->second;
+        return XR_SUCCESS;
+    }
+}
+
+extern "C" MOCK_RUNTIME_EXPORT XRAPI_ATTR XrResult XRAPI_CALL xrNegotiateLoaderRuntimeInterface(const XrNegotiateLoaderInfo* loaderInfo,
+                                                                                              XrNegotiateRuntimeRequest* runtimeRequest)
+{
+    if (!loaderInfo || !runtimeRequest || loaderInfo->structType != XR_LOADER_INTERFACE_STRUCT_LOADER_INFO ||
+        loaderInfo->structVersion != XR_LOADER_INFO_STRUCT_VERSION || loaderInfo->structSize != sizeof(XrNegotiateLoaderInfo) ||
+        runtimeRequest->structType != XR_LOADER_INTERFACE_STRUCT_RUNTIME_REQUEST ||
+        runtimeRequest->structVersion != XR_RUNTIME_INFO_STRUCT_VERSION || runtimeRequest->structSize != sizeof(XrNegotiateRuntimeRequest))
+    {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+
+    if (loaderInfo->minInterfaceVersion > XR_CURRENT_LOADER_RUNTIME_VERSION || loaderInfo->maxInterfaceVersion < XR_CURRENT_LOADER_RUNTIME_VERSION ||
+        XR_VERSION_MAJOR(loaderInfo->minApiVersion) > XR_VERSION_MAJOR(XR_CURRENT_API_VERSION) ||
+        XR_VERSION_MAJOR(loaderInfo->maxApiVersion) < XR_VERSION_MAJOR(XR_CURRENT_API_VERSION))
+    {
+        return XR_ERROR_INITIALIZATION_FAILED;
+    }
+
+    runtimeRequest->runtimeInterfaceVersion = XR_CURRENT_LOADER_RUNTIME_VERSION;
+    runtimeRequest->runtimeApiVersion = XR_CURRENT_API_VERSION;
+    runtimeRequest->getInstanceProcAddr = MockGetInstanceProcAddr;
+    return XR_SUCCESS;
+}
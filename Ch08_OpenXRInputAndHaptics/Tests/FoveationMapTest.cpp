@@ -0,0 +1,162 @@
+#include "TestUtils.h"
+
+#include "../app/src/main/cpp/OpenXR/Foveation/FoveationMap.h"
+#include <cmath>
+
+namespace
+{
+    const float DEG_TO_RAD = 3.14159265358979f / 180.0f;
+    const XrFovf SYMMETRIC_FOV = {-45.0f * DEG_TO_RAD, 45.0f * DEG_TO_RAD, 45.0f * DEG_TO_RAD, -45.0f * DEG_TO_RAD};
+    const FoveationLevel LEVELS[] = {FoveationLevel::NONE, FoveationLevel::LOW, FoveationLevel::MEDIUM, FoveationLevel::HIGH};
+
+    // Mirrors FoveationMap's level profiles: full density up to innerAngleDeg, minDensity from outerAngleDeg on
+    struct ExpectedProfile
+    {
+        FoveationLevel level;
+        float outerAngleDeg;
+        float minDensity;
+    };
+    const ExpectedProfile FOVEATED_PROFILES[] = {
+        {FoveationLevel::LOW, 35.0f, 0.5f},
+        {FoveationLevel::MEDIUM, 30.0f, 0.25f},
+        {FoveationLevel::HIGH, 25.0f, 0.25f},
+    };
+
+    uint8_t GetTexel(const std::vector<uint8_t>& texels, uint32_t mapWidth, uint32_t x, uint32_t y, uint32_t channel = 0)
+    {
+        return texels[(static_cast<size_t>(y) * mapWidth + x) * 2 + channel];
+    }
+
+    // Average row of the full density texels in the map
+    float GetFullDensityCenterRow(const std::vector<uint8_t>& texels, uint32_t mapWidth, uint32_t mapHeight)
+    {
+        float rowSum = 0.0f;
+        int count = 0;
+        for (uint32_t y = 0; y < mapHeight; ++y)
+        {
+            for (uint32_t x = 0; x < mapWidth; ++x)
+            {
+                if (GetTexel(texels, mapWidth, x, y) == 255)
+                {
+                    rowSum += static_cast<float>(y);
+                    ++count;
+                }
+            }
+        }
+        return count > 0 ? rowSum / static_cast<float>(count) : -1.0f;
+    }
+
+    void TestCenterIsFullDensity()
+    {
+        // An odd size puts a texel center exactly on the view center
+        const uint32_t size = 33;
+        for (FoveationLevel level : LEVELS)
+        {
+            std::vector<uint8_t> texels;
+            FoveationMap::Generate(SYMMETRIC_FOV, level, 0.0f, size, size, static_cast<float>(size), static_cast<float>(size), texels);
+            TEST_CHECK(texels.size() == size * size * 2);
+            TEST_CHECK(GetTexel(texels, size, size / 2, size / 2, 0) == 255);
+            TEST_CHECK(GetTexel(texels, size, size / 2, size / 2, 1) == 255);
+        }
+    }
+
+    void TestPeripheryIsMinDensity()
+    {
+        const uint32_t size = 32;
+        for (const ExpectedProfile& profile : FOVEATED_PROFILES)
+        {
+            const uint8_t minDensity = static_cast<uint8_t>(std::lround(profile.minDensity * 255.0f));
+            TEST_CHECK(FoveationMap::GetDensity(profile.level, (profile.outerAngleDeg + 0.1f) * DEG_TO_RAD) == profile.minDensity);
+            TEST_CHECK(FoveationMap::GetDensity(profile.level, 90.0f * DEG_TO_RAD) == profile.minDensity);
+
+            std::vector<uint8_t> texels;
+            FoveationMap::Generate(SYMMETRIC_FOV, profile.level, 0.0f, size, size, static_cast<float>(size), static_cast<float>(size), texels);
+
+            // Every texel whose center is past the outer angle is at the minimum
+            const float tanExtent = std::tan(45.0f * DEG_TO_RAD);
+            for (uint32_t y = 0; y < size; ++y)
+            {
+                for (uint32_t x = 0; x < size; ++x)
+                {
+                    const float tanX = -tanExtent + 2.0f * tanExtent * (static_cast<float>(x) + 0.5f) / static_cast<float>(size);
+                    const float tanY = tanExtent - 2.0f * tanExtent * (static_cast<float>(y) + 0.5f) / static_cast<float>(size);
+                    const float eccentricityDeg = std::atan(std::sqrt(tanX * tanX + tanY * tanY)) / DEG_TO_RAD;
+                    if (eccentricityDeg > profile.outerAngleDeg + 0.01f)
+                    {
+                        TEST_CHECK(GetTexel(texels, size, x, y, 0) == minDensity);
+                        TEST_CHECK(GetTexel(texels, size, x, y, 1) == minDensity);
+                    }
+                }
+            }
+            TEST_CHECK(GetTexel(texels, size, 0, 0) == minDensity);
+            TEST_CHECK(GetTexel(texels, size, size - 1, size - 1) == minDensity);
+        }
+    }
+
+    void TestVerticalOffsetMovesCenterUp()
+    {
+        const uint32_t size = 32;
+        std::vector<uint8_t> centered, raised;
+        FoveationMap::Generate(SYMMETRIC_FOV, FoveationLevel::HIGH, 0.0f, size, size, static_cast<float>(size), static_cast<float>(size), centered);
+        FoveationMap::Generate(SYMMETRIC_FOV, FoveationLevel::HIGH, 15.0f, size, size, static_cast<float>(size), static_cast<float>(size), raised);
+
+        const float centeredRow = GetFullDensityCenterRow(centered, size, size);
+        const float raisedRow = GetFullDensityCenterRow(raised, size, size);
+        TEST_CHECK(centeredRow > 0.0f && raisedRow > 0.0f);
+        TEST_CHECK(raisedRow < centeredRow);
+
+        // 15 degrees up is inside the raised region but outside the centered one
+        const uint32_t row = static_cast<uint32_t>((1.0f - std::tan(15.0f * DEG_TO_RAD)) * 0.5f * size);
+        TEST_CHECK(GetTexel(raised, size, size / 2, row) == 255);
+        TEST_CHECK(GetTexel(centered, size, size / 2, row) < 255);
+    }
+
+    void TestUncoveredTexelsAreFullDensity()
+    {
+        // The rendered region covers 20.5 x 12.25 texels of a 32 x 24 map, so columns from 21 and rows from 13 are outside
+        const uint32_t mapWidth = 32;
+        const uint32_t mapHeight = 24;
+        std::vector<uint8_t> texels;
+        FoveationMap::Generate(SYMMETRIC_FOV, FoveationLevel::HIGH, 0.0f, mapWidth, mapHeight, 20.5f, 12.25f, texels);
+        TEST_CHECK(texels.size() == mapWidth * mapHeight * 2);
+
+        TEST_CHECK(GetTexel(texels, mapWidth, 0, 0) < 255);
+        for (uint32_t y = 0; y < mapHeight; ++y)
+        {
+            for (uint32_t x = 0; x < mapWidth; ++x)
+            {
+                if (x < 21 && y < 13) continue;
+                TEST_CHECK(GetTexel(texels, mapWidth, x, y, 0) == 255);
+                TEST_CHECK(GetTexel(texels, mapWidth, x, y, 1) == 255);
+            }
+        }
+
+        // Nothing covered at all
+        FoveationMap::Generate(SYMMETRIC_FOV, FoveationLevel::HIGH, 0.0f, mapWidth, mapHeight, 0.0f, 0.0f, texels);
+        for (uint8_t texel : texels)
+        {
+            TEST_CHECK(texel == 255);
+        }
+    }
+
+    void TestNoneIsFullDensity()
+    {
+        const uint32_t size = 32;
+        std::vector<uint8_t> texels;
+        FoveationMap::Generate(SYMMETRIC_FOV, FoveationLevel::NONE, 10.0f, size, size, static_cast<float>(size), static_cast<float>(size), texels);
+        for (uint8_t texel : texels)
+        {
+            TEST_CHECK(texel == 255);
+        }
+    }
+}
+
+int main()
+{
+    TestCenterIsFullDensity();
+    TestPeripheryIsMinDensity();
+    TestVerticalOffsetMovesCenterUp();
+    TestUncoveredTexelsAreFullDensity();
+    TestNoneIsFullDensity();
+    return TEST_RESULT();
+}
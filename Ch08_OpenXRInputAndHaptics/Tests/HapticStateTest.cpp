@@ -0,0 +1,98 @@
+#include "TestUtils.h"
+
+#include "../app/src/main/cpp/OpenXR/Input/HapticState.h"
+
+namespace
+{
+    const XrDuration MS = 1000000;
+
+    HapticPulse MakePulse(float amplitude, XrDuration duration, float frequency = XR_FREQUENCY_UNSPECIFIED)
+    {
+        HapticPulse pulse;
+        pulse.amplitude = amplitude;
+        pulse.duration = duration;
+        pulse.frequency = frequency;
+        return pulse;
+    }
+
+    void TestCoalescing()
+    {
+        HapticState state;
+        state.QueuePulse(MakePulse(0.3f, 50 * MS, 100.0f));
+        TEST_CHECK(state.hasPendingPulse);
+        TEST_CHECK(state.pendingPulse.amplitude == 0.3f);
+
+        // A stronger, shorter request takes over amplitude and frequency but keeps the longer duration
+        state.QueuePulse(MakePulse(0.8f, 20 * MS, 200.0f));
+        TEST_CHECK(state.pendingPulse.amplitude == 0.8f);
+        TEST_CHECK(state.pendingPulse.frequency == 200.0f);
+        TEST_CHECK(state.pendingPulse.duration == 50 * MS);
+
+        // A weaker, longer one only extends the duration
+        state.QueuePulse(MakePulse(0.1f, 300 * MS, 50.0f));
+        TEST_CHECK(state.pendingPulse.amplitude == 0.8f);
+        TEST_CHECK(state.pendingPulse.frequency == 200.0f);
+        TEST_CHECK(state.pendingPulse.duration == 300 * MS);
+
+        // Once flushed, the next request starts afresh
+        state.hasPendingPulse = false;
+        state.QueuePulse(MakePulse(0.2f, 10 * MS));
+        TEST_CHECK(state.pendingPulse.amplitude == 0.2f);
+        TEST_CHECK(state.pendingPulse.duration == 10 * MS);
+    }
+
+    void TestPatternStepping()
+    {
+        HapticState state;
+        state.pattern = {MakePulse(0.5f, 100 * MS), MakePulse(0.0f, 50 * MS), MakePulse(1.0f, 100 * MS)};
+
+        // The first segment starts right away
+        XrTime now = 1000 * MS;
+        state.StepPattern(now);
+        TEST_CHECK(state.hasPendingPulse);
+        TEST_CHECK(state.pendingPulse.amplitude == 0.5f);
+        TEST_CHECK(state.patternIndex == 1);
+        TEST_CHECK(state.segmentEndTime == now + 100 * MS);
+        state.hasPendingPulse = false;
+
+        // Nothing happens before the segment elapsed
+        state.StepPattern(now + 99 * MS);
+        TEST_CHECK(!state.hasPendingPulse);
+        TEST_CHECK(state.patternIndex == 1);
+
+        // The gap only waits
+        now += 100 * MS;
+        state.StepPattern(now);
+        TEST_CHECK(!state.hasPendingPulse);
+        TEST_CHECK(state.patternIndex == 2);
+        TEST_CHECK(state.segmentEndTime == now + 50 * MS);
+
+        now += 50 * MS;
+        state.StepPattern(now);
+        TEST_CHECK(state.hasPendingPulse);
+        TEST_CHECK(state.pendingPulse.amplitude == 1.0f);
+        state.hasPendingPulse = false;
+
+        // The pattern is cleared once its last segment elapsed
+        now += 100 * MS;
+        state.StepPattern(now);
+        TEST_CHECK(!state.hasPendingPulse);
+        TEST_CHECK(state.pattern.empty());
+        TEST_CHECK(state.patternIndex == 0);
+
+        // A pattern segment coalesces with a pulse requested in the same frame
+        state.pattern = {MakePulse(0.4f, 200 * MS)};
+        state.segmentEndTime = 0;
+        state.QueuePulse(MakePulse(0.9f, 10 * MS));
+        state.StepPattern(now);
+        TEST_CHECK(state.pendingPulse.amplitude == 0.9f);
+        TEST_CHECK(state.pendingPulse.duration == 200 * MS);
+    }
+}
+
+int main()
+{
+    TestCoalescing();
+    TestPatternStepping();
+    return TEST_RESULT();
+}
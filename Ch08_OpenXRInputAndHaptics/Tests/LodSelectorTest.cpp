@@ -0,0 +1,68 @@
+#include "TestUtils.h"
+
+#include "../app/src/main/cpp/Engine/Rendering/Mesh/LodSelector.h"
+#include <cfloat>
+
+namespace
+{
+    const XrFovf SYMMETRIC_FOV = {-0.785398f, 0.785398f, 0.785398f, -0.785398f};  // 90 degrees, a view height of 2 at depth 1
+
+    float ComputeScreenSizeAt(const XrVector3f& position, float radius)
+    {
+        XrMatrix4x4f modelMatrix, viewMatrix;
+        XrMatrix4x4f_CreateTranslation(&modelMatrix, position.x, position.y, position.z);
+        XrMatrix4x4f_CreateIdentity(&viewMatrix);
+        return LodSelector::ComputeScreenSize({0.0f, 0.0f, 0.0f}, radius, modelMatrix, viewMatrix, SYMMETRIC_FOV);
+    }
+
+    void TestScreenSize()
+    {
+        // In front: diameter 1 at depth 5 covers a tenth of the view's height of 10
+        const float inFront = ComputeScreenSizeAt({0.0f, 0.0f, -5.0f}, 0.5f);
+        TEST_CHECK(inFront > 0.099f && inFront < 0.101f);
+
+        // Around the viewer, whether the center is in front or behind
+        TEST_CHECK(ComputeScreenSizeAt({0.0f, 0.0f, -0.3f}, 0.5f) == FLT_MAX);
+        TEST_CHECK(ComputeScreenSizeAt({0.0f, 0.0f, 0.3f}, 0.5f) == FLT_MAX);
+
+        // Entirely behind the viewer
+        TEST_CHECK(ComputeScreenSizeAt({0.0f, 0.0f, 5.0f}, 0.5f) == 0.0f);
+        const std::vector<MeshLod> lods = {{nullptr, 0.5f}, {nullptr, 0.25f}};
+        TEST_CHECK(LodSelector::SelectLevel(lods, ComputeScreenSizeAt({0.0f, 0.0f, 5.0f}, 0.5f), 0) == lods.size());
+    }
+
+    void TestHysteresis()
+    {
+        const std::vector<MeshLod> lods = {{nullptr, 0.5f}, {nullptr, 0.25f}};
+
+        // Switching to a coarser level needs the size 10% below the threshold
+        TEST_CHECK(LodSelector::SelectLevel(lods, 0.46f, 0) == 0);
+        TEST_CHECK(LodSelector::SelectLevel(lods, 0.44f, 0) == 1);
+
+        // and switching back needs it 10% above
+        TEST_CHECK(LodSelector::SelectLevel(lods, 0.54f, 1) == 1);
+        TEST_CHECK(LodSelector::SelectLevel(lods, 0.56f, 1) == 0);
+
+        // Between the two bands the current level holds either way
+        TEST_CHECK(LodSelector::SelectLevel(lods, 0.5f, 0) == 0);
+        TEST_CHECK(LodSelector::SelectLevel(lods, 0.5f, 1) == 1);
+
+        // Large changes skip levels
+        TEST_CHECK(LodSelector::SelectLevel(lods, 0.1f, 0) == 2);
+        TEST_CHECK(LodSelector::SelectLevel(lods, FLT_MAX, 2) == 0);
+
+        // An out of range current level is clamped, and no levels means the mesh itself
+        TEST_CHECK(LodSelector::SelectLevel(lods, 0.1f, 7) == 2);
+        TEST_CHECK(LodSelector::SelectLevel({}, 0.1f, 0) == 0);
+
+        // The hysteresis fraction is configurable
+        TEST_CHECK(LodSelector::SelectLevel(lods, 0.46f, 0, 0.0f) == 1);
+    }
+}
+
+int main()
+{
+    TestScreenSize();
+    TestHysteresis();
+    return TEST_RESULT();
+}
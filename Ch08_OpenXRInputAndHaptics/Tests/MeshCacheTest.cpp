@@ -0,0 +1,79 @@
+#include "TestUtils.h"
+
+#include "../app/src/main/cpp/Engine/Rendering/Mesh/MeshCache.h"
+#include "../app/src/main/cpp/Engine/Rendering/Mesh/MeshSimplifier.h"
+#include "../app/src/main/cpp/Engine/Rendering/Mesh/SphereMesh.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace
+{
+    const std::string CACHE_PATH = "MeshCacheTest.meshcache";
+
+    bool HasSameIndices(const IMesh& a, const IMesh& b)
+    {
+        return a.GetIndexCount() == b.GetIndexCount() &&
+               std::memcmp(a.GetIndexData(), b.GetIndexData(), static_cast<size_t>(a.GetIndexCount()) * sizeof(uint32_t)) == 0;
+    }
+
+    void TestRoundTrip()
+    {
+        std::shared_ptr<IMesh> built = MeshCache::Build(std::make_shared<SphereMesh>(0.1f, 32, 16), VertexLayout::GetStandard(), 3);
+        TEST_CHECK(!built->GetLods().empty());
+        TEST_CHECK(MeshCache::Write(CACHE_PATH, *built, 0, 0, 3));
+
+        std::shared_ptr<MappedMesh> mapped = MeshCache::Load(CACHE_PATH);
+        TEST_CHECK(mapped != nullptr);
+        if (!mapped) return;
+
+        // Small meshes store 16-bit indices, read back as 32-bit ones
+        TEST_CHECK(mapped->GetHeader().indexStride == sizeof(uint16_t));
+        TEST_CHECK(mapped->GetShortIndexData() != nullptr);
+        TEST_CHECK(mapped->GetHeader().lodLevelLimit == 3);
+        TEST_CHECK(mapped->GetVertexCount() == built->GetVertexCount());
+        TEST_CHECK(HasSameIndices(*mapped, *built));
+        TEST_CHECK(mapped->GetIndices().size() == built->GetIndexCount());
+
+        TEST_CHECK(mapped->GetLods().size() == built->GetLods().size());
+        for (size_t i = 0; i < mapped->GetLods().size() && i < built->GetLods().size(); ++i)
+        {
+            const MeshLod& mappedLod = mapped->GetLods()[i];
+            const MeshLod& builtLod = built->GetLods()[i];
+            TEST_CHECK(mappedLod.maxScreenSize == builtLod.maxScreenSize);
+            TEST_CHECK(mappedLod.mesh->GetVertexCount() == builtLod.mesh->GetVertexCount());
+            TEST_CHECK(HasSameIndices(*mappedLod.mesh, *builtLod.mesh));
+            TEST_CHECK(mappedLod.mesh->GetVerticesWithNormals().size() == builtLod.mesh->GetVertexCount());
+        }
+    }
+
+    void TestLoadOrBuild()
+    {
+        std::remove(CACHE_PATH.c_str());
+        int buildCount = 0;
+        auto build = [&buildCount]()
+        {
+            ++buildCount;
+            return std::make_shared<SphereMesh>(0.1f, 16, 8);
+        };
+
+        std::shared_ptr<IMesh> first = MeshCache::LoadOrBuild(CACHE_PATH, build, VertexLayout::GetStandard(), 2);
+        std::shared_ptr<IMesh> second = MeshCache::LoadOrBuild(CACHE_PATH, build, VertexLayout::GetStandard(), 2);
+        TEST_CHECK(buildCount == 1);
+        TEST_CHECK(first && second && first->GetLods().size() == second->GetLods().size());
+
+        // Asking for another level count rebuilds the cache
+        MeshCache::LoadOrBuild(CACHE_PATH, build, VertexLayout::GetStandard(), 0);
+        TEST_CHECK(buildCount == 2);
+        std::shared_ptr<MappedMesh> rebuilt = MeshCache::Load(CACHE_PATH);
+        TEST_CHECK(rebuilt && rebuilt->GetLods().empty());
+    }
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestLoadOrBuild();
+    std::remove(CACHE_PATH.c_str());
+    return TEST_RESULT();
+}
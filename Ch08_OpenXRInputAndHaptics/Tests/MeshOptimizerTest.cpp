@@ -0,0 +1,79 @@
+#include "TestUtils.h"
+
+#include "../app/src/main/cpp/Engine/Rendering/Mesh/CubeMesh.h"
+#include "../app/src/main/cpp/Engine/Rendering/Mesh/MeshOptimizer.h"
+#include "../app/src/main/cpp/Engine/Rendering/Mesh/SphereMesh.h"
+
+namespace
+{
+    // Expands an indexed mesh back to one vertex per corner, the way the generators emit it before welding
+    void Unweld(const IMesh& mesh, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+    {
+        vertices.clear();
+        indices.clear();
+        for (uint32_t index : mesh.GetIndices())
+        {
+            indices.push_back(static_cast<uint32_t>(vertices.size()));
+            vertices.push_back(mesh.GetVerticesWithNormals()[index]);
+        }
+    }
+
+    void TestCubeWeld()
+    {
+        const CubeMesh cube(1.0f);
+        TEST_CHECK(cube.GetVertexCount() == 24);
+        TEST_CHECK(cube.GetIndexCount() == 36);
+
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        Unweld(cube, vertices, indices);
+        TEST_CHECK(vertices.size() == 36);
+
+        const MeshOptimizer::Report report = MeshOptimizer::Optimize(vertices, indices);
+        TEST_CHECK(report.vertexCountBefore == 36);
+        TEST_CHECK(report.vertexCountAfter == 24);
+        TEST_CHECK(vertices.size() == 24);
+        TEST_CHECK(indices.size() == 36);
+        TEST_CHECK(report.acmrAfter <= report.acmrBefore);
+    }
+
+    void TestSphereAcmr()
+    {
+        const SphereMesh sphere(1.0f, 32, 16);
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        Unweld(sphere, vertices, indices);
+
+        const MeshOptimizer::Report report = MeshOptimizer::Optimize(vertices, indices);
+        TEST_CHECK(report.vertexCountAfter < report.vertexCountBefore);
+        TEST_CHECK(report.acmrAfter <= report.acmrBefore);
+        TEST_CHECK(report.acmrAfter == MeshOptimizer::ComputeACMR(indices, vertices.size()));
+
+        // Running the pipeline again on its own output must not make the order worse
+        const MeshOptimizer::Report again = MeshOptimizer::Optimize(vertices, indices);
+        TEST_CHECK(again.vertexCountAfter == again.vertexCountBefore);
+        TEST_CHECK(again.acmrAfter <= again.acmrBefore);
+    }
+
+    void Test16BitIndices()
+    {
+        // Index 65535 is the largest that fits, so 65536 vertices is the limit
+        TEST_CHECK(MeshOptimizer::CanUse16BitIndices(0));
+        TEST_CHECK(MeshOptimizer::CanUse16BitIndices(65535));
+        TEST_CHECK(MeshOptimizer::CanUse16BitIndices(65536));
+        TEST_CHECK(!MeshOptimizer::CanUse16BitIndices(65537));
+
+        const uint32_t indices[] = {0, 1, 65534, 65535};
+        const std::vector<uint16_t> shortIndices = MeshOptimizer::To16BitIndices(indices, 4);
+        TEST_CHECK(shortIndices.size() == 4);
+        TEST_CHECK(shortIndices[2] == 65534 && shortIndices[3] == 65535);
+    }
+}
+
+int main()
+{
+    TestCubeWeld();
+    TestSphereAcmr();
+    Test16BitIndices();
+    return TEST_RESULT();
+}
@@ -0,0 +1,109 @@
+#include "TestUtils.h"
+
+#include "../app/src/main/cpp/Engine/Rendering/Mesh/MeshSimplifier.h"
+#include "../app/src/main/cpp/Engine/Rendering/Mesh/SphereMesh.h"
+#include <xr_linear_algebra.h>
+#include <map>
+#include <utility>
+
+namespace
+{
+    XrVector3f ToVector3(const XrVector4f& position) { return {position.x, position.y, position.z}; }
+
+    // Sign of the face normal against the direction from the origin to the face, for shapes around the origin
+    float GetOutwardness(const std::vector<Vertex>& vertices, const uint32_t* triangle)
+    {
+        const XrVector3f a = ToVector3(vertices[triangle[0]].position);
+        const XrVector3f b = ToVector3(vertices[triangle[1]].position);
+        const XrVector3f c = ToVector3(vertices[triangle[2]].position);
+        XrVector3f ab, ac, normal;
+        XrVector3f_Sub(&ab, &b, &a);
+        XrVector3f_Sub(&ac, &c, &a);
+        XrVector3f_Cross(&normal, &ab, &ac);
+        const XrVector3f centroid = {(a.x + b.x + c.x) / 3.0f, (a.y + b.y + c.y) / 3.0f, (a.z + b.z + c.z) / 3.0f};
+        return XrVector3f_Dot(&normal, &centroid);
+    }
+
+    // Counts how many triangles use each undirected edge
+    std::map<std::pair<uint32_t, uint32_t>, int> CountEdgeUses(const std::vector<uint32_t>& indices)
+    {
+        std::map<std::pair<uint32_t, uint32_t>, int> edgeUses;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t a = indices[i + corner];
+                const uint32_t b = indices[i + (corner + 1) % 3];
+                ++edgeUses[a < b ? std::make_pair(a, b) : std::make_pair(b, a)];
+            }
+        }
+        return edgeUses;
+    }
+
+    void TestSphereSimplify()
+    {
+        const SphereMesh sphere(1.0f, 32, 16);
+        const std::vector<Vertex>& vertices = sphere.GetVerticesWithNormals();
+        const std::vector<uint32_t>& indices = sphere.GetIndices();
+        const size_t triangleCount = indices.size() / 3;
+
+        // The generated sphere winds every face the same way
+        const bool outwardWinding = GetOutwardness(vertices, &indices[0]) > 0.0f;
+        for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            TEST_CHECK((GetOutwardness(vertices, &indices[i]) > 0.0f) == outwardWinding);
+        }
+
+        const size_t targetTriangleCount = triangleCount / 4;
+        std::vector<Vertex> simplifiedVertices;
+        std::vector<uint32_t> simplifiedIndices;
+        MeshSimplifier::Simplify(vertices, indices, targetTriangleCount, simplifiedVertices, simplifiedIndices);
+        const size_t simplifiedTriangleCount = simplifiedIndices.size() / 3;
+
+        // Each collapse on a closed surface removes two triangles, so the target is hit to within one
+        TEST_CHECK(simplifiedTriangleCount <= targetTriangleCount);
+        TEST_CHECK(simplifiedTriangleCount + 2 >= targetTriangleCount);
+
+        // No face turned inside out
+        for (size_t i = 0; i + 2 < simplifiedIndices.size(); i += 3)
+        {
+            TEST_CHECK((GetOutwardness(simplifiedVertices, &simplifiedIndices[i]) > 0.0f) == outwardWinding);
+        }
+
+        // Still closed: every edge has exactly two triangles, none became a border, and the genus is unchanged
+        const std::map<std::pair<uint32_t, uint32_t>, int> edgeUses = CountEdgeUses(simplifiedIndices);
+        for (const auto& edge : edgeUses)
+        {
+            TEST_CHECK(edge.second == 2);
+        }
+        const long eulerCharacteristic = static_cast<long>(simplifiedVertices.size()) - static_cast<long>(edgeUses.size()) +
+                                         static_cast<long>(simplifiedTriangleCount);
+        TEST_CHECK(eulerCharacteristic == 2);
+    }
+
+    void TestGenerateLods()
+    {
+        SphereMesh sphere(1.0f, 32, 16);
+        MeshSimplifier::GenerateLods(sphere);
+        const std::vector<MeshLod>& lods = sphere.GetLods();
+        TEST_CHECK(!lods.empty());
+
+        // Coarser levels have fewer triangles and smaller screen size thresholds
+        uint64_t previousIndexCount = sphere.GetIndexCount();
+        float previousMaxScreenSize = 1.0f;
+        for (const MeshLod& lod : lods)
+        {
+            TEST_CHECK(lod.mesh->GetIndexCount() < previousIndexCount);
+            TEST_CHECK(lod.maxScreenSize < previousMaxScreenSize);
+            previousIndexCount = lod.mesh->GetIndexCount();
+            previousMaxScreenSize = lod.maxScreenSize;
+        }
+    }
+}
+
+int main()
+{
+    TestSphereSimplify();
+    TestGenerateLods();
+    return TEST_RESULT();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal checks for the unit tests: a failed check prints its location and carries on, and the test's main
+// returns TEST_RESULT() so ctest sees the failure
+namespace TestUtils
+{
+    inline int& GetFailureCount()
+    {
+        static int failureCount = 0;
+        return failureCount;
+    }
+}
+
+#define TEST_CHECK(condition)                                                                    \
+    do                                                                                           \
+    {                                                                                            \
+        if (!(condition))                                                                        \
+        {                                                                                        \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);  \
+            ++TestUtils::GetFailureCount();                                                      \
+        }                                                                                        \
+    } while (0)
+
+#define TEST_RESULT() (TestUtils::GetFailureCount() == 0 ? 0 : 1)
@@ -0,0 +1,31 @@
+﻿#include "StressObjectMotion.h"
+#include "../../Engine/Components/Core/Transform.h"
+#include "../../Engine/Core/GameObject.h"
+#include "../../OpenXR/OpenXRSessionMgr.h"
+#include <cmath>
+
+StressObjectMotion::StressObjectMotion(float phase, float radius, float angularSpeed)
+    : m_Phase(phase), m_Radius(radius), m_AngularSpeed(angularSpeed)
+{
+}
+
+void StressObjectMotion::Initialize()
+{
+    Transform* transform = GetGameObject()->GetComponent<Transform>();
+    if (transform)
+    {
+        m_Origin = transform->GetPosition();
+    }
+}
+
+void StressObjectMotion::Simulate(float deltaTime)
+{
+    Transform* transform = GetGameObject()->GetComponent<Transform>();
+    if (!transform) return;
+
+    const double seconds = static_cast<double>(OpenXRSessionMgr::frameState.predictedDisplayTime) * 1e-9;
+    const float angle = m_Phase + static_cast<float>(std::fmod(seconds * m_AngularSpeed, 6.283185307179586));
+
+    transform->SetPosition({m_Origin.x + m_Radius * std::cos(angle), m_Origin.y + m_Radius * std::sin(angle), m_Origin.z});
+    transform->SetRotation({0.0f, std::sin(angle * 0.5f), 0.0f, std::cos(angle * 0.5f)});
+}
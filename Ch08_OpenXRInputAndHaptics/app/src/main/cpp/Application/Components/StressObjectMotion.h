@@ -0,0 +1,20 @@
+﻿#pragma once
+#include "../../Engine/Core/IComponent.h"
+#include <openxr/openxr.h>
+
+// Moves a stress scene object along a small orbit around its start position. The motion is driven by the
+// predicted display time, so both views of a frame see the same pose and runs are reproducible.
+class StressObjectMotion : public IComponent
+{
+public:
+    StressObjectMotion(float phase, float radius, float angularSpeed);
+
+    void Initialize() override;
+    void Simulate(float deltaTime) override;
+
+private:
+    XrVector3f m_Origin = {0.0f, 0.0f, 0.0f};
+    float m_Phase;
+    float m_Radius;
+    float m_AngularSpeed;
+};
@@ -2,7 +2,7 @@
 #include "../../Engine/Components/Input/InputMgr.h"
 #include "../../OpenXR/OpenXRInputMgr.h"
 
-void TestControllerHaptics::Tick(float deltaTime)
+void TestControllerHaptics::Simulate(float deltaTime)
 {
     if (InputMgr::GetSelectDown(1))
     {
@@ -4,5 +4,5 @@
 class TestControllerHaptics : public IComponent
 {
 public:
-   void Tick(float deltaTime) override; 
+   void Simulate(float deltaTime) override; 
 };
\ No newline at end of file
@@ -3,13 +3,26 @@
 #include <GraphicsAPI_Vulkan.h>
 #include <openxr/openxr.h>
 
+#include "../OpenXR/OpenXRAttachmentMgr.h"
+#include "../OpenXR/OpenXRCompositionLayerMgr.h"
 #include "../OpenXR/OpenXRCoreMgr.h"
 #include "../OpenXR/OpenXRDisplayMgr.h"
+#include "../OpenXR/OpenXRFoveationMgr.h"
+#include "../OpenXR/OpenXRFrameTimingMgr.h"
+#include "../OpenXR/OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
 #include "../OpenXR/OpenXRInputMgr.h"
 #include "../OpenXR/OpenXRRenderMgr.h"
+#include "../OpenXR/OpenXRResolutionMgr.h"
 #include "../OpenXR/OpenXRSessionMgr.h"
 #include "../OpenXR/OpenXRSpaceMgr.h"
+#include "../Engine/Assets/AssetLoaderMgr.h"
 #include "../Engine/Components/Rendering/Camera.h"
+#include "../Engine/Components/XRDevices/TrackedPoseFilter.h"
+#include "../Engine/Rendering/DrawListRecorder.h"
+#include "../Engine/Rendering/MeshResourceRegistry.h"
+#include "../Engine/Rendering/Shader/PipelineCache.h"
+#include "../Engine/Rendering/Shader/ShaderLibrary.h"
+#include "../Scenes/TableFloorScene.h"
 
 GraphicsAPI_Type OpenXRTutorial::m_apiType = UNKNOWN;
 
@@ -20,51 +33,96 @@ OpenXRTutorial::OpenXRTutorial(GraphicsAPI_Type apiType)
 
 OpenXRTutorial::~OpenXRTutorial() = default;
 
-void OpenXRTutorial::Run()
+void OpenXRTutorial::SetScene(std::unique_ptr<IScene> scene)
+{
+    m_scene = std::move(scene);
+}
+
+void OpenXRTutorial::Run(uint64_t maxFrameCount)
 {
     InitializeOpenXR();
     InitializeSceneRendering();
-    while (true)
+    uint64_t frameCount = 0;
+    while (maxFrameCount == 0 || frameCount < maxFrameCount)
     {
         PollSystemEvents();
         OpenXRSessionMgr::PollEvent();
         if (OpenXRSessionMgr::IsSessionRunning())
         {
+            OpenXRFrameTimingMgr::StartFrameRecord();
+
+            OpenXRFrameTimingMgr::BeginStage(FrameStage::WAIT);
             OpenXRSessionMgr::WaitFrame();
+            OpenXRFrameTimingMgr::EndStage(FrameStage::WAIT);
+            OpenXRFrameTimingMgr::UpdateFrameState(OpenXRSessionMgr::frameState);
+
+            OpenXRFrameTimingMgr::BeginStage(FrameStage::BEGIN);
             OpenXRSessionMgr::BeginFrame();
+            OpenXRFrameTimingMgr::EndStage(FrameStage::BEGIN);
 
+            // Streamed assets are uploaded and resolved here, so both views of a frame see the same resources
+            AssetLoaderMgr::Tick();
+
+            OpenXRFrameTimingMgr::BeginStage(FrameStage::SIMULATE);
             if (OpenXRSessionMgr::IsShouldProcessInput())
             {
-
                 OpenXRInputMgr::Tick(OpenXRSessionMgr::frameState.predictedDisplayTime,
                                      OpenXRSpaceMgr::activeSpaces);
+                TrackedPoseFilter::Tick(OpenXRSessionMgr::frameState.predictedDisplayTime);
             }
+            // Once per frame, however many views are rendered
+            m_scene->Simulate(OpenXRFrameTimingMgr::GetDeltaTime());
+            OpenXRFrameTimingMgr::EndStage(FrameStage::SIMULATE);
 
             const bool shouldRender = OpenXRSessionMgr::IsShouldRender();
 
             if (shouldRender)
             {
+                OpenXRFrameTimingMgr::BeginStage(FrameStage::RECORD);
                 OpenXRRenderMgr::RefreshViewsData();
+                OpenXRCompositionLayerMgr::RenderDirtyLayers();
                 for (int i = 0; i != static_cast<int>(OpenXRDisplayMgr::GetViewsCount()); ++i)
                 {
                     OpenXRDisplayMgr::StartRenderingView(i);
 
-                    m_tableFloorScene->Update(0.016f);
+                    m_scene->Update(i == 0 ? OpenXRFrameTimingMgr::GetDeltaTime() : 0.0f);
 
                     OpenXRDisplayMgr::StopRenderingView();
                 }
                 OpenXRRenderMgr::UpdateRenderLayerInfo();
+                OpenXRFrameTimingMgr::EndStage(FrameStage::RECORD);
+            }
+
+            if (OpenXRSessionMgr::IsShouldProcessInput())
+            {
+                // Haptics requested while updating the views are coalesced and submitted once per frame
+                OpenXRInputMgr::FlushHaptics(OpenXRSessionMgr::frameState.predictedDisplayTime);
             }
 
+            OpenXRFrameTimingMgr::BeginStage(FrameStage::END);
             OpenXRSessionMgr::EndFrame(shouldRender);
+            OpenXRFrameTimingMgr::EndStage(FrameStage::END);
+
+            OpenXRFrameTimingMgr::CollectGpuTimings();
+            OpenXRResolutionMgr::Update(OpenXRFrameTimingMgr::GetLatestGpuFrameTime(), OpenXRSessionMgr::frameState.predictedDisplayPeriod);
+            OpenXRSessionMgr::UpdateRefreshRatePolicy(OpenXRFrameTimingMgr::GetMissedFrameCount(), OpenXRFrameTimingMgr::GetLatestGpuFrameTime());
+            OpenXRFrameTimingMgr::FinishFrameRecord();
+            ++frameCount;
         }
     }
+
+    ShutDownOpenXR();
 }
 
 void OpenXRTutorial::InitializeSceneRendering()
 {
-    m_tableFloorScene = std::make_unique<TableFloorScene>();
-    m_tableFloorScene->Initialize();
+    if (!m_scene)
+    {
+        m_scene = std::make_unique<TableFloorScene>();
+    }
+    AssetLoaderMgr::Initialize();
+    DrawListRecorder::Initialize();
+    m_scene->Initialize();
     
     Camera::SetGraphicsAPIType(m_apiType);
 }
@@ -79,25 +137,46 @@ void OpenXRTutorial::InitializeOpenXR()
     OpenXRInputMgr::SetupBindings();
 
     OpenXRCoreMgr::CreateSession(m_apiType);
+    OpenXRFoveationMgr::Initialize();
+    OpenXRSessionMgr::InitializeDisplayRefreshRate();
 
     OpenXRInputMgr::AttachActionSet();
     OpenXRInputMgr::CreateHandPoseActionSpace();
     
     OpenXRDisplayMgr::GetActiveViewConfigurationType();
     OpenXRDisplayMgr::GetViewConfigurationViewsInfo();
+    OpenXRAttachmentMgr::Initialize();
     OpenXRDisplayMgr::CreateSwapchains();
+    OpenXRResolutionMgr::Initialize();
     OpenXRDisplayMgr::CreateSwapchainImages();
     OpenXRDisplayMgr::CreateSwapchainImageViews();
+    OpenXRAttachmentMgr::CreateAttachments();
+    OpenXRFoveationMgr::OnSwapchainsCreated();
     OpenXRSpaceMgr::CreateReferenceSpace();
 }
 
 void OpenXRTutorial::ShutDownOpenXR()
 {
+    OpenXRFrameTimingMgr::ExportCSV("frame_timing.csv");
+    OpenXRFrameTimingMgr::ExportChromeTrace("frame_timing_trace.json");
+
+    // Swapchains and spaces belong to the session, which belongs to the instance, so they go first
+    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->WaitForIdle();
+    AssetLoaderMgr::Shutdown();
+    DrawListRecorder::Shutdown();
+    m_scene.reset();
+    OpenXRCompositionLayerMgr::Shutdown();
+    MeshResourceRegistry::Shutdown();
+    PipelineCache::Shutdown();
+    ShaderLibrary::Shutdown();
+    OpenXRFoveationMgr::Shutdown();
+    OpenXRAttachmentMgr::Shutdown();
+    OpenXRDisplayMgr::DestroySwapchainsRelatedData();
+    OpenXRSpaceMgr::DestroyReferenceSpace();
+
     // Shutdown the refactored input manager
     OpenXRInputMgr::Shutdown();
 
     OpenXRCoreMgr::DestroySession();
     OpenXRCoreMgr::DestroyInstance();
-    OpenXRDisplayMgr::DestroySwapchainsRelatedData();
-    OpenXRSpaceMgr::DestroyReferenceSpace();
 }
\ No newline at end of file
@@ -1,7 +1,8 @@
 #pragma once
 
 #include <GraphicsAPI.h>
-#include "../Scenes/TableFloorScene.h"
+#include "../Scenes/IScene.h"
+#include <memory>
 
 #if defined(__ANDROID__)
 #include <android_native_app_glue.h>
@@ -13,7 +14,11 @@ public:
     OpenXRTutorial(GraphicsAPI_Type apiType);
     ~OpenXRTutorial();
 
-    void Run();
+    // Runs the frame loop. With a non-zero frame count, returns and shuts OpenXR down after that many frames.
+    void Run(uint64_t maxFrameCount = 0);
+
+    // Replaces the default TableFloorScene. The scene is initialized by Run once the graphics API exists.
+    void SetScene(std::unique_ptr<IScene> scene);
 
     static GraphicsAPI_Type m_apiType;
 
@@ -40,5 +45,5 @@ private:
     void ShutDownOpenXR();
     void PollSystemEvents();
 
-    std::unique_ptr<TableFloorScene> m_tableFloorScene;
+    std::unique_ptr<IScene> m_scene;
 };
\ No newline at end of file
@@ -0,0 +1,40 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <memory>
+
+enum class AssetStatus : uint8_t {
+    LOADING,
+    READY,
+    FAILED
+};
+
+// Shared reference to an asset loaded by AssetLoaderMgr. Handles only change status inside AssetLoaderMgr::Tick,
+// so an asset never appears between the views of one frame. Main thread only.
+template <typename T>
+class AssetHandle {
+public:
+    AssetHandle() = default;
+
+    bool IsValid() const { return m_Slot != nullptr; }
+    AssetStatus GetStatus() const { return m_Slot ? m_Slot->status : AssetStatus::FAILED; }
+    bool IsReady() const { return GetStatus() == AssetStatus::READY; }
+    bool IsLoading() const { return GetStatus() == AssetStatus::LOADING; }
+
+    // Only meaningful once the handle is ready
+    const T& Get() const { return m_Slot->value; }
+
+    void Reset() { m_Slot.reset(); }
+
+private:
+    friend class AssetLoaderMgr;
+
+    struct Slot {
+        AssetStatus status = AssetStatus::LOADING;
+        T value{};
+    };
+
+    explicit AssetHandle(std::shared_ptr<Slot> slot) : m_Slot(std::move(slot)) {}
+
+    std::shared_ptr<Slot> m_Slot;
+};
@@ -0,0 +1,329 @@
+﻿#include "AssetLoaderMgr.h"
+#include "../Rendering/MeshResourceRegistry.h"
+#include "../Rendering/Mesh/MeshCache.h"
+#include <DebugOutput.h>
+#include <algorithm>
+#include <fstream>
+
+#if defined(__ANDROID__)
+#include <android/asset_manager.h>
+#include "../../Application/OpenXRTutorial.h"
+#endif
+
+std::vector<std::thread> AssetLoaderMgr::m_Threads;
+bool AssetLoaderMgr::m_Running = false;
+std::mutex AssetLoaderMgr::m_QueueMutex;
+std::condition_variable AssetLoaderMgr::m_IoCondition;
+std::condition_variable AssetLoaderMgr::m_DecodeCondition;
+std::deque<AssetLoaderMgr::Job> AssetLoaderMgr::m_IoQueue;
+std::deque<AssetLoaderMgr::Job> AssetLoaderMgr::m_DecodeQueue;
+std::deque<AssetLoaderMgr::Job> AssetLoaderMgr::m_UploadQueue;
+size_t AssetLoaderMgr::m_PendingCount = 0;
+uint64_t AssetLoaderMgr::m_UploadBudget = 4 * 1024 * 1024;
+std::unordered_map<std::string, std::weak_ptr<AssetHandle<std::vector<char>>::Slot>> AssetLoaderMgr::m_Files;
+std::vector<AssetLoaderMgr::ResidentMesh> AssetLoaderMgr::m_ResidentMeshes;
+
+void AssetLoaderMgr::Initialize(uint32_t decodeThreadCount)
+{
+    if (m_Running) return;
+
+    if (decodeThreadCount == 0)
+    {
+        const uint32_t coreCount = std::thread::hardware_concurrency();
+        decodeThreadCount = std::min(std::max(coreCount > 2 ? coreCount - 2 : 1u, 1u), 4u);
+    }
+
+    m_Running = true;
+    m_Threads.emplace_back(&AssetLoaderMgr::IoLoop);
+    for (uint32_t i = 0; i < decodeThreadCount; ++i)
+    {
+        m_Threads.emplace_back(&AssetLoaderMgr::DecodeLoop);
+    }
+    XR_TUT_LOG("AssetLoaderMgr: 1 IO thread, " << decodeThreadCount << " decode threads");
+}
+
+void AssetLoaderMgr::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_QueueMutex);
+        m_Running = false;
+    }
+    m_IoCondition.notify_all();
+    m_DecodeCondition.notify_all();
+    for (std::thread& thread : m_Threads)
+    {
+        thread.join();
+    }
+    m_Threads.clear();
+
+    m_IoQueue.clear();
+    m_DecodeQueue.clear();
+    m_UploadQueue.clear();
+    m_PendingCount = 0;
+    m_Files.clear();
+    ReleaseUnusedMeshes(true);
+}
+
+void AssetLoaderMgr::Tick()
+{
+    ReleaseUnusedMeshes(false);
+
+    uint64_t uploadedBytes = 0;
+    bool first = true;
+    while (true)
+    {
+        Job job;
+        {
+            std::lock_guard<std::mutex> lock(m_QueueMutex);
+            if (m_UploadQueue.empty()) break;
+
+            // The cost is known once decoded; a job over the remaining budget waits, unless nothing ran this frame
+            const uint64_t cost = m_UploadQueue.front().uploadCost && !m_UploadQueue.front().failed ? m_UploadQueue.front().uploadCost() : 0;
+            if (!first && uploadedBytes + cost > m_UploadBudget) break;
+            uploadedBytes += cost;
+            first = false;
+
+            job = std::move(m_UploadQueue.front());
+            m_UploadQueue.pop_front();
+            --m_PendingCount;
+        }
+
+        bool success = !job.failed;
+        if (success && job.upload)
+        {
+            success = job.upload();
+        }
+        job.resolve(success);
+    }
+}
+
+AssetHandle<std::vector<char>> AssetLoaderMgr::LoadFileAsync(const std::string& path)
+{
+    auto it = m_Files.find(path);
+    if (it != m_Files.end())
+    {
+        std::shared_ptr<AssetHandle<std::vector<char>>::Slot> slot = it->second.lock();
+        if (slot && slot->status != AssetStatus::FAILED)
+        {
+            return AssetHandle<std::vector<char>>(slot);
+        }
+    }
+
+    std::shared_ptr<AssetHandle<std::vector<char>>::Slot> slot = std::make_shared<AssetHandle<std::vector<char>>::Slot>();
+    m_Files[path] = slot;
+
+    Job job;
+    job.io = [slot, path]() { return ReadFile(path, slot->value); };
+    job.resolve = [slot](bool success) { slot->status = success ? AssetStatus::READY : AssetStatus::FAILED; };
+    Submit(std::move(job));
+
+    return AssetHandle<std::vector<char>>(slot);
+}
+
+AssetHandle<std::shared_ptr<IMesh>> AssetLoaderMgr::LoadMeshAsync(const std::string& gltfPath, uint32_t meshIndex, const std::string& cachePath,
+                                                                  const VertexLayout& layout)
+{
+    // MeshCache maps the cache file or parses the glTF itself, so the whole load runs as one decode job
+    return CreateMeshAsync([gltfPath, meshIndex, cachePath, layout]() { return MeshCache::LoadOrImportGltf(gltfPath, meshIndex, cachePath, layout); });
+}
+
+AssetHandle<std::shared_ptr<IMesh>> AssetLoaderMgr::CreateMeshAsync(std::function<std::shared_ptr<IMesh>()> build)
+{
+    std::shared_ptr<MeshSlot> slot = std::make_shared<MeshSlot>();
+
+    Job job;
+    job.decode = [slot, build]()
+    {
+        slot->value = build();
+        return slot->value != nullptr;
+    };
+    job.uploadCost = [slot]() { return GetMeshSize(slot->value); };
+    job.upload = [slot]() { return UploadMesh(slot); };
+    job.resolve = [slot](bool success)
+    {
+        slot->status = success ? AssetStatus::READY : AssetStatus::FAILED;
+        if (!success) slot->value.reset();
+    };
+    Submit(std::move(job));
+
+    return AssetHandle<std::shared_ptr<IMesh>>(slot);
+}
+
+bool AssetLoaderMgr::ReadFile(const std::string& path, std::vector<char>& data)
+{
+#if defined(__ANDROID__)
+    if (OpenXRTutorial::androidApp == nullptr || OpenXRTutorial::androidApp->activity == nullptr || OpenXRTutorial::androidApp->activity->assetManager == nullptr)
+    {
+        XR_TUT_LOG_ERROR("Android asset manager not available");
+        return false;
+    }
+
+    AAsset* asset = AAssetManager_open(OpenXRTutorial::androidApp->activity->assetManager, path.c_str(), AASSET_MODE_BUFFER);
+    if (!asset)
+    {
+        XR_TUT_LOG_ERROR("Failed to open Android asset: " << path);
+        return false;
+    }
+
+    const size_t length = AAsset_getLength(asset);
+    data.resize(length);
+    const int bytesRead = length > 0 ? AAsset_read(asset, data.data(), length) : 0;
+    AAsset_close(asset);
+
+    if (length == 0 || bytesRead != static_cast<int>(length))
+    {
+        XR_TUT_LOG_ERROR("Failed to read Android asset: " << path);
+        return false;
+    }
+    return true;
+#else
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        XR_TUT_LOG_ERROR("Failed to open file: " << path);
+        return false;
+    }
+
+    const size_t fileSize = static_cast<size_t>(file.tellg());
+    data.resize(fileSize);
+    file.seekg(0);
+    file.read(data.data(), static_cast<std::streamsize>(fileSize));
+
+    if (!file.good() && !file.eof())
+    {
+        XR_TUT_LOG_ERROR("Failed to read complete file: " << path);
+        return false;
+    }
+    return true;
+#endif
+}
+
+size_t AssetLoaderMgr::GetPendingCount()
+{
+    std::lock_guard<std::mutex> lock(m_QueueMutex);
+    return m_PendingCount;
+}
+
+void AssetLoaderMgr::Submit(Job job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_QueueMutex);
+        ++m_PendingCount;
+        if (job.io)
+        {
+            m_IoQueue.push_back(std::move(job));
+        }
+        else if (job.decode)
+        {
+            m_DecodeQueue.push_back(std::move(job));
+        }
+        else
+        {
+            m_UploadQueue.push_back(std::move(job));
+        }
+    }
+    m_IoCondition.notify_one();
+    m_DecodeCondition.notify_one();
+}
+
+void AssetLoaderMgr::IoLoop()
+{
+    std::unique_lock<std::mutex> lock(m_QueueMutex);
+    while (true)
+    {
+        m_IoCondition.wait(lock, []() { return !m_Running || !m_IoQueue.empty(); });
+        if (!m_Running) return;
+
+        Job job = std::move(m_IoQueue.front());
+        m_IoQueue.pop_front();
+
+        lock.unlock();
+        job.failed = !job.io();
+        lock.lock();
+
+        if (!job.failed && job.decode)
+        {
+            m_DecodeQueue.push_back(std::move(job));
+            m_DecodeCondition.notify_one();
+        }
+        else
+        {
+            m_UploadQueue.push_back(std::move(job));
+        }
+    }
+}
+
+void AssetLoaderMgr::DecodeLoop()
+{
+    std::unique_lock<std::mutex> lock(m_QueueMutex);
+    while (true)
+    {
+        m_DecodeCondition.wait(lock, []() { return !m_Running || !m_DecodeQueue.empty(); });
+        if (!m_Running) return;
+
+        Job job = std::move(m_DecodeQueue.front());
+        m_DecodeQueue.pop_front();
+
+        lock.unlock();
+        job.failed = !job.decode();
+        lock.lock();
+
+        m_UploadQueue.push_back(std::move(job));
+    }
+}
+
+bool AssetLoaderMgr::UploadMesh(const std::shared_ptr<MeshSlot>& slot)
+{
+    // The loader holds a registry reference until nobody uses the mesh any more, so renderers picking it up
+    // later in the frame only bump the ref count
+    const std::shared_ptr<IMesh>& mesh = slot->value;
+    ResidentMesh resident;
+    resident.mesh = mesh;
+    resident.handle = slot;
+    if (!MeshResourceRegistry::Acquire(*mesh))
+    {
+        return false;
+    }
+    resident.acquired.push_back(mesh.get());
+    for (const MeshLod& lod : mesh->GetLods())
+    {
+        if (MeshResourceRegistry::Acquire(*lod.mesh))
+        {
+            resident.acquired.push_back(lod.mesh.get());
+        }
+    }
+    m_ResidentMeshes.push_back(std::move(resident));
+    return true;
+}
+
+uint64_t AssetLoaderMgr::GetMeshSize(const std::shared_ptr<IMesh>& mesh)
+{
+    if (!mesh) return 0;
+
+    uint64_t size = MeshResourceRegistry::GetUploadSize(*mesh);
+    for (const MeshLod& lod : mesh->GetLods())
+    {
+        size += MeshResourceRegistry::GetUploadSize(*lod.mesh);
+    }
+    return size;
+}
+
+void AssetLoaderMgr::ReleaseUnusedMeshes(bool releaseAll)
+{
+    for (auto it = m_ResidentMeshes.begin(); it != m_ResidentMeshes.end();)
+    {
+        // No handle left, and the loader's is the only registry reference: renderers count from their Acquire on
+        if (releaseAll || (it->handle.expired() && MeshResourceRegistry::GetRefCount(*it->mesh) == 1))
+        {
+            for (const IMesh* mesh : it->acquired)
+            {
+                MeshResourceRegistry::Release(*mesh);
+            }
+            it = m_ResidentMeshes.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,126 @@
+﻿#pragma once
+
+#include "AssetHandle.h"
+#include "../Rendering/Mesh/IMesh.h"
+#include "../Rendering/VertexLayout.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Streams assets without blocking the frame loop. A job goes through up to three stages:
+//  - IO on a single loader thread, so reads don't compete for the storage,
+//  - decode on a small worker pool (parsing, mesh processing),
+//  - upload on the main thread in Tick, which creates GPU resources under a per-frame byte budget and resolves
+//    the handle. The graphics API is not thread-safe, so GPU work stays on the thread that records the frame.
+class AssetLoaderMgr {
+public:
+    // decodeThreadCount 0 picks one from the core count, leaving cores to the render and XR runtime threads
+    static void Initialize(uint32_t decodeThreadCount = 0);
+    // Joins the loader threads; handles still loading never resolve
+    static void Shutdown();
+
+    // Runs the upload stage of finished jobs and resolves their handles. Call once per frame before recording.
+    static void Tick();
+
+    // Reads a whole file, from the APK assets on Android. Requests for a file that is still referenced share the
+    // same handle.
+    static AssetHandle<std::vector<char>> LoadFileAsync(const std::string& path);
+
+    // Loads a mesh through MeshCache and uploads it, with its levels of detail, to MeshResourceRegistry
+    static AssetHandle<std::shared_ptr<IMesh>> LoadMeshAsync(const std::string& gltfPath, uint32_t meshIndex, const std::string& cachePath = "",
+                                                             const VertexLayout& layout = VertexLayout::GetStandard());
+    // Builds a mesh on a decode thread, e.g. a procedural mesh or one processed with MeshSimplifier, then uploads it
+    static AssetHandle<std::shared_ptr<IMesh>> CreateMeshAsync(std::function<std::shared_ptr<IMesh>()> build);
+
+    // Runs decode on a worker, then upload on the main thread. Either function can be empty and fails the asset by
+    // returning false.
+    template <typename T>
+    static AssetHandle<T> RunAsync(std::function<bool(T&)> decode, std::function<bool(T&)> upload = nullptr);
+
+    // A handle that is ready from the start, for assets already in memory
+    template <typename T>
+    static AssetHandle<T> MakeReady(T value);
+
+    // Blocking read used by the IO stage
+    static bool ReadFile(const std::string& path, std::vector<char>& data);
+
+    // Bytes uploaded per Tick before the remaining jobs wait for the next frame. At least one job always runs.
+    static void SetUploadBudget(uint64_t bytesPerFrame) { m_UploadBudget = bytesPerFrame; }
+
+    // Jobs submitted but not resolved yet
+    static size_t GetPendingCount();
+
+private:
+    struct Job {
+        std::function<bool()> io;
+        std::function<bool()> decode;
+        std::function<bool()> upload;
+        std::function<uint64_t()> uploadCost;  // Bytes the upload stage sends to the GPU, known after decode
+        std::function<void(bool)> resolve;
+        bool failed = false;
+    };
+
+    typedef AssetHandle<std::shared_ptr<IMesh>>::Slot MeshSlot;
+
+    // A streamed mesh stays uploaded while a handle to it exists or a renderer holds a registry reference to it
+    struct ResidentMesh {
+        std::shared_ptr<IMesh> mesh;
+        std::weak_ptr<MeshSlot> handle;      // Expires with the last handle
+        std::vector<const IMesh*> acquired;  // The mesh and its levels, each holding one registry reference
+    };
+
+    static void Submit(Job job);
+    static void IoLoop();
+    static void DecodeLoop();
+    static bool UploadMesh(const std::shared_ptr<MeshSlot>& slot);
+    static uint64_t GetMeshSize(const std::shared_ptr<IMesh>& mesh);
+    static void ReleaseUnusedMeshes(bool releaseAll);
+
+    static std::vector<std::thread> m_Threads;
+    static bool m_Running;
+    static std::mutex m_QueueMutex;
+    static std::condition_variable m_IoCondition;
+    static std::condition_variable m_DecodeCondition;
+    static std::deque<Job> m_IoQueue;
+    static std::deque<Job> m_DecodeQueue;
+    static std::deque<Job> m_UploadQueue;
+    static size_t m_PendingCount;
+    static uint64_t m_UploadBudget;
+
+    static std::unordered_map<std::string, std::weak_ptr<AssetHandle<std::vector<char>>::Slot>> m_Files;
+    static std::vector<ResidentMesh> m_ResidentMeshes;
+};
+
+template <typename T>
+AssetHandle<T> AssetLoaderMgr::RunAsync(std::function<bool(T&)> decode, std::function<bool(T&)> upload)
+{
+    std::shared_ptr<typename AssetHandle<T>::Slot> slot = std::make_shared<typename AssetHandle<T>::Slot>();
+
+    Job job;
+    if (decode)
+    {
+        job.decode = [slot, decode]() { return decode(slot->value); };
+    }
+    if (upload)
+    {
+        job.upload = [slot, upload]() { return upload(slot->value); };
+    }
+    job.resolve = [slot](bool success) { slot->status = success ? AssetStatus::READY : AssetStatus::FAILED; };
+    Submit(std::move(job));
+
+    return AssetHandle<T>(slot);
+}
+
+template <typename T>
+AssetHandle<T> AssetLoaderMgr::MakeReady(T value)
+{
+    std::shared_ptr<typename AssetHandle<T>::Slot> slot = std::make_shared<typename AssetHandle<T>::Slot>();
+    slot->value = std::move(value);
+    slot->status = AssetStatus::READY;
+    return AssetHandle<T>(slot);
+}
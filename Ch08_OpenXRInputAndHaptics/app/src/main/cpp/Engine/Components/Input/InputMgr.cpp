@@ -23,7 +23,24 @@ XrPosef InputMgr::GetHandPose(int handIndex, bool* isActive)
     return OpenXRInputMgr::handStates[handIndex].pose;
 }
 
+bool InputMgr::GetHandVelocity(int handIndex, XrVector3f& linearVelocity, XrVector3f& angularVelocity)
+{
+    linearVelocity = OpenXRInputMgr::handStates[handIndex].linearVelocity;
+    angularVelocity = OpenXRInputMgr::handStates[handIndex].angularVelocity;
+    return OpenXRInputMgr::handStates[handIndex].velocityValid;
+}
+
 void InputMgr::TriggerHapticFeedback(int handIndex, float amplitude, XrDuration duration)
 {
      OpenXRInputMgr::TriggerHapticFeedback(handIndex,amplitude,duration);
 }
+
+void InputMgr::PlayHapticPattern(int handIndex, const std::vector<HapticPulse>& pattern)
+{
+    OpenXRInputMgr::PlayHapticPattern(handIndex, pattern);
+}
+
+void InputMgr::StopHapticFeedback(int handIndex)
+{
+    OpenXRInputMgr::StopHapticFeedback(handIndex);
+}
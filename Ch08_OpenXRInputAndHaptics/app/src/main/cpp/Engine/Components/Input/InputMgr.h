@@ -1,5 +1,8 @@
 ﻿#pragma once
 #include <openxr/openxr.h>
+#include <vector>
+
+#include "../../../OpenXR/Input/HapticState.h"
 
 class InputMgr
 {
@@ -8,5 +11,8 @@ public:
     static bool GetSelect(int handIndex);      // Button held down
     static bool GetSelectUp(int handIndex);    // Button just released
     static XrPosef GetHandPose(int handIndex, bool* isActive = nullptr);
+    static bool GetHandVelocity(int handIndex, XrVector3f& linearVelocity, XrVector3f& angularVelocity);
     static void TriggerHapticFeedback(int handIndex, float amplitude = 0.5f, XrDuration duration = 100000000);
+    static void PlayHapticPattern(int handIndex, const std::vector<HapticPulse>& pattern);
+    static void StopHapticFeedback(int handIndex);
 };
@@ -2,13 +2,20 @@
 #include <GraphicsAPI.h>
 #include <xr_linear_algebra.h>
 #include <DebugOutput.h>
+#include <limits>
+#include "../../../OpenXR/OpenXRAttachmentMgr.h"
 #include "../../../OpenXR/OpenXRCoreMgr.h"
 #include "../../../OpenXR/OpenXRDisplayMgr.h"
+#include "../../../OpenXR/OpenXRFoveationMgr.h"
+#include "../../../OpenXR/OpenXRFrameTimingMgr.h"
 #include "../../../OpenXR/OpenXRRenderMgr.h"
+#include "../../../OpenXR/OpenXRResolutionMgr.h"
 #include "../../../OpenXR/OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
 #include "../../Core/Scene.h"
 #include "../../Core/GameObject.h"
 #include "../Core/Transform.h"
+#include "../../Diagnostics/TraceLogMgr.h"
+#include "../../Rendering/DrawListRecorder.h"
 
 GraphicsAPI_Type Camera::s_globalApiType = UNKNOWN;
 
@@ -35,6 +42,13 @@ void Camera::SetProjectionParameters(float nearPlane, float farPlane)
     m_ViewProjectionDirty = true;
 }
 
+void Camera::SetReversedZ(bool reversedZ)
+{
+    m_ReversedZ = reversedZ;
+    m_ProjectionDirty = true;
+    m_ViewProjectionDirty = true;
+}
+
 void Camera::SetViewMatrix(const XrMatrix4x4f& viewMatrix)
 {
     m_ViewProjectionDirty = true;
@@ -59,8 +73,9 @@ void Camera::SetupForOpenXR(int viewIndex, void* colorImage, void* depthImage, G
     
     m_RenderSettings.colorImage = colorImage;
     m_RenderSettings.depthImage = depthImage;
-    m_RenderSettings.width = OpenXRDisplayMgr::activeViewConfigurationViews[viewIndex].recommendedImageRectWidth;
-    m_RenderSettings.height = OpenXRDisplayMgr::activeViewConfigurationViews[viewIndex].recommendedImageRectHeight;
+    const XrExtent2Di extent = OpenXRResolutionMgr::GetViewExtent(viewIndex);
+    m_RenderSettings.width = static_cast<uint32_t>(extent.width);
+    m_RenderSettings.height = static_cast<uint32_t>(extent.height);
     m_RenderSettings.blendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
     m_RenderSettings.clearColor = {0.17f, 0.17f, 0.17f, 1.0f};
     m_RenderSettings.pipeline = nullptr;
@@ -118,8 +133,6 @@ void Camera::PreTick(float deltaTime) {
             m_CurrentViewIndex = currentViewIndex;
             m_ApiType = s_globalApiType;
             
-            m_RenderSettings.width = OpenXRDisplayMgr::activeViewConfigurationViews[currentViewIndex].recommendedImageRectWidth;
-            m_RenderSettings.height = OpenXRDisplayMgr::activeViewConfigurationViews[currentViewIndex].recommendedImageRectHeight;
             m_RenderSettings.blendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
             m_RenderSettings.clearColor = {0.17f, 0.17f, 0.17f, 1.0f};
             m_RenderSettings.pipeline = nullptr;
@@ -127,7 +140,27 @@ void Camera::PreTick(float deltaTime) {
             m_NeedsMatrixUpdate = true;
         }
         
-        OpenXRDisplayMgr::AcquireAndWaitSwapChainImages(currentViewIndex, m_RenderSettings.colorImage, m_RenderSettings.depthImage);
+        // The dynamic resolution scale can change between frames, so the rendered region is refreshed every time
+        const XrExtent2Di extent = OpenXRResolutionMgr::GetViewExtent(currentViewIndex);
+        m_RenderSettings.width = static_cast<uint32_t>(extent.width);
+        m_RenderSettings.height = static_cast<uint32_t>(extent.height);
+
+        // When acquiring is deferred, the view is recorded first and the compositor is only waited on before submitting it
+        if (OpenXRDisplayMgr::IsAcquireDeferred()) {
+            OpenXRDisplayMgr::GetDeferredRenderTargets(currentViewIndex, m_RenderSettings.colorImage, m_RenderSettings.depthImage);
+        } else {
+            OpenXRDisplayMgr::AcquireAndWaitSwapChainImages(currentViewIndex, m_RenderSettings.colorImage, m_RenderSettings.depthImage);
+        }
+        // Transient attachments stand in for the swapchain ones, and multisampled color resolves into the swapchain image
+        m_RenderSettings.resolveImage = nullptr;
+        if (void* colorAttachment = OpenXRAttachmentMgr::GetColorAttachment(currentViewIndex)) {
+            m_RenderSettings.resolveImage = m_RenderSettings.colorImage;
+            m_RenderSettings.colorImage = colorAttachment;
+        }
+        if (void* depthAttachment = OpenXRAttachmentMgr::GetDepthAttachment(currentViewIndex)) {
+            m_RenderSettings.depthImage = depthAttachment;
+        }
+        SubmitDepthRange();
         
         if (m_NeedsMatrixUpdate) {
             UpdateMatricesFromOpenXR();
@@ -136,21 +169,43 @@ void Camera::PreTick(float deltaTime) {
     }
     
     OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->BeginRendering();
+    if (m_RenderSettings.resolveImage) {
+        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->SetResolveAttachments(&m_RenderSettings.resolveImage, 1);
+    }
+    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->BeginGpuScope(("View " + std::to_string(m_CurrentViewIndex)).c_str());
+    if (m_CurrentViewIndex >= 0 && !OpenXRDisplayMgr::IsAcquireDeferred()) {
+        OpenXRFoveationMgr::BindViewDensityMap(m_CurrentViewIndex);
+    }
     SetupRenderTarget();
+    DrawListRecorder::BeginView();
 }
 
 void Camera::PostTick(float deltaTime) {
+    DrawListRecorder::EndView();
+    OpenXRFrameTimingMgr::BeginStage(FrameStage::SUBMIT);
+    if (m_CurrentViewIndex >= 0 && OpenXRDisplayMgr::IsAcquireDeferred()) {
+        OpenXRDisplayMgr::AcquireAndBindDeferredRenderTargets(m_CurrentViewIndex);
+        // The runtime's density map belongs to the acquired image, so it's only known now
+        OpenXRFoveationMgr::BindViewDensityMap(m_CurrentViewIndex);
+        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->ResolveDeferredRenderTargets();
+    }
+    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->EndGpuScope();
     OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->EndRendering();
+    if (m_RenderSettings.resolveImage) {
+        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->SetResolveAttachments(nullptr, 0);
+    }
     
     if (m_CurrentViewIndex >= 0) {
         OpenXRDisplayMgr::ReleaseSwapChainImages(m_CurrentViewIndex);
     }
+    OpenXRFrameTimingMgr::EndStage(FrameStage::SUBMIT);
 }
 
 void Camera::SetupRenderTarget()
 {
     if (m_RenderSettings.colorImage && m_RenderSettings.width > 0 && m_RenderSettings.height > 0)
     {
+        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->BeginGpuScope("Clear");
         if (m_RenderSettings.blendMode == XR_ENVIRONMENT_BLEND_MODE_OPAQUE)
         {
             OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->ClearColor(
@@ -161,18 +216,46 @@ void Camera::SetupRenderTarget()
                 m_RenderSettings.clearColor.w
             );
         }
+        else if (m_RenderSettings.resolveImage)
+        {
+            // The multisampled image starts out undefined, so it can't keep the swapchain contents
+            OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->ClearColor(m_RenderSettings.colorImage, 0.0f, 0.0f, 0.0f, 0.0f);
+        }
         
-        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->ClearDepth(m_RenderSettings.depthImage, 1.0f);
+        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->ClearDepth(m_RenderSettings.depthImage, m_ReversedZ ? 0.0f : 1.0f);
+        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->EndGpuScope();
     }
     else
     {
-        XR_TUT_LOG_ERROR("Camera::SetupRenderTarget() - Invalid render settings: colorImage=" << m_RenderSettings.colorImage << ", width=" << m_RenderSettings.width << ", height=" << m_RenderSettings.height);
+        XR_TRACE_ERROR("Camera::SetupRenderTarget() - Invalid render settings: colorImage={}, width={}, height={}", m_RenderSettings.colorImage, m_RenderSettings.width, m_RenderSettings.height);
     }
 }
 
 void Camera::UpdateProjectionMatrix()
 {
     XrMatrix4x4f_CreateProjectionFov(&m_ProjectionMatrix, m_ApiType, m_FieldOfView, m_NearPlane, m_FarPlane);
+
+    if (m_ReversedZ) {
+        // z' = w - z turns the [0, 1] depth d into 1 - d. A [-1, 1] clip space would need clip control instead.
+        if (m_ApiType == OPENGL || m_ApiType == OPENGL_ES) {
+            XR_TUT_LOG_ERROR("Camera::UpdateProjectionMatrix() - Reversed Z isn't supported with OpenGL");
+            return;
+        }
+        for (int column = 0; column < 4; ++column) {
+            m_ProjectionMatrix.m[column * 4 + 2] = m_ProjectionMatrix.m[column * 4 + 3] - m_ProjectionMatrix.m[column * 4 + 2];
+        }
+    }
+}
+
+void Camera::SubmitDepthRange() const
+{
+    // A far plane at or in front of the near one is the infinite projection
+    const float farZ = m_FarPlane > m_NearPlane ? m_FarPlane : std::numeric_limits<float>::infinity();
+    if (m_ReversedZ) {
+        OpenXRRenderMgr::SetDepthRange(farZ, m_NearPlane);
+    } else {
+        OpenXRRenderMgr::SetDepthRange(m_NearPlane, farZ);
+    }
 }
 
 void Camera::UpdateViewProjectionMatrix()
@@ -14,6 +14,9 @@ public:
     
     void SetFieldOfView(const XrFovf& fov);
     void SetProjectionParameters(float nearPlane, float farPlane);
+    // Maps the near plane to depth 1 and the far plane to depth 0, which spreads the float depth precision
+    // far more evenly over the distance. Set it before the first frame, pipelines are built for one or the other.
+    void SetReversedZ(bool reversedZ);
     void SetViewMatrix(const XrMatrix4x4f& viewMatrix);
     void SetProjectionMatrix(const XrMatrix4x4f& projMatrix);
     void SetRenderSettings(const RenderSettings& settings);
@@ -27,6 +30,11 @@ public:
     const XrMatrix4x4f& GetProjectionMatrix();
     const XrMatrix4x4f& GetViewProjectionMatrix();
     const RenderSettings& GetRenderSettings() const { return m_RenderSettings; }
+    const XrFovf& GetFieldOfView() const { return m_FieldOfView; }
+    float GetNearPlane() const { return m_NearPlane; }
+    float GetFarPlane() const { return m_FarPlane; }
+    bool IsReversedZ() const { return m_ReversedZ; }
+    int GetCurrentViewIndex() const { return m_CurrentViewIndex; }
     
     void PreTick(float deltaTime) override;
     void PostTick(float deltaTime) override;
@@ -35,6 +43,7 @@ private:
     XrFovf m_FieldOfView = {-1.0f, 1.0f, 1.0f, -1.0f};
     float m_NearPlane = 0.05f;
     float m_FarPlane = 1000.0f;
+    bool m_ReversedZ = false;
     
     XrMatrix4x4f m_ProjectionMatrix;
     XrMatrix4x4f m_ViewProjectionMatrix;
@@ -48,6 +57,7 @@ private:
     static GraphicsAPI_Type s_globalApiType;
     
     void SetupRenderTarget();
+    void SubmitDepthRange() const;
     void UpdateProjectionMatrix();
     void UpdateViewProjectionMatrix();
     void UpdateMatricesFromOpenXR();
@@ -0,0 +1,67 @@
+﻿#include "CompositionLayerPanel.h"
+#include "../../Core/GameObject.h"
+#include "../Core/Transform.h"
+
+CompositionLayerPanel::CompositionLayerPanel(const CompositionLayerCreateInfo& createInfo)
+    : m_CreateInfo(createInfo)
+{
+}
+
+CompositionLayerPanel::~CompositionLayerPanel()
+{
+    Destroy();
+}
+
+void CompositionLayerPanel::Initialize()
+{
+    m_Layer = OpenXRCompositionLayerMgr::CreateLayer(m_CreateInfo);
+}
+
+void CompositionLayerPanel::Simulate(float deltaTime)
+{
+    if (m_Layer == INVALID_COMPOSITION_LAYER) {
+        return;
+    }
+
+    // Only the pose is refreshed every frame, it doesn't touch the content
+    Transform* transform = GetGameObject()->GetComponent<Transform>();
+    if (transform) {
+        OpenXRCompositionLayerMgr::SetPose(m_Layer, {transform->GetRotation(), transform->GetPosition()});
+    }
+}
+
+void CompositionLayerPanel::Destroy()
+{
+    if (m_Layer != INVALID_COMPOSITION_LAYER) {
+        OpenXRCompositionLayerMgr::DestroyLayer(m_Layer);
+        m_Layer = INVALID_COMPOSITION_LAYER;
+    }
+}
+
+void CompositionLayerPanel::SetVisible(bool visible)
+{
+    if (m_Layer != INVALID_COMPOSITION_LAYER) {
+        OpenXRCompositionLayerMgr::SetVisible(m_Layer, visible);
+    }
+}
+
+void CompositionLayerPanel::SetClearColor(const XrColor4f& clearColor)
+{
+    if (m_Layer != INVALID_COMPOSITION_LAYER) {
+        OpenXRCompositionLayerMgr::SetClearColor(m_Layer, clearColor);
+    }
+}
+
+void CompositionLayerPanel::SetContentRenderer(OpenXRCompositionLayerMgr::ContentRenderer contentRenderer)
+{
+    if (m_Layer != INVALID_COMPOSITION_LAYER) {
+        OpenXRCompositionLayerMgr::SetContentRenderer(m_Layer, std::move(contentRenderer));
+    }
+}
+
+void CompositionLayerPanel::Invalidate()
+{
+    if (m_Layer != INVALID_COMPOSITION_LAYER) {
+        OpenXRCompositionLayerMgr::MarkDirty(m_Layer);
+    }
+}
@@ -0,0 +1,29 @@
+﻿#pragma once
+
+#include "../../Core/IComponent.h"
+#include "../../../OpenXR/OpenXRCompositionLayerMgr.h"
+#include <openxr/openxr.h>
+
+// Shows a panel as its own composition layer, placed at the game object's Transform. The content is rendered
+// once and then again only after Invalidate, the compositor takes care of presenting it every frame.
+class CompositionLayerPanel : public IComponent {
+public:
+    explicit CompositionLayerPanel(const CompositionLayerCreateInfo& createInfo = CompositionLayerCreateInfo());
+    ~CompositionLayerPanel() override;
+
+    void Initialize() override;
+    void Simulate(float deltaTime) override;
+    void Destroy() override;
+
+    void SetVisible(bool visible);
+    void SetClearColor(const XrColor4f& clearColor);
+    void SetContentRenderer(OpenXRCompositionLayerMgr::ContentRenderer contentRenderer);
+    // Call when what the content renderer draws has changed
+    void Invalidate();
+
+    CompositionLayerHandle GetLayer() const { return m_Layer; }
+
+private:
+    CompositionLayerCreateInfo m_CreateInfo;
+    CompositionLayerHandle m_Layer = INVALID_COMPOSITION_LAYER;
+};
\ No newline at end of file
@@ -1,64 +1,118 @@
 #include "Material.h"
 #include <DebugOutput.h>
-#include <fstream>
+#include <algorithm>
 #include <vector>
+#include "../../../OpenXR/OpenXRAttachmentMgr.h"
 #include "../../../OpenXR/OpenXRCoreMgr.h"
 #include "../../../OpenXR/OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
 #include "../../../OpenXR/OpenXRDisplayMgr.h"
+#include "../../../OpenXR/OpenXRFoveationMgr.h"
 #include "Camera.h"
 #include "../../Core/Scene.h"
 #include "../../Core/GameObject.h"
-#include "../../Rendering/Vertex.h"
-
-#if defined(__ANDROID__)
-#include <android/asset_manager.h>
-#include "../../../Application/OpenXRTutorial.h"
-#endif
 
 Material::Material(const std::string& vertShaderFile, const std::string& fragShaderFile, GraphicsAPI_Type apiType)
     : m_VertShaderFile(vertShaderFile), m_FragShaderFile(fragShaderFile), m_ApiType(apiType)
 {
 }
 
-Material::~Material()
-{
-    if (m_VertexShader) OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyShader(m_VertexShader);
-    if (m_FragmentShader) OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyShader(m_FragmentShader);
-}
+Material::~Material() = default;
 
 void Material::Initialize() {
+    LoadShaders();
+}
+
+void Material::SetFeatures(ShaderVariantKey features) {
+    if (features == m_Features) {
+        return;
+    }
+    const bool keywordsChanged = ShaderVariant::GetKeywordKey(features) != ShaderVariant::GetKeywordKey(m_Features);
+    m_Features = features;
+    m_Pipelines.clear();
+
+    // Pipelines stay in PipelineCache, so dropping the old modules doesn't affect frames still in flight
+    if (keywordsChanged && (m_VertexShader || m_VertShaderSource.IsValid())) {
+        m_VertexShader.reset();
+        m_FragmentShader.reset();
+        LoadShaders();
+    }
+}
+
+void Material::LoadShaders() {
     if (m_ApiType == VULKAN) {
-        m_VertexShader = CreateShaderFromFile(m_VertShaderFile, GraphicsAPI::ShaderCreateInfo::Type::VERTEX);
-        m_FragmentShader = CreateShaderFromFile(m_FragShaderFile, GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT);
+        // Materials using the same shaders share one read and one module per shader
+        m_VertShaderSource = ShaderLibrary::LoadAsync(GetShaderPath(ShaderVariant::GetShaderFile(m_VertShaderFile, m_Features)));
+        m_FragShaderSource = ShaderLibrary::LoadAsync(GetShaderPath(ShaderVariant::GetShaderFile(m_FragShaderFile, m_Features)));
     }
 }
 
-void Material::Destroy() {
-    if (m_VertexShader) {
-        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyShader(m_VertexShader);
-        m_VertexShader = nullptr;
+bool Material::IsReady() {
+    if (m_VertexShader && m_FragmentShader) {
+        return true;
     }
-    if (m_FragmentShader) {
-        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyShader(m_FragmentShader);
-        m_FragmentShader = nullptr;
+    if (!m_VertShaderSource.IsValid() || !m_FragShaderSource.IsValid()) {
+        return false;
     }
-    if (m_Pipeline) {
-        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyPipeline(m_Pipeline);
-        m_Pipeline = nullptr;
+    if (!m_VertShaderSource.IsReady() || !m_FragShaderSource.IsReady()) {
+        if (m_VertShaderSource.GetStatus() == AssetStatus::FAILED || m_FragShaderSource.GetStatus() == AssetStatus::FAILED) {
+            XR_TUT_LOG_ERROR("Material::IsReady() - Failed to load " << m_VertShaderFile << " or " << m_FragShaderFile);
+            m_VertShaderSource.Reset();
+            m_FragShaderSource.Reset();
+        }
+        return false;
     }
-}
 
-void* Material::GetOrCreatePipeline() {
-    if (m_Pipeline) {
-        return m_Pipeline;
+    m_VertexShader = m_VertShaderSource.Get();
+    m_FragmentShader = m_FragShaderSource.Get();
+    m_VertShaderSource.Reset();
+    m_FragShaderSource.Reset();
+    if (m_VertexShader->reflection.stage != GraphicsAPI::ShaderCreateInfo::Type::VERTEX || m_FragmentShader->reflection.stage != GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT) {
+        XR_TUT_LOG_ERROR("Material::IsReady() - " << m_VertShaderFile << " or " << m_FragShaderFile << " is not of the expected stage");
+        m_VertexShader.reset();
+        m_FragmentShader.reset();
     }
-    
-    if (!m_VertexShader || !m_FragmentShader) {
+    return m_VertexShader && m_FragmentShader;
+}
+
+void Material::Destroy() {
+    // ShaderLibrary destroys the modules once no material uses them
+    m_VertexShader.reset();
+    m_FragmentShader.reset();
+    m_Pipelines.clear();
+    m_VertShaderSource.Reset();
+    m_FragShaderSource.Reset();
+}
+
+void* Material::GetOrCreatePipeline(const VertexLayout& vertexLayout) {
+    if (!IsReady()) {
         return nullptr;
     }
-    
-    m_Pipeline = CreatePipeline();
-    return m_Pipeline;
+
+    // Foveation and the camera's depth convention can change at runtime, so they are part of the lookup too
+    PipelineKey key;
+    key.vertexShaderHash = m_VertexShader->hash;
+    key.fragmentShaderHash = m_FragmentShader->hash;
+    key.variant = m_Features;
+    key.vertexLayout = vertexLayout;
+    key.fragmentDensityMap = OpenXRFoveationMgr::IsActive();
+    Camera* activeCamera = Scene::GetActiveCamera();
+    key.reversedZ = activeCamera && activeCamera->IsReversedZ();
+    for (const auto& keyPipeline : m_Pipelines) {
+        if (keyPipeline.first == key) {
+            return keyPipeline.second;
+        }
+    }
+
+    void* pipeline = PipelineCache::Find(key);
+    if (!pipeline) {
+        pipeline = CreatePipeline(key);
+        if (!pipeline) {
+            return nullptr;
+        }
+        PipelineCache::Add(key, pipeline);
+    }
+    m_Pipelines.emplace_back(key, pipeline);
+    return pipeline;
 }
 
 Camera* Material::GetActiveCamera() {
@@ -69,21 +123,35 @@ Camera* Material::GetActiveCamera() {
     return activeCamera;
 }
 
-void* Material::CreatePipeline() {
-    Camera* activeCamera = GetActiveCamera();
-    if (!activeCamera) {
+void* Material::CreatePipeline(const PipelineKey& key) {
+    if (!GetActiveCamera()) {
         XR_TUT_LOG_ERROR("Material::CreatePipeline() - No active camera found, using default settings");
     }
     
+    const VertexLayout& vertexLayout = key.vertexLayout;
     GraphicsAPI::PipelineCreateInfo pipelineCreateInfo;
-    pipelineCreateInfo.shaders = {m_VertexShader, m_FragmentShader};
-
-    pipelineCreateInfo.vertexInputState.attributes.resize(2);
-    pipelineCreateInfo.vertexInputState.attributes[0] = {0, 0, GraphicsAPI::VertexType::VEC4, 0, "POSITION"};
-    pipelineCreateInfo.vertexInputState.attributes[1] = {1, 0, GraphicsAPI::VertexType::VEC3, sizeof(XrVector4f), "NORMAL"};
+    pipelineCreateInfo.shaders = {m_VertexShader->module, m_FragmentShader->module};
+
+    // The semantic doubles as the shader input location; packed types are expanded to float by the input stage.
+    // Streams the vertex shader doesn't read are left out, inputs the layout lacks can't be drawn.
+    static const char* const semanticNames[] = {"POSITION", "NORMAL", "TEXCOORD"};
+    const std::vector<uint32_t>& inputLocations = m_VertexShader->reflection.inputLocations;
+    for (uint32_t location : inputLocations) {
+        if (!vertexLayout.Find(static_cast<VertexSemantic>(location))) {
+            XR_TUT_LOG_ERROR("Material::CreatePipeline() - " << m_VertShaderFile << " reads location " << location << ", which the vertex layout lacks");
+            return nullptr;
+        }
+    }
+    for (const VertexAttributeStream& stream : vertexLayout.attributes) {
+        const uint32_t location = static_cast<uint32_t>(stream.semantic);
+        if (std::find(inputLocations.begin(), inputLocations.end(), location) == inputLocations.end()) {
+            continue;
+        }
+        pipelineCreateInfo.vertexInputState.attributes.push_back({location, 0, stream.type, stream.offset, semanticNames[location]});
+    }
     
     pipelineCreateInfo.vertexInputState.bindings.resize(1);
-    pipelineCreateInfo.vertexInputState.bindings[0] = {0, 0, sizeof(Vertex)};
+    pipelineCreateInfo.vertexInputState.bindings[0] = {0, 0, vertexLayout.stride};
 
     pipelineCreateInfo.inputAssemblyState.topology = GraphicsAPI::PrimitiveTopology::TRIANGLE_LIST;
     pipelineCreateInfo.inputAssemblyState.primitiveRestartEnable = false;
@@ -96,14 +164,14 @@ void* Material::CreatePipeline() {
     pipelineCreateInfo.rasterisationState.depthBiasEnable = false;
     pipelineCreateInfo.rasterisationState.lineWidth = 1.0f;
 
-    pipelineCreateInfo.multisampleState.rasterisationSamples = 1;
+    pipelineCreateInfo.multisampleState.rasterisationSamples = OpenXRAttachmentMgr::GetSampleCount();
     pipelineCreateInfo.multisampleState.sampleShadingEnable = false;
     pipelineCreateInfo.multisampleState.minSampleShading = 1.0f;
     pipelineCreateInfo.multisampleState.sampleMask = 0xFFFFFFFF;
 
     pipelineCreateInfo.depthStencilState.depthTestEnable = true;
     pipelineCreateInfo.depthStencilState.depthWriteEnable = true;
-    pipelineCreateInfo.depthStencilState.depthCompareOp = GraphicsAPI::CompareOp::LESS_OR_EQUAL;
+    pipelineCreateInfo.depthStencilState.depthCompareOp = key.reversedZ ? GraphicsAPI::CompareOp::GREATER_OR_EQUAL : GraphicsAPI::CompareOp::LESS_OR_EQUAL;
     pipelineCreateInfo.depthStencilState.depthBoundsTestEnable = false;
     pipelineCreateInfo.depthStencilState.stencilTestEnable = false;
 
@@ -118,111 +186,25 @@ void* Material::CreatePipeline() {
     );
     pipelineCreateInfo.colorBlendState.attachments[0].blendEnable = false;
 
-    pipelineCreateInfo.layout.resize(2);
-    
-    pipelineCreateInfo.layout[0].bindingIndex = 0;
-    pipelineCreateInfo.layout[0].resource = nullptr;
-    pipelineCreateInfo.layout[0].type = GraphicsAPI::DescriptorInfo::Type::BUFFER;
-    pipelineCreateInfo.layout[0].stage = GraphicsAPI::DescriptorInfo::Stage::VERTEX;
-    
-    pipelineCreateInfo.layout[1].bindingIndex = 1;
-    pipelineCreateInfo.layout[1].resource = nullptr;
-    pipelineCreateInfo.layout[1].type = GraphicsAPI::DescriptorInfo::Type::BUFFER;
-    pipelineCreateInfo.layout[1].stage = GraphicsAPI::DescriptorInfo::Stage::FRAGMENT;
+    // Descriptor bindings come from the shaders themselves
+    pipelineCreateInfo.layout = ShaderLibrary::BuildPipelineLayout({m_VertexShader.get(), m_FragmentShader.get()});
+    pipelineCreateInfo.specializationConstants = ShaderVariant::GetSpecializationConstants(m_Features);
 
     pipelineCreateInfo.colorFormats = {OpenXRDisplayMgr::colorSwapchainInfos[0].swapchainFormat};
-    pipelineCreateInfo.depthFormat = OpenXRDisplayMgr::depthSwapchainInfos[0].swapchainFormat;
+    pipelineCreateInfo.depthFormat = OpenXRAttachmentMgr::GetDepthFormat();
+    pipelineCreateInfo.transientDepth = OpenXRAttachmentMgr::IsDepthTransient();
+    pipelineCreateInfo.fragmentDensityMap = key.fragmentDensityMap;
 
     void* pipeline = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->CreatePipeline(pipelineCreateInfo);
     return pipeline;
 }
 
 
-void* Material::CreateShaderFromFile(const std::string& filename, GraphicsAPI::ShaderCreateInfo::Type type)
+std::string Material::GetShaderPath(const std::string& filename) const
 {
 #if defined(__ANDROID__)
-    return LoadShaderFromAndroidAssets(filename, type);
+    return "shaders/" + filename;
 #else
-    return LoadShaderFromFileSystem(filename, type);
+    return filename;
 #endif
 }
-
-#if defined(__ANDROID__)
-void* Material::LoadShaderFromAndroidAssets(const std::string& filename, GraphicsAPI::ShaderCreateInfo::Type type)
-{
-    std::string shaderPath = "shaders/" + filename;
-
-    if (OpenXRTutorial::androidApp == nullptr || OpenXRTutorial::androidApp->activity == nullptr || OpenXRTutorial::androidApp->activity->assetManager == nullptr)
-    {
-        XR_TUT_LOG_ERROR("Android asset manager not available");
-        return nullptr;
-    }
-
-    AAsset* asset = AAssetManager_open(OpenXRTutorial::androidApp->activity->assetManager, shaderPath.c_str(), AASSET_MODE_BUFFER);
-    if (!asset)
-    {
-        XR_TUT_LOG_ERROR("Failed to open Android asset: " << shaderPath);
-        return nullptr;
-    }
-
-    const size_t length = AAsset_getLength(asset);
-    if (length == 0)
-    {
-        XR_TUT_LOG_ERROR("Android asset is empty: " << shaderPath);
-        AAsset_close(asset);
-        return nullptr;
-    }
-
-    std::vector<char> buffer(length);
-    int bytesRead = AAsset_read(asset, buffer.data(), length);
-    AAsset_close(asset);
-
-    return CreateShaderFromBuffer(buffer, type, shaderPath);
-}
-#endif
-
-void* Material::LoadShaderFromFileSystem(const std::string& filename, GraphicsAPI::ShaderCreateInfo::Type type)
-{
-    std::string shaderPath = filename;
-
-    std::ifstream file(shaderPath, std::ios::ate | std::ios::binary);
-    if (!file.is_open())
-    {
-        XR_TUT_LOG_ERROR("Failed to open shader file: " << shaderPath);
-        return nullptr;
-    }
-
-    size_t fileSize = file.tellg();
-
-    std::vector<char> buffer(fileSize);
-    file.seekg(0);
-    file.read(buffer.data(), static_cast<std::streamsize>(fileSize));
-    file.close();
-
-    if (!file.good() && !file.eof())
-    {
-        XR_TUT_LOG_ERROR("Failed to read complete shader file: " << shaderPath);
-        return nullptr;
-    }
-
-    return CreateShaderFromBuffer(buffer, type, shaderPath);
-}
-
-void* Material::CreateShaderFromBuffer(const std::vector<char>& buffer,
-                                       GraphicsAPI::ShaderCreateInfo::Type type,
-                                       const std::string& shaderPath)
-{
-    GraphicsAPI::ShaderCreateInfo shaderCreateInfo;
-    shaderCreateInfo.type = type;
-    shaderCreateInfo.sourceSize = buffer.size();
-    shaderCreateInfo.sourceData = buffer.data();
-
-    void* shader = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->CreateShader(shaderCreateInfo);
-    if (!shader)
-    {
-        XR_TUT_LOG_ERROR("Failed to create shader from buffer: " << shaderPath);
-        return nullptr;
-    }
-
-    return shader;
-}
\ No newline at end of file
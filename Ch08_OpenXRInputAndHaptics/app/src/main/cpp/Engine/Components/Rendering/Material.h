@@ -1,7 +1,14 @@
 #pragma once
 
 #include "../../Core/IComponent.h"
+#include "../../Assets/AssetHandle.h"
+#include "../../Rendering/VertexLayout.h"
+#include "../../Rendering/Shader/PipelineCache.h"
+#include "../../Rendering/Shader/ShaderLibrary.h"
+#include "../../Rendering/Shader/ShaderVariant.h"
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <GraphicsAPI.h>
 #include <openxr/openxr.h>
@@ -13,8 +20,8 @@ public:
     Material(const std::string& vertShaderFile, const std::string& fragShaderFile, GraphicsAPI_Type apiType);
     ~Material() override;
     
-    void* GetVertexShader() const { return m_VertexShader; }
-    void* GetFragmentShader() const { return m_FragmentShader; }
+    void* GetVertexShader() const { return m_VertexShader ? m_VertexShader->module : nullptr; }
+    void* GetFragmentShader() const { return m_FragmentShader ? m_FragmentShader->module : nullptr; }
     
     void SetColor(const XrVector4f& color) { m_Color = color; }
     const XrVector4f& GetColor() const { return m_Color; }
@@ -22,28 +29,37 @@ public:
         m_Color = {r, g, b, a}; 
     }
     
-    void* GetOrCreatePipeline();
+    // Changing keyword features streams in other shader files, the material isn't ready until they arrive.
+    // Specialization constant features only switch pipelines.
+    void SetFeatures(ShaderVariantKey features);
+    ShaderVariantKey GetFeatures() const { return m_Features; }
+
+    // Pipelines are created per vertex layout, depth convention and foveation state, so one material can draw both
+    // float and packed meshes. They are shared through PipelineCache with every material using the same shaders
+    // and features.
+    void* GetOrCreatePipeline(const VertexLayout& vertexLayout);
+
+    // Shaders are streamed in through ShaderLibrary; objects using the material are skipped until they are created
+    bool IsReady();
     
     void Initialize() override;
     void Destroy() override;
     
 private:
-    void* m_VertexShader = nullptr;
-    void* m_FragmentShader = nullptr;
-    void* m_Pipeline = nullptr;
+    std::shared_ptr<const ShaderModule> m_VertexShader;
+    std::shared_ptr<const ShaderModule> m_FragmentShader;
+    std::vector<std::pair<PipelineKey, void*>> m_Pipelines;  // Owned by PipelineCache
+    ShaderVariantKey m_Features = 0;
     std::string m_VertShaderFile;
     std::string m_FragShaderFile;
     GraphicsAPI_Type m_ApiType;
     XrVector4f m_Color = {1.0f, 1.0f, 1.0f, 1.0f};
+    AssetHandle<std::shared_ptr<const ShaderModule>> m_VertShaderSource;
+    AssetHandle<std::shared_ptr<const ShaderModule>> m_FragShaderSource;
     
-    void* CreateShaderFromFile(const std::string& filename, GraphicsAPI::ShaderCreateInfo::Type type);
-#if defined(__ANDROID__)
-    void* LoadShaderFromAndroidAssets(const std::string& filename, GraphicsAPI::ShaderCreateInfo::Type type);
-#endif
-    
-    void* LoadShaderFromFileSystem(const std::string& filename, GraphicsAPI::ShaderCreateInfo::Type type);
-    void* CreateShaderFromBuffer(const std::vector<char>& buffer, GraphicsAPI::ShaderCreateInfo::Type type, const std::string& shaderPath);
-    void* CreatePipeline();
+    void LoadShaders();
+    std::string GetShaderPath(const std::string& filename) const;
+    void* CreatePipeline(const PipelineKey& key);
     
     Camera* GetActiveCamera();
 };
@@ -7,8 +7,11 @@
 #include "../../../OpenXR/OpenXRCoreMgr.h"
 #include "../../../OpenXR/OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
 #include "Material.h"
-#include "../../Rendering/Vertex.h"
-#include <DebugOutput.h>
+#include "../../Diagnostics/TraceLogMgr.h"
+#include "../../Rendering/DrawListRecorder.h"
+#include "../../Rendering/Mesh/LodSelector.h"
+#include <algorithm>
+#include <cmath>
 
 #include "ObjectRenderData.h"
 
@@ -19,14 +22,24 @@ MeshRenderer::~MeshRenderer()
 
 void MeshRenderer::SetMesh(std::shared_ptr<IMesh> mesh)
 {
-    m_Mesh = mesh;
+    // Release before replacing the mesh, the registry entries are keyed by the old mesh and its levels
     if (m_BuffersCreated)
     {
         DestroyBuffers();
     }
+    m_Mesh = mesh;
     CreateBuffers();
 }
 
+void MeshRenderer::SetMeshAsync(const AssetHandle<std::shared_ptr<IMesh>>& mesh, std::shared_ptr<IMesh> placeholder)
+{
+    m_PendingMesh = mesh;
+    if (placeholder)
+    {
+        SetMesh(placeholder);
+    }
+}
+
 void MeshRenderer::Initialize()
 {
     if (m_Mesh)
@@ -35,6 +48,23 @@ void MeshRenderer::Initialize()
     }
 }
 
+void MeshRenderer::Simulate(float deltaTime)
+{
+    // Swapped once per frame, so every view draws the same mesh
+    if (m_PendingMesh.IsValid() && !m_PendingMesh.IsLoading())
+    {
+        if (m_PendingMesh.IsReady())
+        {
+            SetMesh(m_PendingMesh.Get());
+        }
+        else
+        {
+            XR_TRACE_ERROR("MeshRenderer::Tick() - Streamed mesh failed to load, keeping the placeholder");
+        }
+        m_PendingMesh.Reset();
+    }
+}
+
 void MeshRenderer::Tick(float deltaTime)
 {
     if (m_Mesh && m_BuffersCreated)
@@ -48,30 +78,61 @@ void MeshRenderer::Destroy()
     DestroyBuffers();
 }
 
+size_t MeshRenderer::GetCurrentLod(int viewIndex) const
+{
+    return viewIndex >= 0 && static_cast<size_t>(viewIndex) < m_ViewLods.size() ? m_ViewLods[viewIndex] : 0;
+}
+
 void MeshRenderer::CreateBuffers()
 {
     if (!m_Mesh) return;
 
-    const auto& verticesWithNormals = m_Mesh->GetVerticesWithNormals();
-    const auto& indices = m_Mesh->GetIndices();
-
-    GraphicsAPI::BufferCreateInfo vertexBufferInfo;
-    vertexBufferInfo.type = GraphicsAPI::BufferCreateInfo::Type::VERTEX;
-    vertexBufferInfo.stride = sizeof(Vertex);
-    vertexBufferInfo.size = verticesWithNormals.size() * sizeof(Vertex);
-    vertexBufferInfo.data = const_cast<void*>(static_cast<const void*>(verticesWithNormals.data()));
-    m_VertexBuffer = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->CreateBuffer(vertexBufferInfo);
+    // Renderers sharing a mesh share its buffers, the registry uploads each mesh once
+    m_LodBuffers.push_back({m_Mesh.get(), MeshResourceRegistry::Acquire(*m_Mesh)});
+    for (const MeshLod& lod : m_Mesh->GetLods())
+    {
+        m_LodBuffers.push_back({lod.mesh.get(), MeshResourceRegistry::Acquire(*lod.mesh)});
+    }
+    m_ViewLods.clear();
 
-    GraphicsAPI::BufferCreateInfo indexBufferInfo;
-    indexBufferInfo.type = GraphicsAPI::BufferCreateInfo::Type::INDEX;
-    indexBufferInfo.stride = sizeof(uint32_t);
-    indexBufferInfo.size = indices.size() * sizeof(uint32_t);
-    indexBufferInfo.data = const_cast<void*>(static_cast<const void*>(indices.data()));
-    m_IndexBuffer = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->CreateBuffer(indexBufferInfo);
+    // Bounding sphere around the box of the full detail mesh; the coarser levels only collapse onto its vertices
+    const std::vector<Vertex>& vertices = m_Mesh->GetVerticesWithNormals();
+    XrVector3f boundsMin = {0.0f, 0.0f, 0.0f};
+    XrVector3f boundsMax = {0.0f, 0.0f, 0.0f};
+    if (!vertices.empty())
+    {
+        boundsMin = {vertices[0].position.x, vertices[0].position.y, vertices[0].position.z};
+        boundsMax = boundsMin;
+    }
+    for (const Vertex& vertex : vertices)
+    {
+        boundsMin = {std::min(boundsMin.x, vertex.position.x), std::min(boundsMin.y, vertex.position.y), std::min(boundsMin.z, vertex.position.z)};
+        boundsMax = {std::max(boundsMax.x, vertex.position.x), std::max(boundsMax.y, vertex.position.y), std::max(boundsMax.z, vertex.position.z)};
+    }
+    m_BoundsCenter = {(boundsMin.x + boundsMax.x) * 0.5f, (boundsMin.y + boundsMax.y) * 0.5f, (boundsMin.z + boundsMax.z) * 0.5f};
+    m_BoundsRadius = 0.0f;
+    for (const Vertex& vertex : vertices)
+    {
+        const XrVector3f offset = {vertex.position.x - m_BoundsCenter.x, vertex.position.y - m_BoundsCenter.y, vertex.position.z - m_BoundsCenter.z};
+        m_BoundsRadius = std::max(m_BoundsRadius, XrVector3f_Length(&offset));
+    }
 
     m_BuffersCreated = true;
 }
 
+size_t MeshRenderer::SelectLod(Camera& camera, const XrMatrix4x4f& modelMatrix)
+{
+    if (m_LodBuffers.size() <= 1) return 0;
+
+    // Each view keeps its own level, the views can straddle a threshold differently
+    const size_t viewIndex = static_cast<size_t>(std::max(camera.GetCurrentViewIndex(), 0));
+    if (viewIndex >= m_ViewLods.size()) m_ViewLods.resize(viewIndex + 1, 0);
+
+    const float screenSize = LodSelector::ComputeScreenSize(m_BoundsCenter, m_BoundsRadius, modelMatrix, camera.GetViewMatrix(), camera.GetFieldOfView());
+    m_ViewLods[viewIndex] = LodSelector::SelectLevel(m_Mesh->GetLods(), screenSize, m_ViewLods[viewIndex]);
+    return m_ViewLods[viewIndex];
+}
+
 
 void MeshRenderer::RenderMesh()
 {
@@ -80,59 +141,49 @@ void MeshRenderer::RenderMesh()
 
     if (!transform || !material)
     {
-        XR_TUT_LOG_ERROR("MeshRenderer::RenderMesh() - Missing transform or material");
+        XR_TRACE_ERROR("MeshRenderer::RenderMesh() - Missing transform or material");
         return;
     }
 
-    if (!m_VertexBuffer || !m_IndexBuffer || !m_Mesh)
+    // Shaders still streaming in
+    if (!material->IsReady())
     {
-        XR_TUT_LOG_ERROR("MeshRenderer::RenderMesh() - Invalid buffers or mesh");
+        return;
+    }
+
+    if (m_LodBuffers.empty() || !m_Mesh)
+    {
+        XR_TRACE_ERROR("MeshRenderer::RenderMesh() - Invalid buffers or mesh");
         return;
     }
 
     Camera* activeCamera = Scene::GetActiveCamera();
     if (!activeCamera)
     {
-        XR_TUT_LOG_ERROR("MeshRenderer::RenderMesh() - No active camera found");
+        XR_TRACE_ERROR("MeshRenderer::RenderMesh() - No active camera found");
         return;
     }
 
     const RenderSettings& cameraSettings = activeCamera->GetRenderSettings();
     if (!cameraSettings.colorImage || cameraSettings.width == 0 || cameraSettings.height == 0)
     {
-        XR_TUT_LOG_ERROR("MeshRenderer::RenderMesh() - Invalid camera render settings");
+        XR_TRACE_ERROR("MeshRenderer::RenderMesh() - Invalid camera render settings");
         return;
     }
 
-    void* pipeline = material->GetOrCreatePipeline();
-    if (!pipeline)
+    const LodBuffers& lod = m_LodBuffers[SelectLod(*activeCamera, transform->GetModelMatrix())];
+    if (!lod.allocation)
     {
-        XR_TUT_LOG_ERROR("Failed to get or create pipeline for material");
+        XR_TRACE_ERROR("MeshRenderer::RenderMesh() - Invalid buffers");
         return;
     }
 
-    void* colorImages[] = {cameraSettings.colorImage};
-    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->SetRenderAttachments(
-        colorImages, 1,
-        cameraSettings.depthImage,
-        cameraSettings.width, cameraSettings.height,
-        pipeline
-        );
-
-    GraphicsAPI::Viewport viewport;
-    viewport.x = 0;
-    viewport.y = 0;
-    viewport.width = static_cast<float>(cameraSettings.width);
-    viewport.height = static_cast<float>(cameraSettings.height);
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->SetViewports(&viewport, 1);
-
-    GraphicsAPI::Rect2D scissor = {{0, 0}, {cameraSettings.width, cameraSettings.height}};
-    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->SetScissors(&scissor, 1);
-
-    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->SetPipeline(pipeline);
+    void* pipeline = material->GetOrCreatePipeline(lod.mesh->GetVertexLayout());
+    if (!pipeline)
+    {
+        XR_TRACE_ERROR("Failed to get or create pipeline for material");
+        return;
+    }
 
     const XrMatrix4x4f& modelMatrix = transform->GetModelMatrix();
     const XrMatrix4x4f& viewMatrix = activeCamera->GetViewMatrix();
@@ -144,60 +195,60 @@ void MeshRenderer::RenderMesh()
     XrMatrix4x4f_Multiply(&renderData.modelViewProj, &renderData.viewProj, &renderData.model);
     renderData.color = material->GetColor();
 
-    if (!m_UniformBuffer)
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+    const size_t framesInFlight = std::max(graphicsAPI->GetFramesInFlight(), 1u);
+    const size_t viewIndex = static_cast<size_t>(std::max(activeCamera->GetCurrentViewIndex(), 0));
+    if (!m_UniformBuffer || viewIndex >= m_UniformViewCount)
     {
+        // Grows with the views seen so far. Draws recorded earlier this frame keep the old buffer until the GPU finished them.
+        if (m_UniformBuffer) graphicsAPI->DestroyBuffer(m_UniformBuffer);
+        const size_t alignment = graphicsAPI->GetUniformBufferOffsetAlignment();
+        m_UniformSlotSize = (sizeof(ObjectRenderData) + alignment - 1) / alignment * alignment;
+        m_UniformViewCount = viewIndex + 1;
+
         GraphicsAPI::BufferCreateInfo uniformBufferInfo;
         uniformBufferInfo.type = GraphicsAPI::BufferCreateInfo::Type::UNIFORM;
-        uniformBufferInfo.size = sizeof(ObjectRenderData);
+        uniformBufferInfo.size = m_UniformSlotSize * m_UniformViewCount * framesInFlight;
         uniformBufferInfo.data = nullptr;
-        m_UniformBuffer = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->CreateBuffer(uniformBufferInfo);
+        m_UniformBuffer = graphicsAPI->CreateBuffer(uniformBufferInfo);
     }
 
-    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->SetBufferData(m_UniformBuffer, 0, sizeof(ObjectRenderData), &renderData);
-
-    GraphicsAPI::DescriptorInfo objectDataDescriptor;
-    objectDataDescriptor.bindingIndex = 0;
-    objectDataDescriptor.resource = m_UniformBuffer;
-    objectDataDescriptor.type = GraphicsAPI::DescriptorInfo::Type::BUFFER;
-    objectDataDescriptor.stage = GraphicsAPI::DescriptorInfo::Stage::VERTEX;
-    objectDataDescriptor.readWrite = false;
-    objectDataDescriptor.bufferOffset = 0;
-    objectDataDescriptor.bufferSize = sizeof(ObjectRenderData);
-    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->SetDescriptor(objectDataDescriptor);
-
-    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->UpdateDescriptors();
-
-    uint32_t indexCount = static_cast<uint32_t>(m_Mesh->GetIndexCount());
-    if (indexCount == 0)
-    {
-        XR_TUT_LOG_ERROR("MeshRenderer::RenderMesh() - Index count is 0");
-        return;
-    }
-
-    void* vertexBuffer = m_VertexBuffer;
-    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->SetVertexBuffers(&vertexBuffer, 1);
-
-    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->SetIndexBuffer(m_IndexBuffer);
-
-    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DrawIndexed(indexCount);
+    // The slot of this frame was last read by the frame framesInFlight back, which the graphics API waited for
+    const size_t frameSlot = static_cast<size_t>(graphicsAPI->GetRecordingValue() % framesInFlight);
+    const size_t uniformOffset = (frameSlot * m_UniformViewCount + viewIndex) * m_UniformSlotSize;
+    graphicsAPI->SetBufferData(m_UniformBuffer, uniformOffset, sizeof(ObjectRenderData), &renderData);
+
+    // Recorded right away, or later on a recording thread when the view's draws are split across threads
+    DrawCommand draw;
+    draw.pipeline = pipeline;
+    draw.colorImage = cameraSettings.colorImage;
+    draw.depthImage = cameraSettings.depthImage;
+    draw.width = cameraSettings.width;
+    draw.height = cameraSettings.height;
+    draw.uniformBuffer = m_UniformBuffer;
+    draw.uniformOffset = static_cast<uint32_t>(uniformOffset);
+    draw.uniformSize = sizeof(ObjectRenderData);
+    draw.vertexBuffer = lod.allocation->vertexBuffer;
+    draw.indexBuffer = lod.allocation->indexBuffer;
+    draw.vertexOffset = lod.allocation->vertexOffset;
+    draw.firstIndex = lod.allocation->firstIndex;
+    draw.indexCount = lod.allocation->indexCount;
+    DrawListRecorder::Submit(draw, GetGameObject()->GetName().c_str());
+    MeshResourceRegistry::MarkUsed(*lod.mesh);
 }
 
 void MeshRenderer::DestroyBuffers()
 {
-    if (m_VertexBuffer)
-    {
-        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyBuffer(m_VertexBuffer);
-        m_VertexBuffer = nullptr;
-    }
-    if (m_IndexBuffer)
+    for (LodBuffers& lod : m_LodBuffers)
     {
-        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyBuffer(m_IndexBuffer);
-        m_IndexBuffer = nullptr;
+        if (lod.allocation) MeshResourceRegistry::Release(*lod.mesh);
     }
+    m_LodBuffers.clear();
     if (m_UniformBuffer)
     {
         OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyBuffer(m_UniformBuffer);
         m_UniformBuffer = nullptr;
     }
+    m_UniformViewCount = 0;
     m_BuffersCreated = false;
 }
\ No newline at end of file
@@ -1,8 +1,14 @@
 ﻿#pragma once
 
 #include "../../Core/IComponent.h"
+#include "../../Assets/AssetHandle.h"
 #include "../../Rendering/Mesh/IMesh.h"
+#include "../../Rendering/MeshResourceRegistry.h"
 #include <memory>
+#include <vector>
+#include <xr_linear_algebra.h>
+
+class Camera;
 
 class MeshRenderer : public IComponent {
 
@@ -12,18 +18,36 @@ public:
     
     void SetMesh(std::shared_ptr<IMesh> mesh);
     std::shared_ptr<IMesh> GetMesh() const { return m_Mesh; }
+    // Draws the placeholder, if any, until the streamed mesh is ready
+    void SetMeshAsync(const AssetHandle<std::shared_ptr<IMesh>>& mesh, std::shared_ptr<IMesh> placeholder = nullptr);
     
     void Initialize() override;
+    void Simulate(float deltaTime) override;
     void Tick(float deltaTime) override;
     void Destroy() override;
 
+    // Level of detail drawn in the given view during the last frame; 0 is the mesh itself
+    size_t GetCurrentLod(int viewIndex) const;
+
 private:
+    struct LodBuffers {
+        const IMesh* mesh;
+        const MeshAllocation* allocation;  // Owned by MeshResourceRegistry, null if the upload failed
+    };
+
     void CreateBuffers();
+    size_t SelectLod(Camera& camera, const XrMatrix4x4f& modelMatrix);
     void RenderMesh();
     void DestroyBuffers();
     std::shared_ptr<IMesh> m_Mesh;
-    void* m_VertexBuffer = nullptr;
-    void* m_IndexBuffer = nullptr;
+    AssetHandle<std::shared_ptr<IMesh>> m_PendingMesh;
+    std::vector<LodBuffers> m_LodBuffers;  // One per level of detail, the mesh itself first
+    std::vector<size_t> m_ViewLods;        // Current level per view, kept for the selection hysteresis
+    XrVector3f m_BoundsCenter = {0.0f, 0.0f, 0.0f};
+    float m_BoundsRadius = 0.0f;
+    // One slot of ObjectRenderData per view and frame in flight, so a slot is never rewritten while the GPU reads it
     void* m_UniformBuffer = nullptr;
+    size_t m_UniformSlotSize = 0;
+    size_t m_UniformViewCount = 0;
     bool m_BuffersCreated = false;
 };
@@ -0,0 +1,325 @@
+﻿#include "TrackedPoseFilter.h"
+#include "../Input/InputMgr.h"
+#include <xr_linear_algebra.h>
+#include <cmath>
+
+std::vector<int> TrackedPoseFilter::m_Sources{};
+std::vector<TrackedPoseFilterSettings> TrackedPoseFilter::m_Settings{};
+std::vector<float> TrackedPoseFilter::m_Raw[CHANNEL_COUNT]{};
+std::vector<float> TrackedPoseFilter::m_Filtered[CHANNEL_COUNT]{};
+std::vector<float> TrackedPoseFilter::m_Derivative[CHANNEL_COUNT]{};
+std::vector<float> TrackedPoseFilter::m_PositionAlpha{};
+std::vector<float> TrackedPoseFilter::m_RotationAlpha{};
+std::vector<float> TrackedPoseFilter::m_DerivativeAlpha{};
+std::vector<uint8_t> TrackedPoseFilter::m_SampleValid{};
+std::vector<uint8_t> TrackedPoseFilter::m_HasFilteredPose{};
+std::vector<float> TrackedPoseFilter::m_TimeSinceTracked{};
+std::vector<XrVector3f> TrackedPoseFilter::m_LinearVelocities{};
+std::vector<XrVector3f> TrackedPoseFilter::m_AngularVelocities{};
+std::vector<XrPosef> TrackedPoseFilter::m_Poses{};
+std::vector<uint8_t> TrackedPoseFilter::m_PosesValid{};
+XrTime TrackedPoseFilter::m_LastPredictedTime = 0;
+
+namespace
+{
+    const XrPosef IDENTITY_POSE = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+
+    void ExtrapolatePose(XrPosef& pose, const XrVector3f& linearVelocity, const XrVector3f& angularVelocity, float time)
+    {
+        pose.position.x += linearVelocity.x * time;
+        pose.position.y += linearVelocity.y * time;
+        pose.position.z += linearVelocity.z * time;
+
+        const float angularSpeed = XrVector3f_Length(&angularVelocity);
+        if (angularSpeed > 1e-6f)
+        {
+            // Angular velocity is expressed in the reference space, so the delta is applied after the current rotation
+            XrQuaternionf delta;
+            XrQuaternionf_CreateFromAxisAngle(&delta, &angularVelocity, angularSpeed * time);
+            XrQuaternionf rotated;
+            XrQuaternionf_Multiply(&rotated, &pose.orientation, &delta);
+            pose.orientation = rotated;
+        }
+    }
+}
+
+int TrackedPoseFilter::RegisterDevice(int handIndex, const TrackedPoseFilterSettings& settings)
+{
+    int deviceHandle = -1;
+    for (size_t i = 0; i < m_Sources.size(); ++i)
+    {
+        if (m_Sources[i] < 0)
+        {
+            deviceHandle = static_cast<int>(i);
+            break;
+        }
+    }
+
+    if (deviceHandle < 0)
+    {
+        deviceHandle = static_cast<int>(m_Sources.size());
+        const size_t deviceCount = m_Sources.size() + 1;
+
+        m_Sources.resize(deviceCount);
+        m_Settings.resize(deviceCount);
+        for (int channel = 0; channel < CHANNEL_COUNT; ++channel)
+        {
+            m_Raw[channel].resize(deviceCount);
+            m_Filtered[channel].resize(deviceCount);
+            m_Derivative[channel].resize(deviceCount);
+        }
+        m_PositionAlpha.resize(deviceCount);
+        m_RotationAlpha.resize(deviceCount);
+        m_DerivativeAlpha.resize(deviceCount);
+        m_SampleValid.resize(deviceCount);
+        m_HasFilteredPose.resize(deviceCount);
+        m_TimeSinceTracked.resize(deviceCount);
+        m_LinearVelocities.resize(deviceCount);
+        m_AngularVelocities.resize(deviceCount);
+        m_Poses.resize(deviceCount);
+        m_PosesValid.resize(deviceCount);
+    }
+
+    m_Sources[deviceHandle] = handIndex;
+    m_Settings[deviceHandle] = settings;
+    m_HasFilteredPose[deviceHandle] = 0;
+    m_SampleValid[deviceHandle] = 0;
+    m_TimeSinceTracked[deviceHandle] = 0.0f;
+    m_LinearVelocities[deviceHandle] = {0.0f, 0.0f, 0.0f};
+    m_AngularVelocities[deviceHandle] = {0.0f, 0.0f, 0.0f};
+    m_Poses[deviceHandle] = IDENTITY_POSE;
+    m_PosesValid[deviceHandle] = 0;
+
+    return deviceHandle;
+}
+
+void TrackedPoseFilter::UnregisterDevice(int deviceHandle)
+{
+    if (IsValidHandle(deviceHandle))
+    {
+        m_Sources[deviceHandle] = -1;
+        m_PosesValid[deviceHandle] = 0;
+    }
+}
+
+void TrackedPoseFilter::SetDeviceSource(int deviceHandle, int handIndex)
+{
+    if (!IsValidHandle(deviceHandle)) return;
+    m_Sources[deviceHandle] = handIndex;
+    m_HasFilteredPose[deviceHandle] = 0;
+}
+
+void TrackedPoseFilter::SetDeviceSettings(int deviceHandle, const TrackedPoseFilterSettings& settings)
+{
+    if (!IsValidHandle(deviceHandle)) return;
+    m_Settings[deviceHandle] = settings;
+}
+
+void TrackedPoseFilter::Tick(XrTime predictedTime)
+{
+    float deltaTime = 0.0f;
+    if (m_LastPredictedTime != 0 && predictedTime > m_LastPredictedTime)
+    {
+        deltaTime = static_cast<float>(predictedTime - m_LastPredictedTime) * 1e-9f;
+    }
+    m_LastPredictedTime = predictedTime;
+
+    GatherSamples(deltaTime);
+    FilterSamples(deltaTime);
+    ScatterPoses();
+}
+
+const XrPosef& TrackedPoseFilter::GetFilteredPose(int deviceHandle, bool* isValid)
+{
+    if (!IsValidHandle(deviceHandle))
+    {
+        if (isValid) *isValid = false;
+        return IDENTITY_POSE;
+    }
+    if (isValid) *isValid = m_PosesValid[deviceHandle] != 0;
+    return m_Poses[deviceHandle];
+}
+
+bool TrackedPoseFilter::IsValidHandle(int deviceHandle)
+{
+    return deviceHandle >= 0 && deviceHandle < static_cast<int>(m_Sources.size());
+}
+
+void TrackedPoseFilter::GatherSamples(float deltaTime)
+{
+    for (size_t i = 0; i < m_Sources.size(); ++i)
+    {
+        m_SampleValid[i] = 0;
+        if (m_Sources[i] < 0) continue;
+
+        const TrackedPoseFilterSettings& settings = m_Settings[i];
+
+        bool poseActive = false;
+        XrPosef pose = InputMgr::GetHandPose(m_Sources[i], &poseActive);
+
+        if (poseActive)
+        {
+            XrVector3f linearVelocity, angularVelocity;
+            if (InputMgr::GetHandVelocity(m_Sources[i], linearVelocity, angularVelocity))
+            {
+                m_LinearVelocities[i] = linearVelocity;
+                m_AngularVelocities[i] = angularVelocity;
+                if (settings.predictionTime > 0.0f)
+                {
+                    ExtrapolatePose(pose, linearVelocity, angularVelocity, settings.predictionTime);
+                }
+            }
+            else
+            {
+                m_LinearVelocities[i] = {0.0f, 0.0f, 0.0f};
+                m_AngularVelocities[i] = {0.0f, 0.0f, 0.0f};
+            }
+            m_TimeSinceTracked[i] = 0.0f;
+            m_SampleValid[i] = 1;
+        }
+        else if (m_HasFilteredPose[i])
+        {
+            // Coast from the last filtered pose for a short while, then hold it
+            m_TimeSinceTracked[i] += deltaTime;
+            if (m_TimeSinceTracked[i] > settings.maxExtrapolationTime) continue;
+
+            pose = {{m_Filtered[3][i], m_Filtered[4][i], m_Filtered[5][i], m_Filtered[6][i]},
+                    {m_Filtered[0][i], m_Filtered[1][i], m_Filtered[2][i]}};
+            ExtrapolatePose(pose, m_LinearVelocities[i], m_AngularVelocities[i], deltaTime);
+            m_SampleValid[i] = 1;
+        }
+        else
+        {
+            continue;
+        }
+
+        // Keep the quaternion in the same hemisphere as the filtered one so the components blend correctly
+        if (m_HasFilteredPose[i])
+        {
+            const float dot = pose.orientation.x * m_Filtered[3][i] + pose.orientation.y * m_Filtered[4][i] +
+                              pose.orientation.z * m_Filtered[5][i] + pose.orientation.w * m_Filtered[6][i];
+            if (dot < 0.0f)
+            {
+                pose.orientation = {-pose.orientation.x, -pose.orientation.y, -pose.orientation.z, -pose.orientation.w};
+            }
+        }
+
+        m_Raw[0][i] = pose.position.x;
+        m_Raw[1][i] = pose.position.y;
+        m_Raw[2][i] = pose.position.z;
+        m_Raw[3][i] = pose.orientation.x;
+        m_Raw[4][i] = pose.orientation.y;
+        m_Raw[5][i] = pose.orientation.z;
+        m_Raw[6][i] = pose.orientation.w;
+    }
+}
+
+void TrackedPoseFilter::FilterSamples(float deltaTime)
+{
+    const size_t deviceCount = m_Sources.size();
+    const float invDeltaTime = deltaTime > 0.0f ? 1.0f / deltaTime : 0.0f;
+
+    // Devices without a sample keep their state (alpha 0); a first sample or disabled smoothing takes the raw value (alpha 1)
+    for (size_t i = 0; i < deviceCount; ++i)
+    {
+        const bool smoothing = m_SampleValid[i] && m_HasFilteredPose[i] && m_Settings[i].enableSmoothing;
+        m_DerivativeAlpha[i] = smoothing ? SmoothingAlpha(m_Settings[i].derivativeCutoff, deltaTime) : 0.0f;
+        if (!smoothing && m_SampleValid[i])
+        {
+            for (int channel = 0; channel < CHANNEL_COUNT; ++channel)
+            {
+                m_Derivative[channel][i] = 0.0f;
+            }
+        }
+    }
+
+    for (int channel = 0; channel < CHANNEL_COUNT; ++channel)
+    {
+        const float* raw = m_Raw[channel].data();
+        const float* filtered = m_Filtered[channel].data();
+        const float* alpha = m_DerivativeAlpha.data();
+        float* derivative = m_Derivative[channel].data();
+        for (size_t i = 0; i < deviceCount; ++i)
+        {
+            const float rate = (raw[i] - filtered[i]) * invDeltaTime;
+            derivative[i] += alpha[i] * (rate - derivative[i]);
+        }
+    }
+
+    for (size_t i = 0; i < deviceCount; ++i)
+    {
+        if (!m_SampleValid[i])
+        {
+            m_PositionAlpha[i] = 0.0f;
+            m_RotationAlpha[i] = 0.0f;
+        }
+        else if (!m_HasFilteredPose[i] || !m_Settings[i].enableSmoothing)
+        {
+            m_PositionAlpha[i] = 1.0f;
+            m_RotationAlpha[i] = 1.0f;
+        }
+        else
+        {
+            const TrackedPoseFilterSettings& settings = m_Settings[i];
+            const float linearSpeed = std::sqrt(m_Derivative[0][i] * m_Derivative[0][i] +
+                                                m_Derivative[1][i] * m_Derivative[1][i] +
+                                                m_Derivative[2][i] * m_Derivative[2][i]);
+            // The quaternion changes at half the angular speed
+            const float angularSpeed = 2.0f * std::sqrt(m_Derivative[3][i] * m_Derivative[3][i] +
+                                                        m_Derivative[4][i] * m_Derivative[4][i] +
+                                                        m_Derivative[5][i] * m_Derivative[5][i] +
+                                                        m_Derivative[6][i] * m_Derivative[6][i]);
+            m_PositionAlpha[i] = SmoothingAlpha(settings.minCutoff + settings.beta * linearSpeed, deltaTime);
+            m_RotationAlpha[i] = SmoothingAlpha(settings.minCutoff + settings.beta * angularSpeed, deltaTime);
+        }
+    }
+
+    for (int channel = 0; channel < CHANNEL_COUNT; ++channel)
+    {
+        const float* raw = m_Raw[channel].data();
+        const float* alpha = channel < 3 ? m_PositionAlpha.data() : m_RotationAlpha.data();
+        float* filtered = m_Filtered[channel].data();
+        for (size_t i = 0; i < deviceCount; ++i)
+        {
+            filtered[i] += alpha[i] * (raw[i] - filtered[i]);
+        }
+    }
+
+    for (size_t i = 0; i < deviceCount; ++i)
+    {
+        m_HasFilteredPose[i] |= m_SampleValid[i];
+    }
+}
+
+void TrackedPoseFilter::ScatterPoses()
+{
+    for (size_t i = 0; i < m_Sources.size(); ++i)
+    {
+        if (m_Sources[i] < 0) continue;
+
+        if (!m_SampleValid[i] && (!m_Settings[i].holdLastValid || !m_HasFilteredPose[i]))
+        {
+            bool poseActive = false;
+            m_Poses[i] = InputMgr::GetHandPose(m_Sources[i], &poseActive);
+            m_PosesValid[i] = poseActive;
+            m_HasFilteredPose[i] = 0;
+            continue;
+        }
+
+        XrQuaternionf orientation = {m_Filtered[3][i], m_Filtered[4][i], m_Filtered[5][i], m_Filtered[6][i]};
+        const float lengthRcp = XrRcpSqrt(orientation.x * orientation.x + orientation.y * orientation.y +
+                                          orientation.z * orientation.z + orientation.w * orientation.w);
+        orientation = {orientation.x * lengthRcp, orientation.y * lengthRcp, orientation.z * lengthRcp, orientation.w * lengthRcp};
+
+        m_Poses[i] = {orientation, {m_Filtered[0][i], m_Filtered[1][i], m_Filtered[2][i]}};
+        m_PosesValid[i] = 1;
+    }
+}
+
+float TrackedPoseFilter::SmoothingAlpha(float cutoff, float deltaTime)
+{
+    if (deltaTime <= 0.0f) return 0.0f;
+
+    const float tau = 1.0f / (2.0f * 3.14159265f * cutoff);
+    return 1.0f / (1.0f + tau / deltaTime);
+}
@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include <openxr/openxr.h>
+#include <cstdint>
+#include <vector>
+
+#include "TrackedPoseFilterSettings.h"
+
+// Filters the poses of every registered tracked device in one batch per frame.
+// Channels are stored as separate arrays so each filter step is a flat loop over devices.
+class TrackedPoseFilter
+{
+public:
+    static int RegisterDevice(int handIndex, const TrackedPoseFilterSettings& settings = {});
+    static void UnregisterDevice(int deviceHandle);
+    static void SetDeviceSource(int deviceHandle, int handIndex);
+    static void SetDeviceSettings(int deviceHandle, const TrackedPoseFilterSettings& settings);
+
+    static void Tick(XrTime predictedTime);
+
+    // Unknown handles, such as the -1 of a driver that isn't registered yet, give the identity pose and isValid=false
+    static const XrPosef& GetFilteredPose(int deviceHandle, bool* isValid = nullptr);
+
+private:
+    static constexpr int CHANNEL_COUNT = 7;  // Position xyz, orientation xyzw
+
+    static bool IsValidHandle(int deviceHandle);
+    static void GatherSamples(float deltaTime);
+    static void FilterSamples(float deltaTime);
+    static void ScatterPoses();
+    static float SmoothingAlpha(float cutoff, float deltaTime);
+
+    static std::vector<int> m_Sources;  // Hand index per device, -1 marks a free slot
+    static std::vector<TrackedPoseFilterSettings> m_Settings;
+
+    static std::vector<float> m_Raw[CHANNEL_COUNT];
+    static std::vector<float> m_Filtered[CHANNEL_COUNT];
+    static std::vector<float> m_Derivative[CHANNEL_COUNT];
+    static std::vector<float> m_PositionAlpha;
+    static std::vector<float> m_RotationAlpha;
+    static std::vector<float> m_DerivativeAlpha;
+
+    static std::vector<uint8_t> m_SampleValid;
+    static std::vector<uint8_t> m_HasFilteredPose;
+    static std::vector<float> m_TimeSinceTracked;
+    static std::vector<XrVector3f> m_LinearVelocities;
+    static std::vector<XrVector3f> m_AngularVelocities;
+
+    static std::vector<XrPosef> m_Poses;
+    static std::vector<uint8_t> m_PosesValid;
+
+    static XrTime m_LastPredictedTime;
+};
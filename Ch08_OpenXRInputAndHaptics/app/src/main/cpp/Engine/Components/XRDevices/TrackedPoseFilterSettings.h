@@ -0,0 +1,15 @@
+﻿#pragma once
+
+struct TrackedPoseFilterSettings
+{
+    // One-Euro filter: cutoff = minCutoff + beta * speed
+    bool enableSmoothing = true;
+    float minCutoff = 1.0f;         // Hz, lower is smoother while the device is still
+    float beta = 5.0f;              // Higher reduces lag on fast motion
+    float derivativeCutoff = 1.0f;  // Hz, used to smooth the speed estimate
+
+    float predictionTime = 0.0f;    // Seconds to extrapolate along the runtime reported velocity
+
+    bool holdLastValid = true;          // Keep the last filtered pose while tracking is lost
+    float maxExtrapolationTime = 0.1f;  // Seconds to coast on the last velocity before holding
+};
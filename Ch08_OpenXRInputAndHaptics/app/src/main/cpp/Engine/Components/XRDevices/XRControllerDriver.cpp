@@ -1,21 +1,41 @@
 ﻿#include "XRControllerDriver.h"
+#include "TrackedPoseFilter.h"
 #include "../Core/Transform.h"
 #include "../Rendering/Camera.h"
 #include "../../Core/GameObject.h"
-#include "../Input/InputMgr.h"
+
+void XRControllerDriver::Initialize()
+{
+    m_PoseFilterHandle = TrackedPoseFilter::RegisterDevice(m_Handedness);
+}
+
+void XRControllerDriver::Destroy()
+{
+    TrackedPoseFilter::UnregisterDevice(m_PoseFilterHandle);
+    m_PoseFilterHandle = -1;
+}
 
 void XRControllerDriver::SetHandedness(int handedness)
 {
    m_Handedness = handedness; 
+   TrackedPoseFilter::SetDeviceSource(m_PoseFilterHandle, m_Handedness);
+}
+
+void XRControllerDriver::SetPoseFilterSettings(const TrackedPoseFilterSettings& settings)
+{
+    TrackedPoseFilter::SetDeviceSettings(m_PoseFilterHandle, settings);
 }
 
-void XRControllerDriver::PreTick(float deltaTime)
+void XRControllerDriver::Simulate(float deltaTime)
 {
     Transform* transform = GetGameObject()->GetComponent<Transform>();
     if (transform) {
-        bool poseActive;
-        const XrPosef& pose = InputMgr::GetHandPose(m_Handedness, &poseActive);
-        transform->SetPosition(pose.position);
-        transform->SetRotation(pose.orientation);
+        // Filtered in one batch per frame; holds the last valid pose instead of snapping to the origin
+        bool poseValid;
+        const XrPosef& pose = TrackedPoseFilter::GetFilteredPose(m_PoseFilterHandle, &poseValid);
+        if (poseValid) {
+            transform->SetPosition(pose.position);
+            transform->SetRotation(pose.orientation);
+        }
     }
 }
@@ -1,13 +1,18 @@
 ﻿#pragma once
 
 #include "../../Core/IComponent.h"
+#include "TrackedPoseFilterSettings.h"
 
 class XRControllerDriver : public IComponent
 {
 public:
+    void Initialize() override;
+    void Destroy() override;
     void SetHandedness(int handedness);
-    void PreTick(float deltaTime) override;
+    void SetPoseFilterSettings(const TrackedPoseFilterSettings& settings);
+    void Simulate(float deltaTime) override;
 
 private:
     int m_Handedness = 0;
+    int m_PoseFilterHandle = -1;
 };
\ No newline at end of file
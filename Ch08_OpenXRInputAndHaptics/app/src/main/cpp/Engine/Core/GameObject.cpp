@@ -1,5 +1,15 @@
 ﻿#include "GameObject.h"
 
+void GameObject::Simulate(float deltaTime) {
+    if (!m_Active) return;
+    
+    for (auto& componentPair : m_ComponentsLists) {
+        if (componentPair.second->IsEnabled()) {
+            componentPair.second->Simulate(deltaTime);
+        }
+    }
+}
+
 void GameObject::PreTick(float deltaTime) {
     if (!m_Active) return;
     
@@ -43,6 +43,7 @@ public:
         return nullptr;
     }
 
+    void Simulate(float deltaTime);
     void PreTick(float deltaTime);
     void Tick(float deltaTime);
     void PostTick(float deltaTime);
@@ -11,6 +11,9 @@ public:
     virtual ~IComponent() = default;
     
     virtual void Initialize() {}
+    // Once per frame, before any view is rendered; state that advances with time belongs here
+    virtual void Simulate(float deltaTime) {}
+    // Once per rendered view
     virtual void PreTick(float deltaTime) {}
     virtual void Tick(float deltaTime) {}
     virtual void PostTick(float deltaTime) {}
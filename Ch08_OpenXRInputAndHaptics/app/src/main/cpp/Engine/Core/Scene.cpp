@@ -43,6 +43,17 @@ void Scene::Clear()
     m_GameObjectsLists.clear();
 }
 
+void Scene::Simulate(float deltaTime)
+{
+    for (auto& gameObject : m_GameObjectsLists)
+    {
+        if (gameObject->IsActive())
+        {
+            gameObject->Simulate(deltaTime);
+        }
+    }
+}
+
 void Scene::Update(float deltaTime)
 {
     for (auto& gameObject : m_GameObjectsLists)
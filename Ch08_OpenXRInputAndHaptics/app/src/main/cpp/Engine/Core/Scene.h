@@ -16,6 +16,9 @@ public:
     void DestroyGameObject(GameObject* gameObject);
     void Clear();
     
+    // Advances the objects once per frame
+    void Simulate(float deltaTime);
+    // Renders the current view
     void Update(float deltaTime);
     
     const std::string& GetName() const { return m_SceneName; }
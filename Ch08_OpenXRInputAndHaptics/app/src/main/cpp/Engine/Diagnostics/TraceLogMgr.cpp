@@ -0,0 +1,223 @@
+﻿#include "TraceLogMgr.h"
+
+#include <DebugOutput.h>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+
+#if defined(__ANDROID__)
+#include <android/log.h>
+#endif
+
+std::mutex TraceLogMgr::m_BuffersMutex;
+std::vector<std::unique_ptr<TraceThreadBuffer>> TraceLogMgr::m_Buffers;
+thread_local TraceThreadBuffer* TraceLogMgr::m_ThreadBuffer = nullptr;
+std::thread TraceLogMgr::m_FlushThread;
+std::atomic<bool> TraceLogMgr::m_Running{false};
+std::mutex TraceLogMgr::m_FlushMutex;
+std::vector<TraceLogMgr::PendingRecord> TraceLogMgr::m_PendingRecords;
+uint64_t TraceLogMgr::m_ReportedDroppedCount = 0;
+
+namespace
+{
+    const char LEVEL_CHARS[] = {'V', 'I', 'W', 'E'};
+
+    // Decodes the argument at the given payload offset, appends it and returns the offset of the next one
+    size_t AppendArg(std::string& text, const TraceRecord& record, TraceArgType type, size_t offset)
+    {
+        char buffer[32];
+        switch (type)
+        {
+            case TraceArgType::INT:
+            {
+                int64_t value;
+                std::memcpy(&value, record.payload + offset, sizeof(value));
+                std::snprintf(buffer, sizeof(buffer), "%" PRId64, value);
+                text += buffer;
+                return offset + sizeof(value);
+            }
+            case TraceArgType::UINT:
+            {
+                uint64_t value;
+                std::memcpy(&value, record.payload + offset, sizeof(value));
+                std::snprintf(buffer, sizeof(buffer), "%" PRIu64, value);
+                text += buffer;
+                return offset + sizeof(value);
+            }
+            case TraceArgType::DOUBLE:
+            {
+                double value;
+                std::memcpy(&value, record.payload + offset, sizeof(value));
+                std::snprintf(buffer, sizeof(buffer), "%g", value);
+                text += buffer;
+                return offset + sizeof(value);
+            }
+            case TraceArgType::BOOL:
+            {
+                text += record.payload[offset] ? "true" : "false";
+                return offset + 1;
+            }
+            case TraceArgType::POINTER:
+            {
+                const void* value;
+                std::memcpy(&value, record.payload + offset, sizeof(value));
+                std::snprintf(buffer, sizeof(buffer), "%p", value);
+                text += buffer;
+                return offset + sizeof(value);
+            }
+            case TraceArgType::STRING:
+            {
+                uint16_t length;
+                std::memcpy(&length, record.payload + offset, sizeof(length));
+                text.append(reinterpret_cast<const char*>(record.payload + offset + sizeof(length)), length);
+                return offset + sizeof(length) + length;
+            }
+        }
+        return offset;
+    }
+}
+
+void TraceLogMgr::Start()
+{
+    if (m_Running.exchange(true)) return;
+
+    m_FlushThread = std::thread(&TraceLogMgr::FlushLoop);
+}
+
+void TraceLogMgr::Stop()
+{
+    if (m_Running.exchange(false))
+    {
+        m_FlushThread.join();
+    }
+    Flush();
+}
+
+uint64_t TraceLogMgr::GetDroppedCount()
+{
+    std::lock_guard<std::mutex> lock(m_BuffersMutex);
+    uint64_t droppedCount = 0;
+    for (const std::unique_ptr<TraceThreadBuffer>& buffer : m_Buffers)
+    {
+        droppedCount += buffer->GetDroppedCount();
+    }
+    return droppedCount;
+}
+
+TraceThreadBuffer& TraceLogMgr::GetThreadBuffer()
+{
+    // Only the first call on each thread takes the lock. Buffers outlive their threads so the
+    // flusher can still drain them.
+    if (!m_ThreadBuffer)
+    {
+        std::lock_guard<std::mutex> lock(m_BuffersMutex);
+        m_Buffers.push_back(std::make_unique<TraceThreadBuffer>(static_cast<uint32_t>(m_Buffers.size())));
+        m_ThreadBuffer = m_Buffers.back().get();
+    }
+    return *m_ThreadBuffer;
+}
+
+int64_t TraceLogMgr::GetTimeNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceLogMgr::FlushLoop()
+{
+    while (m_Running.load(std::memory_order_acquire))
+    {
+        Flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(FLUSH_INTERVAL_MS));
+    }
+}
+
+void TraceLogMgr::Flush()
+{
+    std::lock_guard<std::mutex> flushLock(m_FlushMutex);
+
+    uint64_t droppedCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_BuffersMutex);
+        for (const std::unique_ptr<TraceThreadBuffer>& buffer : m_Buffers)
+        {
+            PendingRecord pending;
+            pending.threadId = buffer->GetThreadId();
+            while (buffer->TryRead(pending.record))
+            {
+                m_PendingRecords.push_back(pending);
+            }
+            droppedCount += buffer->GetDroppedCount();
+        }
+    }
+
+    // Interleave the threads in the order the messages were written
+    std::stable_sort(m_PendingRecords.begin(), m_PendingRecords.end(), [](const PendingRecord& a, const PendingRecord& b)
+                     { return a.record.timeNs < b.record.timeNs; });
+
+    for (const PendingRecord& pending : m_PendingRecords)
+    {
+        WriteLine(pending.record.site->level, FormatRecord(pending.record, pending.threadId));
+    }
+    m_PendingRecords.clear();
+
+    if (droppedCount > m_ReportedDroppedCount)
+    {
+        WriteLine(TraceLevel::WARN, "[W] TraceLogMgr: " + std::to_string(droppedCount - m_ReportedDroppedCount) + " messages dropped, trace buffer full");
+        m_ReportedDroppedCount = droppedCount;
+    }
+
+#if !defined(__ANDROID__)
+    std::fflush(stdout);
+#endif
+}
+
+std::string TraceLogMgr::FormatRecord(const TraceRecord& record, uint32_t threadId)
+{
+    const TraceSite& site = *record.site;
+    std::string text;
+    text.reserve(128);
+    text += '[';
+    text += LEVEL_CHARS[static_cast<int>(site.level)];
+    text += "][T" + std::to_string(threadId) + "] ";
+
+    size_t offset = 0;
+    uint32_t argIndex = 0;
+    for (const char* c = site.format; *c; ++c)
+    {
+        if (c[0] == '{' && c[1] == '}')
+        {
+            if (argIndex < record.argCount)
+            {
+                offset = AppendArg(text, record, record.argTypes[argIndex++], offset);
+            }
+            else
+            {
+                text += "{?}";
+            }
+            ++c;
+            continue;
+        }
+        text += *c;
+    }
+
+    if (site.level >= TraceLevel::WARN)
+    {
+        const char* fileName = std::strrchr(site.file, '/');
+        const char* backslash = std::strrchr(fileName ? fileName : site.file, '\\');
+        fileName = backslash ? backslash + 1 : (fileName ? fileName + 1 : site.file);
+        text += " (" + std::string(fileName) + ":" + std::to_string(site.line) + ")";
+    }
+    return text;
+}
+
+void TraceLogMgr::WriteLine(TraceLevel level, const std::string& line)
+{
+#if defined(__ANDROID__)
+    static const android_LogPriority priorities[] = {ANDROID_LOG_VERBOSE, ANDROID_LOG_INFO, ANDROID_LOG_WARN, ANDROID_LOG_ERROR};
+    __android_log_write(priorities[static_cast<int>(level)], XR_TUT_LOG_TAG, line.c_str());
+#else
+    FILE* stream = level >= TraceLevel::WARN ? stderr : stdout;
+    std::fputs(line.c_str(), stream);
+    std::fputc('\n', stream);
+#endif
+}
@@ -0,0 +1,188 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "TraceRecord.h"
+#include "TraceThreadBuffer.h"
+
+// Calls below this level are compiled out entirely, arguments included
+#ifndef XR_TRACE_MIN_LEVEL
+#ifdef NDEBUG
+#define XR_TRACE_MIN_LEVEL XR_TRACE_LEVEL_INFO
+#else
+#define XR_TRACE_MIN_LEVEL XR_TRACE_LEVEL_VERBOSE
+#endif
+#endif
+
+#define XR_TRACE_IMPL(traceLevel, format, ...)                                                   \
+    do                                                                                           \
+    {                                                                                            \
+        static constexpr TraceSite xrTraceSite{traceLevel, format, __FILE__, __LINE__};          \
+        TraceLogMgr::Write(&xrTraceSite, ##__VA_ARGS__);                                         \
+    } while (0)
+
+#if XR_TRACE_MIN_LEVEL <= XR_TRACE_LEVEL_VERBOSE
+#define XR_TRACE_VERBOSE(format, ...) XR_TRACE_IMPL(TraceLevel::VERBOSE, format, ##__VA_ARGS__)
+#else
+#define XR_TRACE_VERBOSE(format, ...) do {} while (0)
+#endif
+
+#if XR_TRACE_MIN_LEVEL <= XR_TRACE_LEVEL_INFO
+#define XR_TRACE_INFO(format, ...) XR_TRACE_IMPL(TraceLevel::INFO, format, ##__VA_ARGS__)
+#else
+#define XR_TRACE_INFO(format, ...) do {} while (0)
+#endif
+
+#if XR_TRACE_MIN_LEVEL <= XR_TRACE_LEVEL_WARN
+#define XR_TRACE_WARN(format, ...) XR_TRACE_IMPL(TraceLevel::WARN, format, ##__VA_ARGS__)
+#else
+#define XR_TRACE_WARN(format, ...) do {} while (0)
+#endif
+
+#if XR_TRACE_MIN_LEVEL <= XR_TRACE_LEVEL_ERROR
+#define XR_TRACE_ERROR(format, ...) XR_TRACE_IMPL(TraceLevel::ERR, format, ##__VA_ARGS__)
+#else
+#define XR_TRACE_ERROR(format, ...) do {} while (0)
+#endif
+
+// Low-overhead logging for per-frame code. The calling thread only copies its arguments into a
+// thread-local ring; formatting and the write to logcat/stdout happen on a background thread.
+// Usage: XR_TRACE_WARN("Mesh {} has {} indices", name, count);
+class TraceLogMgr
+{
+public:
+    // Starts the background thread that formats and writes buffered messages
+    static void Start();
+    // Stops the background thread and writes whatever is still buffered
+    static void Stop();
+
+    template <typename... Args>
+    static void Write(const TraceSite* site, const Args&... args)
+    {
+        TraceThreadBuffer& buffer = GetThreadBuffer();
+        TraceRecord* record = buffer.BeginWrite();
+        if (!record) return;
+
+        record->site = site;
+        record->timeNs = GetTimeNs();
+        record->argCount = 0;
+        record->payloadSize = 0;
+        EncodeArgs(*record, args...);
+        buffer.EndWrite();
+    }
+
+    // Messages lost because a thread's buffer was full
+    static uint64_t GetDroppedCount();
+
+    static constexpr int FLUSH_INTERVAL_MS = 10;
+
+private:
+    static TraceThreadBuffer& GetThreadBuffer();
+    static int64_t GetTimeNs();
+
+    static void FlushLoop();
+    static void Flush();
+    static std::string FormatRecord(const TraceRecord& record, uint32_t threadId);
+    static void WriteLine(TraceLevel level, const std::string& line);
+
+    struct PendingRecord
+    {
+        TraceRecord record;
+        uint32_t threadId;
+    };
+
+    static std::mutex m_BuffersMutex;
+    static std::vector<std::unique_ptr<TraceThreadBuffer>> m_Buffers;
+    static thread_local TraceThreadBuffer* m_ThreadBuffer;
+
+    static std::thread m_FlushThread;
+    static std::atomic<bool> m_Running;
+    static std::mutex m_FlushMutex;
+    static std::vector<PendingRecord> m_PendingRecords;
+    static uint64_t m_ReportedDroppedCount;
+
+    static void EncodeArgs(TraceRecord&) {}
+
+    template <typename T, typename... Rest>
+    static void EncodeArgs(TraceRecord& record, const T& arg, const Rest&... rest)
+    {
+        EncodeArg(record, arg);
+        EncodeArgs(record, rest...);
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type EncodeArg(TraceRecord& record, const T& value)
+    {
+        const int64_t encoded = value;
+        PushArg(record, TraceArgType::INT, &encoded, sizeof(encoded));
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value && !std::is_same<T, bool>::value>::type EncodeArg(TraceRecord& record, const T& value)
+    {
+        const uint64_t encoded = value;
+        PushArg(record, TraceArgType::UINT, &encoded, sizeof(encoded));
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_enum<T>::value>::type EncodeArg(TraceRecord& record, const T& value)
+    {
+        const int64_t encoded = static_cast<int64_t>(value);
+        PushArg(record, TraceArgType::INT, &encoded, sizeof(encoded));
+    }
+
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value>::type EncodeArg(TraceRecord& record, const T& value)
+    {
+        const double encoded = value;
+        PushArg(record, TraceArgType::DOUBLE, &encoded, sizeof(encoded));
+    }
+
+    template <typename T>
+    static void EncodeArg(TraceRecord& record, T* const& value)
+    {
+        const void* encoded = value;
+        PushArg(record, TraceArgType::POINTER, &encoded, sizeof(encoded));
+    }
+
+    static void EncodeArg(TraceRecord& record, bool value)
+    {
+        const uint8_t encoded = value ? 1 : 0;
+        PushArg(record, TraceArgType::BOOL, &encoded, sizeof(encoded));
+    }
+
+    static void EncodeArg(TraceRecord& record, const char* value) { EncodeString(record, value ? value : "(null)", value ? std::strlen(value) : 6); }
+    static void EncodeArg(TraceRecord& record, char* value) { EncodeArg(record, static_cast<const char*>(value)); }
+    static void EncodeArg(TraceRecord& record, const std::string& value) { EncodeString(record, value.data(), value.size()); }
+
+    // Strings are stored as a 16-bit length followed by the characters, truncated to the space left
+    static void EncodeString(TraceRecord& record, const char* value, size_t length)
+    {
+        const size_t space = TraceRecord::PAYLOAD_SIZE - record.payloadSize;
+        if (record.argCount >= TraceRecord::MAX_ARGS || space < sizeof(uint16_t)) return;
+
+        const uint16_t storedLength = static_cast<uint16_t>(std::min(length, space - sizeof(uint16_t)));
+        std::memcpy(record.payload + record.payloadSize, &storedLength, sizeof(storedLength));
+        std::memcpy(record.payload + record.payloadSize + sizeof(storedLength), value, storedLength);
+        record.payloadSize += static_cast<uint16_t>(sizeof(storedLength) + storedLength);
+        record.argTypes[record.argCount++] = TraceArgType::STRING;
+    }
+
+    // Arguments that don't fit are left out and show up as "{?}" in the output
+    static void PushArg(TraceRecord& record, TraceArgType type, const void* data, size_t size)
+    {
+        if (record.argCount >= TraceRecord::MAX_ARGS || record.payloadSize + size > TraceRecord::PAYLOAD_SIZE) return;
+
+        std::memcpy(record.payload + record.payloadSize, data, size);
+        record.payloadSize += static_cast<uint16_t>(size);
+        record.argTypes[record.argCount++] = type;
+    }
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+
+// Plain integers so the levels can also be compared by the preprocessor
+#define XR_TRACE_LEVEL_VERBOSE 0
+#define XR_TRACE_LEVEL_INFO 1
+#define XR_TRACE_LEVEL_WARN 2
+#define XR_TRACE_LEVEL_ERROR 3
+
+// ERROR is a macro in wingdi.h, hence ERR
+enum class TraceLevel : uint8_t
+{
+    VERBOSE = XR_TRACE_LEVEL_VERBOSE,
+    INFO = XR_TRACE_LEVEL_INFO,
+    WARN = XR_TRACE_LEVEL_WARN,
+    ERR = XR_TRACE_LEVEL_ERROR
+};
+
+enum class TraceArgType : uint8_t
+{
+    INT,
+    UINT,
+    DOUBLE,
+    BOOL,
+    POINTER,
+    STRING
+};
+
+// One per trace call site, with static storage. Records refer to it by address, so the format string
+// is never copied.
+struct TraceSite
+{
+    TraceLevel level;
+    const char* format;  // "{}" marks where each argument goes
+    const char* file;
+    int line;
+};
+
+// Arguments are stored binary-encoded and only formatted by the flusher thread
+struct TraceRecord
+{
+    static constexpr uint32_t MAX_ARGS = 8;
+    static constexpr uint32_t PAYLOAD_SIZE = 96;
+
+    const TraceSite* site = nullptr;
+    int64_t timeNs = 0;
+    uint8_t argCount = 0;
+    TraceArgType argTypes[MAX_ARGS] = {};
+    uint16_t payloadSize = 0;
+    uint8_t payload[PAYLOAD_SIZE] = {};
+};
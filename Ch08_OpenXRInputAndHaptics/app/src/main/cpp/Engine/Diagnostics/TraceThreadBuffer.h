@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#include "TraceRecord.h"
+
+// Lock-free single-producer/single-consumer queue owned by one logging thread and drained by the flusher.
+// When it is full new records are dropped rather than blocking the producer.
+class TraceThreadBuffer
+{
+public:
+    static constexpr uint32_t CAPACITY = 512;  // Must be a power of two
+
+    explicit TraceThreadBuffer(uint32_t threadId) : m_ThreadId(threadId) {}
+
+    // Returns the slot to fill in, or nullptr when the buffer is full. Must be followed by EndWrite().
+    TraceRecord* BeginWrite()
+    {
+        const uint64_t writeIndex = m_WriteIndex.load(std::memory_order_relaxed);
+        if (writeIndex - m_ReadIndex.load(std::memory_order_acquire) >= CAPACITY)
+        {
+            m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &m_Records[writeIndex & (CAPACITY - 1)];
+    }
+
+    void EndWrite()
+    {
+        m_WriteIndex.store(m_WriteIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool TryRead(TraceRecord& record)
+    {
+        const uint64_t readIndex = m_ReadIndex.load(std::memory_order_relaxed);
+        if (readIndex == m_WriteIndex.load(std::memory_order_acquire)) return false;
+
+        record = m_Records[readIndex & (CAPACITY - 1)];
+        m_ReadIndex.store(readIndex + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint64_t GetDroppedCount() const { return m_DroppedCount.load(std::memory_order_relaxed); }
+    uint32_t GetThreadId() const { return m_ThreadId; }
+
+private:
+    TraceRecord m_Records[CAPACITY];
+    std::atomic<uint64_t> m_WriteIndex{0};
+    std::atomic<uint64_t> m_ReadIndex{0};
+    std::atomic<uint64_t> m_DroppedCount{0};
+    uint32_t m_ThreadId;
+};
@@ -0,0 +1,73 @@
+#include "BufferArena.h"
+#include <iterator>
+
+BufferArena::BufferArena(GraphicsAPI* graphicsAPI, GraphicsAPI::BufferCreateInfo::Type type, uint32_t stride, uint64_t capacity)
+    : m_GraphicsAPI(graphicsAPI), m_Type(type), m_Stride(stride), m_Capacity(capacity)
+{
+    GraphicsAPI::BufferCreateInfo bufferInfo;
+    bufferInfo.type = type;
+    bufferInfo.stride = stride;
+    bufferInfo.size = static_cast<size_t>(capacity * stride);
+    bufferInfo.data = nullptr;
+    m_Buffer = m_GraphicsAPI->CreateBuffer(bufferInfo);
+    m_FreeRanges[0] = capacity;
+}
+
+BufferArena::~BufferArena()
+{
+    if (m_Buffer)
+    {
+        m_GraphicsAPI->DestroyBuffer(m_Buffer);
+    }
+}
+
+bool BufferArena::Allocate(uint64_t count, const void* data, uint64_t& offset)
+{
+    if (count == 0) return false;
+
+    for (auto it = m_FreeRanges.begin(); it != m_FreeRanges.end(); ++it)
+    {
+        if (it->second < count) continue;
+
+        offset = it->first;
+        const uint64_t remaining = it->second - count;
+        m_FreeRanges.erase(it);
+        if (remaining > 0)
+        {
+            m_FreeRanges[offset + count] = remaining;
+        }
+        m_UsedCount += count;
+
+        if (data)
+        {
+            m_GraphicsAPI->SetBufferData(m_Buffer, static_cast<size_t>(offset * m_Stride), static_cast<size_t>(count * m_Stride), const_cast<void*>(data));
+        }
+        return true;
+    }
+    return false;
+}
+
+void BufferArena::Free(uint64_t offset, uint64_t count)
+{
+    if (count == 0) return;
+    m_UsedCount -= count;
+
+    uint64_t first = offset;
+    uint64_t last = offset + count;
+    auto next = m_FreeRanges.lower_bound(offset);
+    if (next != m_FreeRanges.end() && next->first == last)
+    {
+        last += next->second;
+        next = m_FreeRanges.erase(next);
+    }
+    if (next != m_FreeRanges.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == first)
+        {
+            first = previous->first;
+            m_FreeRanges.erase(previous);
+        }
+    }
+    m_FreeRanges[first] = last - first;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <GraphicsAPI.h>
+#include <cstdint>
+#include <map>
+
+// One large GPU buffer carved into ranges of equally sized elements. Ranges are addressed by their first element,
+// so many meshes can live in one vertex or index buffer and be drawn with DrawIndexed offsets.
+class BufferArena {
+public:
+    BufferArena(GraphicsAPI* graphicsAPI, GraphicsAPI::BufferCreateInfo::Type type, uint32_t stride, uint64_t capacity);
+    ~BufferArena();
+
+    BufferArena(const BufferArena&) = delete;
+    BufferArena& operator=(const BufferArena&) = delete;
+
+    // First fit. Copies count elements from data into the range when data is not null. Returns false when no free
+    // range is large enough.
+    bool Allocate(uint64_t count, const void* data, uint64_t& offset);
+    // Freed ranges are merged with their free neighbours
+    void Free(uint64_t offset, uint64_t count);
+
+    void* GetBuffer() const { return m_Buffer; }
+    GraphicsAPI::BufferCreateInfo::Type GetType() const { return m_Type; }
+    uint32_t GetStride() const { return m_Stride; }
+    uint64_t GetCapacity() const { return m_Capacity; }
+    uint64_t GetUsedCount() const { return m_UsedCount; }
+    bool IsEmpty() const { return m_UsedCount == 0; }
+
+private:
+    GraphicsAPI* m_GraphicsAPI;
+    GraphicsAPI::BufferCreateInfo::Type m_Type;
+    uint32_t m_Stride;
+    uint64_t m_Capacity;
+    uint64_t m_UsedCount = 0;
+    void* m_Buffer = nullptr;
+    std::map<uint64_t, uint64_t> m_FreeRanges;  // First element -> element count
+};
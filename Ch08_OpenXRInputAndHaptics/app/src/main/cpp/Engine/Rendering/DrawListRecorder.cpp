@@ -0,0 +1,204 @@
+#include "DrawListRecorder.h"
+#include "../../OpenXR/OpenXRCoreMgr.h"
+#include "../../OpenXR/OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
+#include <DebugOutput.h>
+#include <algorithm>
+
+uint32_t DrawListRecorder::m_RequestedThreadCount = 0;
+uint32_t DrawListRecorder::m_ThreadCount = 1;
+uint32_t DrawListRecorder::m_MinDrawsPerChunk = 64;
+bool DrawListRecorder::m_Collecting = false;
+std::vector<DrawCommand> DrawListRecorder::m_Draws;
+std::vector<std::thread> DrawListRecorder::m_Threads;
+std::mutex DrawListRecorder::m_Mutex;
+std::condition_variable DrawListRecorder::m_StartCondition;
+std::condition_variable DrawListRecorder::m_DoneCondition;
+bool DrawListRecorder::m_Running = false;
+uint64_t DrawListRecorder::m_Generation = 0;
+uint32_t DrawListRecorder::m_ChunkCount = 0;
+uint32_t DrawListRecorder::m_NextChunk = 0;
+uint32_t DrawListRecorder::m_PendingChunks = 0;
+
+void DrawListRecorder::Initialize()
+{
+    if (m_Running) return;
+
+    const uint32_t supportedThreadCount = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->GetRecordingThreadCount();
+    m_ThreadCount = std::max(std::min(m_RequestedThreadCount > 0 ? m_RequestedThreadCount : supportedThreadCount, supportedThreadCount), 1u);
+
+    m_Running = true;
+    for (uint32_t threadIndex = 1; threadIndex < m_ThreadCount; ++threadIndex)
+    {
+        m_Threads.emplace_back(&DrawListRecorder::WorkerLoop, threadIndex);
+    }
+    XR_TUT_LOG("DrawListRecorder: " << m_ThreadCount << " recording threads");
+}
+
+void DrawListRecorder::Shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Running = false;
+    }
+    m_StartCondition.notify_all();
+    for (std::thread& thread : m_Threads)
+    {
+        thread.join();
+    }
+    m_Threads.clear();
+    m_Draws.clear();
+    m_Collecting = false;
+    m_ThreadCount = 1;
+}
+
+void DrawListRecorder::BeginView()
+{
+    m_Collecting = m_ThreadCount > 1;
+    m_Draws.clear();
+}
+
+void DrawListRecorder::Submit(const DrawCommand& draw, const char* name)
+{
+    if (m_Collecting)
+    {
+        m_Draws.push_back(draw);
+        return;
+    }
+
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+    graphicsAPI->BeginGpuScope(name);
+    Record(draw);
+    graphicsAPI->EndGpuScope();
+}
+
+void DrawListRecorder::EndView()
+{
+    if (!m_Collecting) return;
+    m_Collecting = false;
+    if (m_Draws.empty()) return;
+
+    // Recording threads can't open GPU scopes, the chunks are timed together
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+    graphicsAPI->BeginGpuScope("Draws");
+
+    const uint32_t chunkCount = std::min(m_ThreadCount, static_cast<uint32_t>((m_Draws.size() + m_MinDrawsPerChunk - 1) / m_MinDrawsPerChunk));
+    if (chunkCount <= 1)
+    {
+        for (const DrawCommand& draw : m_Draws)
+        {
+            Record(draw);
+        }
+    }
+    else
+    {
+        graphicsAPI->BeginParallelRecording(chunkCount);
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_ChunkCount = chunkCount;
+            m_NextChunk = 0;
+            m_PendingChunks = chunkCount;
+            ++m_Generation;
+        }
+        m_StartCondition.notify_all();
+
+        // The calling thread takes chunks too, so a busy worker never holds up the list
+        RecordChunks(0);
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_DoneCondition.wait(lock, []() { return m_PendingChunks == 0; });
+        }
+        graphicsAPI->EndParallelRecording();
+    }
+
+    graphicsAPI->EndGpuScope();
+    m_Draws.clear();
+}
+
+void DrawListRecorder::Record(const DrawCommand& draw)
+{
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+
+    void* colorImages[] = {draw.colorImage};
+    graphicsAPI->SetRenderAttachments(colorImages, 1, draw.depthImage, draw.width, draw.height, draw.pipeline);
+
+    GraphicsAPI::Viewport viewport;
+    viewport.x = 0;
+    viewport.y = 0;
+    viewport.width = static_cast<float>(draw.width);
+    viewport.height = static_cast<float>(draw.height);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    graphicsAPI->SetViewports(&viewport, 1);
+
+    GraphicsAPI::Rect2D scissor = {{0, 0}, {draw.width, draw.height}};
+    graphicsAPI->SetScissors(&scissor, 1);
+
+    graphicsAPI->SetPipeline(draw.pipeline);
+
+    GraphicsAPI::DescriptorInfo objectDataDescriptor;
+    objectDataDescriptor.bindingIndex = 0;
+    objectDataDescriptor.resource = draw.uniformBuffer;
+    objectDataDescriptor.type = GraphicsAPI::DescriptorInfo::Type::BUFFER;
+    objectDataDescriptor.stage = GraphicsAPI::DescriptorInfo::Stage::VERTEX;
+    objectDataDescriptor.readWrite = false;
+    objectDataDescriptor.bufferOffset = draw.uniformOffset;
+    objectDataDescriptor.bufferSize = draw.uniformSize;
+    graphicsAPI->SetDescriptor(objectDataDescriptor);
+
+    graphicsAPI->UpdateDescriptors();
+
+    // Arena buffers are only rebound when the previous draw used a different arena
+    void* vertexBuffer = draw.vertexBuffer;
+    graphicsAPI->SetVertexBuffers(&vertexBuffer, 1);
+
+    graphicsAPI->SetIndexBuffer(draw.indexBuffer);
+
+    graphicsAPI->DrawIndexed(draw.indexCount, 1, draw.firstIndex, draw.vertexOffset);
+}
+
+void DrawListRecorder::RecordChunks(uint32_t threadIndex)
+{
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+    while (true)
+    {
+        uint32_t chunk = 0;
+        uint32_t chunkCount = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (m_NextChunk >= m_ChunkCount) return;
+            chunk = m_NextChunk++;
+            chunkCount = m_ChunkCount;
+        }
+
+        // Contiguous ranges executed one after the other keep the submission order
+        const size_t first = m_Draws.size() * chunk / chunkCount;
+        const size_t last = m_Draws.size() * (chunk + 1) / chunkCount;
+        graphicsAPI->BeginThreadRecording(threadIndex, chunk);
+        for (size_t i = first; i < last; ++i)
+        {
+            Record(m_Draws[i]);
+        }
+        graphicsAPI->EndThreadRecording();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (--m_PendingChunks == 0)
+        {
+            m_DoneCondition.notify_one();
+        }
+    }
+}
+
+void DrawListRecorder::WorkerLoop(uint32_t threadIndex)
+{
+    uint64_t generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_StartCondition.wait(lock, [&generation]() { return !m_Running || m_Generation != generation; });
+            if (!m_Running) return;
+            generation = m_Generation;
+        }
+        RecordChunks(threadIndex);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Everything needed to record one draw, resolved on the main thread so recording threads only call the graphics API
+struct DrawCommand {
+    void* pipeline = nullptr;
+    void* colorImage = nullptr;
+    void* depthImage = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    void* uniformBuffer = nullptr;  // Bound at binding 0 of the vertex stage
+    uint32_t uniformOffset = 0;     // A multiple of GraphicsAPI::GetUniformBufferOffsetAlignment()
+    uint32_t uniformSize = 0;
+    void* vertexBuffer = nullptr;
+    void* indexBuffer = nullptr;
+    int32_t vertexOffset = 0;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+};
+
+// Records the draws of a view on several threads. Draws submitted between BeginView and EndView are collected, and
+// EndView splits them into contiguous chunks recorded in parallel into secondary command buffers, which the graphics
+// API then executes in submission order. With one thread, or a backend without parallel recording, draws are recorded
+// as they are submitted.
+class DrawListRecorder {
+public:
+    // 0 uses as many threads as the graphics API can record with. Applies to the next Initialize.
+    static void SetThreadCount(uint32_t threadCount) { m_RequestedThreadCount = threadCount; }
+    static void Initialize();
+    static void Shutdown();
+
+    // Recording threads, the calling thread included
+    static uint32_t GetThreadCount() { return m_ThreadCount; }
+
+    static void BeginView();
+    static void Submit(const DrawCommand& draw, const char* name);
+    static void EndView();
+
+    // Smaller lists use fewer chunks, a chunk costs a command buffer and a thread handoff
+    static void SetMinDrawsPerChunk(uint32_t drawCount) { m_MinDrawsPerChunk = drawCount > 0 ? drawCount : 1; }
+
+private:
+    static void Record(const DrawCommand& draw);
+    static void RecordChunks(uint32_t threadIndex);
+    static void WorkerLoop(uint32_t threadIndex);
+
+    static uint32_t m_RequestedThreadCount;
+    static uint32_t m_ThreadCount;
+    static uint32_t m_MinDrawsPerChunk;
+    static bool m_Collecting;
+    static std::vector<DrawCommand> m_Draws;
+
+    static std::vector<std::thread> m_Threads;
+    static std::mutex m_Mutex;
+    static std::condition_variable m_StartCondition;
+    static std::condition_variable m_DoneCondition;
+    static bool m_Running;
+    static uint64_t m_Generation;  // Bumped for every list, wakes the workers
+    static uint32_t m_ChunkCount;
+    static uint32_t m_NextChunk;
+    static uint32_t m_PendingChunks;
+};
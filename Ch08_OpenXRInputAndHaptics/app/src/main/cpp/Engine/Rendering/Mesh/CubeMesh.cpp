@@ -1,8 +1,14 @@
 ﻿#include "CubeMesh.h"
+#include "MeshOptimizer.h"
+#include "../../Diagnostics/TraceLogMgr.h"
 
 CubeMesh::CubeMesh(float size)
 {
     GenerateCubeData(size);
+
+    // The faces are generated as 36 separate vertices; welding shares the corners within each face
+    const MeshOptimizer::Report report = MeshOptimizer::Optimize(m_verticesWithNormals, m_indices);
+    XR_TRACE_VERBOSE("CubeMesh: {} -> {} vertices, ACMR {} -> {}", report.vertexCountBefore, report.vertexCountAfter, report.acmrBefore, report.acmrAfter);
 }
 
 void CubeMesh::GenerateCubeData(float size)
@@ -0,0 +1,401 @@
+﻿#include "GltfImporter.h"
+#include "../../Utils/Json.h"
+#include <DebugOutput.h>
+#include <xr_linear_algebra.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    const uint32_t GLB_MAGIC = 0x46546C67;       // "glTF"
+    const uint32_t GLB_CHUNK_JSON = 0x4E4F534A;  // "JSON"
+    const uint32_t GLB_CHUNK_BIN = 0x004E4942;   // "BIN\0"
+
+    const int COMPONENT_BYTE = 5120;
+    const int COMPONENT_UNSIGNED_BYTE = 5121;
+    const int COMPONENT_SHORT = 5122;
+    const int COMPONENT_UNSIGNED_SHORT = 5123;
+    const int COMPONENT_UNSIGNED_INT = 5125;
+    const int COMPONENT_FLOAT = 5126;
+
+    const int MODE_TRIANGLES = 4;
+
+    struct GltfDocument
+    {
+        JsonValue json;
+        std::vector<std::vector<uint8_t>> buffers;
+    };
+
+    bool ReadFile(const std::string& filePath, std::vector<uint8_t>& data)
+    {
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return false;
+
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        return file.good() || file.eof();
+    }
+
+    std::string GetDirectory(const std::string& filePath)
+    {
+        const size_t separator = filePath.find_last_of("/\\");
+        return separator == std::string::npos ? std::string() : filePath.substr(0, separator + 1);
+    }
+
+    bool DecodeBase64(const std::string& text, size_t start, std::vector<uint8_t>& data)
+    {
+        uint32_t accumulator = 0;
+        int bitCount = 0;
+        for (size_t i = start; i < text.size() && text[i] != '='; ++i)
+        {
+            const char c = text[i];
+            uint32_t value;
+            if (c >= 'A' && c <= 'Z') value = c - 'A';
+            else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+            else if (c >= '0' && c <= '9') value = c - '0' + 52;
+            else if (c == '+') value = 62;
+            else if (c == '/') value = 63;
+            else return false;
+
+            accumulator = (accumulator << 6) | value;
+            bitCount += 6;
+            if (bitCount >= 8)
+            {
+                bitCount -= 8;
+                data.push_back(static_cast<uint8_t>((accumulator >> bitCount) & 0xFF));
+            }
+        }
+        return true;
+    }
+
+    bool LoadBuffers(const std::string& filePath, const std::vector<uint8_t>& glbBinaryChunk, GltfDocument& document)
+    {
+        const JsonValue* buffers = document.json.Find("buffers");
+        if (!buffers) return true;
+
+        for (const JsonValue& buffer : buffers->array)
+        {
+            document.buffers.emplace_back();
+            std::vector<uint8_t>& data = document.buffers.back();
+
+            const JsonValue* uri = buffer.Find("uri");
+            if (!uri)
+            {
+                // The buffer without a URI is the binary chunk of a .glb
+                data = glbBinaryChunk;
+            }
+            else if (uri->string.compare(0, 5, "data:") == 0)
+            {
+                const size_t comma = uri->string.find(";base64,");
+                if (comma == std::string::npos || !DecodeBase64(uri->string, comma + 8, data))
+                {
+                    XR_TUT_LOG_ERROR("GltfImporter: unsupported data URI in " << filePath);
+                    return false;
+                }
+            }
+            else if (!ReadFile(GetDirectory(filePath) + uri->string, data))
+            {
+                XR_TUT_LOG_ERROR("GltfImporter: failed to read buffer " << uri->string << " of " << filePath);
+                return false;
+            }
+
+            if (data.size() < static_cast<size_t>(buffer.GetNumber("byteLength")))
+            {
+                XR_TUT_LOG_ERROR("GltfImporter: buffer shorter than its byteLength in " << filePath);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ParseDocument(const std::string& filePath, const std::vector<uint8_t>& fileData, GltfDocument& document)
+    {
+        const char* json = reinterpret_cast<const char*>(fileData.data());
+        size_t jsonLength = fileData.size();
+        std::vector<uint8_t> binaryChunk;
+
+        uint32_t magic = 0;
+        if (fileData.size() >= 12) std::memcpy(&magic, fileData.data(), 4);
+        if (magic == GLB_MAGIC)
+        {
+            // 12 byte header, then chunks of [length, type, data padded to 4 bytes]; JSON comes first
+            size_t offset = 12;
+            jsonLength = 0;
+            while (offset + 8 <= fileData.size())
+            {
+                uint32_t chunkLength, chunkType;
+                std::memcpy(&chunkLength, fileData.data() + offset, 4);
+                std::memcpy(&chunkType, fileData.data() + offset + 4, 4);
+                offset += 8;
+                if (chunkLength > fileData.size() - offset) break;
+
+                if (chunkType == GLB_CHUNK_JSON && jsonLength == 0)
+                {
+                    json = reinterpret_cast<const char*>(fileData.data() + offset);
+                    jsonLength = chunkLength;
+                }
+                else if (chunkType == GLB_CHUNK_BIN && binaryChunk.empty())
+                {
+                    binaryChunk.assign(fileData.data() + offset, fileData.data() + offset + chunkLength);
+                }
+                offset += (chunkLength + 3) & ~3u;
+            }
+        }
+
+        if (!JsonValue::Parse(json, jsonLength, document.json) || !document.json.IsObject())
+        {
+            XR_TUT_LOG_ERROR("GltfImporter: malformed JSON in " << filePath);
+            return false;
+        }
+        return LoadBuffers(filePath, binaryChunk, document);
+    }
+
+    size_t GetComponentCount(const std::string& type)
+    {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4") return 4;
+        return 0;
+    }
+
+    size_t GetComponentSize(int componentType)
+    {
+        switch (componentType)
+        {
+        case COMPONENT_BYTE:
+        case COMPONENT_UNSIGNED_BYTE: return 1;
+        case COMPONENT_SHORT:
+        case COMPONENT_UNSIGNED_SHORT: return 2;
+        case COMPONENT_UNSIGNED_INT:
+        case COMPONENT_FLOAT: return 4;
+        default: return 0;
+        }
+    }
+
+    float ReadComponent(const uint8_t* data, int componentType, bool normalized)
+    {
+        switch (componentType)
+        {
+        case COMPONENT_FLOAT: { float v; std::memcpy(&v, data, 4); return v; }
+        case COMPONENT_UNSIGNED_INT: { uint32_t v; std::memcpy(&v, data, 4); return static_cast<float>(v); }
+        case COMPONENT_UNSIGNED_SHORT: { uint16_t v; std::memcpy(&v, data, 2); return normalized ? v / 65535.0f : v; }
+        case COMPONENT_SHORT: { int16_t v; std::memcpy(&v, data, 2); return normalized ? std::max(v / 32767.0f, -1.0f) : v; }
+        case COMPONENT_UNSIGNED_BYTE: return normalized ? data[0] / 255.0f : data[0];
+        case COMPONENT_BYTE: { const int8_t v = static_cast<int8_t>(data[0]); return normalized ? std::max(v / 127.0f, -1.0f) : v; }
+        default: return 0.0f;
+        }
+    }
+
+    // Finds the first element of an accessor and checks count elements fit inside its buffer view.
+    // data is left null when the accessor has no buffer view, which means all zeros
+    bool LocateAccessorData(const GltfDocument& document, const JsonValue& accessor, size_t elementSize, size_t count, const uint8_t*& data, size_t& stride)
+    {
+        data = nullptr;
+        stride = elementSize;
+        const JsonValue* bufferViewIndex = accessor.Find("bufferView");
+        if (!bufferViewIndex) return true;
+
+        const JsonValue* bufferViews = document.json.Find("bufferViews");
+        if (!bufferViews || static_cast<size_t>(bufferViewIndex->number) >= bufferViews->array.size()) return false;
+
+        const JsonValue& bufferView = (*bufferViews)[static_cast<size_t>(bufferViewIndex->number)];
+        const size_t bufferIndex = static_cast<size_t>(bufferView.GetNumber("buffer"));
+        if (bufferIndex >= document.buffers.size()) return false;
+
+        const std::vector<uint8_t>& buffer = document.buffers[bufferIndex];
+        if (bufferView.Find("byteStride")) stride = static_cast<size_t>(bufferView.GetNumber("byteStride"));
+        const size_t viewOffset = static_cast<size_t>(bufferView.GetNumber("byteOffset"));
+        const size_t viewLength = static_cast<size_t>(bufferView.GetNumber("byteLength"));
+        const size_t accessorOffset = static_cast<size_t>(accessor.GetNumber("byteOffset"));
+
+        if (count > 0 && (viewOffset + viewLength > buffer.size() || accessorOffset + (count - 1) * stride + elementSize > viewLength)) return false;
+
+        data = buffer.data() + viewOffset + accessorOffset;
+        return true;
+    }
+
+    // Reads an accessor as rows of componentCount floats (or integers converted to float)
+    bool ReadAccessor(const GltfDocument& document, size_t accessorIndex, size_t expectedComponentCount, std::vector<float>& values, size_t& count)
+    {
+        const JsonValue* accessors = document.json.Find("accessors");
+        if (!accessors || accessorIndex >= accessors->array.size()) return false;
+
+        const JsonValue& accessor = (*accessors)[accessorIndex];
+        const int componentType = static_cast<int>(accessor.GetNumber("componentType"));
+        const size_t componentCount = GetComponentCount(accessor.GetString("type"));
+        const size_t componentSize = GetComponentSize(componentType);
+        const bool normalized = accessor.Find("normalized") && accessor.Find("normalized")->number != 0.0;
+        count = static_cast<size_t>(accessor.GetNumber("count"));
+        if (componentCount != expectedComponentCount || componentSize == 0) return false;
+
+        values.assign(count * componentCount, 0.0f);
+        const uint8_t* data = nullptr;
+        size_t stride = 0;
+        if (!LocateAccessorData(document, accessor, componentSize * componentCount, count, data, stride)) return false;
+        if (!data) return true;
+
+        for (size_t element = 0; element < count; ++element)
+        {
+            for (size_t component = 0; component < componentCount; ++component)
+            {
+                values[element * componentCount + component] = ReadComponent(data + element * stride + component * componentSize, componentType, normalized);
+            }
+        }
+        return true;
+    }
+
+    bool ReadIndices(const GltfDocument& document, size_t accessorIndex, std::vector<uint32_t>& indices)
+    {
+        // Indices are read separately so 32 bit values don't go through float
+        const JsonValue* accessors = document.json.Find("accessors");
+        if (!accessors || accessorIndex >= accessors->array.size()) return false;
+
+        const JsonValue& accessor = (*accessors)[accessorIndex];
+        const int componentType = static_cast<int>(accessor.GetNumber("componentType"));
+        if (componentType == COMPONENT_UNSIGNED_INT)
+        {
+            if (accessor.GetString("type") != "SCALAR") return false;
+
+            const size_t count = static_cast<size_t>(accessor.GetNumber("count"));
+            const uint8_t* data = nullptr;
+            size_t stride = 0;
+            if (!LocateAccessorData(document, accessor, 4, count, data, stride)) return false;
+
+            indices.assign(count, 0);
+            if (!data) return true;
+            for (size_t i = 0; i < count; ++i)
+            {
+                std::memcpy(&indices[i], data + i * stride, 4);
+            }
+            return true;
+        }
+
+        std::vector<float> values;
+        size_t count = 0;
+        if (!ReadAccessor(document, accessorIndex, 1, values, count)) return false;
+        indices.assign(values.begin(), values.end());
+        return true;
+    }
+
+    void GenerateNormals(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t firstVertex, size_t firstIndex)
+    {
+        // Area weighted average of the adjacent face normals
+        for (size_t i = firstIndex; i + 2 < indices.size(); i += 3)
+        {
+            Vertex& a = vertices[indices[i]];
+            Vertex& b = vertices[indices[i + 1]];
+            Vertex& c = vertices[indices[i + 2]];
+            XrVector3f ab = {b.position.x - a.position.x, b.position.y - a.position.y, b.position.z - a.position.z};
+            XrVector3f ac = {c.position.x - a.position.x, c.position.y - a.position.y, c.position.z - a.position.z};
+            XrVector3f faceNormal;
+            XrVector3f_Cross(&faceNormal, &ab, &ac);
+            for (Vertex* vertex : {&a, &b, &c})
+            {
+                XrVector3f_Add(&vertex->normal, &vertex->normal, &faceNormal);
+            }
+        }
+        for (size_t i = firstVertex; i < vertices.size(); ++i)
+        {
+            // Unreferenced or degenerate vertices keep a zero normal instead of NaNs
+            if (XrVector3f_Length(&vertices[i].normal) > 0.0f) XrVector3f_Normalize(&vertices[i].normal);
+        }
+    }
+
+    bool ImportPrimitive(const GltfDocument& document, const JsonValue& primitive, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+    {
+        const JsonValue* attributes = primitive.Find("attributes");
+        const JsonValue* positionAccessor = attributes ? attributes->Find("POSITION") : nullptr;
+        if (!positionAccessor) return false;
+
+        std::vector<float> positions;
+        size_t vertexCount = 0;
+        if (!ReadAccessor(document, static_cast<size_t>(positionAccessor->number), 3, positions, vertexCount)) return false;
+
+        std::vector<float> normals;
+        const JsonValue* normalAccessor = attributes->Find("NORMAL");
+        size_t normalCount = 0;
+        const bool hasNormals = normalAccessor && ReadAccessor(document, static_cast<size_t>(normalAccessor->number), 3, normals, normalCount) &&
+                                normalCount == vertexCount;
+
+        const size_t firstVertex = vertices.size();
+        const size_t firstIndex = indices.size();
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            vertices.emplace_back(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2],
+                                  hasNormals ? normals[i * 3] : 0.0f, hasNormals ? normals[i * 3 + 1] : 0.0f, hasNormals ? normals[i * 3 + 2] : 0.0f);
+        }
+
+        std::vector<uint32_t> primitiveIndices;
+        const JsonValue* indicesAccessor = primitive.Find("indices");
+        if (indicesAccessor)
+        {
+            if (!ReadIndices(document, static_cast<size_t>(indicesAccessor->number), primitiveIndices)) return false;
+        }
+        else
+        {
+            for (uint32_t i = 0; i < vertexCount; ++i) primitiveIndices.push_back(i);
+        }
+
+        for (uint32_t index : primitiveIndices)
+        {
+            if (index >= vertexCount) return false;
+            indices.push_back(static_cast<uint32_t>(firstVertex) + index);
+        }
+        indices.resize(firstIndex + (indices.size() - firstIndex) / 3 * 3);
+
+        if (!hasNormals)
+        {
+            GenerateNormals(vertices, indices, firstVertex, firstIndex);
+        }
+        return true;
+    }
+}
+
+bool GltfImporter::Import(const std::string& filePath, std::vector<std::shared_ptr<StaticMesh>>& meshes)
+{
+    std::vector<uint8_t> fileData;
+    if (!ReadFile(filePath, fileData))
+    {
+        XR_TUT_LOG_ERROR("GltfImporter: failed to read " << filePath);
+        return false;
+    }
+
+    GltfDocument document;
+    if (!ParseDocument(filePath, fileData, document)) return false;
+
+    const JsonValue* gltfMeshes = document.json.Find("meshes");
+    if (!gltfMeshes || gltfMeshes->array.empty())
+    {
+        XR_TUT_LOG_ERROR("GltfImporter: no meshes in " << filePath);
+        return false;
+    }
+
+    for (const JsonValue& gltfMesh : gltfMeshes->array)
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+
+        const JsonValue* primitives = gltfMesh.Find("primitives");
+        for (size_t i = 0; primitives && i < primitives->array.size(); ++i)
+        {
+            const JsonValue& primitive = primitives->array[i];
+            if (static_cast<int>(primitive.GetNumber("mode", MODE_TRIANGLES)) != MODE_TRIANGLES)
+            {
+                XR_TUT_LOG("GltfImporter: skipping non-triangle primitive of mesh " << gltfMesh.GetString("name"));
+                continue;
+            }
+            if (!ImportPrimitive(document, primitive, vertices, indices))
+            {
+                XR_TUT_LOG_ERROR("GltfImporter: invalid primitive " << i << " of mesh " << gltfMesh.GetString("name") << " in " << filePath);
+                return false;
+            }
+        }
+
+        meshes.push_back(std::make_shared<StaticMesh>(std::move(vertices), std::move(indices)));
+    }
+    return true;
+}
@@ -0,0 +1,15 @@
+﻿#pragma once
+
+#include "StaticMesh.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Loads the triangle meshes of a glTF 2.0 asset (.gltf with external or embedded buffers, or .glb).
+// All triangle primitives of a glTF mesh are merged into one StaticMesh. Only POSITION and NORMAL are read;
+// normals are generated when missing. Node transforms, sparse accessors and compression extensions
+// are not supported.
+class GltfImporter {
+public:
+    static bool Import(const std::string& filePath, std::vector<std::shared_ptr<StaticMesh>>& meshes);
+};
@@ -1,8 +1,20 @@
 ﻿#pragma once
 
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <openxr/openxr.h>
 #include "../Vertex.h"
+#include "../VertexLayout.h"
+
+class IMesh;
+
+// A coarser version of a mesh. It is used while the mesh's projected bounding sphere diameter, as a fraction of
+// the view's vertical extent, is below maxScreenSize (see LodSelector).
+struct MeshLod {
+    std::shared_ptr<IMesh> mesh;
+    float maxScreenSize;
+};
 
 class IMesh {
 public:
@@ -13,4 +25,23 @@ public:
     
     virtual uint64_t GetVertexCount() const = 0;
     virtual uint64_t GetIndexCount() const = 0;
+
+    // Layout of the buffer returned by GetVertexData(). Meshes with packed vertices override it.
+    virtual const VertexLayout& GetVertexLayout() const { return VertexLayout::GetStandard(); }
+
+    // Raw buffer contents for uploading. Meshes that don't keep their data in vectors, such as ones mapped
+    // from a cache file, override these.
+    virtual const void* GetVertexData() const { return GetVerticesWithNormals().data(); }
+    virtual const uint32_t* GetIndexData() const { return GetIndices().data(); }
+    // The indices in 16 bits, for meshes that store them that way; nullptr when they only exist in 32 bits
+    virtual const uint16_t* GetShortIndexData() const { return nullptr; }
+
+    uint64_t GetVertexDataSize() const { return GetVertexCount() * GetVertexLayout().stride; }
+
+    // Levels of detail below the mesh itself, finest first (see MeshSimplifier::GenerateLods)
+    const std::vector<MeshLod>& GetLods() const { return m_Lods; }
+    void SetLods(std::vector<MeshLod> lods) { m_Lods = std::move(lods); }
+
+private:
+    std::vector<MeshLod> m_Lods;
 };
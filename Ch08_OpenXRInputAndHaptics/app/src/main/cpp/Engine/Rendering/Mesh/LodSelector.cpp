@@ -0,0 +1,45 @@
+﻿#include "LodSelector.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+float LodSelector::ComputeScreenSize(const XrVector3f& boundsCenter, float boundsRadius, const XrMatrix4x4f& modelMatrix, const XrMatrix4x4f& viewMatrix,
+                                     const XrFovf& fov)
+{
+    XrMatrix4x4f modelViewMatrix;
+    XrMatrix4x4f_Multiply(&modelViewMatrix, &viewMatrix, &modelMatrix);
+    XrVector3f viewCenter;
+    XrMatrix4x4f_TransformVector3f(&viewCenter, &modelViewMatrix, &boundsCenter);
+
+    // The largest axis scale bounds the scaled sphere
+    float scale = 0.0f;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float* column = &modelMatrix.m[axis * 4];
+        scale = std::max(scale, std::sqrt(column[0] * column[0] + column[1] * column[1] + column[2] * column[2]));
+    }
+    const float radius = boundsRadius * scale;
+
+    // Views look down -Z
+    const float depth = -viewCenter.z;
+    const float viewHeight = std::tan(fov.angleUp) - std::tan(fov.angleDown);
+    if (std::fabs(depth) <= radius || viewHeight <= 0.0f) return FLT_MAX;
+    // Entirely behind the viewer: nothing of it is visible, so the coarsest level will do
+    if (depth < 0.0f) return 0.0f;
+
+    return 2.0f * radius / (depth * viewHeight);
+}
+
+size_t LodSelector::SelectLevel(const std::vector<MeshLod>& lods, float screenSize, size_t currentLevel, float hysteresis)
+{
+    size_t level = std::min(currentLevel, lods.size());
+    while (level < lods.size() && screenSize < lods[level].maxScreenSize * (1.0f - hysteresis))
+    {
+        ++level;
+    }
+    while (level > 0 && screenSize > lods[level - 1].maxScreenSize * (1.0f + hysteresis))
+    {
+        --level;
+    }
+    return level;
+}
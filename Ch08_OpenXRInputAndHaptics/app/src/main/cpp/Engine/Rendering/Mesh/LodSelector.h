@@ -0,0 +1,17 @@
+﻿#pragma once
+
+#include "IMesh.h"
+#include <xr_linear_algebra.h>
+
+// Picks a mesh's level of detail from the size of its bounding sphere projected into a view
+class LodSelector {
+public:
+    // Projected bounding sphere diameter as a fraction of the FOV's vertical extent. Very large when the viewer
+    // is inside the sphere and 0 when the sphere is entirely behind the viewer.
+    static float ComputeScreenSize(const XrVector3f& boundsCenter, float boundsRadius, const XrMatrix4x4f& modelMatrix, const XrMatrix4x4f& viewMatrix,
+                                   const XrFovf& fov);
+
+    // Level 0 is the mesh itself and level i > 0 is lods[i - 1]. The level only changes once screenSize is past a
+    // threshold by the hysteresis fraction, so objects hovering around a threshold don't pop back and forth.
+    static size_t SelectLevel(const std::vector<MeshLod>& lods, float screenSize, size_t currentLevel, float hysteresis = 0.1f);
+};
@@ -0,0 +1,79 @@
+﻿#include "MappedMesh.h"
+#include "../VertexPacker.h"
+
+MappedMesh::MappedMesh(std::shared_ptr<MappedFile> file, const MeshCacheHeader& header)
+    : m_File(std::move(file)), m_Header(header)
+{
+    m_Layout.stride = m_Header.vertexStride;
+    for (uint32_t i = 0; i < m_Header.attributeCount; ++i)
+    {
+        const MeshCacheHeader::Attribute& attribute = m_Header.attributes[i];
+        m_Layout.attributes.push_back({static_cast<VertexSemantic>(attribute.semantic), static_cast<GraphicsAPI::VertexType>(attribute.type), attribute.offset});
+    }
+
+    // Each level reads its own blocks of the file, through a header describing just them
+    std::vector<MeshLod> lods;
+    for (uint32_t i = 0; i < m_Header.lodCount; ++i)
+    {
+        const MeshCacheHeader::Lod& lod = m_Header.lods[i];
+        MeshCacheHeader lodHeader = m_Header;
+        lodHeader.vertexCount = lod.vertexCount;
+        lodHeader.indexCount = lod.indexCount;
+        lodHeader.vertexOffset = lod.vertexOffset;
+        lodHeader.indexOffset = lod.indexOffset;
+        lodHeader.lodCount = 0;
+        lods.push_back({std::make_shared<MappedMesh>(m_File, lodHeader), lod.maxScreenSize});
+    }
+    SetLods(std::move(lods));
+}
+
+const void* MappedMesh::GetVertexData() const
+{
+    return m_File->GetData() + m_Header.vertexOffset;
+}
+
+const uint32_t* MappedMesh::GetIndexData() const
+{
+    if (m_Header.indexStride == sizeof(uint16_t))
+    {
+        return GetIndices().data();
+    }
+    return reinterpret_cast<const uint32_t*>(m_File->GetData() + m_Header.indexOffset);
+}
+
+const uint16_t* MappedMesh::GetShortIndexData() const
+{
+    if (m_Header.indexStride != sizeof(uint16_t))
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<const uint16_t*>(m_File->GetData() + m_Header.indexOffset);
+}
+
+const std::vector<Vertex>& MappedMesh::GetVerticesWithNormals() const
+{
+    std::call_once(m_VertexCopyOnce, [this]()
+    {
+        VertexPacker::Unpack(m_File->GetData() + m_Header.vertexOffset, static_cast<size_t>(m_Header.vertexCount), m_Layout, m_VertexCopy);
+    });
+    return m_VertexCopy;
+}
+
+const std::vector<uint32_t>& MappedMesh::GetIndices() const
+{
+    std::call_once(m_IndexCopyOnce, [this]()
+    {
+        const uint8_t* indexData = m_File->GetData() + m_Header.indexOffset;
+        if (m_Header.indexStride == sizeof(uint16_t))
+        {
+            const uint16_t* shortIndices = reinterpret_cast<const uint16_t*>(indexData);
+            m_IndexCopy.assign(shortIndices, shortIndices + m_Header.indexCount);
+        }
+        else
+        {
+            const uint32_t* indices = reinterpret_cast<const uint32_t*>(indexData);
+            m_IndexCopy.assign(indices, indices + m_Header.indexCount);
+        }
+    });
+    return m_IndexCopy;
+}
@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#include "IMesh.h"
+#include "MeshCacheFormat.h"
+#include "../../Utils/MappedFile.h"
+#include <memory>
+#include <mutex>
+
+// Mesh whose buffers live in a memory mapped cache file. Uploading reads straight from the mapping; the
+// vector accessors copy the data out on first use only, which any thread may trigger. Indices stored in
+// 16 bits are widened into the same copy for GetIndexData. The levels of detail stored in the file are mapped
+// meshes too, sharing the mapping, and are returned by GetLods().
+class MappedMesh : public IMesh {
+public:
+    MappedMesh(std::shared_ptr<MappedFile> file, const MeshCacheHeader& header);
+
+    const std::vector<Vertex>& GetVerticesWithNormals() const override;
+    const std::vector<uint32_t>& GetIndices() const override;
+
+    uint64_t GetVertexCount() const override { return m_Header.vertexCount; }
+    uint64_t GetIndexCount() const override { return m_Header.indexCount; }
+
+    const VertexLayout& GetVertexLayout() const override { return m_Layout; }
+    const void* GetVertexData() const override;
+    const uint32_t* GetIndexData() const override;
+    const uint16_t* GetShortIndexData() const override;
+
+    const MeshCacheHeader& GetHeader() const { return m_Header; }
+
+private:
+    std::shared_ptr<MappedFile> m_File;
+    MeshCacheHeader m_Header;
+    VertexLayout m_Layout;
+    mutable std::vector<Vertex> m_VertexCopy;
+    mutable std::vector<uint32_t> m_IndexCopy;
+    mutable std::once_flag m_VertexCopyOnce;
+    mutable std::once_flag m_IndexCopyOnce;
+};
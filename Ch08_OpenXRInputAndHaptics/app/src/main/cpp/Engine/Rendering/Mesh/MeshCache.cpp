@@ -0,0 +1,314 @@
+﻿#include "MeshCache.h"
+#include "GltfImporter.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "PackedMesh.h"
+#include <DebugOutput.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace
+{
+    uint64_t AlignUp(uint64_t value, uint64_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    bool GetSourceStamp(const std::string& filePath, uint64_t& size, int64_t& modifiedTime)
+    {
+        struct stat fileStat;
+        if (stat(filePath.c_str(), &fileStat) != 0) return false;
+
+        size = static_cast<uint64_t>(fileStat.st_size);
+        modifiedTime = static_cast<int64_t>(fileStat.st_mtime);
+        return true;
+    }
+
+    // Distinguishes the temporary files of writers that store the same cache at the same time
+    std::atomic<uint32_t> temporaryFileCounter{0};
+
+    bool IsValidBlock(uint64_t offset, uint64_t count, uint64_t stride, size_t fileSize)
+    {
+        if (offset < sizeof(MeshCacheHeader) || offset % MeshCacheHeader::DATA_ALIGNMENT != 0) return false;
+        // Written this way so huge counts from a corrupt file can't overflow the check
+        return count <= (fileSize - std::min<uint64_t>(offset, fileSize)) / stride;
+    }
+
+    bool IsValidHeader(const MeshCacheHeader& header, size_t fileSize)
+    {
+        if (header.magic != MeshCacheHeader::MAGIC || header.version != MeshCacheHeader::VERSION) return false;
+        const bool validIndexStride = header.indexStride == sizeof(uint32_t) ||
+                                      (header.indexStride == sizeof(uint16_t) && MeshOptimizer::CanUse16BitIndices(header.vertexCount));
+        if (header.vertexStride == 0 || !validIndexStride || header.attributeCount > MeshCacheHeader::MAX_ATTRIBUTES) return false;
+        for (uint32_t i = 0; i < header.attributeCount; ++i)
+        {
+            const MeshCacheHeader::Attribute& attribute = header.attributes[i];
+            const uint32_t typeSize = VertexLayout::GetTypeSize(static_cast<GraphicsAPI::VertexType>(attribute.type));
+            if (attribute.semantic > static_cast<uint8_t>(VertexSemantic::TEXCOORD0) || typeSize == 0 || attribute.offset + typeSize > header.vertexStride)
+                return false;
+        }
+
+        if (!IsValidBlock(header.vertexOffset, header.vertexCount, header.vertexStride, fileSize) ||
+            !IsValidBlock(header.indexOffset, header.indexCount, header.indexStride, fileSize) || header.lodCount > MeshCacheHeader::MAX_LODS)
+            return false;
+        for (uint32_t i = 0; i < header.lodCount; ++i)
+        {
+            const MeshCacheHeader::Lod& lod = header.lods[i];
+            if (!IsValidBlock(lod.vertexOffset, lod.vertexCount, header.vertexStride, fileSize) ||
+                !IsValidBlock(lod.indexOffset, lod.indexCount, header.indexStride, fileSize) ||
+                (header.indexStride == sizeof(uint16_t) && !MeshOptimizer::CanUse16BitIndices(lod.vertexCount)))
+                return false;
+        }
+        return true;
+    }
+
+    // Index data of a mesh in the stride of the cache file
+    const char* GetIndexData(const IMesh& mesh, uint32_t indexStride, std::vector<uint16_t>& shortIndices)
+    {
+        if (indexStride == sizeof(uint16_t))
+        {
+            shortIndices = MeshOptimizer::To16BitIndices(mesh.GetIndexData(), static_cast<size_t>(mesh.GetIndexCount()));
+            return reinterpret_cast<const char*>(shortIndices.data());
+        }
+        return reinterpret_cast<const char*>(mesh.GetIndexData());
+    }
+}
+
+std::shared_ptr<MappedMesh> MeshCache::Load(const std::string& cachePath)
+{
+    std::unique_ptr<MappedFile> file(new MappedFile());
+    if (!file->Open(cachePath) || file->GetSize() < sizeof(MeshCacheHeader)) return nullptr;
+
+    MeshCacheHeader header;
+    std::copy(file->GetData(), file->GetData() + sizeof(MeshCacheHeader), reinterpret_cast<uint8_t*>(&header));
+    if (!IsValidHeader(header, file->GetSize()))
+    {
+        XR_TUT_LOG_ERROR("MeshCache: invalid or outdated cache file " << cachePath);
+        return nullptr;
+    }
+
+    return std::make_shared<MappedMesh>(std::move(file), header);
+}
+
+bool MeshCache::Write(const std::string& cachePath, const IMesh& mesh, uint64_t sourceSize, int64_t sourceModifiedTime, uint32_t lodLevelLimit)
+{
+    const VertexLayout& layout = mesh.GetVertexLayout();
+    if (layout.attributes.size() > MeshCacheHeader::MAX_ATTRIBUTES)
+    {
+        XR_TUT_LOG_ERROR("MeshCache: vertex layout of " << cachePath << " has too many attributes");
+        return false;
+    }
+
+    // The mesh followed by its levels of detail, finest first
+    std::vector<const IMesh*> levels = {&mesh};
+    for (const MeshLod& lod : mesh.GetLods())
+    {
+        if (levels.size() > MeshCacheHeader::MAX_LODS) break;
+        if (lod.mesh->GetVertexLayout() != layout)
+        {
+            XR_TUT_LOG_ERROR("MeshCache: levels of detail of " << cachePath << " are in another vertex layout than the mesh");
+            return false;
+        }
+        levels.push_back(lod.mesh.get());
+    }
+
+    MeshCacheHeader header;
+    header.vertexStride = layout.stride;
+    header.attributeCount = static_cast<uint32_t>(layout.attributes.size());
+    for (uint32_t i = 0; i < header.attributeCount; ++i)
+    {
+        header.attributes[i] = {static_cast<uint8_t>(layout.attributes[i].semantic), static_cast<uint8_t>(layout.attributes[i].type),
+                                static_cast<uint16_t>(layout.attributes[i].offset)};
+    }
+    header.indexStride = sizeof(uint16_t);
+    for (const IMesh* level : levels)
+    {
+        if (!MeshOptimizer::CanUse16BitIndices(level->GetVertexCount())) header.indexStride = sizeof(uint32_t);
+    }
+
+    // Vertex blocks of all levels first, then their index blocks
+    std::vector<uint64_t> vertexOffsets(levels.size());
+    std::vector<uint64_t> indexOffsets(levels.size());
+    uint64_t offset = AlignUp(sizeof(MeshCacheHeader), MeshCacheHeader::DATA_ALIGNMENT);
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        vertexOffsets[i] = offset;
+        offset = AlignUp(offset + levels[i]->GetVertexCount() * header.vertexStride, MeshCacheHeader::DATA_ALIGNMENT);
+    }
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        indexOffsets[i] = offset;
+        offset = AlignUp(offset + levels[i]->GetIndexCount() * header.indexStride, MeshCacheHeader::DATA_ALIGNMENT);
+    }
+
+    header.vertexCount = mesh.GetVertexCount();
+    header.indexCount = mesh.GetIndexCount();
+    header.vertexOffset = vertexOffsets[0];
+    header.indexOffset = indexOffsets[0];
+    header.sourceSize = sourceSize;
+    header.sourceModifiedTime = sourceModifiedTime;
+    header.acmr = MeshOptimizer::ComputeACMR(mesh.GetIndices(), static_cast<size_t>(header.vertexCount));
+    header.lodLevelLimit = lodLevelLimit;
+    header.lodCount = static_cast<uint32_t>(levels.size() - 1);
+    for (uint32_t i = 0; i < header.lodCount; ++i)
+    {
+        const IMesh* level = levels[i + 1];
+        header.lods[i] = {level->GetVertexCount(), level->GetIndexCount(), vertexOffsets[i + 1], indexOffsets[i + 1], mesh.GetLods()[i].maxScreenSize, 0};
+    }
+
+    // Bounds come from the float vertices, so they don't carry the quantization error of a packed layout
+    const std::vector<Vertex>& vertices = mesh.GetVerticesWithNormals();
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        header.boundsMin[axis] = header.vertexCount > 0 ? (&vertices[0].position.x)[axis] : 0.0f;
+        header.boundsMax[axis] = header.boundsMin[axis];
+    }
+    for (uint64_t i = 0; i < header.vertexCount; ++i)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float value = (&vertices[i].position.x)[axis];
+            header.boundsMin[axis] = std::min(header.boundsMin[axis], value);
+            header.boundsMax[axis] = std::max(header.boundsMax[axis], value);
+        }
+    }
+
+    // Written next to the destination and renamed, so a crash never leaves a truncated cache behind. Each writer
+    // gets its own temporary file, the last rename wins.
+    const std::string temporaryPath = cachePath + ".tmp" + std::to_string(temporaryFileCounter++);
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            XR_TUT_LOG_ERROR("MeshCache: failed to create " << temporaryPath);
+            return false;
+        }
+
+        // Pads up to each block's aligned offset before writing it
+        const char padding[MeshCacheHeader::DATA_ALIGNMENT] = {};
+        uint64_t position = 0;
+        auto writeBlock = [&file, &padding, &position](uint64_t blockOffset, const char* data, uint64_t size)
+        {
+            file.write(padding, static_cast<std::streamsize>(blockOffset - position));
+            file.write(data, static_cast<std::streamsize>(size));
+            position = blockOffset + size;
+        };
+        writeBlock(0, reinterpret_cast<const char*>(&header), sizeof(header));
+        for (size_t i = 0; i < levels.size(); ++i)
+        {
+            writeBlock(vertexOffsets[i], static_cast<const char*>(levels[i]->GetVertexData()), levels[i]->GetVertexCount() * header.vertexStride);
+        }
+        for (size_t i = 0; i < levels.size(); ++i)
+        {
+            std::vector<uint16_t> shortIndices;
+            writeBlock(indexOffsets[i], GetIndexData(*levels[i], header.indexStride, shortIndices), levels[i]->GetIndexCount() * header.indexStride);
+        }
+        if (!file.good())
+        {
+            XR_TUT_LOG_ERROR("MeshCache: failed to write " << temporaryPath);
+            return false;
+        }
+    }
+
+    std::remove(cachePath.c_str());
+    if (std::rename(temporaryPath.c_str(), cachePath.c_str()) != 0)
+    {
+        XR_TUT_LOG_ERROR("MeshCache: failed to move " << temporaryPath << " to " << cachePath);
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<IMesh> MeshCache::Build(std::shared_ptr<IMesh> mesh, const VertexLayout& layout, uint32_t maxLodLevelCount)
+{
+    // Simplified from the float vertices, before packing, so the levels don't compound the quantization error
+    if (maxLodLevelCount > 0)
+    {
+        MeshSimplifier::GenerateLods(*mesh, maxLodLevelCount);
+    }
+    if (layout != mesh->GetVertexLayout())
+    {
+        return std::make_shared<PackedMesh>(*mesh, layout);
+    }
+    return mesh;
+}
+
+std::shared_ptr<IMesh> MeshCache::LoadOrImportGltf(const std::string& gltfPath, uint32_t meshIndex, const std::string& cachePath,
+                                                   const VertexLayout& layout, uint32_t maxLodLevelCount)
+{
+    const std::string resolvedCachePath = cachePath.empty() ? gltfPath + "." + std::to_string(meshIndex) + ".meshcache" : cachePath;
+
+    // Without the source asset, e.g. when only caches are shipped, any valid cache is used
+    uint64_t sourceSize = 0;
+    int64_t sourceModifiedTime = 0;
+    const bool hasSource = GetSourceStamp(gltfPath, sourceSize, sourceModifiedTime);
+
+    std::shared_ptr<MappedMesh> cachedMesh = Load(resolvedCachePath);
+    if (cachedMesh && cachedMesh->GetVertexLayout() == layout && cachedMesh->GetHeader().lodLevelLimit == maxLodLevelCount &&
+        (!hasSource || (cachedMesh->GetHeader().sourceSize == sourceSize && cachedMesh->GetHeader().sourceModifiedTime == sourceModifiedTime)))
+    {
+        return cachedMesh;
+    }
+    if (cachedMesh && !hasSource)
+    {
+        // Nothing to reimport from, so make do with the cached levels of detail and convert the vertices if needed
+        if (cachedMesh->GetVertexLayout() == layout) return cachedMesh;
+        return std::make_shared<PackedMesh>(*cachedMesh, layout);
+    }
+    cachedMesh.reset();
+
+    const auto importStart = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<StaticMesh>> meshes;
+    if (!hasSource || !GltfImporter::Import(gltfPath, meshes)) return nullptr;
+    if (meshIndex >= meshes.size())
+    {
+        XR_TUT_LOG_ERROR("MeshCache: " << gltfPath << " has no mesh " << meshIndex);
+        return nullptr;
+    }
+
+    std::shared_ptr<StaticMesh> mesh = meshes[meshIndex];
+    const MeshOptimizer::Report report = MeshOptimizer::Optimize(mesh->GetMutableVertices(), mesh->GetMutableIndices());
+    std::shared_ptr<IMesh> storedMesh = Build(mesh, layout, maxLodLevelCount);
+
+    const auto importMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - importStart).count();
+    XR_TUT_LOG("MeshCache: imported " << gltfPath << " mesh " << meshIndex << " in " << importMs << " ms, " << report.vertexCountBefore << " -> " << report.vertexCountAfter
+               << " vertices, ACMR " << report.acmrBefore << " -> " << report.acmrAfter << ", " << storedMesh->GetLods().size() << " levels of detail");
+
+    if (!Write(resolvedCachePath, *storedMesh, sourceSize, sourceModifiedTime, maxLodLevelCount))
+    {
+        return storedMesh;
+    }
+
+    // Serve the freshly written cache, so the first run exercises the same path as the later ones
+    std::shared_ptr<MappedMesh> writtenMesh = Load(resolvedCachePath);
+    if (writtenMesh) return writtenMesh;
+    return storedMesh;
+}
+
+std::shared_ptr<IMesh> MeshCache::LoadOrBuild(const std::string& cachePath, const std::function<std::shared_ptr<IMesh>()>& build,
+                                              const VertexLayout& layout, uint32_t maxLodLevelCount)
+{
+    std::shared_ptr<MappedMesh> cachedMesh = Load(cachePath);
+    if (cachedMesh && cachedMesh->GetVertexLayout() == layout && cachedMesh->GetHeader().lodLevelLimit == maxLodLevelCount)
+    {
+        return cachedMesh;
+    }
+    cachedMesh.reset();
+
+    std::shared_ptr<IMesh> mesh = build();
+    if (!mesh) return nullptr;
+    std::shared_ptr<IMesh> storedMesh = Build(mesh, layout, maxLodLevelCount);
+    if (!Write(cachePath, *storedMesh, 0, 0, maxLodLevelCount))
+    {
+        return storedMesh;
+    }
+
+    std::shared_ptr<MappedMesh> writtenMesh = Load(cachePath);
+    if (writtenMesh) return writtenMesh;
+    return storedMesh;
+}
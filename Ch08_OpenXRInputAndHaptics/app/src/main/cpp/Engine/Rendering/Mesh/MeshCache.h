@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include "IMesh.h"
+#include "MappedMesh.h"
+#include <functional>
+#include <memory>
+#include <string>
+
+// Binary mesh cache (see MeshCacheFormat.h). Imported meshes are indexed, reordered for the vertex caches,
+// simplified into levels of detail and written once; later runs map the cache file and upload from it without
+// parsing or simplifying anything.
+class MeshCache {
+public:
+    // Loads mesh meshIndex of a glTF asset from its cache, importing the asset and rewriting the cache when
+    // the cache is missing, older than the asset, stored in another vertex layout or with another LOD level count.
+    // The cache path defaults to "<gltfPath>.<meshIndex>.meshcache".
+    static std::shared_ptr<IMesh> LoadOrImportGltf(const std::string& gltfPath, uint32_t meshIndex, const std::string& cachePath = "",
+                                                   const VertexLayout& layout = VertexLayout::GetStandard(), uint32_t maxLodLevelCount = 0);
+
+    // Same for a generated mesh, e.g. a procedural one: build only runs when the cache can't be used
+    static std::shared_ptr<IMesh> LoadOrBuild(const std::string& cachePath, const std::function<std::shared_ptr<IMesh>()>& build,
+                                              const VertexLayout& layout = VertexLayout::GetStandard(), uint32_t maxLodLevelCount = 0);
+
+    // The build step of the cache without the file: generates up to maxLodLevelCount levels of detail with
+    // MeshSimplifier and converts the mesh and its levels to layout
+    static std::shared_ptr<IMesh> Build(std::shared_ptr<IMesh> mesh, const VertexLayout& layout, uint32_t maxLodLevelCount);
+
+    // Returns nullptr when the file is missing or not a valid cache
+    static std::shared_ptr<MappedMesh> Load(const std::string& cachePath);
+
+    // Stores the mesh with its first MAX_LODS levels of detail. lodLevelLimit records the level count they were
+    // generated with.
+    static bool Write(const std::string& cachePath, const IMesh& mesh, uint64_t sourceSize = 0, int64_t sourceModifiedTime = 0,
+                      uint32_t lodLevelLimit = 0);
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+
+// On-disk layout of a mesh cache file, in native (little-endian) byte order:
+//   [MeshCacheHeader] [vertices, vertexStride bytes each] [vertices of each level of detail]
+//   [indices, indexStride bytes each] [indices of each level of detail]
+// The vertices are interleaved in the layout described by the header's attributes (see VertexLayout), and the
+// levels of detail share layout and index stride with the mesh. Indices are 16-bit when every one of them fits
+// (see MeshOptimizer::CanUse16BitIndices), 32-bit otherwise; those of a level count from its own first vertex.
+// Every data block starts on a DATA_ALIGNMENT boundary, so a mapping of the file can be uploaded as is.
+struct MeshCacheHeader
+{
+    static constexpr uint32_t MAGIC = 0x4843534D;  // "MSCH"
+    static constexpr uint32_t VERSION = 4;
+    static constexpr uint64_t DATA_ALIGNMENT = 16;
+    static constexpr uint32_t MAX_ATTRIBUTES = 4;
+    static constexpr uint32_t MAX_LODS = 8;
+
+    struct Attribute
+    {
+        uint8_t semantic;  // VertexSemantic
+        uint8_t type;      // GraphicsAPI::VertexType
+        uint16_t offset;
+    };
+
+    // A level of detail, see MeshLod
+    struct Lod
+    {
+        uint64_t vertexCount;
+        uint64_t indexCount;
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        float maxScreenSize;
+        uint32_t padding;
+    };
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t vertexStride = 0;
+    uint32_t indexStride = 0;
+    uint64_t vertexCount = 0;
+    uint64_t indexCount = 0;
+    uint64_t vertexOffset = 0;
+    uint64_t indexOffset = 0;
+
+    // Identifies the source asset the cache was built from, to detect stale caches
+    uint64_t sourceSize = 0;
+    int64_t sourceModifiedTime = 0;
+
+    float boundsMin[3] = {};
+    float boundsMax[3] = {};
+    float acmr = 0.0f;  // Average cache miss ratio of the stored index order
+
+    uint32_t attributeCount = 0;
+    Attribute attributes[MAX_ATTRIBUTES] = {};
+
+    // Level count the levels of detail were generated with, 0 when none were; identifies the build settings
+    uint32_t lodLevelLimit = 0;
+    uint32_t lodCount = 0;  // Finest first
+    Lod lods[MAX_LODS] = {};
+};
@@ -0,0 +1,421 @@
+﻿#include "MeshOptimizer.h"
+#include <xr_linear_algebra.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+    const uint32_t INVALID_INDEX = UINT32_MAX;
+
+    // FIFO post-transform cache simulated with insertion timestamps: a vertex is cached if it was inserted within
+    // the last cacheSize misses
+    class FifoCache
+    {
+    public:
+        FifoCache(size_t vertexCount, uint32_t cacheSize) : m_InsertedAt(vertexCount, 0), m_CacheSize(cacheSize) {}
+
+        uint32_t CountTriangleMisses(const uint32_t* triangle)
+        {
+            uint32_t misses = 0;
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t vertex = triangle[corner];
+                if (m_InsertedAt[vertex] == 0 || m_MissCount - m_InsertedAt[vertex] >= m_CacheSize)
+                {
+                    ++m_MissCount;
+                    m_InsertedAt[vertex] = m_MissCount;
+                    ++misses;
+                }
+            }
+            return misses;
+        }
+
+        // Ages every entry out at once
+        void Flush() { m_MissCount += m_CacheSize; }
+
+        uint32_t GetMissCount() const { return m_MissCount; }
+
+    private:
+        std::vector<uint32_t> m_InsertedAt;
+        uint32_t m_MissCount = 0;
+        uint32_t m_CacheSize;
+    };
+
+    struct WeldKey
+    {
+        int64_t cells[6];
+
+        bool operator==(const WeldKey& other) const { return std::memcmp(cells, other.cells, sizeof(cells)) == 0; }
+    };
+
+    struct WeldKeyHash
+    {
+        size_t operator()(const WeldKey& key) const
+        {
+            uint64_t hash = 14695981039346656037ull;  // FNV-1a over the cells
+            for (int64_t cell : key.cells)
+            {
+                hash ^= static_cast<uint64_t>(cell);
+                hash *= 1099511628211ull;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    int64_t ToWeldCell(float value, float tolerance)
+    {
+        if (tolerance > 0.0f) return std::llround(static_cast<double>(value) / tolerance);
+
+        // Adding +0 turns -0 into +0, so the two compare equal by bits as well
+        const float normalized = value + 0.0f;
+        uint32_t bits;
+        std::memcpy(&bits, &normalized, sizeof(bits));
+        return bits;
+    }
+
+    XrVector3f GetTriangleCentroid(const std::vector<Vertex>& vertices, const uint32_t* triangle)
+    {
+        const XrVector4f& a = vertices[triangle[0]].position;
+        const XrVector4f& b = vertices[triangle[1]].position;
+        const XrVector4f& c = vertices[triangle[2]].position;
+        return {(a.x + b.x + c.x) / 3.0f, (a.y + b.y + c.y) / 3.0f, (a.z + b.z + c.z) / 3.0f};
+    }
+
+    // Cross product of two edges: points along the face normal, with twice the triangle area as its length
+    XrVector3f GetTriangleAreaNormal(const std::vector<Vertex>& vertices, const uint32_t* triangle)
+    {
+        const XrVector4f& a = vertices[triangle[0]].position;
+        const XrVector4f& b = vertices[triangle[1]].position;
+        const XrVector4f& c = vertices[triangle[2]].position;
+        const XrVector3f ab = {b.x - a.x, b.y - a.y, b.z - a.z};
+        const XrVector3f ac = {c.x - a.x, c.y - a.y, c.z - a.z};
+        XrVector3f areaNormal;
+        XrVector3f_Cross(&areaNormal, &ab, &ac);
+        return areaNormal;
+    }
+
+    struct TipsifyState
+    {
+        std::vector<uint32_t> triangleOffsets;   // Start of each vertex's triangle list in adjacentTriangles
+        std::vector<uint32_t> adjacentTriangles;
+        std::vector<uint32_t> liveTriangleCounts;
+        std::vector<uint32_t> cacheTimestamps;
+        std::vector<uint32_t> deadEndStack;
+        uint32_t timestamp = 0;
+        uint32_t cursor = 0;
+    };
+
+    uint32_t SkipDeadEnd(TipsifyState& state, size_t vertexCount)
+    {
+        while (!state.deadEndStack.empty())
+        {
+            const uint32_t vertex = state.deadEndStack.back();
+            state.deadEndStack.pop_back();
+            if (state.liveTriangleCounts[vertex] > 0) return vertex;
+        }
+        while (state.cursor < vertexCount)
+        {
+            if (state.liveTriangleCounts[state.cursor] > 0) return state.cursor;
+            ++state.cursor;
+        }
+        return INVALID_INDEX;
+    }
+
+    uint32_t GetNextVertex(TipsifyState& state, const std::vector<uint32_t>& candidates, size_t vertexCount, uint32_t cacheSize)
+    {
+        // Prefer the candidate that stays in the cache longest while it still has triangles to emit
+        uint32_t bestVertex = INVALID_INDEX;
+        int64_t bestPriority = -1;
+        for (uint32_t vertex : candidates)
+        {
+            if (state.liveTriangleCounts[vertex] == 0) continue;
+
+            int64_t priority = 0;
+            const uint32_t age = state.timestamp - state.cacheTimestamps[vertex];
+            if (age + 2 * state.liveTriangleCounts[vertex] <= cacheSize)
+            {
+                priority = age;
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                bestVertex = vertex;
+            }
+        }
+        return bestVertex != INVALID_INDEX ? bestVertex : SkipDeadEnd(state, vertexCount);
+    }
+}
+
+MeshOptimizer::Report MeshOptimizer::Optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float weldTolerance, float overdrawThreshold)
+{
+    Report report;
+    report.vertexCountBefore = vertices.size();
+    report.acmrBefore = ComputeACMR(indices, vertices.size());
+
+    WeldVertices(vertices, indices, weldTolerance);
+    OptimizeVertexCache(indices, vertices.size());
+    OptimizeOverdraw(indices, vertices, overdrawThreshold);
+    OptimizeVertexFetch(vertices, indices);
+
+    report.vertexCountAfter = vertices.size();
+    report.acmrAfter = ComputeACMR(indices, vertices.size());
+    return report;
+}
+
+void MeshOptimizer::WeldVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float tolerance)
+{
+    std::unordered_map<WeldKey, uint32_t, WeldKeyHash> weldedIndices;
+    weldedIndices.reserve(vertices.size());
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const Vertex& vertex = vertices[i];
+        const WeldKey key = {{ToWeldCell(vertex.position.x, tolerance), ToWeldCell(vertex.position.y, tolerance), ToWeldCell(vertex.position.z, tolerance),
+                              ToWeldCell(vertex.normal.x, tolerance), ToWeldCell(vertex.normal.y, tolerance), ToWeldCell(vertex.normal.z, tolerance)}};
+        const auto inserted = weldedIndices.emplace(key, static_cast<uint32_t>(welded.size()));
+        if (inserted.second) welded.push_back(vertex);
+        remap[i] = inserted.first->second;
+    }
+
+    size_t writeIndex = 0;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        const uint32_t a = remap[indices[i]];
+        const uint32_t b = remap[indices[i + 1]];
+        const uint32_t c = remap[indices[i + 2]];
+        if (a == b || b == c || a == c) continue;
+
+        indices[writeIndex++] = a;
+        indices[writeIndex++] = b;
+        indices[writeIndex++] = c;
+    }
+    indices.resize(writeIndex);
+    vertices.swap(welded);
+}
+
+void MeshOptimizer::OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertexCount == 0) return;
+
+    TipsifyState state;
+    state.liveTriangleCounts.assign(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        ++state.liveTriangleCounts[indices[i]];
+    }
+
+    state.triangleOffsets.assign(vertexCount + 1, 0);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        state.triangleOffsets[vertex + 1] = state.triangleOffsets[vertex] + state.liveTriangleCounts[vertex];
+    }
+    state.adjacentTriangles.resize(state.triangleOffsets[vertexCount]);
+    std::vector<uint32_t> fillCounts(vertexCount, 0);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            const uint32_t vertex = indices[triangle * 3 + corner];
+            state.adjacentTriangles[state.triangleOffsets[vertex] + fillCounts[vertex]++] = static_cast<uint32_t>(triangle);
+        }
+    }
+
+    state.cacheTimestamps.assign(vertexCount, 0);
+    state.timestamp = cacheSize + 1;
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    std::vector<uint32_t> candidates;
+
+    uint32_t fanningVertex = SkipDeadEnd(state, vertexCount);
+    while (fanningVertex != INVALID_INDEX)
+    {
+        candidates.clear();
+        for (uint32_t i = state.triangleOffsets[fanningVertex]; i < state.triangleOffsets[fanningVertex + 1]; ++i)
+        {
+            const uint32_t triangle = state.adjacentTriangles[i];
+            if (emitted[triangle]) continue;
+
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t vertex = indices[triangle * 3 + corner];
+                output.push_back(vertex);
+                state.deadEndStack.push_back(vertex);
+                candidates.push_back(vertex);
+                --state.liveTriangleCounts[vertex];
+                if (state.timestamp - state.cacheTimestamps[vertex] > cacheSize)
+                {
+                    state.cacheTimestamps[vertex] = state.timestamp++;
+                }
+            }
+            emitted[triangle] = true;
+        }
+        fanningVertex = GetNextVertex(state, candidates, vertexCount, cacheSize);
+    }
+
+    // A trailing partial triangle, if any, is kept as is
+    output.insert(output.end(), indices.begin() + static_cast<std::ptrdiff_t>(triangleCount * 3), indices.end());
+    indices.swap(output);
+}
+
+void MeshOptimizer::OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, float threshold, uint32_t cacheSize)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2) return;
+
+    // Hard boundaries: a triangle missing on all three vertices finds nothing useful in the cache, so the
+    // triangles from there on can move without costing transforms
+    std::vector<size_t> hardClusterStarts;
+    FifoCache cache(vertices.size(), cacheSize);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        if (cache.CountTriangleMisses(&indices[triangle * 3]) == 3) hardClusterStarts.push_back(triangle);
+    }
+    if (hardClusterStarts.empty() || hardClusterStarts[0] != 0) hardClusterStarts.insert(hardClusterStarts.begin(), 0);
+    hardClusterStarts.push_back(triangleCount);
+
+    // Soft boundaries: cut each hard cluster wherever the piece so far, started with an empty cache, is already
+    // within threshold of the ACMR of the whole cluster
+    std::vector<size_t> clusterStarts;
+    for (size_t hard = 0; hard + 1 < hardClusterStarts.size(); ++hard)
+    {
+        const size_t start = hardClusterStarts[hard];
+        const size_t end = hardClusterStarts[hard + 1];
+
+        cache.Flush();
+        const uint32_t missCountBefore = cache.GetMissCount();
+        for (size_t triangle = start; triangle < end; ++triangle)
+        {
+            cache.CountTriangleMisses(&indices[triangle * 3]);
+        }
+        const float targetAcmr = threshold * static_cast<float>(cache.GetMissCount() - missCountBefore) / static_cast<float>(end - start);
+
+        cache.Flush();
+        clusterStarts.push_back(start);
+        size_t pieceStart = start;
+        uint32_t pieceMissCount = 0;
+        for (size_t triangle = start; triangle < end; ++triangle)
+        {
+            pieceMissCount += cache.CountTriangleMisses(&indices[triangle * 3]);
+            if (triangle + 1 < end && static_cast<float>(pieceMissCount) <= targetAcmr * static_cast<float>(triangle + 1 - pieceStart))
+            {
+                pieceStart = triangle + 1;
+                pieceMissCount = 0;
+                clusterStarts.push_back(pieceStart);
+                cache.Flush();
+            }
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+
+    XrVector3f meshCentroid = {0.0f, 0.0f, 0.0f};
+    float meshArea = 0.0f;
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        const XrVector3f areaNormal = GetTriangleAreaNormal(vertices, &indices[triangle * 3]);
+        XrVector3f centroid = GetTriangleCentroid(vertices, &indices[triangle * 3]);
+        const float area = XrVector3f_Length(&areaNormal);
+        XrVector3f_Scale(&centroid, &centroid, area);
+        XrVector3f_Add(&meshCentroid, &meshCentroid, &centroid);
+        meshArea += area;
+    }
+    if (meshArea > 0.0f) XrVector3f_Scale(&meshCentroid, &meshCentroid, 1.0f / meshArea);
+
+    // Clusters far out along their own normal are likely on the silhouette facing the viewer, so drawing them
+    // first lets the depth test reject what they cover
+    struct Cluster
+    {
+        size_t start;
+        size_t end;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters;
+    clusters.reserve(clusterStarts.size() - 1);
+    for (size_t i = 0; i + 1 < clusterStarts.size(); ++i)
+    {
+        XrVector3f normal = {0.0f, 0.0f, 0.0f};
+        XrVector3f centroid = {0.0f, 0.0f, 0.0f};
+        float area = 0.0f;
+        for (size_t triangle = clusterStarts[i]; triangle < clusterStarts[i + 1]; ++triangle)
+        {
+            const XrVector3f areaNormal = GetTriangleAreaNormal(vertices, &indices[triangle * 3]);
+            XrVector3f triangleCentroid = GetTriangleCentroid(vertices, &indices[triangle * 3]);
+            const float triangleArea = XrVector3f_Length(&areaNormal);
+            XrVector3f_Scale(&triangleCentroid, &triangleCentroid, triangleArea);
+            XrVector3f_Add(&centroid, &centroid, &triangleCentroid);
+            XrVector3f_Add(&normal, &normal, &areaNormal);
+            area += triangleArea;
+        }
+
+        float sortKey = 0.0f;
+        if (area > 0.0f && XrVector3f_Length(&normal) > 0.0f)
+        {
+            XrVector3f_Scale(&centroid, &centroid, 1.0f / area);
+            XrVector3f_Normalize(&normal);
+            XrVector3f offset;
+            XrVector3f_Sub(&offset, &centroid, &meshCentroid);
+            sortKey = XrVector3f_Dot(&offset, &normal);
+        }
+        clusters.push_back({clusterStarts[i], clusterStarts[i + 1], sortKey});
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (const Cluster& cluster : clusters)
+    {
+        output.insert(output.end(), indices.begin() + static_cast<std::ptrdiff_t>(cluster.start * 3),
+                      indices.begin() + static_cast<std::ptrdiff_t>(cluster.end * 3));
+    }
+    output.insert(output.end(), indices.begin() + static_cast<std::ptrdiff_t>(triangleCount * 3), indices.end());
+    indices.swap(output);
+}
+
+void MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+    std::vector<uint32_t> remap(vertices.size(), INVALID_INDEX);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == INVALID_INDEX)
+        {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(reordered);
+}
+
+float MeshOptimizer::ComputeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize)
+{
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return 0.0f;
+
+    FifoCache cache(vertexCount, cacheSize);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        cache.CountTriangleMisses(&indices[triangle * 3]);
+    }
+    return static_cast<float>(cache.GetMissCount()) / static_cast<float>(triangleCount);
+}
+
+std::vector<uint16_t> MeshOptimizer::To16BitIndices(const uint32_t* indices, size_t indexCount)
+{
+    std::vector<uint16_t> shortIndices(indexCount);
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        shortIndices[i] = static_cast<uint16_t>(indices[i]);
+    }
+    return shortIndices;
+}
@@ -0,0 +1,50 @@
+﻿#pragma once
+
+#include "../Vertex.h"
+#include <cstdint>
+#include <vector>
+
+// Offline processing of indexed triangle lists for the GPU's vertex caches
+class MeshOptimizer {
+public:
+    struct Report
+    {
+        size_t vertexCountBefore = 0;
+        size_t vertexCountAfter = 0;
+        float acmrBefore = 0.0f;
+        float acmrAfter = 0.0f;
+    };
+
+    // Full pipeline: weld, vertex cache order, overdraw order, vertex fetch order
+    static Report Optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float weldTolerance = DEFAULT_WELD_TOLERANCE,
+                           float overdrawThreshold = DEFAULT_OVERDRAW_THRESHOLD);
+
+    // Merges vertices whose positions and normals fall in the same cell of a grid of the given tolerance (0 merges
+    // bit-identical vertices only) and drops the triangles that become degenerate. Unreferenced vertices are kept.
+    static void WeldVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, float tolerance = 0.0f);
+
+    // Reorders the triangles with Tipsify (Sander et al. 2007) for a post-transform cache of cacheSize entries
+    static void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+    // Reorders clusters of a cache optimized index buffer so outward facing ones come first and occlude the rest
+    // (Sander et al. 2007). Clusters are cut where the ACMR stays within threshold times the input's.
+    static void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vertex>& vertices, float threshold = DEFAULT_OVERDRAW_THRESHOLD,
+                                 uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+    // Reorders the vertices by first use in the index buffer and drops unreferenced ones, so vertex fetches
+    // walk memory linearly
+    static void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+    // Average cache miss ratio: transformed vertices per triangle with a FIFO cache. 3.0 is the worst case,
+    // around 0.6-0.7 is typical for a well ordered regular mesh.
+    static float ComputeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize = DEFAULT_CACHE_SIZE);
+
+    // Every index of a mesh with at most this many vertices fits in 16 bits
+    static bool CanUse16BitIndices(uint64_t vertexCount) { return vertexCount <= MAX_16BIT_INDEX_VERTEX_COUNT; }
+    static std::vector<uint16_t> To16BitIndices(const uint32_t* indices, size_t indexCount);
+
+    static constexpr uint32_t DEFAULT_CACHE_SIZE = 16;
+    static constexpr float DEFAULT_WELD_TOLERANCE = 1e-5f;
+    static constexpr float DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+    static constexpr uint64_t MAX_16BIT_INDEX_VERTEX_COUNT = 65536;
+};
@@ -0,0 +1,376 @@
+﻿#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "StaticMesh.h"
+#include <DebugOutput.h>
+#include <xr_linear_algebra.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+
+namespace
+{
+    // Keeps open borders in place: their constraint planes weigh this much more than the surface's own
+    const double BOUNDARY_WEIGHT = 10.0;
+
+    // Symmetric 4x4 matrix: xx xy xz xw yy yz yw zz zw ww
+    struct Quadric
+    {
+        double m[10] = {};
+
+        void AddPlane(const XrVector3f& normal, float distance, double weight)
+        {
+            const double a = normal.x, b = normal.y, c = normal.z, d = distance;
+            const double plane[10] = {a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d};
+            for (int i = 0; i < 10; ++i) m[i] += plane[i] * weight;
+        }
+
+        void Add(const Quadric& other)
+        {
+            for (int i = 0; i < 10; ++i) m[i] += other.m[i];
+        }
+
+        // Sum of the weighted squared distances from p to the accumulated planes
+        double Evaluate(const XrVector3f& p) const
+        {
+            const double x = p.x, y = p.y, z = p.z;
+            return m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x + m[4] * y * y + 2.0 * m[5] * y * z + 2.0 * m[6] * y +
+                   m[7] * z * z + 2.0 * m[8] * z + m[9];
+        }
+    };
+
+    struct Collapse
+    {
+        double cost;
+        uint32_t from;
+        uint32_t to;
+        uint32_t fromVersion;
+        uint32_t toVersion;
+
+        bool operator>(const Collapse& other) const { return cost > other.cost; }
+    };
+
+    struct PositionKey
+    {
+        uint32_t bits[3];
+
+        explicit PositionKey(const XrVector4f& position)
+        {
+            // Adding +0 turns -0 into +0, so the two compare equal by bits as well
+            const float coordinates[3] = {position.x + 0.0f, position.y + 0.0f, position.z + 0.0f};
+            std::memcpy(bits, coordinates, sizeof(bits));
+        }
+
+        bool operator==(const PositionKey& other) const { return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2]; }
+    };
+
+    struct PositionKeyHash
+    {
+        size_t operator()(const PositionKey& key) const
+        {
+            return static_cast<size_t>((static_cast<uint64_t>(key.bits[0]) * 73856093u) ^ (static_cast<uint64_t>(key.bits[1]) * 19349663u) ^
+                                       (static_cast<uint64_t>(key.bits[2]) * 83492791u));
+        }
+    };
+
+    uint64_t GetEdgeKey(uint32_t a, uint32_t b)
+    {
+        return a < b ? (static_cast<uint64_t>(a) << 32) | b : (static_cast<uint64_t>(b) << 32) | a;
+    }
+
+    XrVector3f GetFaceNormal(const XrVector3f& a, const XrVector3f& b, const XrVector3f& c)
+    {
+        XrVector3f ab, ac, normal;
+        XrVector3f_Sub(&ab, &b, &a);
+        XrVector3f_Sub(&ac, &c, &a);
+        XrVector3f_Cross(&normal, &ab, &ac);
+        return normal;
+    }
+
+    class QuadricSimplifier
+    {
+    public:
+        QuadricSimplifier(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+        {
+            // Collapses work on positions, so vertices that only differ in their normal move together
+            std::unordered_map<PositionKey, uint32_t, PositionKeyHash> positionIndices;
+            positionIndices.reserve(vertices.size());
+            std::vector<uint32_t> remap(vertices.size());
+            for (size_t i = 0; i < vertices.size(); ++i)
+            {
+                const XrVector4f& position = vertices[i].position;
+                const auto inserted = positionIndices.emplace(PositionKey(position), static_cast<uint32_t>(m_Positions.size()));
+                if (inserted.second) m_Positions.push_back({position.x, position.y, position.z});
+                remap[i] = inserted.first->second;
+            }
+
+            for (size_t i = 0; i + 2 < indices.size(); i += 3)
+            {
+                const uint32_t a = remap[indices[i]];
+                const uint32_t b = remap[indices[i + 1]];
+                const uint32_t c = remap[indices[i + 2]];
+                if (a == b || b == c || a == c) continue;
+                m_Triangles.push_back({{a, b, c}});
+            }
+            m_TriangleAlive.assign(m_Triangles.size(), true);
+            m_LiveTriangleCount = m_Triangles.size();
+
+            m_VertexTriangles.resize(m_Positions.size());
+            m_Quadrics.resize(m_Positions.size());
+            m_Removed.assign(m_Positions.size(), false);
+            m_Versions.assign(m_Positions.size(), 0);
+
+            std::unordered_map<uint64_t, uint32_t> edgeTriangleCounts;
+            for (uint32_t triangle = 0; triangle < m_Triangles.size(); ++triangle)
+            {
+                const uint32_t* corners = m_Triangles[triangle].data();
+                XrVector3f normal = GetFaceNormal(m_Positions[corners[0]], m_Positions[corners[1]], m_Positions[corners[2]]);
+                if (XrVector3f_Length(&normal) > 0.0f)
+                {
+                    XrVector3f_Normalize(&normal);
+                    const float distance = -XrVector3f_Dot(&normal, &m_Positions[corners[0]]);
+                    for (int corner = 0; corner < 3; ++corner) m_Quadrics[corners[corner]].AddPlane(normal, distance, 1.0);
+                }
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    m_VertexTriangles[corners[corner]].push_back(triangle);
+                    ++edgeTriangleCounts[GetEdgeKey(corners[corner], corners[(corner + 1) % 3])];
+                }
+            }
+
+            // Border edges get a plane through the edge, perpendicular to its triangle
+            for (uint32_t triangle = 0; triangle < m_Triangles.size(); ++triangle)
+            {
+                const uint32_t* corners = m_Triangles[triangle].data();
+                XrVector3f faceNormal = GetFaceNormal(m_Positions[corners[0]], m_Positions[corners[1]], m_Positions[corners[2]]);
+                if (XrVector3f_Length(&faceNormal) == 0.0f) continue;
+                XrVector3f_Normalize(&faceNormal);
+
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    const uint32_t a = corners[corner];
+                    const uint32_t b = corners[(corner + 1) % 3];
+                    if (edgeTriangleCounts[GetEdgeKey(a, b)] != 1) continue;
+
+                    XrVector3f edge, borderNormal;
+                    XrVector3f_Sub(&edge, &m_Positions[b], &m_Positions[a]);
+                    XrVector3f_Cross(&borderNormal, &edge, &faceNormal);
+                    if (XrVector3f_Length(&borderNormal) == 0.0f) continue;
+                    XrVector3f_Normalize(&borderNormal);
+                    const float distance = -XrVector3f_Dot(&borderNormal, &m_Positions[a]);
+                    m_Quadrics[a].AddPlane(borderNormal, distance, BOUNDARY_WEIGHT);
+                    m_Quadrics[b].AddPlane(borderNormal, distance, BOUNDARY_WEIGHT);
+                }
+            }
+
+            for (const auto& edge : edgeTriangleCounts)
+            {
+                PushCollapse(static_cast<uint32_t>(edge.first >> 32), static_cast<uint32_t>(edge.first & 0xFFFFFFFF));
+            }
+        }
+
+        void Run(size_t targetTriangleCount)
+        {
+            while (m_LiveTriangleCount > targetTriangleCount && !m_Queue.empty())
+            {
+                const Collapse collapse = m_Queue.top();
+                m_Queue.pop();
+                if (m_Removed[collapse.from] || m_Removed[collapse.to] || m_Versions[collapse.from] != collapse.fromVersion ||
+                    m_Versions[collapse.to] != collapse.toVersion)
+                {
+                    continue;
+                }
+                if (!IsCollapseValid(collapse.from, collapse.to)) continue;
+
+                ApplyCollapse(collapse.from, collapse.to);
+            }
+        }
+
+        void GetResult(std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices) const
+        {
+            std::vector<uint32_t> remap(m_Positions.size(), UINT32_MAX);
+            outVertices.clear();
+            outIndices.clear();
+            for (uint32_t triangle = 0; triangle < m_Triangles.size(); ++triangle)
+            {
+                if (!m_TriangleAlive[triangle]) continue;
+                for (uint32_t position : m_Triangles[triangle])
+                {
+                    if (remap[position] == UINT32_MAX)
+                    {
+                        remap[position] = static_cast<uint32_t>(outVertices.size());
+                        const XrVector3f& p = m_Positions[position];
+                        outVertices.emplace_back(p.x, p.y, p.z, 0.0f, 0.0f, 0.0f);
+                    }
+                    outIndices.push_back(remap[position]);
+                }
+            }
+
+            // Area weighted smooth normals
+            for (size_t i = 0; i + 2 < outIndices.size(); i += 3)
+            {
+                Vertex& a = outVertices[outIndices[i]];
+                Vertex& b = outVertices[outIndices[i + 1]];
+                Vertex& c = outVertices[outIndices[i + 2]];
+                const XrVector3f faceNormal = GetFaceNormal({a.position.x, a.position.y, a.position.z}, {b.position.x, b.position.y, b.position.z},
+                                                            {c.position.x, c.position.y, c.position.z});
+                for (Vertex* vertex : {&a, &b, &c}) XrVector3f_Add(&vertex->normal, &vertex->normal, &faceNormal);
+            }
+            for (Vertex& vertex : outVertices)
+            {
+                if (XrVector3f_Length(&vertex.normal) > 0.0f) XrVector3f_Normalize(&vertex.normal);
+            }
+        }
+
+    private:
+        void PushCollapse(uint32_t a, uint32_t b)
+        {
+            Quadric quadric = m_Quadrics[a];
+            quadric.Add(m_Quadrics[b]);
+            const double costAtA = quadric.Evaluate(m_Positions[a]);
+            const double costAtB = quadric.Evaluate(m_Positions[b]);
+            if (costAtA <= costAtB)
+                m_Queue.push({costAtA, b, a, m_Versions[b], m_Versions[a]});
+            else
+                m_Queue.push({costAtB, a, b, m_Versions[a], m_Versions[b]});
+        }
+
+        void GetNeighbors(uint32_t vertex, std::vector<uint32_t>& neighbors) const
+        {
+            neighbors.clear();
+            for (uint32_t triangle : m_VertexTriangles[vertex])
+            {
+                if (!m_TriangleAlive[triangle]) continue;
+                for (uint32_t corner : m_Triangles[triangle])
+                {
+                    if (corner != vertex) neighbors.push_back(corner);
+                }
+            }
+            std::sort(neighbors.begin(), neighbors.end());
+            neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        }
+
+        bool IsCollapseValid(uint32_t from, uint32_t to)
+        {
+            // Link condition: the endpoints may only share the neighbors of the triangles on the edge itself,
+            // otherwise the collapse pinches the surface into a non-manifold fin
+            GetNeighbors(from, m_FromNeighbors);
+            GetNeighbors(to, m_ToNeighbors);
+            size_t sharedNeighborCount = 0;
+            for (uint32_t neighbor : m_FromNeighbors)
+            {
+                if (std::binary_search(m_ToNeighbors.begin(), m_ToNeighbors.end(), neighbor)) ++sharedNeighborCount;
+            }
+            size_t edgeTriangleCount = 0;
+            for (uint32_t triangle : m_VertexTriangles[from])
+            {
+                if (!m_TriangleAlive[triangle]) continue;
+                const std::array<uint32_t, 3>& corners = m_Triangles[triangle];
+                if (corners[0] == to || corners[1] == to || corners[2] == to) ++edgeTriangleCount;
+            }
+            if (edgeTriangleCount == 0 || sharedNeighborCount != edgeTriangleCount) return false;
+
+            // Reject collapses that flip a remaining triangle
+            for (uint32_t triangle : m_VertexTriangles[from])
+            {
+                if (!m_TriangleAlive[triangle]) continue;
+                const std::array<uint32_t, 3>& corners = m_Triangles[triangle];
+                if (corners[0] == to || corners[1] == to || corners[2] == to) continue;
+
+                XrVector3f moved[3];
+                for (int corner = 0; corner < 3; ++corner) moved[corner] = m_Positions[corners[corner] == from ? to : corners[corner]];
+                const XrVector3f before = GetFaceNormal(m_Positions[corners[0]], m_Positions[corners[1]], m_Positions[corners[2]]);
+                const XrVector3f after = GetFaceNormal(moved[0], moved[1], moved[2]);
+                if (XrVector3f_Dot(&before, &after) <= 0.0f) return false;
+            }
+            return true;
+        }
+
+        void ApplyCollapse(uint32_t from, uint32_t to)
+        {
+            for (uint32_t triangle : m_VertexTriangles[from])
+            {
+                if (!m_TriangleAlive[triangle]) continue;
+                std::array<uint32_t, 3>& corners = m_Triangles[triangle];
+                if (corners[0] == to || corners[1] == to || corners[2] == to)
+                {
+                    m_TriangleAlive[triangle] = false;
+                    --m_LiveTriangleCount;
+                    continue;
+                }
+                for (uint32_t& corner : corners)
+                {
+                    if (corner == from) corner = to;
+                }
+                m_VertexTriangles[to].push_back(triangle);
+            }
+            m_VertexTriangles[from].clear();
+            m_Removed[from] = true;
+            m_Quadrics[to].Add(m_Quadrics[from]);
+            ++m_Versions[to];
+
+            GetNeighbors(to, m_ToNeighbors);
+            for (uint32_t neighbor : m_ToNeighbors) PushCollapse(to, neighbor);
+        }
+
+        std::vector<XrVector3f> m_Positions;
+        std::vector<std::array<uint32_t, 3>> m_Triangles;
+        std::vector<bool> m_TriangleAlive;
+        size_t m_LiveTriangleCount = 0;
+        std::vector<std::vector<uint32_t>> m_VertexTriangles;
+        std::vector<Quadric> m_Quadrics;
+        std::vector<bool> m_Removed;
+        std::vector<uint32_t> m_Versions;
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_Queue;
+        std::vector<uint32_t> m_FromNeighbors;
+        std::vector<uint32_t> m_ToNeighbors;
+    };
+}
+
+void MeshSimplifier::Simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t targetTriangleCount,
+                              std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices)
+{
+    QuadricSimplifier simplifier(vertices, indices);
+    simplifier.Run(targetTriangleCount);
+    simplifier.GetResult(outVertices, outIndices);
+}
+
+void MeshSimplifier::GenerateLods(IMesh& mesh, uint32_t maxLevelCount, float reductionPerLevel, float fullDetailScreenSize, size_t minTriangleCount)
+{
+    std::vector<MeshLod> lods;
+    const size_t baseTriangleCount = static_cast<size_t>(mesh.GetIndexCount() / 3);
+    size_t previousTriangleCount = baseTriangleCount;
+    const IMesh* previous = &mesh;
+
+    for (uint32_t level = 0; level < maxLevelCount; ++level)
+    {
+        const size_t targetTriangleCount = static_cast<size_t>(static_cast<float>(previousTriangleCount) * reductionPerLevel);
+        if (targetTriangleCount < minTriangleCount) break;
+
+        // Each level starts from the previous one, which is smaller and already close to the target
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        Simplify(previous->GetVerticesWithNormals(), previous->GetIndices(), targetTriangleCount, vertices, indices);
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0 || triangleCount > previousTriangleCount * 9 / 10) break;
+
+        MeshOptimizer::Optimize(vertices, indices);
+        std::shared_ptr<StaticMesh> lodMesh = std::make_shared<StaticMesh>(std::move(vertices), std::move(indices));
+
+        // Triangle count goes with the square of the screen size at constant density
+        const float maxScreenSize = fullDetailScreenSize * std::sqrt(static_cast<float>(triangleCount) / static_cast<float>(baseTriangleCount));
+        lods.push_back({lodMesh, maxScreenSize});
+
+        previousTriangleCount = triangleCount;
+        previous = lodMesh.get();
+    }
+
+    if (!lods.empty())
+    {
+        XR_TUT_LOG("MeshSimplifier: " << lods.size() << " levels of detail, " << baseTriangleCount << " -> " << previousTriangleCount << " triangles");
+    }
+    mesh.SetLods(std::move(lods));
+}
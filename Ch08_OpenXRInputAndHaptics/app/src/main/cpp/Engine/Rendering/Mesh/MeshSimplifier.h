@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include "IMesh.h"
+#include <cstdint>
+#include <vector>
+
+// Offline mesh simplification with quadric error metrics (Garland and Heckbert 1997). Edges are collapsed onto
+// whichever endpoint adds less error, so no new positions are invented. Simplified meshes get smooth normals
+// recomputed from their faces, which rounds off hard edges; that is fine for the distant levels this is for.
+class MeshSimplifier {
+public:
+    // Collapses edges until at most targetTriangleCount triangles are left, or no valid collapse remains
+    static void Simplify(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t targetTriangleCount,
+                         std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices);
+
+    // Attaches successively coarser levels to the mesh, each with about reductionPerLevel of the previous level's
+    // triangles. Their screen size thresholds keep the on-screen triangle density roughly constant once the mesh
+    // is smaller than fullDetailScreenSize.
+    static void GenerateLods(IMesh& mesh, uint32_t maxLevelCount = DEFAULT_MAX_LEVEL_COUNT, float reductionPerLevel = 0.5f,
+                             float fullDetailScreenSize = 0.25f, size_t minTriangleCount = DEFAULT_MIN_TRIANGLE_COUNT);
+
+    static constexpr uint32_t DEFAULT_MAX_LEVEL_COUNT = 4;
+    static constexpr size_t DEFAULT_MIN_TRIANGLE_COUNT = 32;
+};
@@ -0,0 +1,26 @@
+﻿#include "PackedMesh.h"
+#include "../VertexPacker.h"
+
+PackedMesh::PackedMesh(const IMesh& source, const VertexLayout& layout)
+    : m_Layout(layout), m_VertexCount(source.GetVertexCount())
+{
+    const std::vector<Vertex>& vertices = source.GetVerticesWithNormals();
+    m_VertexData = VertexPacker::Pack(vertices.data(), vertices.size(), m_Layout);
+    m_Indices.assign(source.GetIndexData(), source.GetIndexData() + source.GetIndexCount());
+
+    std::vector<MeshLod> lods;
+    for (const MeshLod& lod : source.GetLods())
+    {
+        lods.push_back({std::make_shared<PackedMesh>(*lod.mesh, layout), lod.maxScreenSize});
+    }
+    SetLods(std::move(lods));
+}
+
+const std::vector<Vertex>& PackedMesh::GetVerticesWithNormals() const
+{
+    if (m_VertexCopy.empty() && m_VertexCount > 0)
+    {
+        VertexPacker::Unpack(m_VertexData.data(), static_cast<size_t>(m_VertexCount), m_Layout, m_VertexCopy);
+    }
+    return m_VertexCopy;
+}
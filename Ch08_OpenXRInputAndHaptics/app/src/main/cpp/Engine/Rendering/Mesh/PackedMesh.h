@@ -0,0 +1,27 @@
+﻿#pragma once
+
+#include "IMesh.h"
+
+// Copy of a mesh with its vertex buffer in another layout, typically VertexLayout::GetCompact(). The float
+// vertices are decoded from the packed data on first use of GetVerticesWithNormals() only. The source's levels of
+// detail are packed as well.
+class PackedMesh : public IMesh {
+public:
+    PackedMesh(const IMesh& source, const VertexLayout& layout);
+
+    const std::vector<Vertex>& GetVerticesWithNormals() const override;
+    const std::vector<uint32_t>& GetIndices() const override { return m_Indices; }
+
+    uint64_t GetVertexCount() const override { return m_VertexCount; }
+    uint64_t GetIndexCount() const override { return m_Indices.size(); }
+
+    const VertexLayout& GetVertexLayout() const override { return m_Layout; }
+    const void* GetVertexData() const override { return m_VertexData.data(); }
+
+private:
+    VertexLayout m_Layout;
+    std::vector<uint8_t> m_VertexData;
+    std::vector<uint32_t> m_Indices;
+    uint64_t m_VertexCount = 0;
+    mutable std::vector<Vertex> m_VertexCopy;
+};
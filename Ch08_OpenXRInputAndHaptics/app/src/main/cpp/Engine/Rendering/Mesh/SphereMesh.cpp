@@ -0,0 +1,49 @@
+﻿#include "SphereMesh.h"
+#include "MeshOptimizer.h"
+#include "../../Diagnostics/TraceLogMgr.h"
+#include <algorithm>
+#include <cmath>
+
+SphereMesh::SphereMesh(float radius, uint32_t segments, uint32_t rings)
+{
+    GenerateSphereData(radius, std::max(segments, 3u), std::max(rings, 2u));
+
+    // Welding merges the seam column and the pole vertices and drops the degenerate pole triangles
+    const MeshOptimizer::Report report = MeshOptimizer::Optimize(m_verticesWithNormals, m_indices);
+    XR_TRACE_VERBOSE("SphereMesh: {}x{}, {} -> {} vertices, ACMR {} -> {}", segments, rings, report.vertexCountBefore, report.vertexCountAfter,
+                     report.acmrBefore, report.acmrAfter);
+}
+
+void SphereMesh::GenerateSphereData(float radius, uint32_t segments, uint32_t rings)
+{
+    const float pi = 3.14159265358979f;
+
+    // The seam column is duplicated so every ring has segments + 1 vertices
+    m_verticesWithNormals.reserve((segments + 1) * (rings + 1));
+    for (uint32_t ring = 0; ring <= rings; ++ring)
+    {
+        const float polar = pi * static_cast<float>(ring) / static_cast<float>(rings);
+        const float y = std::cos(polar);
+        const float ringRadius = std::sin(polar);
+
+        for (uint32_t segment = 0; segment <= segments; ++segment)
+        {
+            const float azimuth = 2.0f * pi * static_cast<float>(segment) / static_cast<float>(segments);
+            const XrVector3f normal = {ringRadius * std::cos(azimuth), y, ringRadius * std::sin(azimuth)};
+            m_verticesWithNormals.emplace_back(normal.x * radius, normal.y * radius, normal.z * radius, normal.x, normal.y, normal.z);
+        }
+    }
+
+    m_indices.reserve(segments * rings * 6);
+    for (uint32_t ring = 0; ring < rings; ++ring)
+    {
+        for (uint32_t segment = 0; segment < segments; ++segment)
+        {
+            const uint32_t current = ring * (segments + 1) + segment;
+            const uint32_t below = current + segments + 1;
+
+            m_indices.insert(m_indices.end(), {current, current + 1, below});
+            m_indices.insert(m_indices.end(), {current + 1, below + 1, below});
+        }
+    }
+}
@@ -0,0 +1,22 @@
+﻿#pragma once
+
+#include "IMesh.h"
+
+class SphereMesh : public IMesh {
+private:
+    std::vector<Vertex> m_verticesWithNormals;
+    std::vector<uint32_t> m_indices;
+
+public:
+    // A UV sphere; the vertex count grows with segments * rings
+    SphereMesh(float radius = 0.5f, uint32_t segments = 16, uint32_t rings = 8);
+    
+    const std::vector<Vertex>& GetVerticesWithNormals() const override { return m_verticesWithNormals; }
+    const std::vector<uint32_t>& GetIndices() const override { return m_indices; }
+    
+    uint64_t GetVertexCount() const override { return m_verticesWithNormals.size(); }
+    uint64_t GetIndexCount() const override { return m_indices.size(); }
+
+private:
+    void GenerateSphereData(float radius, uint32_t segments, uint32_t rings);
+};
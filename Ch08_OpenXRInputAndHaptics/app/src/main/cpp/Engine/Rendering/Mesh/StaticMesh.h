@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include "IMesh.h"
+#include <utility>
+
+// Indexed mesh built from existing vertex and index data, e.g. by an importer
+class StaticMesh : public IMesh {
+private:
+    std::vector<Vertex> m_verticesWithNormals;
+    std::vector<uint32_t> m_indices;
+
+public:
+    StaticMesh(std::vector<Vertex> vertices, std::vector<uint32_t> indices)
+        : m_verticesWithNormals(std::move(vertices)), m_indices(std::move(indices)) {}
+
+    const std::vector<Vertex>& GetVerticesWithNormals() const override { return m_verticesWithNormals; }
+    const std::vector<uint32_t>& GetIndices() const override { return m_indices; }
+
+    uint64_t GetVertexCount() const override { return m_verticesWithNormals.size(); }
+    uint64_t GetIndexCount() const override { return m_indices.size(); }
+
+    std::vector<Vertex>& GetMutableVertices() { return m_verticesWithNormals; }
+    std::vector<uint32_t>& GetMutableIndices() { return m_indices; }
+};
@@ -0,0 +1,190 @@
+#include "MeshResourceRegistry.h"
+#include "Mesh/MeshOptimizer.h"
+#include "../../OpenXR/OpenXRCoreMgr.h"
+#include "../../OpenXR/OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
+#include <DebugOutput.h>
+#include <algorithm>
+
+std::unordered_map<const IMesh*, MeshResourceRegistry::Entry> MeshResourceRegistry::m_Entries;
+std::deque<MeshResourceRegistry::RetiredRange> MeshResourceRegistry::m_RetiredRanges;
+std::vector<std::unique_ptr<BufferArena>> MeshResourceRegistry::m_Arenas;
+uint64_t MeshResourceRegistry::m_ArenaSize = 16 * 1024 * 1024;
+
+const MeshAllocation* MeshResourceRegistry::Acquire(const IMesh& mesh)
+{
+    auto it = m_Entries.find(&mesh);
+    if (it != m_Entries.end())
+    {
+        ++it->second.refCount;
+        return &it->second.allocation;
+    }
+
+    const uint64_t vertexCount = mesh.GetVertexCount();
+    const uint64_t indexCount = mesh.GetIndexCount();
+    const uint32_t vertexStride = mesh.GetVertexLayout().stride;
+    if (vertexCount == 0 || indexCount == 0 || vertexStride == 0)
+    {
+        return nullptr;
+    }
+
+    FreeRetiredRanges();
+
+    Entry entry;
+    uint64_t vertexOffset = 0;
+    entry.vertexArena = Allocate(GraphicsAPI::BufferCreateInfo::Type::VERTEX, vertexStride, vertexCount, mesh.GetVertexData(), vertexOffset);
+    if (!entry.vertexArena)
+    {
+        return nullptr;
+    }
+
+    // Indices stay relative to the mesh's first vertex, vertexOffset rebases them. That keeps 16-bit indices usable
+    // for small meshes wherever they land in the arena.
+    uint64_t firstIndex = 0;
+    if (mesh.GetShortIndexData())
+    {
+        entry.indexArena = Allocate(GraphicsAPI::BufferCreateInfo::Type::INDEX, sizeof(uint16_t), indexCount, mesh.GetShortIndexData(), firstIndex);
+    }
+    else if (MeshOptimizer::CanUse16BitIndices(vertexCount))
+    {
+        const std::vector<uint16_t> shortIndices = MeshOptimizer::To16BitIndices(mesh.GetIndexData(), static_cast<size_t>(indexCount));
+        entry.indexArena = Allocate(GraphicsAPI::BufferCreateInfo::Type::INDEX, sizeof(uint16_t), indexCount, shortIndices.data(), firstIndex);
+    }
+    else
+    {
+        entry.indexArena = Allocate(GraphicsAPI::BufferCreateInfo::Type::INDEX, sizeof(uint32_t), indexCount, mesh.GetIndexData(), firstIndex);
+    }
+    if (!entry.indexArena)
+    {
+        Free(entry.vertexArena, vertexOffset, vertexCount);
+        return nullptr;
+    }
+
+    entry.allocation.vertexBuffer = entry.vertexArena->GetBuffer();
+    entry.allocation.indexBuffer = entry.indexArena->GetBuffer();
+    entry.allocation.vertexOffset = static_cast<int32_t>(vertexOffset);
+    entry.allocation.firstIndex = static_cast<uint32_t>(firstIndex);
+    entry.allocation.indexCount = static_cast<uint32_t>(indexCount);
+    entry.vertexCount = vertexCount;
+    entry.refCount = 1;
+
+    return &m_Entries.emplace(&mesh, entry).first->second.allocation;
+}
+
+void MeshResourceRegistry::Release(const IMesh& mesh)
+{
+    auto it = m_Entries.find(&mesh);
+    if (it == m_Entries.end())
+    {
+        XR_TUT_LOG_ERROR("MeshResourceRegistry: released a mesh that was never acquired");
+        return;
+    }
+    if (--it->second.refCount > 0) return;
+
+    // Frames in flight may still draw the mesh, so its ranges wait for the last of them before they can be
+    // overwritten. A mesh no frame drew since it was acquired is freed right away.
+    const Entry& entry = it->second;
+    const uint64_t value = entry.lastUseValue;
+    auto position = std::upper_bound(m_RetiredRanges.begin(), m_RetiredRanges.end(), value,
+                                     [](uint64_t candidate, const RetiredRange& range) { return candidate < range.value; });
+    position = m_RetiredRanges.insert(position, {value, entry.vertexArena, static_cast<uint64_t>(entry.allocation.vertexOffset), entry.vertexCount});
+    m_RetiredRanges.insert(position + 1, {value, entry.indexArena, entry.allocation.firstIndex, entry.allocation.indexCount});
+    m_Entries.erase(it);
+    FreeRetiredRanges();
+}
+
+void MeshResourceRegistry::MarkUsed(const IMesh& mesh)
+{
+    auto it = m_Entries.find(&mesh);
+    if (it != m_Entries.end())
+    {
+        it->second.lastUseValue = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->GetRecordingValue();
+    }
+}
+
+uint32_t MeshResourceRegistry::GetRefCount(const IMesh& mesh)
+{
+    auto it = m_Entries.find(&mesh);
+    return it != m_Entries.end() ? it->second.refCount : 0;
+}
+
+uint64_t MeshResourceRegistry::GetUploadSize(const IMesh& mesh)
+{
+    const uint64_t indexStride = MeshOptimizer::CanUse16BitIndices(mesh.GetVertexCount()) ? sizeof(uint16_t) : sizeof(uint32_t);
+    return mesh.GetVertexDataSize() + mesh.GetIndexCount() * indexStride;
+}
+
+MeshResourceRegistry::Stats MeshResourceRegistry::GetStats()
+{
+    Stats stats;
+    stats.meshCount = m_Entries.size();
+    stats.arenaCount = m_Arenas.size();
+    for (const std::unique_ptr<BufferArena>& arena : m_Arenas)
+    {
+        stats.arenaBytes += arena->GetCapacity() * arena->GetStride();
+        stats.usedBytes += arena->GetUsedCount() * arena->GetStride();
+    }
+    return stats;
+}
+
+void MeshResourceRegistry::Shutdown()
+{
+    if (!m_Entries.empty())
+    {
+        XR_TUT_LOG_ERROR("MeshResourceRegistry: " << m_Entries.size() << " meshes still acquired at shutdown");
+    }
+    m_Entries.clear();
+    m_RetiredRanges.clear();
+    m_Arenas.clear();
+}
+
+BufferArena* MeshResourceRegistry::Allocate(GraphicsAPI::BufferCreateInfo::Type type, uint32_t stride, uint64_t count, const void* data, uint64_t& offset)
+{
+    for (const std::unique_ptr<BufferArena>& arena : m_Arenas)
+    {
+        if (arena->GetType() == type && arena->GetStride() == stride && arena->Allocate(count, data, offset))
+        {
+            return arena.get();
+        }
+    }
+
+    if (!OpenXRCoreMgr::openxrGraphicsAPI || !OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI)
+    {
+        XR_TUT_LOG_ERROR("MeshResourceRegistry: no graphics API to create an arena with");
+        return nullptr;
+    }
+
+    const uint64_t capacity = std::max(m_ArenaSize / stride, count);
+    m_Arenas.push_back(std::make_unique<BufferArena>(OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get(), type, stride, capacity));
+    if (!m_Arenas.back()->Allocate(count, data, offset))
+    {
+        m_Arenas.pop_back();
+        return nullptr;
+    }
+    return m_Arenas.back().get();
+}
+
+void MeshResourceRegistry::FreeRetiredRanges()
+{
+    if (m_RetiredRanges.empty()) return;
+
+    const uint64_t completedValue = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->GetCompletedValue();
+    while (!m_RetiredRanges.empty() && m_RetiredRanges.front().value <= completedValue)
+    {
+        const RetiredRange range = m_RetiredRanges.front();
+        m_RetiredRanges.pop_front();
+        Free(range.arena, range.offset, range.count);
+    }
+}
+
+void MeshResourceRegistry::Free(BufferArena* arena, uint64_t offset, uint64_t count)
+{
+    arena->Free(offset, count);
+    if (!arena->IsEmpty()) return;
+
+    // Empty arenas are given back so memory follows the meshes still in use
+    auto it = std::find_if(m_Arenas.begin(), m_Arenas.end(), [arena](const std::unique_ptr<BufferArena>& candidate) { return candidate.get() == arena; });
+    if (it != m_Arenas.end())
+    {
+        m_Arenas.erase(it);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "BufferArena.h"
+#include "Mesh/IMesh.h"
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Where a mesh lives on the GPU. The buffers are shared arenas, draw with
+// DrawIndexed(indexCount, 1, firstIndex, vertexOffset).
+struct MeshAllocation {
+    void* vertexBuffer = nullptr;
+    void* indexBuffer = nullptr;
+    int32_t vertexOffset = 0;  // In vertices
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+};
+
+// Ref-counted GPU storage per mesh instance. Renderers drawing the same IMesh share one upload, and small meshes
+// are packed into large vertex and index arenas so consecutive draws rarely need to rebind buffers.
+class MeshResourceRegistry {
+public:
+    struct Stats {
+        size_t meshCount = 0;
+        size_t arenaCount = 0;
+        uint64_t arenaBytes = 0;  // Allocated GPU memory
+        uint64_t usedBytes = 0;   // Part of it holding mesh data, or released ranges the GPU may still read
+    };
+
+    // Uploads the mesh on first use. Returns nullptr if the mesh is empty or the upload failed.
+    static const MeshAllocation* Acquire(const IMesh& mesh);
+    // The mesh's ranges are freed once every Acquire has been released and the GPU finished the frames using them
+    static void Release(const IMesh& mesh);
+    // Records that the frame being recorded draws the mesh, call it for every draw of an acquired mesh
+    static void MarkUsed(const IMesh& mesh);
+    // Acquires of the mesh not released yet, 0 when it isn't uploaded
+    static uint32_t GetRefCount(const IMesh& mesh);
+    // Bytes Acquire uploads for the mesh, indices counted in the stride it picks for them
+    static uint64_t GetUploadSize(const IMesh& mesh);
+
+    static Stats GetStats();
+
+    // Destroys all arenas. Must run before the graphics device is destroyed.
+    static void Shutdown();
+
+private:
+    struct Entry {
+        MeshAllocation allocation;
+        BufferArena* vertexArena = nullptr;
+        BufferArena* indexArena = nullptr;
+        uint64_t vertexCount = 0;
+        uint32_t refCount = 0;
+        uint64_t lastUseValue = 0;  // GPU timeline value of the last frame drawing the mesh, 0 if none did
+    };
+
+    static BufferArena* Allocate(GraphicsAPI::BufferCreateInfo::Type type, uint32_t stride, uint64_t count, const void* data, uint64_t& offset);
+    static void Free(BufferArena* arena, uint64_t offset, uint64_t count);
+    static void FreeRetiredRanges();
+
+    struct RetiredRange {
+        uint64_t value = 0;  // GPU timeline value after which the range can be reused
+        BufferArena* arena = nullptr;
+        uint64_t offset = 0;
+        uint64_t count = 0;
+    };
+
+    static std::unordered_map<const IMesh*, Entry> m_Entries;
+    static std::deque<RetiredRange> m_RetiredRanges;  // In the order of their values
+    static std::vector<std::unique_ptr<BufferArena>> m_Arenas;
+    static uint64_t m_ArenaSize;  // Bytes per arena, meshes larger than this get an arena of their own
+};
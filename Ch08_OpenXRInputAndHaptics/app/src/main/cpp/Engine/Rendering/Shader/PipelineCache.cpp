@@ -0,0 +1,31 @@
+#include "PipelineCache.h"
+#include "../../../OpenXR/OpenXRCoreMgr.h"
+#include "../../../OpenXR/OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
+
+std::vector<std::pair<PipelineKey, void*>> PipelineCache::m_Pipelines;
+
+void* PipelineCache::Find(const PipelineKey& key)
+{
+    for (const std::pair<PipelineKey, void*>& entry : m_Pipelines)
+    {
+        if (entry.first == key)
+        {
+            return entry.second;
+        }
+    }
+    return nullptr;
+}
+
+void PipelineCache::Add(const PipelineKey& key, void* pipeline)
+{
+    m_Pipelines.emplace_back(key, pipeline);
+}
+
+void PipelineCache::Shutdown()
+{
+    for (std::pair<PipelineKey, void*>& entry : m_Pipelines)
+    {
+        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyPipeline(entry.second);
+    }
+    m_Pipelines.clear();
+}
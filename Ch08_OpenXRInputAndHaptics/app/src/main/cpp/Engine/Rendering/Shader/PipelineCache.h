@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ShaderVariant.h"
+#include "../VertexLayout.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Everything a material pipeline is built from besides the fixed render state
+struct PipelineKey {
+    uint64_t vertexShaderHash = 0;
+    uint64_t fragmentShaderHash = 0;
+    ShaderVariantKey variant = 0;
+    VertexLayout vertexLayout;
+    bool fragmentDensityMap = false;
+    bool reversedZ = false;
+
+    bool operator==(const PipelineKey& other) const {
+        return vertexShaderHash == other.vertexShaderHash && fragmentShaderHash == other.fragmentShaderHash && variant == other.variant &&
+               vertexLayout == other.vertexLayout && fragmentDensityMap == other.fragmentDensityMap &&
+               reversedZ == other.reversedZ;
+    }
+};
+
+// Pipelines shared by every material with the same shaders, variant and vertex layout, so materials that only
+// differ in color create one pipeline between them. Pipelines live until Shutdown. Main thread only.
+class PipelineCache {
+public:
+    static void* Find(const PipelineKey& key);
+    static void Add(const PipelineKey& key, void* pipeline);
+
+    static size_t GetPipelineCount() { return m_Pipelines.size(); }
+
+    // Destroys all pipelines. Must run before the graphics device is destroyed.
+    static void Shutdown();
+
+private:
+    static std::vector<std::pair<PipelineKey, void*>> m_Pipelines;
+};
@@ -0,0 +1,203 @@
+#include "ShaderLibrary.h"
+#include "../../Assets/AssetLoaderMgr.h"
+#include "../../Utils/MappedFile.h"
+#include "../../../OpenXR/OpenXRCoreMgr.h"
+#include "../../../OpenXR/OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
+#include <DebugOutput.h>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+std::unordered_multimap<uint64_t, std::weak_ptr<const ShaderModule>> ShaderLibrary::m_Modules;
+std::unordered_map<std::string, std::weak_ptr<const ShaderModule>> ShaderLibrary::m_PathModules;
+std::unordered_map<std::string, AssetHandle<std::shared_ptr<const ShaderModule>>> ShaderLibrary::m_PendingLoads;
+
+namespace
+{
+    // Output of the decode stage, consumed by the upload stage on the main thread
+    struct ShaderSource
+    {
+        MappedFile mappedFile;
+        std::vector<char> data;  // Used where files can't be mapped, e.g. APK assets
+        const void* code = nullptr;
+        size_t size = 0;
+        uint64_t hash = 0;
+        ShaderReflection reflection;
+    };
+}
+
+AssetHandle<std::shared_ptr<const ShaderModule>> ShaderLibrary::LoadAsync(const std::string& path)
+{
+    auto pending = m_PendingLoads.find(path);
+    if (pending != m_PendingLoads.end())
+    {
+        if (pending->second.IsLoading())
+        {
+            return pending->second;
+        }
+        m_PendingLoads.erase(pending);
+    }
+
+    // A file loaded before whose module is still alive needs no IO at all
+    auto pathModule = m_PathModules.find(path);
+    if (pathModule != m_PathModules.end())
+    {
+        std::shared_ptr<const ShaderModule> existing = pathModule->second.lock();
+        if (existing)
+        {
+            return AssetLoaderMgr::MakeReady(existing);
+        }
+    }
+
+    std::shared_ptr<ShaderSource> source = std::make_shared<ShaderSource>();
+    AssetHandle<std::shared_ptr<const ShaderModule>> handle = AssetLoaderMgr::RunAsync<std::shared_ptr<const ShaderModule>>(
+        [source, path](std::shared_ptr<const ShaderModule>&)
+        {
+#if defined(__ANDROID__)
+            if (!AssetLoaderMgr::ReadFile(path, source->data)) return false;
+            source->code = source->data.data();
+            source->size = source->data.size();
+#else
+            if (!source->mappedFile.Open(path))
+            {
+                XR_TUT_LOG_ERROR("ShaderLibrary: failed to open " << path);
+                return false;
+            }
+            source->code = source->mappedFile.GetData();
+            source->size = source->mappedFile.GetSize();
+#endif
+            source->hash = HashCode(source->code, source->size);
+            if (!SpirvReflection::Reflect(source->code, source->size, source->reflection))
+            {
+                XR_TUT_LOG_ERROR("ShaderLibrary: " << path << " is not valid SPIR-V");
+                return false;
+            }
+            return true;
+        },
+        [source, path](std::shared_ptr<const ShaderModule>& module)
+        {
+            // Requests for the path from now on go through m_PathModules, so the pending handle doesn't keep the module alive
+            m_PendingLoads.erase(path);
+            module = Create(source->code, source->size, source->hash, source->reflection);
+            m_PathModules[path] = module;
+            // The module holds a copy of the code now, the mapping or read buffer can go
+            source->mappedFile.Close();
+            source->data = std::vector<char>();
+            return module != nullptr;
+        });
+
+    m_PendingLoads[path] = handle;
+    return handle;
+}
+
+std::shared_ptr<const ShaderModule> ShaderLibrary::Create(const void* code, size_t size)
+{
+    ShaderReflection reflection;
+    if (!SpirvReflection::Reflect(code, size, reflection))
+    {
+        XR_TUT_LOG_ERROR("ShaderLibrary: code is not valid SPIR-V");
+        return nullptr;
+    }
+    return Create(code, size, HashCode(code, size), reflection);
+}
+
+std::shared_ptr<const ShaderModule> ShaderLibrary::FindModule(const void* code, size_t size, uint64_t hash)
+{
+    // The hash only narrows the search, the code itself decides
+    auto range = m_Modules.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        std::shared_ptr<const ShaderModule> existing = it->second.lock();
+        if (existing && existing->code.size() == size && std::memcmp(existing->code.data(), code, size) == 0)
+        {
+            return existing;
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<const ShaderModule> ShaderLibrary::Create(const void* code, size_t size, uint64_t hash, const ShaderReflection& reflection)
+{
+    std::shared_ptr<const ShaderModule> existing = FindModule(code, size, hash);
+    if (existing)
+    {
+        return existing;
+    }
+
+    GraphicsAPI::ShaderCreateInfo shaderCreateInfo;
+    shaderCreateInfo.type = reflection.stage;
+    shaderCreateInfo.sourceData = static_cast<const char*>(code);
+    shaderCreateInfo.sourceSize = size;
+
+    void* shader = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->CreateShader(shaderCreateInfo);
+    if (!shader)
+    {
+        XR_TUT_LOG_ERROR("ShaderLibrary: failed to create shader module");
+        return nullptr;
+    }
+
+    ShaderModule* module = new ShaderModule();
+    module->module = shader;
+    module->hash = hash;
+    module->reflection = reflection;
+    module->code.assign(static_cast<const char*>(code), static_cast<const char*>(code) + size);
+    std::shared_ptr<const ShaderModule> shared(module, [](const ShaderModule* released)
+    {
+        auto range = m_Modules.equal_range(released->hash);
+        for (auto entry = range.first; entry != range.second;)
+        {
+            entry = entry->second.expired() ? m_Modules.erase(entry) : std::next(entry);
+        }
+        void* shader = released->module;
+        OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyShader(shader);
+        delete released;
+    });
+    m_Modules.emplace(hash, shared);
+    return shared;
+}
+
+std::vector<GraphicsAPI::DescriptorInfo> ShaderLibrary::BuildPipelineLayout(const std::vector<const ShaderModule*>& modules)
+{
+    // A binding used by several stages appears once per stage; the backend merges them into one binding
+    std::vector<GraphicsAPI::DescriptorInfo> layout;
+    for (const ShaderModule* module : modules)
+    {
+        if (!module) continue;
+        for (const GraphicsAPI::DescriptorInfo& descriptor : module->reflection.descriptors)
+        {
+            const bool mismatch = std::any_of(layout.begin(), layout.end(), [&descriptor](const GraphicsAPI::DescriptorInfo& existing)
+            {
+                return existing.bindingIndex == descriptor.bindingIndex && (existing.type != descriptor.type || existing.readWrite != descriptor.readWrite);
+            });
+            if (mismatch)
+            {
+                XR_TUT_LOG_ERROR("ShaderLibrary: stages disagree on the type of binding " << descriptor.bindingIndex);
+                continue;
+            }
+            layout.push_back(descriptor);
+        }
+    }
+    std::stable_sort(layout.begin(), layout.end(),
+                     [](const GraphicsAPI::DescriptorInfo& a, const GraphicsAPI::DescriptorInfo& b) { return a.bindingIndex < b.bindingIndex; });
+    return layout;
+}
+
+void ShaderLibrary::Shutdown()
+{
+    m_PendingLoads.clear();
+    m_PathModules.clear();
+    m_Modules.clear();
+}
+
+uint64_t ShaderLibrary::HashCode(const void* code, size_t size)
+{
+    // FNV-1a over the bytes; shaders are loaded once so speed hardly matters, collisions do
+    uint64_t hash = 14695981039346656037ull;
+    const uint8_t* bytes = static_cast<const uint8_t*>(code);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash ^ size;
+}
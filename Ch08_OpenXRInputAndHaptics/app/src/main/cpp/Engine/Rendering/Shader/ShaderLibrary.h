@@ -0,0 +1,49 @@
+#pragma once
+
+#include "SpirvReflection.h"
+#include "../../Assets/AssetHandle.h"
+#include <GraphicsAPI.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A created shader module with the interface reflected from its SPIR-V
+struct ShaderModule {
+    void* module = nullptr;
+    uint64_t hash = 0;
+    ShaderReflection reflection;
+    // Copy of the SPIR-V, so code that only shares the hash isn't mistaken for this module
+    std::vector<char> code;
+};
+
+// Shader modules shared by content. Each SPIR-V blob is read once, mapped rather than copied where the platform
+// allows, and identical code creates a single module however many materials or paths refer to it. The module is
+// destroyed when the last shared_ptr to it is released. Main thread only.
+class ShaderLibrary {
+public:
+    // Reads, hashes and reflects the file on the asset loader threads; the module is created in AssetLoaderMgr::Tick
+    static AssetHandle<std::shared_ptr<const ShaderModule>> LoadAsync(const std::string& path);
+
+    // Returns the existing module when one with the same code is alive
+    static std::shared_ptr<const ShaderModule> Create(const void* code, size_t size);
+
+    // Merges the descriptor bindings of the stages into one pipeline layout
+    static std::vector<GraphicsAPI::DescriptorInfo> BuildPipelineLayout(const std::vector<const ShaderModule*>& modules);
+
+    static size_t GetModuleCount() { return m_Modules.size(); }
+
+    // Forgets all modules. Those still referenced are destroyed when released, before the graphics device.
+    static void Shutdown();
+
+    static uint64_t HashCode(const void* code, size_t size);
+
+private:
+    static std::shared_ptr<const ShaderModule> Create(const void* code, size_t size, uint64_t hash, const ShaderReflection& reflection);
+
+    static std::shared_ptr<const ShaderModule> FindModule(const void* code, size_t size, uint64_t hash);
+
+    static std::unordered_multimap<uint64_t, std::weak_ptr<const ShaderModule>> m_Modules;  // By content hash
+    static std::unordered_map<std::string, std::weak_ptr<const ShaderModule>> m_PathModules;  // Module of every file loaded so far
+    static std::unordered_map<std::string, AssetHandle<std::shared_ptr<const ShaderModule>>> m_PendingLoads;
+};
@@ -0,0 +1,57 @@
+#include "ShaderVariant.h"
+
+namespace
+{
+    struct FeatureInfo
+    {
+        ShaderFeature feature;
+        const char* keyword;   // Null for specialization constant features
+        uint32_t constantId;   // Only used by specialization constant features
+    };
+
+    const FeatureInfo FEATURES[] = {
+        {ShaderFeature::UNLIT, "UNLIT", 0},
+        {ShaderFeature::HALF_LAMBERT, nullptr, 0},
+    };
+}
+
+ShaderVariantKey ShaderVariant::GetKeywordKey(ShaderVariantKey key)
+{
+    ShaderVariantKey keywordKey = 0;
+    for (const FeatureInfo& info : FEATURES)
+    {
+        if (info.keyword && HasFeature(key, info.feature))
+        {
+            keywordKey |= static_cast<uint32_t>(info.feature);
+        }
+    }
+    return keywordKey;
+}
+
+std::string ShaderVariant::GetShaderFile(const std::string& baseFile, ShaderVariantKey key)
+{
+    const size_t extension = baseFile.rfind('.');
+    std::string file = extension == std::string::npos ? baseFile : baseFile.substr(0, extension);
+    for (const FeatureInfo& info : FEATURES)
+    {
+        if (info.keyword && HasFeature(key, info.feature))
+        {
+            file += "_";
+            file += info.keyword;
+        }
+    }
+    return extension == std::string::npos ? file : file + baseFile.substr(extension);
+}
+
+std::vector<GraphicsAPI::SpecializationConstant> ShaderVariant::GetSpecializationConstants(ShaderVariantKey key)
+{
+    std::vector<GraphicsAPI::SpecializationConstant> constants;
+    for (const FeatureInfo& info : FEATURES)
+    {
+        if (!info.keyword)
+        {
+            constants.push_back({info.constantId, HasFeature(key, info.feature) ? 1u : 0u});
+        }
+    }
+    return constants;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <GraphicsAPI.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Optional shader features; a material's variant key is the set it enables. Keyword features select shader
+// files compiled with the keyword defined (GLSL_SHADER_KEYWORDS in CMakeLists.txt), so whatever they remove is
+// gone from the module, inputs included. The others are specialization constants of the same module and only
+// cost a pipeline.
+enum class ShaderFeature : uint32_t {
+    UNLIT = 1u << 0,         // Keyword UNLIT: flat color, no normals fetched
+    HALF_LAMBERT = 1u << 1   // Specialization constant 0: wrapped diffuse for softer shading
+};
+
+typedef uint32_t ShaderVariantKey;
+
+inline ShaderVariantKey operator|(ShaderFeature a, ShaderFeature b) { return static_cast<uint32_t>(a) | static_cast<uint32_t>(b); }
+inline ShaderVariantKey operator|(ShaderVariantKey a, ShaderFeature b) { return a | static_cast<uint32_t>(b); }
+
+class ShaderVariant {
+public:
+    static bool HasFeature(ShaderVariantKey key, ShaderFeature feature) { return (key & static_cast<uint32_t>(feature)) != 0; }
+
+    // The part of the key that selects shader files
+    static ShaderVariantKey GetKeywordKey(ShaderVariantKey key);
+
+    // "VertexShader.spv" becomes "VertexShader_UNLIT.spv" for an unlit key. Keywords are appended in declaration
+    // order; a combination of several needs its own compiled file.
+    static std::string GetShaderFile(const std::string& baseFile, ShaderVariantKey key);
+
+    // Values for every specialization constant feature, enabled or not, so pipelines never rely on the defaults
+    static std::vector<GraphicsAPI::SpecializationConstant> GetSpecializationConstants(ShaderVariantKey key);
+};
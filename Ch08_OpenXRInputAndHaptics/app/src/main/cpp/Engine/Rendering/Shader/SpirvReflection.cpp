@@ -0,0 +1,231 @@
+#include "SpirvReflection.h"
+#include <DebugOutput.h>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+    const uint32_t SPIRV_MAGIC = 0x07230203;
+    const size_t HEADER_WORD_COUNT = 5;
+
+    // Opcodes, decorations and enumerants from the SPIR-V specification, only the ones read here
+    enum Op : uint32_t
+    {
+        OP_ENTRY_POINT = 15,
+        OP_TYPE_IMAGE = 25,
+        OP_TYPE_SAMPLER = 26,
+        OP_TYPE_SAMPLED_IMAGE = 27,
+        OP_TYPE_ARRAY = 28,
+        OP_TYPE_RUNTIME_ARRAY = 29,
+        OP_TYPE_STRUCT = 30,
+        OP_TYPE_POINTER = 32,
+        OP_VARIABLE = 59,
+        OP_DECORATE = 71
+    };
+
+    enum Decoration : uint32_t
+    {
+        DECORATION_BUFFER_BLOCK = 3,
+        DECORATION_BUILT_IN = 11,
+        DECORATION_NON_WRITABLE = 24,
+        DECORATION_LOCATION = 30,
+        DECORATION_BINDING = 33,
+        DECORATION_DESCRIPTOR_SET = 34
+    };
+
+    enum StorageClass : uint32_t
+    {
+        STORAGE_UNIFORM_CONSTANT = 0,
+        STORAGE_INPUT = 1,
+        STORAGE_UNIFORM = 2,
+        STORAGE_STORAGE_BUFFER = 12
+    };
+
+    // Image Sampled operand: 1 is used with a sampler, 2 is a storage image
+    const uint32_t IMAGE_SAMPLED_STORAGE = 2;
+
+    struct Decorations
+    {
+        uint32_t set = 0;
+        uint32_t binding = UINT32_MAX;
+        uint32_t location = UINT32_MAX;
+        bool builtIn = false;
+        bool bufferBlock = false;
+        bool nonWritable = false;
+    };
+
+    struct TypeInfo
+    {
+        uint32_t opcode = 0;
+        uint32_t operand = 0;   // Pointee for pointers, element for arrays, Sampled for images
+        uint32_t storage = 0;   // Storage class of pointers
+    };
+
+    bool ToShaderType(uint32_t executionModel, GraphicsAPI::ShaderCreateInfo::Type& type)
+    {
+        switch (executionModel)
+        {
+            case 0: type = GraphicsAPI::ShaderCreateInfo::Type::VERTEX; return true;
+            case 1: type = GraphicsAPI::ShaderCreateInfo::Type::TESSELLATION_CONTROL; return true;
+            case 2: type = GraphicsAPI::ShaderCreateInfo::Type::TESSELLATION_EVALUATION; return true;
+            case 3: type = GraphicsAPI::ShaderCreateInfo::Type::GEOMETRY; return true;
+            case 4: type = GraphicsAPI::ShaderCreateInfo::Type::FRAGMENT; return true;
+            case 5: type = GraphicsAPI::ShaderCreateInfo::Type::COMPUTE; return true;
+            default: return false;
+        }
+    }
+}
+
+bool SpirvReflection::Reflect(const void* code, size_t size, ShaderReflection& reflection)
+{
+    if (!code || size % sizeof(uint32_t) != 0 || size < HEADER_WORD_COUNT * sizeof(uint32_t))
+    {
+        return false;
+    }
+
+    // The code may come straight from a file mapping, so it is copied rather than assumed to be aligned
+    std::vector<uint32_t> words(size / sizeof(uint32_t));
+    std::memcpy(words.data(), code, size);
+    if (words[0] != SPIRV_MAGIC)
+    {
+        return false;
+    }
+
+    bool hasEntryPoint = false;
+    std::unordered_map<uint32_t, Decorations> decorations;
+    std::unordered_map<uint32_t, TypeInfo> types;
+    std::vector<std::pair<uint32_t, uint32_t>> variables;  // Result id, pointer type id
+
+    for (size_t offset = HEADER_WORD_COUNT; offset < words.size();)
+    {
+        const uint32_t opcode = words[offset] & 0xFFFF;
+        const uint32_t wordCount = words[offset] >> 16;
+        if (wordCount == 0 || offset + wordCount > words.size())
+        {
+            return false;
+        }
+        const uint32_t* operands = &words[offset + 1];
+
+        switch (opcode)
+        {
+            case OP_ENTRY_POINT:
+                // Modules with several entry points are reflected for the first one, which is what "main" is
+                if (!hasEntryPoint && wordCount >= 3)
+                {
+                    hasEntryPoint = ToShaderType(operands[0], reflection.stage);
+                }
+                break;
+            case OP_DECORATE:
+                if (wordCount >= 3)
+                {
+                    Decorations& target = decorations[operands[0]];
+                    const uint32_t value = wordCount >= 4 ? operands[2] : 0;
+                    switch (operands[1])
+                    {
+                        case DECORATION_BUFFER_BLOCK: target.bufferBlock = true; break;
+                        case DECORATION_BUILT_IN: target.builtIn = true; break;
+                        case DECORATION_NON_WRITABLE: target.nonWritable = true; break;
+                        case DECORATION_LOCATION: target.location = value; break;
+                        case DECORATION_BINDING: target.binding = value; break;
+                        case DECORATION_DESCRIPTOR_SET: target.set = value; break;
+                        default: break;
+                    }
+                }
+                break;
+            case OP_TYPE_IMAGE:
+                if (wordCount >= 8) types[operands[0]] = {opcode, operands[6], 0};
+                break;
+            case OP_TYPE_SAMPLER:
+            case OP_TYPE_SAMPLED_IMAGE:
+            case OP_TYPE_STRUCT:
+                if (wordCount >= 2) types[operands[0]] = {opcode, 0, 0};
+                break;
+            case OP_TYPE_ARRAY:
+            case OP_TYPE_RUNTIME_ARRAY:
+                if (wordCount >= 3) types[operands[0]] = {opcode, operands[1], 0};
+                break;
+            case OP_TYPE_POINTER:
+                if (wordCount >= 4) types[operands[0]] = {opcode, operands[2], operands[1]};
+                break;
+            case OP_VARIABLE:
+                if (wordCount >= 4) variables.push_back({operands[1], operands[0]});
+                break;
+            default:
+                break;
+        }
+        offset += wordCount;
+    }
+
+    if (!hasEntryPoint)
+    {
+        return false;
+    }
+
+    const GraphicsAPI::DescriptorInfo::Stage descriptorStage = static_cast<GraphicsAPI::DescriptorInfo::Stage>(reflection.stage);
+    for (const std::pair<uint32_t, uint32_t>& variable : variables)
+    {
+        auto pointer = types.find(variable.second);
+        if (pointer == types.end() || pointer->second.opcode != OP_TYPE_POINTER) continue;
+        const uint32_t storage = pointer->second.storage;
+        const Decorations& variableDecorations = decorations[variable.first];
+
+        if (storage == STORAGE_INPUT)
+        {
+            if (!variableDecorations.builtIn && variableDecorations.location != UINT32_MAX)
+            {
+                reflection.inputLocations.push_back(variableDecorations.location);
+            }
+            continue;
+        }
+        if (storage != STORAGE_UNIFORM_CONSTANT && storage != STORAGE_UNIFORM && storage != STORAGE_STORAGE_BUFFER) continue;
+        if (variableDecorations.binding == UINT32_MAX) continue;
+
+        if (variableDecorations.set != 0)
+        {
+            XR_TUT_LOG_ERROR("SpirvReflection: descriptor set " << variableDecorations.set << " is not supported, binding " << variableDecorations.binding << " ignored");
+            continue;
+        }
+
+        // Arrays of resources share the element's descriptor type
+        uint32_t typeId = pointer->second.operand;
+        auto type = types.find(typeId);
+        while (type != types.end() && (type->second.opcode == OP_TYPE_ARRAY || type->second.opcode == OP_TYPE_RUNTIME_ARRAY))
+        {
+            typeId = type->second.operand;
+            type = types.find(typeId);
+        }
+        if (type == types.end()) continue;
+
+        GraphicsAPI::DescriptorInfo descriptor = {};
+        descriptor.bindingIndex = variableDecorations.binding;
+        descriptor.resource = nullptr;
+        descriptor.stage = descriptorStage;
+        switch (type->second.opcode)
+        {
+            case OP_TYPE_STRUCT:
+                // Storage buffers are StorageBuffer blocks, or Uniform blocks decorated BufferBlock in older SPIR-V
+                descriptor.type = GraphicsAPI::DescriptorInfo::Type::BUFFER;
+                descriptor.readWrite = storage == STORAGE_STORAGE_BUFFER || decorations[typeId].bufferBlock;
+                break;
+            case OP_TYPE_IMAGE:
+                descriptor.type = GraphicsAPI::DescriptorInfo::Type::IMAGE;
+                descriptor.readWrite = type->second.operand == IMAGE_SAMPLED_STORAGE && !variableDecorations.nonWritable;
+                break;
+            case OP_TYPE_SAMPLER:
+                descriptor.type = GraphicsAPI::DescriptorInfo::Type::SAMPLER;
+                descriptor.readWrite = false;
+                break;
+            default:
+                XR_TUT_LOG_ERROR("SpirvReflection: binding " << variableDecorations.binding << " is a combined image sampler, which GraphicsAPI can't describe; "
+                                 "use a separate texture and sampler");
+                continue;
+        }
+        reflection.descriptors.push_back(descriptor);
+    }
+
+    std::sort(reflection.descriptors.begin(), reflection.descriptors.end(),
+              [](const GraphicsAPI::DescriptorInfo& a, const GraphicsAPI::DescriptorInfo& b) { return a.bindingIndex < b.bindingIndex; });
+    std::sort(reflection.inputLocations.begin(), reflection.inputLocations.end());
+    return true;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <GraphicsAPI.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Resource interface of one SPIR-V entry point
+struct ShaderReflection {
+    GraphicsAPI::ShaderCreateInfo::Type stage = GraphicsAPI::ShaderCreateInfo::Type::VERTEX;
+    std::vector<GraphicsAPI::DescriptorInfo> descriptors;  // Set 0 bindings, resource is null
+    std::vector<uint32_t> inputLocations;                  // User inputs, sorted; vertex attributes for a vertex shader
+};
+
+// Minimal SPIR-V parser reading just enough of a module to build pipeline layouts: the entry point's stage,
+// the descriptor bindings and the input locations.
+class SpirvReflection {
+public:
+    // Returns false when the code isn't valid SPIR-V or has no supported entry point
+    static bool Reflect(const void* code, size_t size, ShaderReflection& reflection);
+};
@@ -0,0 +1,68 @@
+#include "VertexLayout.h"
+#include "Vertex.h"
+#include <cstddef>
+
+const VertexAttributeStream* VertexLayout::Find(VertexSemantic semantic) const
+{
+    for (const VertexAttributeStream& attribute : attributes)
+    {
+        if (attribute.semantic == semantic) return &attribute;
+    }
+    return nullptr;
+}
+
+uint32_t VertexLayout::GetTypeSize(GraphicsAPI::VertexType type)
+{
+    switch (type)
+    {
+        case GraphicsAPI::VertexType::FLOAT:
+        case GraphicsAPI::VertexType::INT:
+        case GraphicsAPI::VertexType::UINT:
+        case GraphicsAPI::VertexType::HALF2:
+        case GraphicsAPI::VertexType::SNORM_10_10_10_2:
+            return 4;
+        case GraphicsAPI::VertexType::VEC2:
+        case GraphicsAPI::VertexType::IVEC2:
+        case GraphicsAPI::VertexType::UVEC2:
+        case GraphicsAPI::VertexType::HALF4:
+        case GraphicsAPI::VertexType::SNORM16x4:
+            return 8;
+        case GraphicsAPI::VertexType::VEC3:
+        case GraphicsAPI::VertexType::IVEC3:
+        case GraphicsAPI::VertexType::UVEC3:
+            return 12;
+        case GraphicsAPI::VertexType::VEC4:
+        case GraphicsAPI::VertexType::IVEC4:
+        case GraphicsAPI::VertexType::UVEC4:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+const VertexLayout& VertexLayout::GetStandard()
+{
+    static const VertexLayout layout = {
+        {{VertexSemantic::POSITION, GraphicsAPI::VertexType::VEC4, static_cast<uint32_t>(offsetof(Vertex, position))},
+         {VertexSemantic::NORMAL, GraphicsAPI::VertexType::VEC3, static_cast<uint32_t>(offsetof(Vertex, normal))}},
+        sizeof(Vertex)};
+    return layout;
+}
+
+VertexLayout VertexLayout::GetCompact(GraphicsAPI* graphicsAPI, bool withTexCoords)
+{
+    const GraphicsAPI::VertexType normalType = graphicsAPI && graphicsAPI->IsVertexTypeSupported(GraphicsAPI::VertexType::SNORM_10_10_10_2)
+                                                   ? GraphicsAPI::VertexType::SNORM_10_10_10_2
+                                                   : GraphicsAPI::VertexType::SNORM16x4;
+
+    VertexLayout layout;
+    layout.attributes.push_back({VertexSemantic::POSITION, GraphicsAPI::VertexType::HALF4, 0});
+    layout.attributes.push_back({VertexSemantic::NORMAL, normalType, GetTypeSize(GraphicsAPI::VertexType::HALF4)});
+    layout.stride = layout.attributes.back().offset + GetTypeSize(normalType);
+    if (withTexCoords)
+    {
+        layout.attributes.push_back({VertexSemantic::TEXCOORD0, GraphicsAPI::VertexType::HALF2, layout.stride});
+        layout.stride += GetTypeSize(GraphicsAPI::VertexType::HALF2);
+    }
+    return layout;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <GraphicsAPI.h>
+#include <cstdint>
+#include <vector>
+
+// What an attribute stream feeds. The value is also the shader input location.
+enum class VertexSemantic : uint8_t {
+    POSITION = 0,
+    NORMAL = 1,
+    TEXCOORD0 = 2
+};
+
+struct VertexAttributeStream {
+    VertexSemantic semantic;
+    GraphicsAPI::VertexType type;
+    uint32_t offset;
+
+    bool operator==(const VertexAttributeStream& other) const {
+        return semantic == other.semantic && type == other.type && offset == other.offset;
+    }
+};
+
+// Interleaved layout of a mesh's vertex buffer. Meshes declare their layout and materials build the
+// pipeline vertex input state from it, so packed and float meshes can be drawn with the same shaders.
+struct VertexLayout {
+    std::vector<VertexAttributeStream> attributes;
+    uint32_t stride = 0;
+
+    const VertexAttributeStream* Find(VertexSemantic semantic) const;
+
+    bool operator==(const VertexLayout& other) const {
+        return stride == other.stride && attributes == other.attributes;
+    }
+    bool operator!=(const VertexLayout& other) const { return !(*this == other); }
+
+    // Size in bytes of one element of the given type
+    static uint32_t GetTypeSize(GraphicsAPI::VertexType type);
+
+    // Float32 layout matching the Vertex struct: 28 bytes
+    static const VertexLayout& GetStandard();
+
+    // Half float positions and 10:10:10:2 normals (12 bytes, 16 with half float UVs). Falls back to 16-bit
+    // normals when the device can't fetch 10:10:10:2 vertices.
+    static VertexLayout GetCompact(GraphicsAPI* graphicsAPI, bool withTexCoords = false);
+};
@@ -0,0 +1,250 @@
+#include "VertexPacker.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    int16_t ToSnorm16(float value)
+    {
+        return static_cast<int16_t>(std::lround(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
+    }
+
+    float FromSnorm16(int16_t value)
+    {
+        return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+    }
+
+    uint32_t ToSnormBits(float value, uint32_t bitCount)
+    {
+        const float maxValue = static_cast<float>((1u << (bitCount - 1)) - 1);
+        const int32_t quantized = static_cast<int32_t>(std::lround(std::min(std::max(value, -1.0f), 1.0f) * maxValue));
+        return static_cast<uint32_t>(quantized) & ((1u << bitCount) - 1);
+    }
+
+    float FromSnormBits(uint32_t bits, uint32_t bitCount)
+    {
+        const float maxValue = static_cast<float>((1u << (bitCount - 1)) - 1);
+        // Sign extend from bitCount bits
+        const int32_t value = static_cast<int32_t>(bits << (32 - bitCount)) >> (32 - bitCount);
+        return std::max(static_cast<float>(value) / maxValue, -1.0f);
+    }
+
+    uint32_t GetComponentCount(GraphicsAPI::VertexType type)
+    {
+        switch (type)
+        {
+            case GraphicsAPI::VertexType::FLOAT:
+            case GraphicsAPI::VertexType::INT:
+            case GraphicsAPI::VertexType::UINT:
+                return 1;
+            case GraphicsAPI::VertexType::VEC2:
+            case GraphicsAPI::VertexType::IVEC2:
+            case GraphicsAPI::VertexType::UVEC2:
+            case GraphicsAPI::VertexType::HALF2:
+                return 2;
+            case GraphicsAPI::VertexType::VEC3:
+            case GraphicsAPI::VertexType::IVEC3:
+            case GraphicsAPI::VertexType::UVEC3:
+                return 3;
+            default:
+                return 4;
+        }
+    }
+
+    // Writes the first components of values in the given type. Integer types are not meaningful for the
+    // attributes a Vertex holds and are left zeroed.
+    void WriteAttribute(GraphicsAPI::VertexType type, const float (&values)[4], uint8_t* destination)
+    {
+        const uint32_t componentCount = GetComponentCount(type);
+        switch (type)
+        {
+            case GraphicsAPI::VertexType::FLOAT:
+            case GraphicsAPI::VertexType::VEC2:
+            case GraphicsAPI::VertexType::VEC3:
+            case GraphicsAPI::VertexType::VEC4:
+                std::memcpy(destination, values, componentCount * sizeof(float));
+                break;
+            case GraphicsAPI::VertexType::HALF2:
+            case GraphicsAPI::VertexType::HALF4:
+                for (uint32_t i = 0; i < componentCount; ++i)
+                {
+                    const uint16_t half = VertexPacker::FloatToHalf(values[i]);
+                    std::memcpy(destination + i * sizeof(uint16_t), &half, sizeof(uint16_t));
+                }
+                break;
+            case GraphicsAPI::VertexType::SNORM16x4:
+                for (uint32_t i = 0; i < componentCount; ++i)
+                {
+                    const int16_t snorm = ToSnorm16(values[i]);
+                    std::memcpy(destination + i * sizeof(int16_t), &snorm, sizeof(int16_t));
+                }
+                break;
+            case GraphicsAPI::VertexType::SNORM_10_10_10_2:
+            {
+                const uint32_t packed = ToSnormBits(values[0], 10) | (ToSnormBits(values[1], 10) << 10) | (ToSnormBits(values[2], 10) << 20) |
+                                        (ToSnormBits(values[3], 2) << 30);
+                std::memcpy(destination, &packed, sizeof(uint32_t));
+                break;
+            }
+            default:
+                std::memset(destination, 0, VertexLayout::GetTypeSize(type));
+                break;
+        }
+    }
+
+    void ReadAttribute(GraphicsAPI::VertexType type, const uint8_t* source, float (&values)[4])
+    {
+        const uint32_t componentCount = GetComponentCount(type);
+        switch (type)
+        {
+            case GraphicsAPI::VertexType::FLOAT:
+            case GraphicsAPI::VertexType::VEC2:
+            case GraphicsAPI::VertexType::VEC3:
+            case GraphicsAPI::VertexType::VEC4:
+                std::memcpy(values, source, componentCount * sizeof(float));
+                break;
+            case GraphicsAPI::VertexType::HALF2:
+            case GraphicsAPI::VertexType::HALF4:
+                for (uint32_t i = 0; i < componentCount; ++i)
+                {
+                    uint16_t half;
+                    std::memcpy(&half, source + i * sizeof(uint16_t), sizeof(uint16_t));
+                    values[i] = VertexPacker::HalfToFloat(half);
+                }
+                break;
+            case GraphicsAPI::VertexType::SNORM16x4:
+                for (uint32_t i = 0; i < componentCount; ++i)
+                {
+                    int16_t snorm;
+                    std::memcpy(&snorm, source + i * sizeof(int16_t), sizeof(int16_t));
+                    values[i] = FromSnorm16(snorm);
+                }
+                break;
+            case GraphicsAPI::VertexType::SNORM_10_10_10_2:
+            {
+                uint32_t packed;
+                std::memcpy(&packed, source, sizeof(uint32_t));
+                values[0] = FromSnormBits(packed & 0x3FF, 10);
+                values[1] = FromSnormBits((packed >> 10) & 0x3FF, 10);
+                values[2] = FromSnormBits((packed >> 20) & 0x3FF, 10);
+                values[3] = FromSnormBits(packed >> 30, 2);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+std::vector<uint8_t> VertexPacker::Pack(const Vertex* vertices, size_t vertexCount, const VertexLayout& layout, const XrVector2f* texCoords)
+{
+    std::vector<uint8_t> data(vertexCount * layout.stride, 0);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        uint8_t* vertexData = data.data() + i * layout.stride;
+        for (const VertexAttributeStream& attribute : layout.attributes)
+        {
+            float values[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            switch (attribute.semantic)
+            {
+                case VertexSemantic::POSITION:
+                    values[0] = vertices[i].position.x;
+                    values[1] = vertices[i].position.y;
+                    values[2] = vertices[i].position.z;
+                    values[3] = 1.0f;
+                    break;
+                case VertexSemantic::NORMAL:
+                    values[0] = vertices[i].normal.x;
+                    values[1] = vertices[i].normal.y;
+                    values[2] = vertices[i].normal.z;
+                    break;
+                case VertexSemantic::TEXCOORD0:
+                    if (texCoords)
+                    {
+                        values[0] = texCoords[i].x;
+                        values[1] = texCoords[i].y;
+                    }
+                    break;
+            }
+            WriteAttribute(attribute.type, values, vertexData + attribute.offset);
+        }
+    }
+    return data;
+}
+
+void VertexPacker::Unpack(const uint8_t* data, size_t vertexCount, const VertexLayout& layout, std::vector<Vertex>& vertices)
+{
+    const VertexAttributeStream* position = layout.Find(VertexSemantic::POSITION);
+    const VertexAttributeStream* normal = layout.Find(VertexSemantic::NORMAL);
+
+    vertices.resize(vertexCount);
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const uint8_t* vertexData = data + i * layout.stride;
+        float values[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        if (position) ReadAttribute(position->type, vertexData + position->offset, values);
+        vertices[i].position = {values[0], values[1], values[2], 1.0f};
+
+        float normalValues[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        if (normal) ReadAttribute(normal->type, vertexData + normal->offset, normalValues);
+        vertices[i].normal = {normalValues[0], normalValues[1], normalValues[2]};
+    }
+}
+
+uint16_t VertexPacker::FloatToHalf(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t exponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent == 0xFF) return static_cast<uint16_t>(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+
+    const int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+    if (halfExponent >= 31) return static_cast<uint16_t>(sign | 0x7C00);
+
+    if (halfExponent <= 0)
+    {
+        // Subnormal half, or zero when even that is too small
+        if (halfExponent < -10) return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000;
+        const uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t halfMantissa = mantissa >> shift;
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (halfMantissa & 1) != 0)) ++halfMantissa;
+        return static_cast<uint16_t>(sign | halfMantissa);
+    }
+
+    // A carry out of the mantissa bumps the exponent, which is the correctly rounded result (up to infinity)
+    uint32_t half = sign | (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+    const uint32_t remainder = mantissa & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1) != 0)) ++half;
+    return static_cast<uint16_t>(half);
+}
+
+float VertexPacker::HalfToFloat(uint16_t value)
+{
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1F;
+    const uint32_t mantissa = value & 0x3FF;
+
+    if (exponent == 0)
+    {
+        const float magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign != 0 ? -magnitude : magnitude;
+    }
+
+    uint32_t bits;
+    if (exponent == 31)
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    else
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
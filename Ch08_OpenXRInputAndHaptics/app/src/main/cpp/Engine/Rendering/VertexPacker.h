@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Vertex.h"
+#include "VertexLayout.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Converts between the float Vertex struct and the interleaved buffer of an arbitrary VertexLayout.
+// Positions are stored with w = 1; normals are expected to be unit length when stored as signed normalized.
+class VertexPacker {
+public:
+    // Attributes without source data, e.g. TEXCOORD0 when texCoords is null, are written as zero
+    static std::vector<uint8_t> Pack(const Vertex* vertices, size_t vertexCount, const VertexLayout& layout, const XrVector2f* texCoords = nullptr);
+
+    static void Unpack(const uint8_t* data, size_t vertexCount, const VertexLayout& layout, std::vector<Vertex>& vertices);
+
+    // IEEE 754 binary16 conversion, rounding to nearest even
+    static uint16_t FloatToHalf(float value);
+    static float HalfToFloat(uint16_t value);
+};
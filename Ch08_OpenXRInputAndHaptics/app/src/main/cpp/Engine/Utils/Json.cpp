@@ -0,0 +1,211 @@
+﻿#include "Json.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    const JsonValue s_NullValue;
+
+    class JsonParser
+    {
+    public:
+        JsonParser(const char* text, size_t length) : m_Text(text), m_Length(length) {}
+
+        bool ParseDocument(JsonValue& value)
+        {
+            if (!ParseValue(value, 0)) return false;
+            SkipWhitespace();
+            return m_Position == m_Length;
+        }
+
+    private:
+        // Deeper documents are rejected rather than risking a stack overflow
+        static constexpr int MAX_DEPTH = 64;
+
+        void SkipWhitespace()
+        {
+            while (m_Position < m_Length && std::isspace(static_cast<unsigned char>(m_Text[m_Position]))) ++m_Position;
+        }
+
+        bool Consume(char expected)
+        {
+            SkipWhitespace();
+            if (m_Position >= m_Length || m_Text[m_Position] != expected) return false;
+            ++m_Position;
+            return true;
+        }
+
+        bool ConsumeLiteral(const char* literal)
+        {
+            const size_t length = std::strlen(literal);
+            if (m_Length - m_Position < length || std::strncmp(m_Text + m_Position, literal, length) != 0) return false;
+            m_Position += length;
+            return true;
+        }
+
+        void AppendUtf8(std::string& string, uint32_t codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                string.push_back(static_cast<char>(codePoint));
+            }
+            else if (codePoint < 0x800)
+            {
+                string.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                string.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else
+            {
+                string.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                string.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                string.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+        }
+
+        bool ParseString(std::string& string)
+        {
+            if (!Consume('"')) return false;
+
+            while (m_Position < m_Length && m_Text[m_Position] != '"')
+            {
+                char c = m_Text[m_Position++];
+                if (c != '\\')
+                {
+                    string.push_back(c);
+                    continue;
+                }
+                if (m_Position >= m_Length) return false;
+
+                c = m_Text[m_Position++];
+                switch (c)
+                {
+                case 'b': string.push_back('\b'); break;
+                case 'f': string.push_back('\f'); break;
+                case 'n': string.push_back('\n'); break;
+                case 'r': string.push_back('\r'); break;
+                case 't': string.push_back('\t'); break;
+                case 'u':
+                {
+                    // Surrogate pairs aren't combined; glTF keys and URIs don't need them
+                    if (m_Length - m_Position < 4) return false;
+                    const std::string hex(m_Text + m_Position, 4);
+                    AppendUtf8(string, static_cast<uint32_t>(std::strtoul(hex.c_str(), nullptr, 16)));
+                    m_Position += 4;
+                    break;
+                }
+                default: string.push_back(c); break;
+                }
+            }
+            return m_Position < m_Length && m_Text[m_Position++] == '"';
+        }
+
+        bool ParseValue(JsonValue& value, int depth)
+        {
+            if (depth > MAX_DEPTH) return false;
+
+            SkipWhitespace();
+            if (m_Position >= m_Length) return false;
+
+            const char c = m_Text[m_Position];
+            if (c == '{')
+            {
+                value.type = JsonValue::Type::OBJECT;
+                ++m_Position;
+                if (Consume('}')) return true;
+                do
+                {
+                    std::string key;
+                    if (!ParseString(key) || !Consume(':') || !ParseValue(value.object[key], depth + 1)) return false;
+                } while (Consume(','));
+                return Consume('}');
+            }
+            if (c == '[')
+            {
+                value.type = JsonValue::Type::ARRAY;
+                ++m_Position;
+                if (Consume(']')) return true;
+                do
+                {
+                    value.array.emplace_back();
+                    if (!ParseValue(value.array.back(), depth + 1)) return false;
+                } while (Consume(','));
+                return Consume(']');
+            }
+            if (c == '"')
+            {
+                value.type = JsonValue::Type::STRING;
+                return ParseString(value.string);
+            }
+            if (ConsumeLiteral("true"))
+            {
+                value.type = JsonValue::Type::BOOLEAN;
+                value.number = 1.0;
+                return true;
+            }
+            if (ConsumeLiteral("false"))
+            {
+                value.type = JsonValue::Type::BOOLEAN;
+                return true;
+            }
+            if (ConsumeLiteral("null"))
+            {
+                return true;
+            }
+
+            // strtod needs a terminated string, so copy the characters a number can be made of
+            size_t end = m_Position;
+            while (end < m_Length && (std::isdigit(static_cast<unsigned char>(m_Text[end])) || std::strchr("+-.eE", m_Text[end]))) ++end;
+            if (end == m_Position) return false;
+
+            const std::string numberText(m_Text + m_Position, end - m_Position);
+            char* numberEnd = nullptr;
+            value.type = JsonValue::Type::NUMBER;
+            value.number = std::strtod(numberText.c_str(), &numberEnd);
+            if (numberEnd != numberText.c_str() + numberText.size()) return false;
+
+            m_Position = end;
+            return true;
+        }
+
+        const char* m_Text;
+        size_t m_Length;
+        size_t m_Position = 0;
+    };
+}
+
+bool JsonValue::Parse(const char* text, size_t length, JsonValue& value)
+{
+    value = JsonValue();
+    JsonParser parser(text, length);
+    if (!parser.ParseDocument(value))
+    {
+        value = JsonValue();
+        return false;
+    }
+    return true;
+}
+
+const JsonValue* JsonValue::Find(const std::string& key) const
+{
+    auto it = object.find(key);
+    return it != object.end() ? &it->second : nullptr;
+}
+
+double JsonValue::GetNumber(const std::string& key, double defaultValue) const
+{
+    const JsonValue* value = Find(key);
+    return value && value->type == Type::NUMBER ? value->number : defaultValue;
+}
+
+std::string JsonValue::GetString(const std::string& key, const std::string& defaultValue) const
+{
+    const JsonValue* value = Find(key);
+    return value && value->type == Type::STRING ? value->string : defaultValue;
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const
+{
+    return index < array.size() ? array[index] : s_NullValue;
+}
@@ -0,0 +1,39 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Minimal JSON document model: enough for glTF files and the benchmark results, no writer
+struct JsonValue
+{
+    enum class Type
+    {
+        NUL,
+        BOOLEAN,
+        NUMBER,
+        STRING,
+        ARRAY,
+        OBJECT
+    };
+
+    Type type = Type::NUL;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::map<std::string, JsonValue> object;
+
+    // Returns false and leaves value as null when text isn't a complete JSON document
+    static bool Parse(const char* text, size_t length, JsonValue& value);
+
+    bool IsObject() const { return type == Type::OBJECT; }
+    bool IsArray() const { return type == Type::ARRAY; }
+
+    const JsonValue* Find(const std::string& key) const;
+    double GetNumber(const std::string& key, double defaultValue = 0.0) const;
+    std::string GetString(const std::string& key, const std::string& defaultValue = std::string()) const;
+
+    // Array element, or a shared null value when out of range
+    const JsonValue& operator[](size_t index) const;
+};
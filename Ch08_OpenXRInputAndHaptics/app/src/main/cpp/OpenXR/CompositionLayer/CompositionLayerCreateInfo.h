@@ -0,0 +1,33 @@
+#pragma once
+#include <openxr/openxr.h>
+
+#include <cstdint>
+
+enum class CompositionLayerShape : uint8_t
+{
+    QUAD,
+    // Needs XR_KHR_composition_layer_cylinder, falls back to a quad of the same size without it
+    CYLINDER,
+};
+
+struct CompositionLayerCreateInfo
+{
+    CompositionLayerShape shape = CompositionLayerShape::QUAD;
+    // Size of the layer's swapchain images
+    uint32_t width = 512;
+    uint32_t height = 512;
+    // Placed in the head's view space instead of the world
+    bool headLocked = false;
+    // Blends the layer with what is below it using the image's alpha
+    bool alphaBlend = true;
+
+    // Quad size in meters
+    XrExtent2Df size = {1.0f, 1.0f};
+    // Cylinder shape, the height follows from the arc length and the aspect ratio
+    float radius = 1.0f;
+    float centralAngle = 1.0f;
+    float aspectRatio = 1.0f;
+};
+
+using CompositionLayerHandle = uint32_t;
+constexpr CompositionLayerHandle INVALID_COMPOSITION_LAYER = 0;
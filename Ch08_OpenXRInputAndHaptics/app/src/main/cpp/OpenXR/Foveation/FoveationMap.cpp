@@ -0,0 +1,82 @@
+#include "FoveationMap.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr float DEG_TO_RAD = 3.14159265358979f / 180.0f;
+}
+
+FoveationMap::LevelProfile FoveationMap::GetLevelProfile(FoveationLevel level)
+{
+    switch (level)
+    {
+        case FoveationLevel::LOW:
+            return {20.0f, 35.0f, 0.5f};
+        case FoveationLevel::MEDIUM:
+            return {15.0f, 30.0f, 0.25f};
+        case FoveationLevel::HIGH:
+            return {10.0f, 25.0f, 0.25f};
+        case FoveationLevel::NONE:
+        default:
+            return {180.0f, 180.0f, 1.0f};
+    }
+}
+
+float FoveationMap::GetDensity(FoveationLevel level, float eccentricity)
+{
+    const LevelProfile profile = GetLevelProfile(level);
+    const float innerAngle = profile.innerAngleDeg * DEG_TO_RAD;
+    const float outerAngle = profile.outerAngleDeg * DEG_TO_RAD;
+    if (eccentricity <= innerAngle)
+    {
+        return 1.0f;
+    }
+    if (eccentricity >= outerAngle)
+    {
+        return profile.minDensity;
+    }
+    const float t = (eccentricity - innerAngle) / (outerAngle - innerAngle);
+    return 1.0f + t * (profile.minDensity - 1.0f);
+}
+
+void FoveationMap::Generate(const XrFovf& fov, FoveationLevel level, float verticalOffset, uint32_t mapWidth, uint32_t mapHeight,
+                            float coveredWidth, float coveredHeight, std::vector<uint8_t>& texels)
+{
+    texels.assign(static_cast<size_t>(mapWidth) * mapHeight * 2, 255);
+    if (coveredWidth <= 0.0f || coveredHeight <= 0.0f)
+    {
+        return;
+    }
+
+    // Directions are compared on the z = -1 plane, where the framebuffer maps linearly onto the view's tangents.
+    // Row 0 is the top of the image.
+    const float tanLeft = std::tan(fov.angleLeft);
+    const float tanRight = std::tan(fov.angleRight);
+    const float tanUp = std::tan(fov.angleUp);
+    const float tanDown = std::tan(fov.angleDown);
+    const float tanCenterY = std::tan(verticalOffset * DEG_TO_RAD);
+    const float centerLength = std::sqrt(tanCenterY * tanCenterY + 1.0f);
+
+    const uint32_t coveredColumns = std::min(mapWidth, static_cast<uint32_t>(std::ceil(coveredWidth)));
+    const uint32_t coveredRows = std::min(mapHeight, static_cast<uint32_t>(std::ceil(coveredHeight)));
+    for (uint32_t y = 0; y < coveredRows; ++y)
+    {
+        const float v = std::min((static_cast<float>(y) + 0.5f) / coveredHeight, 1.0f);
+        const float tanY = tanUp + v * (tanDown - tanUp);
+        for (uint32_t x = 0; x < coveredColumns; ++x)
+        {
+            const float u = std::min((static_cast<float>(x) + 0.5f) / coveredWidth, 1.0f);
+            const float tanX = tanLeft + u * (tanRight - tanLeft);
+
+            const float cosAngle = (tanY * tanCenterY + 1.0f) / (std::sqrt(tanX * tanX + tanY * tanY + 1.0f) * centerLength);
+            const float eccentricity = std::acos(std::max(-1.0f, std::min(1.0f, cosAngle)));
+            const uint8_t density = static_cast<uint8_t>(std::lround(GetDensity(level, eccentricity) * 255.0f));
+
+            uint8_t* texel = &texels[(static_cast<size_t>(y) * mapWidth + x) * 2];
+            texel[0] = density;
+            texel[1] = density;
+        }
+    }
+}
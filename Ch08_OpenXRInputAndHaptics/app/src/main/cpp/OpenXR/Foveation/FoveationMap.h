@@ -0,0 +1,31 @@
+#pragma once
+#include <openxr/openxr.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "FoveationSettings.h"
+
+// Builds the contents of a fragment density map for a view. Each RG8 texel holds the horizontal and
+// vertical fragment density of the framebuffer region it covers, 255 being full resolution. Density stays
+// full around the foveation center and falls off linearly with the angle from it.
+class FoveationMap
+{
+public:
+    // The map is mapWidth x mapHeight texels, of which the rendered region covers the top-left
+    // coveredWidth x coveredHeight (fractional at the edges); texels outside of it are left at full density
+    static void Generate(const XrFovf& fov, FoveationLevel level, float verticalOffset, uint32_t mapWidth, uint32_t mapHeight,
+                         float coveredWidth, float coveredHeight, std::vector<uint8_t>& texels);
+
+    // Density of a texel seen at the given angle from the foveation center, in radians
+    static float GetDensity(FoveationLevel level, float eccentricity);
+
+private:
+    struct LevelProfile
+    {
+        float innerAngleDeg;  // Full density up to this angle
+        float outerAngleDeg;  // Minimum density from this angle on
+        float minDensity;
+    };
+    static LevelProfile GetLevelProfile(FoveationLevel level);
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+
+enum class FoveationLevel : uint8_t
+{
+    NONE = 0,
+    LOW,
+    MEDIUM,
+    HIGH,
+};
+
+struct FoveationSettings
+{
+    FoveationLevel level = FoveationLevel::MEDIUM;
+    // Lets the level rise while the GPU is over its frame budget
+    bool dynamic = false;
+    // Follows the gaze instead of the view center where the runtime supports it (XR_META_foveation_eye_tracked)
+    bool eyeTracked = true;
+    // Moves the full resolution region up (positive) or down from the view center, in degrees
+    float verticalOffset = 0.0f;
+};
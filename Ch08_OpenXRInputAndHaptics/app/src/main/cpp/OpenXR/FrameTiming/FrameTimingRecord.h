@@ -0,0 +1,42 @@
+#pragma once
+#include <openxr/openxr.h>
+#include <cstdint>
+
+enum class FrameStage : uint8_t
+{
+    WAIT,
+    BEGIN,
+    SIMULATE,
+    RECORD,
+    SUBMIT,
+    END,
+    COUNT
+};
+
+// One begin/end pair of a stage, inclusive of the stages nested in it
+struct FrameStageSpan
+{
+    FrameStage stage = FrameStage::COUNT;
+    int64_t begin = 0;
+    int64_t end = 0;  // 0 while the stage hasn't ended
+};
+
+struct FrameTimingRecord
+{
+    uint64_t frameIndex = 0;
+    XrTime predictedDisplayTime = 0;
+    XrDuration predictedDisplayPeriod = 0;
+    float deltaTime = 0.0f;
+    uint32_t missedFrames = 0;  // Display periods skipped since the previous frame
+
+    // CPU timestamps in nanoseconds (steady clock). A stage entered several times per frame keeps
+    // its first begin time and the summed duration. Durations are exclusive: a stage begun inside another,
+    // like SUBMIT inside RECORD, pauses the outer one.
+    int64_t stageBegin[static_cast<int>(FrameStage::COUNT)] = {};
+    int64_t stageDuration[static_cast<int>(FrameStage::COUNT)] = {};
+
+    // Every begin/end pair in the order the stages began, for traces. Spans past the capacity are dropped.
+    static constexpr uint32_t MAX_STAGE_SPANS = 32;
+    FrameStageSpan stageSpans[MAX_STAGE_SPANS];
+    uint32_t stageSpanCount = 0;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Single-producer ring buffer that overwrites the oldest entry. Readers never block the producer:
+// each slot carries a sequence number and a reader discards any slot that was rewritten while copying.
+template <typename T, size_t Capacity>
+class FrameTimingRingBuffer
+{
+public:
+    void Push(const T& value)
+    {
+        const uint64_t writeIndex = m_WriteIndex.load(std::memory_order_relaxed);
+        Slot& slot = m_Slots[writeIndex % Capacity];
+
+        slot.sequence.store(writeIndex * 2 + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.value = value;
+        slot.sequence.store(writeIndex * 2 + 2, std::memory_order_release);
+
+        m_WriteIndex.store(writeIndex + 1, std::memory_order_release);
+    }
+
+    // Copies the retained entries, oldest first
+    std::vector<T> Snapshot() const
+    {
+        std::vector<T> values;
+        const uint64_t writeIndex = m_WriteIndex.load(std::memory_order_acquire);
+        const uint64_t firstIndex = writeIndex > Capacity ? writeIndex - Capacity : 0;
+        values.reserve(static_cast<size_t>(writeIndex - firstIndex));
+
+        for (uint64_t index = firstIndex; index < writeIndex; ++index)
+        {
+            const Slot& slot = m_Slots[index % Capacity];
+            const uint64_t expectedSequence = index * 2 + 2;
+            if (slot.sequence.load(std::memory_order_acquire) != expectedSequence) continue;
+
+            T value = slot.value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != expectedSequence) continue;
+
+            values.push_back(value);
+        }
+        return values;
+    }
+
+    uint64_t GetTotalPushed() const { return m_WriteIndex.load(std::memory_order_acquire); }
+
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence{0};
+        T value{};
+    };
+
+    Slot m_Slots[Capacity];
+    std::atomic<uint64_t> m_WriteIndex{0};
+};
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+
+struct GpuTimingRecord
+{
+    uint64_t submissionIndex = 0;
+
+    // GPU timestamps are relative to the start of their submission, so they're placed on the CPU timeline
+    // by offsetting them from the submit time. This is an approximation that ignores the queue latency.
+    int64_t cpuBeginNs = 0;
+    int64_t durationNs = 0;
+    uint32_t depth = 0;  // Nesting level of the scope inside its submission
+    char name[48] = {};
+};
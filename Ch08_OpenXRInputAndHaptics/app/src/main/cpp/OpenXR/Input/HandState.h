@@ -7,4 +7,7 @@ struct HandState
     bool lastSelectPressed = false;
     XrPosef pose = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
     bool poseActive = false;
+    XrVector3f linearVelocity = {0.0f, 0.0f, 0.0f};
+    XrVector3f angularVelocity = {0.0f, 0.0f, 0.0f};
+    bool velocityValid = false;
 };
\ No newline at end of file
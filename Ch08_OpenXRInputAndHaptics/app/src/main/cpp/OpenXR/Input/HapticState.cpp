@@ -0,0 +1,43 @@
+#include "HapticState.h"
+
+#include <algorithm>
+
+void HapticState::QueuePulse(const HapticPulse& pulse)
+{
+    if (!hasPendingPulse)
+    {
+        pendingPulse = pulse;
+        hasPendingPulse = true;
+        return;
+    }
+
+    if (pulse.amplitude > pendingPulse.amplitude)
+    {
+        pendingPulse.amplitude = pulse.amplitude;
+        pendingPulse.frequency = pulse.frequency;
+    }
+    pendingPulse.duration = std::max(pendingPulse.duration, pulse.duration);
+}
+
+void HapticState::StepPattern(XrTime predictedTime)
+{
+    if (pattern.empty() || predictedTime < segmentEndTime)
+    {
+        return;
+    }
+
+    if (patternIndex < pattern.size())
+    {
+        const HapticPulse& segment = pattern[patternIndex++];
+        segmentEndTime = predictedTime + segment.duration;
+        if (segment.amplitude > 0.0f)
+        {
+            QueuePulse(segment);
+        }
+    }
+    else
+    {
+        pattern.clear();
+        patternIndex = 0;
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <openxr/openxr.h>
+#include <vector>
+
+struct HapticPulse
+{
+    float amplitude = 0.5f;
+    XrDuration duration = XR_MIN_HAPTIC_DURATION;
+    float frequency = XR_FREQUENCY_UNSPECIFIED;
+};
+
+// Per-hand haptic requests, gathered during the frame and flushed once by OpenXRInputMgr::FlushHaptics
+struct HapticState
+{
+    // Coalesces requests within one frame: the strongest amplitude wins, durations merge to the longest
+    void QueuePulse(const HapticPulse& pulse);
+    // Starts the next pattern segment once the current one has elapsed and queues it, gaps only wait. The pattern
+    // is cleared one segment after its last.
+    void StepPattern(XrTime predictedTime);
+
+    HapticPulse pendingPulse{};
+    bool hasPendingPulse = false;
+    bool stopRequested = false;
+
+    std::vector<HapticPulse> pattern;  // Segments with zero amplitude act as gaps
+    size_t patternIndex = 0;
+    XrTime segmentEndTime = 0;
+};
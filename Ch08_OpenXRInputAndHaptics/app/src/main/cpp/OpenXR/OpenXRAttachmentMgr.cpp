@@ -0,0 +1,169 @@
+﻿#include "OpenXRAttachmentMgr.h"
+
+#include <DebugOutput.h>
+
+#include "../Engine/Diagnostics/TraceLogMgr.h"
+#include "OpenXRCoreMgr.h"
+#include "OpenXRDisplayMgr.h"
+#include "OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
+
+uint32_t OpenXRAttachmentMgr::m_RequestedSampleCount = OpenXRAttachmentMgr::AUTOMATIC_SAMPLE_COUNT;
+bool OpenXRAttachmentMgr::m_DepthSubmissionRequested = true;
+uint32_t OpenXRAttachmentMgr::m_SampleCount = 1;
+bool OpenXRAttachmentMgr::m_DepthSubmitted = false;
+bool OpenXRAttachmentMgr::m_DepthTransient = false;
+std::vector<OpenXRAttachmentMgr::ViewAttachments> OpenXRAttachmentMgr::m_ViewAttachments{};
+
+void OpenXRAttachmentMgr::SetSampleCount(uint32_t sampleCount)
+{
+    m_RequestedSampleCount = sampleCount;
+}
+
+void OpenXRAttachmentMgr::SetDepthSubmission(bool enabled)
+{
+    m_DepthSubmissionRequested = enabled;
+}
+
+void OpenXRAttachmentMgr::Initialize()
+{
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+    const bool transientSupported = graphicsAPI->IsDeferredRenderTargetSupported();
+
+    // Submitting multisampled depth would need a depth resolve into the swapchain. Depth lets the compositor
+    // reproject per pixel, which matters more than smoother edges, so it wins over multisampling.
+    const bool depthExtension = OpenXRCoreMgr::IsExtensionEnabled(XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME);
+    m_DepthSubmitted = m_DepthSubmissionRequested && depthExtension;
+
+    uint32_t requestedSampleCount = m_RequestedSampleCount;
+    if (requestedSampleCount == AUTOMATIC_SAMPLE_COUNT)
+    {
+        requestedSampleCount = m_DepthSubmitted ? 1 : 4;
+    }
+
+    m_SampleCount = 1;
+    if (requestedSampleCount > 1 && m_DepthSubmitted)
+    {
+        XR_TRACE_WARN("OpenXRAttachmentMgr: {}x MSAA requested together with depth submission, rendering single sampled to submit depth",
+                      requestedSampleCount);
+    }
+    else if (requestedSampleCount > 1 && !transientSupported)
+    {
+        XR_TUT_LOG("Multisampling needs deferred render targets, rendering single sampled");
+    }
+    else if (requestedSampleCount > 1)
+    {
+        // Sample counts are powers of two
+        const uint32_t maxSampleCount = graphicsAPI->GetMaxSampleCount();
+        while (m_SampleCount * 2 <= requestedSampleCount && m_SampleCount * 2 <= maxSampleCount)
+        {
+            m_SampleCount *= 2;
+        }
+    }
+    m_DepthTransient = !m_DepthSubmitted && transientSupported;
+
+    XR_TUT_LOG("View attachments: " << m_SampleCount << "x MSAA, " << (m_DepthTransient ? "transient" : "swapchain") << " depth"
+                                    << (m_DepthSubmitted ? ", submitted" : ""));
+}
+
+void OpenXRAttachmentMgr::CreateAttachments()
+{
+    m_ViewAttachments.resize(OpenXRDisplayMgr::GetViewsCount());
+    for (size_t viewIndex = 0; viewIndex < m_ViewAttachments.size(); ++viewIndex)
+    {
+        // Sized like the swapchains, the dynamic resolution only renders part of them
+        const XrViewConfigurationView& viewConfigurationView = OpenXRDisplayMgr::activeViewConfigurationViews[viewIndex];
+        const uint32_t width = viewConfigurationView.maxImageRectWidth;
+        const uint32_t height = viewConfigurationView.maxImageRectHeight;
+
+        ViewAttachments& attachments = m_ViewAttachments[viewIndex];
+        if (m_SampleCount > 1)
+        {
+            CreateAttachment(width, height, OpenXRDisplayMgr::colorSwapchainInfos[viewIndex].swapchainFormat, false, attachments.colorImage,
+                             attachments.colorView);
+        }
+        if (m_DepthTransient)
+        {
+            CreateAttachment(width, height, GetDepthFormat(), true, attachments.depthImage, attachments.depthView);
+        }
+    }
+}
+
+void OpenXRAttachmentMgr::CreateAttachment(uint32_t width, uint32_t height, int64_t format, bool isDepth, void*& image, void*& imageView)
+{
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+
+    GraphicsAPI::ImageCreateInfo imageCreateInfo{};
+    imageCreateInfo.dimension = 2;
+    imageCreateInfo.width = width;
+    imageCreateInfo.height = height;
+    imageCreateInfo.depth = 1;
+    imageCreateInfo.mipLevels = 1;
+    imageCreateInfo.arrayLayers = 1;
+    imageCreateInfo.sampleCount = m_SampleCount;
+    imageCreateInfo.format = format;
+    imageCreateInfo.cubemap = false;
+    imageCreateInfo.colorAttachment = !isDepth;
+    imageCreateInfo.depthAttachment = isDepth;
+    imageCreateInfo.sampled = false;
+    imageCreateInfo.transient = true;
+    image = graphicsAPI->CreateImage(imageCreateInfo);
+
+    GraphicsAPI::ImageViewCreateInfo imageViewCreateInfo{};
+    imageViewCreateInfo.image = image;
+    imageViewCreateInfo.type = isDepth ? GraphicsAPI::ImageViewCreateInfo::Type::DSV : GraphicsAPI::ImageViewCreateInfo::Type::RTV;
+    imageViewCreateInfo.view = GraphicsAPI::ImageViewCreateInfo::View::TYPE_2D;
+    imageViewCreateInfo.format = format;
+    imageViewCreateInfo.aspect = isDepth ? GraphicsAPI::ImageViewCreateInfo::Aspect::DEPTH_BIT : GraphicsAPI::ImageViewCreateInfo::Aspect::COLOR_BIT;
+    imageViewCreateInfo.baseMipLevel = 0;
+    imageViewCreateInfo.levelCount = 1;
+    imageViewCreateInfo.baseArrayLayer = 0;
+    imageViewCreateInfo.layerCount = 1;
+    imageView = graphicsAPI->CreateImageView(imageViewCreateInfo);
+}
+
+void OpenXRAttachmentMgr::Shutdown()
+{
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+    for (ViewAttachments& attachments : m_ViewAttachments)
+    {
+        if (attachments.colorView) graphicsAPI->DestroyImageView(attachments.colorView);
+        if (attachments.colorImage) graphicsAPI->DestroyImage(attachments.colorImage);
+        if (attachments.depthView) graphicsAPI->DestroyImageView(attachments.depthView);
+        if (attachments.depthImage) graphicsAPI->DestroyImage(attachments.depthImage);
+    }
+    m_ViewAttachments.clear();
+}
+
+uint32_t OpenXRAttachmentMgr::GetSampleCount()
+{
+    return m_SampleCount;
+}
+
+bool OpenXRAttachmentMgr::IsDepthSubmitted()
+{
+    return m_DepthSubmitted;
+}
+
+bool OpenXRAttachmentMgr::IsDepthTransient()
+{
+    return m_DepthTransient;
+}
+
+int64_t OpenXRAttachmentMgr::GetDepthFormat()
+{
+    if (m_DepthTransient)
+    {
+        return OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->GetDepthFormat();
+    }
+    return OpenXRDisplayMgr::depthSwapchainInfos[0].swapchainFormat;
+}
+
+void* OpenXRAttachmentMgr::GetColorAttachment(int viewIndex)
+{
+    return viewIndex < static_cast<int>(m_ViewAttachments.size()) ? m_ViewAttachments[viewIndex].colorView : nullptr;
+}
+
+void* OpenXRAttachmentMgr::GetDepthAttachment(int viewIndex)
+{
+    return viewIndex < static_cast<int>(m_ViewAttachments.size()) ? m_ViewAttachments[viewIndex].depthView : nullptr;
+}
@@ -0,0 +1,54 @@
+﻿#pragma once
+#include <openxr/openxr.h>
+
+#include <cstdint>
+#include <vector>
+
+// Attachments a view renders into besides its color swapchain image. Depth lives in a transient image unless it's
+// submitted to the compositor, and with multisampling the view renders into transient multisampled color that the
+// render pass resolves into the swapchain image. Transient attachments aren't stored, so they need the whole view
+// in one render pass, which only backends with deferred render targets guarantee.
+class OpenXRAttachmentMgr
+{
+public:
+    // Both apply to the swapchains created afterwards. Depth can only be submitted single sampled, so while the
+    // runtime takes depth, a requested sample count above 1 is dropped in favour of depth submission.
+    // AUTOMATIC_SAMPLE_COUNT renders 4x MSAA when depth isn't submitted and single sampled when it is.
+    static constexpr uint32_t AUTOMATIC_SAMPLE_COUNT = 0;
+    static void SetSampleCount(uint32_t sampleCount);
+    static void SetDepthSubmission(bool enabled);
+
+    // Settles the settings against the enabled extensions and the backend, call before the swapchains are created
+    static void Initialize();
+    // Allocates the transient attachments, call once the view swapchains exist
+    static void CreateAttachments();
+    static void Shutdown();
+
+    static uint32_t GetSampleCount();
+    static bool IsDepthSubmitted();
+    // Without a depth swapchain the views use GetDepthAttachment instead
+    static bool IsDepthTransient();
+    static int64_t GetDepthFormat();
+    // Multisampled color the view renders into, nullptr when it renders straight into the swapchain image
+    static void* GetColorAttachment(int viewIndex);
+    // Transient depth of the view, nullptr when the depth swapchain is used
+    static void* GetDepthAttachment(int viewIndex);
+
+private:
+    struct ViewAttachments
+    {
+        void* colorImage = nullptr;
+        void* colorView = nullptr;
+        void* depthImage = nullptr;
+        void* depthView = nullptr;
+    };
+
+    static void CreateAttachment(uint32_t width, uint32_t height, int64_t format, bool isDepth, void*& image, void*& imageView);
+
+    static uint32_t m_RequestedSampleCount;
+    static bool m_DepthSubmissionRequested;
+    static uint32_t m_SampleCount;
+    static bool m_DepthSubmitted;
+    static bool m_DepthTransient;
+    static std::vector<ViewAttachments> m_ViewAttachments;
+};
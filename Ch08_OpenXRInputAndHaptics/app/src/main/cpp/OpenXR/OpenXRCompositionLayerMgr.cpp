@@ -0,0 +1,246 @@
+﻿#include "OpenXRCompositionLayerMgr.h"
+
+#include <DebugOutput.h>
+#include <OpenXRHelper.h>
+
+#include "OpenXRCoreMgr.h"
+#include "OpenXRDisplayMgr.h"
+#include "OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
+#include "OpenXRSpaceMgr.h"
+
+std::map<CompositionLayerHandle, OpenXRCompositionLayerMgr::Layer> OpenXRCompositionLayerMgr::m_Layers{};
+CompositionLayerHandle OpenXRCompositionLayerMgr::m_NextHandle = 1;
+bool OpenXRCompositionLayerMgr::m_LayerLimitReported = false;
+
+CompositionLayerHandle OpenXRCompositionLayerMgr::CreateLayer(const CompositionLayerCreateInfo& createInfo)
+{
+    if (createInfo.width == 0 || createInfo.height == 0 || OpenXRDisplayMgr::colorSwapchainInfos.empty())
+    {
+        XR_TUT_LOG_ERROR("Composition layers need a non-empty size and the view swapchains to exist");
+        return INVALID_COMPOSITION_LAYER;
+    }
+
+    Layer layer;
+    layer.createInfo = createInfo;
+    if (createInfo.shape == CompositionLayerShape::CYLINDER &&
+        !OpenXRCoreMgr::IsExtensionEnabled(XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME))
+    {
+        XR_TUT_LOG("Cylinder composition layers aren't supported, using a flat quad instead");
+        const float arcLength = createInfo.radius * createInfo.centralAngle;
+        layer.createInfo.shape = CompositionLayerShape::QUAD;
+        layer.createInfo.size = {arcLength, arcLength / createInfo.aspectRatio};
+    }
+
+    // Same color format as the views, but single sampled and without depth: the content is drawn by pipelines built
+    // for that, the view pipelines don't match it while the views multisample or have depth
+    XrSwapchainCreateInfo swapchainCreateInfo{};
+    swapchainCreateInfo.type = XR_TYPE_SWAPCHAIN_CREATE_INFO;
+    swapchainCreateInfo.usageFlags = XR_SWAPCHAIN_USAGE_COLOR_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT;
+    swapchainCreateInfo.format = OpenXRDisplayMgr::colorSwapchainInfos[0].swapchainFormat;
+    swapchainCreateInfo.sampleCount = 1;
+    swapchainCreateInfo.width = createInfo.width;
+    swapchainCreateInfo.height = createInfo.height;
+    swapchainCreateInfo.faceCount = 1;
+    swapchainCreateInfo.arraySize = 1;
+    swapchainCreateInfo.mipCount = 1;
+    OPENXR_CHECK(xrCreateSwapchain(OpenXRCoreMgr::xrSession, &swapchainCreateInfo, &layer.swapchainInfo.swapchain),
+                 "Failed to create OpenXR composition layer swapchain");
+    layer.swapchainInfo.swapchainFormat = swapchainCreateInfo.format;
+    OpenXRDisplayMgr::CreateSwapchainImages(layer.swapchainInfo);
+    OpenXRDisplayMgr::CreateSwapchainImageViews(layer.swapchainInfo, false);
+
+    const CompositionLayerHandle handle = m_NextHandle++;
+    m_Layers.emplace(handle, std::move(layer));
+    return handle;
+}
+
+void OpenXRCompositionLayerMgr::DestroyLayer(CompositionLayerHandle handle)
+{
+    auto it = m_Layers.find(handle);
+    if (it == m_Layers.end())
+    {
+        return;
+    }
+    DestroySwapchain(it->second);
+    m_Layers.erase(it);
+}
+
+void OpenXRCompositionLayerMgr::DestroySwapchain(Layer& layer)
+{
+    // A frame in flight may still draw into the images, the swapchain memory can only go once it finished
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+    if (layer.lastRenderValue != 0)
+    {
+        graphicsAPI->WaitForValue(layer.lastRenderValue);
+    }
+    for (void*& imageView : layer.swapchainInfo.imageViews)
+    {
+        graphicsAPI->DestroyImageView(imageView);
+    }
+    layer.swapchainInfo.imageViews.clear();
+    OpenXRCoreMgr::openxrGraphicsAPI->FreeSwapchainImagesMemory(layer.swapchainInfo.swapchain);
+    OPENXR_CHECK(xrDestroySwapchain(layer.swapchainInfo.swapchain), "Failed to destroy OpenXR composition layer swapchain");
+}
+
+OpenXRCompositionLayerMgr::Layer* OpenXRCompositionLayerMgr::FindLayer(CompositionLayerHandle handle)
+{
+    auto it = m_Layers.find(handle);
+    if (it == m_Layers.end())
+    {
+        XR_TUT_LOG_ERROR("Unknown composition layer " << handle);
+        return nullptr;
+    }
+    return &it->second;
+}
+
+void OpenXRCompositionLayerMgr::SetPose(CompositionLayerHandle handle, const XrPosef& pose)
+{
+    if (Layer* layer = FindLayer(handle))
+    {
+        layer->pose = pose;
+    }
+}
+
+void OpenXRCompositionLayerMgr::SetVisible(CompositionLayerHandle handle, bool visible)
+{
+    if (Layer* layer = FindLayer(handle))
+    {
+        layer->visible = visible;
+    }
+}
+
+void OpenXRCompositionLayerMgr::SetClearColor(CompositionLayerHandle handle, const XrColor4f& clearColor)
+{
+    if (Layer* layer = FindLayer(handle))
+    {
+        layer->clearColor = clearColor;
+        layer->dirty = true;
+    }
+}
+
+void OpenXRCompositionLayerMgr::SetContentRenderer(CompositionLayerHandle handle, ContentRenderer contentRenderer)
+{
+    if (Layer* layer = FindLayer(handle))
+    {
+        layer->contentRenderer = std::move(contentRenderer);
+        layer->dirty = true;
+    }
+}
+
+void OpenXRCompositionLayerMgr::MarkDirty(CompositionLayerHandle handle)
+{
+    if (Layer* layer = FindLayer(handle))
+    {
+        layer->dirty = true;
+    }
+}
+
+void OpenXRCompositionLayerMgr::RenderDirtyLayers()
+{
+    for (auto& handleLayer : m_Layers)
+    {
+        Layer& layer = handleLayer.second;
+        if (layer.dirty && layer.visible)
+        {
+            RenderLayer(layer);
+        }
+    }
+}
+
+void OpenXRCompositionLayerMgr::RenderLayer(Layer& layer)
+{
+    OpenXRDisplayMgr::AcquireAndWaitSwapChainImage(layer.swapchainInfo, false);
+
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+    void* colorImageView = layer.swapchainInfo.imageViews[layer.swapchainInfo.currentImageIndex];
+    graphicsAPI->BeginRendering();
+    layer.lastRenderValue = graphicsAPI->GetRecordingValue();
+    graphicsAPI->ClearColor(colorImageView, layer.clearColor.r, layer.clearColor.g, layer.clearColor.b, layer.clearColor.a);
+    if (layer.contentRenderer)
+    {
+        layer.contentRenderer(colorImageView, layer.createInfo.width, layer.createInfo.height);
+    }
+    graphicsAPI->EndRendering();
+
+    XrSwapchainImageReleaseInfo releaseInfo{};
+    releaseInfo.type = XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO;
+    OPENXR_CHECK(xrReleaseSwapchainImage(layer.swapchainInfo.swapchain, &releaseInfo), "Failed to release composition layer image");
+
+    layer.dirty = false;
+    layer.hasContent = true;
+}
+
+void OpenXRCompositionLayerMgr::UpdateLayerHeader(Layer& layer)
+{
+    const CompositionLayerCreateInfo& createInfo = layer.createInfo;
+    XrSwapchainSubImage subImage{};
+    subImage.swapchain = layer.swapchainInfo.swapchain;
+    subImage.imageRect.offset = {0, 0};
+    subImage.imageRect.extent = {static_cast<int32_t>(createInfo.width), static_cast<int32_t>(createInfo.height)};
+    subImage.imageArrayIndex = 0;
+
+    const XrCompositionLayerFlags layerFlags = createInfo.alphaBlend ? XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT : 0;
+    const XrSpace space = createInfo.headLocked ? OpenXRSpaceMgr::viewSpace : OpenXRSpaceMgr::activeSpaces;
+    if (createInfo.shape == CompositionLayerShape::CYLINDER)
+    {
+        layer.cylinder.type = XR_TYPE_COMPOSITION_LAYER_CYLINDER_KHR;
+        layer.cylinder.layerFlags = layerFlags;
+        layer.cylinder.space = space;
+        layer.cylinder.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+        layer.cylinder.subImage = subImage;
+        layer.cylinder.pose = layer.pose;
+        layer.cylinder.radius = createInfo.radius;
+        layer.cylinder.centralAngle = createInfo.centralAngle;
+        layer.cylinder.aspectRatio = createInfo.aspectRatio;
+    }
+    else
+    {
+        layer.quad.type = XR_TYPE_COMPOSITION_LAYER_QUAD;
+        layer.quad.layerFlags = layerFlags;
+        layer.quad.space = space;
+        layer.quad.eyeVisibility = XR_EYE_VISIBILITY_BOTH;
+        layer.quad.subImage = subImage;
+        layer.quad.pose = layer.pose;
+        layer.quad.size = createInfo.size;
+    }
+}
+
+void OpenXRCompositionLayerMgr::AppendLayers(std::vector<XrCompositionLayerBaseHeader*>& layers)
+{
+    for (auto& handleLayer : m_Layers)
+    {
+        Layer& layer = handleLayer.second;
+        if (!layer.visible || !layer.hasContent)
+        {
+            continue;
+        }
+        if (OpenXRCoreMgr::maxLayerCount != 0 && layers.size() >= OpenXRCoreMgr::maxLayerCount)
+        {
+            if (!m_LayerLimitReported)
+            {
+                XR_TUT_LOG_ERROR("Composition layers over the runtime's limit of " << OpenXRCoreMgr::maxLayerCount << " are dropped");
+                m_LayerLimitReported = true;
+            }
+            break;
+        }
+
+        UpdateLayerHeader(layer);
+        if (layer.createInfo.shape == CompositionLayerShape::CYLINDER)
+        {
+            layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&layer.cylinder));
+        }
+        else
+        {
+            layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&layer.quad));
+        }
+    }
+}
+
+void OpenXRCompositionLayerMgr::Shutdown()
+{
+    for (auto& handleLayer : m_Layers)
+    {
+        DestroySwapchain(handleLayer.second);
+    }
+    m_Layers.clear();
+}
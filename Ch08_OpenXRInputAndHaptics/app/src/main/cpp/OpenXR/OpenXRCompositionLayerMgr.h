@@ -0,0 +1,69 @@
+﻿#pragma once
+#include <openxr/openxr.h>
+
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "CompositionLayer/CompositionLayerCreateInfo.h"
+#include "OpenXRDisplay/SwapchainInfo.h"
+
+// Quad and cylinder layers submitted next to the projection layer. The compositor samples them directly at
+// display resolution, and their small swapchains are only rendered again when their content changes, so static
+// panels cost nothing per frame. Layers are drawn in creation order on top of the projection layer.
+class OpenXRCompositionLayerMgr
+{
+public:
+    // Records the layer's content. The image is cleared to the layer's clear color beforehand. It is single sampled
+    // and has no depth attachment, so pipelines drawing into it need to be built for that.
+    using ContentRenderer = std::function<void(void* colorImageView, uint32_t width, uint32_t height)>;
+
+    static CompositionLayerHandle CreateLayer(const CompositionLayerCreateInfo& createInfo);
+    static void DestroyLayer(CompositionLayerHandle handle);
+
+    // Pose in the reference space, or relative to the head for head locked layers
+    static void SetPose(CompositionLayerHandle handle, const XrPosef& pose);
+    static void SetVisible(CompositionLayerHandle handle, bool visible);
+    static void SetClearColor(CompositionLayerHandle handle, const XrColor4f& clearColor);
+    static void SetContentRenderer(CompositionLayerHandle handle, ContentRenderer contentRenderer);
+    // Has the content rendered again on the next frame
+    static void MarkDirty(CompositionLayerHandle handle);
+
+    // Renders the content of the layers marked dirty, call once per frame outside of the views
+    static void RenderDirtyLayers();
+    // Appends the visible layers that have content, up to the runtime's layer limit
+    static void AppendLayers(std::vector<XrCompositionLayerBaseHeader*>& layers);
+
+    static size_t GetLayerCount() { return m_Layers.size(); }
+
+    // Destroys the remaining layers. Must run before the session is destroyed.
+    static void Shutdown();
+
+private:
+    struct Layer
+    {
+        CompositionLayerCreateInfo createInfo;
+        SwapchainInfo swapchainInfo;
+        XrPosef pose = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
+        XrColor4f clearColor = {0.0f, 0.0f, 0.0f, 0.0f};
+        ContentRenderer contentRenderer;
+        bool visible = true;
+        bool dirty = true;
+        // A swapchain can't be submitted before an image of it has been released
+        bool hasContent = false;
+        // GPU timeline value of the last frame that drew into the swapchain, waited for before destroying it
+        uint64_t lastRenderValue = 0;
+        XrCompositionLayerQuad quad{};
+        XrCompositionLayerCylinderKHR cylinder{};
+    };
+
+    static Layer* FindLayer(CompositionLayerHandle handle);
+    static void RenderLayer(Layer& layer);
+    static void UpdateLayerHeader(Layer& layer);
+    static void DestroySwapchain(Layer& layer);
+
+    // Node based, so the layer structures stay where they are until xrEndFrame reads them
+    static std::map<CompositionLayerHandle, Layer> m_Layers;
+    static CompositionLayerHandle m_NextHandle;
+    static bool m_LayerLimitReported;
+};
\ No newline at end of file
@@ -11,9 +11,11 @@
 
 XrInstance OpenXRCoreMgr::m_xrInstance = XR_NULL_HANDLE;
 XrSystemId OpenXRCoreMgr::systemID = XR_NULL_SYSTEM_ID;
+uint32_t OpenXRCoreMgr::maxLayerCount = 0;
 XrSession OpenXRCoreMgr::xrSession = XR_NULL_SYSTEM_ID;
 
 std::unique_ptr<OpenXRGraphicsAPI> OpenXRCoreMgr::openxrGraphicsAPI = nullptr;
+std::vector<std::string> OpenXRCoreMgr::m_activeExtensions{};
 
 void OpenXRCoreMgr::CreateInstance()
 {
@@ -25,13 +27,16 @@ void OpenXRCoreMgr::CreateInstance()
     appInfo.apiVersion = XR_CURRENT_API_VERSION;
 
     std::vector<std::string> requiredExtensions{};
-    std::vector<std::string> activeExtensions{};
+    std::vector<std::string> optionalExtensions{};
+    m_activeExtensions.clear();
     CreateRequiredExtensions(requiredExtensions);
-    FindRequiredExtensions(requiredExtensions, activeExtensions);
+    CreateOptionalExtensions(optionalExtensions);
+    FindRequiredExtensions(requiredExtensions, m_activeExtensions);
+    FindRequiredExtensions(optionalExtensions, m_activeExtensions, true);
 
     // Convert string vector to const char* vector for OpenXR API
     std::vector<const char*> activeExtensionCStrings{};
-    for (const auto& ext : activeExtensions)
+    for (const auto& ext : m_activeExtensions)
     {
         activeExtensionCStrings.push_back(ext.c_str());
     }
@@ -83,6 +88,7 @@ void OpenXRCoreMgr::GetSystemID()
     XR_TUT_LOG("OpenXR System Properties: " << systemProperties.systemName << " - " << systemProperties.systemId);
     XR_TUT_LOG("OpenXR System Graphics Properties: ");
     XR_TUT_LOG("OpenXR Max layer count - " << systemProperties.graphicsProperties.maxLayerCount);
+    maxLayerCount = systemProperties.graphicsProperties.maxLayerCount;
     XR_TUT_LOG("OpenXR Max swapchain image width - " << systemProperties.graphicsProperties.maxSwapchainImageWidth);
     XR_TUT_LOG("OpenXR Max Swapchain image height - " << systemProperties.graphicsProperties.maxSwapchainImageHeight);
     XR_TUT_LOG("OpenXR Orientation Tracking - " << (systemProperties.trackingProperties.orientationTracking ? "enabled" : "disabled"));
@@ -100,7 +106,27 @@ void OpenXRCoreMgr::CreateRequiredExtensions(std::vector<std::string>& requiredE
     requiredExtensions.emplace_back(OpenXRGraphicsAPI::GetGraphicsAPIInstanceExtensionString(OpenXRTutorial::m_apiType));
 }
 
-void OpenXRCoreMgr::FindRequiredExtensions(const std::vector<std::string>& requestExtensions, std::vector<std::string>& activeExtensions)
+void OpenXRCoreMgr::CreateOptionalExtensions(std::vector<std::string>& optionalExtensions)
+{
+    optionalExtensions.clear();
+
+    // Depth submission for positional reprojection in the compositor
+    optionalExtensions.emplace_back(XR_KHR_COMPOSITION_LAYER_DEPTH_EXTENSION_NAME);
+    // Curved panels, see OpenXRCompositionLayerMgr
+    optionalExtensions.emplace_back(XR_KHR_COMPOSITION_LAYER_CYLINDER_EXTENSION_NAME);
+    // Refresh rate control, see OpenXRSessionMgr
+    optionalExtensions.emplace_back(XR_FB_DISPLAY_REFRESH_RATE_EXTENSION_NAME);
+
+    // Foveated rendering through the compositor's density maps, see OpenXRFoveationMgr
+    optionalExtensions.emplace_back(XR_FB_SWAPCHAIN_UPDATE_STATE_EXTENSION_NAME);
+    optionalExtensions.emplace_back(XR_FB_FOVEATION_EXTENSION_NAME);
+    optionalExtensions.emplace_back(XR_FB_FOVEATION_CONFIGURATION_EXTENSION_NAME);
+    optionalExtensions.emplace_back("XR_FB_foveation_vulkan");
+    optionalExtensions.emplace_back(XR_META_FOVEATION_EYE_TRACKED_EXTENSION_NAME);
+}
+
+void OpenXRCoreMgr::FindRequiredExtensions(const std::vector<std::string>& requestExtensions, std::vector<std::string>& activeExtensions,
+                                           bool optional)
 {
     uint32_t extensionCount = 0;
     OPENXR_CHECK(xrEnumerateInstanceExtensionProperties(nullptr, 0, &extensionCount, nullptr), "Failed to enumerate OpenXR instance extensions");
@@ -126,9 +152,21 @@ void OpenXRCoreMgr::FindRequiredExtensions(const std::vector<std::string>& reque
 
         if (!found)
         {
-            XR_TUT_LOG("Required OpenXR Extension " << requestExtension << " not found");
+            XR_TUT_LOG((optional ? "Optional" : "Required") << " OpenXR Extension " << requestExtension << " not found");
+        }
+    }
+}
+
+bool OpenXRCoreMgr::IsExtensionEnabled(const char* extensionName)
+{
+    for (const auto& ext : m_activeExtensions)
+    {
+        if (strcmp(ext.c_str(), extensionName) == 0)
+        {
+            return true;
         }
     }
+    return false;
 }
 
 void OpenXRCoreMgr::CreateSession(GraphicsAPI_Type apiType)
@@ -19,12 +19,20 @@ public:
 
     static void CreateSession(GraphicsAPI_Type apiType);
     static void DestroySession();
+
+    // Whether the extension was requested and is available, optional extensions may be missing
+    static bool IsExtensionEnabled(const char* extensionName);
     
     static XrSystemId systemID;
+    static uint32_t maxLayerCount;
     static XrInstance m_xrInstance;
     static XrSession xrSession;
     static std::unique_ptr<OpenXRGraphicsAPI> openxrGraphicsAPI;
 private:
     static void CreateRequiredExtensions(std::vector<std::string>& requiredExtensions);
-    static void FindRequiredExtensions(const std::vector<std::string>& requestExtensions, std::vector<std::string>& activeExtensions);
+    static void CreateOptionalExtensions(std::vector<std::string>& optionalExtensions);
+    static void FindRequiredExtensions(const std::vector<std::string>& requestExtensions, std::vector<std::string>& activeExtensions,
+                                       bool optional = false);
+
+    static std::vector<std::string> m_activeExtensions;
 };
\ No newline at end of file
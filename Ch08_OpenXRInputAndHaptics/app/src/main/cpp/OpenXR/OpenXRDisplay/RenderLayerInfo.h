@@ -7,6 +7,8 @@ struct RenderLayerInfo
     std::vector<XrCompositionLayerBaseHeader*> layers;
     XrCompositionLayerProjection projectionLayer;
     std::vector<XrCompositionLayerProjectionView> layerProjectionViews;
+    // Chained into the projection views when depth is submitted (XR_KHR_composition_layer_depth)
+    std::vector<XrCompositionLayerDepthInfoKHR> layerDepthInfos;
 
     RenderLayerInfo()
     {
@@ -8,4 +8,6 @@ struct SwapchainConfig
     XrSwapchainUsageFlags usageFlags;
     bool isDepth;
     std::function<int64_t(const std::vector<int64_t>&)> formatSelector;
+    // Extension structures chained into the swapchain create info
+    const void* next = nullptr;
 };
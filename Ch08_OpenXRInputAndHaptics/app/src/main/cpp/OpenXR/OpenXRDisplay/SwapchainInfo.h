@@ -7,4 +7,6 @@ struct SwapchainInfo
     XrSwapchain swapchain = XR_NULL_HANDLE;
     int64_t swapchainFormat = 0;
     std::vector<void*> imageViews;
+    uint32_t currentImageIndex = 0;  // Last acquired image
+    void* deferredRenderTarget = nullptr;  // Stands in for the image views while recording, when acquiring is deferred
 };
\ No newline at end of file
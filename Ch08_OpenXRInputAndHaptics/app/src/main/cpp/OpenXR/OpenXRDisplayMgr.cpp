@@ -1,7 +1,9 @@
 ﻿#include "OpenXRDisplayMgr.h"
 
 #include "DebugOutput.h"
+#include "OpenXRAttachmentMgr.h"
 #include "OpenXRCoreMgr.h"
+#include "OpenXRFoveationMgr.h"
 #include "OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
 #include "OpenXRHelper.h"
 
@@ -13,6 +15,7 @@ std::vector<SwapchainInfo> OpenXRDisplayMgr::colorSwapchainInfos{};
 std::vector<SwapchainInfo> OpenXRDisplayMgr::depthSwapchainInfos{};
 
 int OpenXRDisplayMgr::currentViewIndex = -1;
+uint64_t OpenXRDisplayMgr::swapchainWaitTimeoutCount = 0;
 
 void OpenXRDisplayMgr::GetActiveViewConfigurationType()
 {
@@ -71,8 +74,9 @@ void OpenXRDisplayMgr::CreateSwapchains()
         XrSwapchainCreateInfo swapchainCreateInfo{};
         swapchainCreateInfo.type = XR_TYPE_SWAPCHAIN_CREATE_INFO;
         swapchainCreateInfo.sampleCount = viewConfigurationView.recommendedSwapchainSampleCount;
-        swapchainCreateInfo.width = viewConfigurationView.recommendedImageRectWidth;
-        swapchainCreateInfo.height = viewConfigurationView.recommendedImageRectHeight;
+        // Allocated at the maximum size, OpenXRResolutionMgr picks how much of it is rendered each frame
+        swapchainCreateInfo.width = viewConfigurationView.maxImageRectWidth;
+        swapchainCreateInfo.height = viewConfigurationView.maxImageRectHeight;
         swapchainCreateInfo.faceCount = 1;
         swapchainCreateInfo.arraySize = 1;
         swapchainCreateInfo.mipCount = 1;
@@ -82,10 +86,20 @@ void OpenXRDisplayMgr::CreateSwapchains()
                                     [](const std::vector<int64_t>& formats)
                                     {
                                         return OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->SelectColorSwapchainFormat(formats);
-                                    }};
+                                    },
+                                    OpenXRFoveationMgr::GetColorSwapchainCreateNext()};
         CreateSwapchain(swapchainCreateInfo, swapchainFormats, colorConfig, colorSwapchainInfos[viewIndex]);
+        if (colorConfig.next)
+        {
+            // The runtime's density map of each image is enumerated along with the images
+            OpenXRCoreMgr::openxrGraphicsAPI->EnableSwapchainFoveationImages(colorSwapchainInfos[viewIndex].swapchain);
+        }
 
-        // Create Depth Swapchain
+        // Create Depth Swapchain, unless the views render depth into transient images the compositor never sees
+        if (OpenXRAttachmentMgr::IsDepthTransient())
+        {
+            continue;
+        }
         SwapchainConfig depthConfig{XR_SWAPCHAIN_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | XR_SWAPCHAIN_USAGE_SAMPLED_BIT, true,
                                     [](const std::vector<int64_t>& formats)
                                     {
@@ -101,6 +115,7 @@ void OpenXRDisplayMgr::CreateSwapchain(const XrSwapchainCreateInfo& baseCreateIn
     XrSwapchainCreateInfo swapchainCreateInfo = baseCreateInfo;
     swapchainCreateInfo.usageFlags = config.usageFlags;
     swapchainCreateInfo.format = config.formatSelector(availableSwapchainFormats);
+    swapchainCreateInfo.next = config.next;
 
     const char* swapchainType = config.isDepth ? "depth" : "color";
     OPENXR_CHECK(xrCreateSwapchain(OpenXRCoreMgr::xrSession, &swapchainCreateInfo, &swapchainInfo.swapchain),
@@ -113,7 +128,10 @@ void OpenXRDisplayMgr::CreateSwapchainImages()
     for (int viewIndex = 0; viewIndex < static_cast<int>(GetViewsCount()); viewIndex++)
     {
         CreateSwapchainImages(colorSwapchainInfos[viewIndex]);
-        CreateSwapchainImages(depthSwapchainInfos[viewIndex]);
+        if (depthSwapchainInfos[viewIndex].swapchain != XR_NULL_HANDLE)
+        {
+            CreateSwapchainImages(depthSwapchainInfos[viewIndex]);
+        }
     }
 }
 
@@ -128,10 +146,23 @@ void OpenXRDisplayMgr::CreateSwapchainImages(const SwapchainInfo& swapchainInfo)
 
 void OpenXRDisplayMgr::CreateSwapchainImageViews()
 {
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
     for (int viewIndex = 0; viewIndex < static_cast<int>(GetViewsCount()); viewIndex++)
     {
+        const bool hasDepthSwapchain = depthSwapchainInfos[viewIndex].swapchain != XR_NULL_HANDLE;
         CreateSwapchainImageViews(colorSwapchainInfos[viewIndex], false);
-        CreateSwapchainImageViews(depthSwapchainInfos[viewIndex], true);
+        if (hasDepthSwapchain)
+        {
+            CreateSwapchainImageViews(depthSwapchainInfos[viewIndex], true);
+        }
+        if (graphicsAPI->IsDeferredRenderTargetSupported())
+        {
+            colorSwapchainInfos[viewIndex].deferredRenderTarget = graphicsAPI->CreateDeferredRenderTarget();
+            if (hasDepthSwapchain)
+            {
+                depthSwapchainInfos[viewIndex].deferredRenderTarget = graphicsAPI->CreateDeferredRenderTarget();
+            }
+        }
     }
 }
 
@@ -181,6 +212,10 @@ void OpenXRDisplayMgr::DestroySwapchainsRelatedData()
             OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyImageView(imageView);
         }
         colorSwapchainInfo.imageViews.clear();
+        if (colorSwapchainInfo.deferredRenderTarget)
+        {
+            OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyDeferredRenderTarget(colorSwapchainInfo.deferredRenderTarget);
+        }
         OpenXRCoreMgr::openxrGraphicsAPI->FreeSwapchainImagesMemory(colorSwapchainInfo.swapchain);
         xrDestroySwapchain(colorSwapchainInfo.swapchain);
 
@@ -191,8 +226,15 @@ void OpenXRDisplayMgr::DestroySwapchainsRelatedData()
             OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyImageView(imageView);
         }
         depthSwapchainInfo.imageViews.clear();
-        OpenXRCoreMgr::openxrGraphicsAPI->FreeSwapchainImagesMemory(depthSwapchainInfo.swapchain);
-        xrDestroySwapchain(depthSwapchainInfo.swapchain);
+        if (depthSwapchainInfo.deferredRenderTarget)
+        {
+            OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->DestroyDeferredRenderTarget(depthSwapchainInfo.deferredRenderTarget);
+        }
+        if (depthSwapchainInfo.swapchain != XR_NULL_HANDLE)
+        {
+            OpenXRCoreMgr::openxrGraphicsAPI->FreeSwapchainImagesMemory(depthSwapchainInfo.swapchain);
+            xrDestroySwapchain(depthSwapchainInfo.swapchain);
+        }
     }
     
     colorSwapchainInfos.clear();
@@ -203,21 +245,72 @@ size_t OpenXRDisplayMgr::GetViewsCount() { return static_cast<int>(activeViewCon
 
 void OpenXRDisplayMgr::AcquireAndWaitSwapChainImages(int viewIndex, void*& colorImage, void*& depthImage)
 {
-    uint32_t colorImageIndex = 0, depthImageIndex = 0;
     SwapchainInfo& colorSwapchainInfo = colorSwapchainInfos[viewIndex];
-    OPENXR_CHECK(xrAcquireSwapchainImage(colorSwapchainInfo.swapchain, nullptr, &colorImageIndex), "Failed to acquire color swapchain image");
-
     SwapchainInfo& depthSwapchainInfo = depthSwapchainInfos[viewIndex];
-    OPENXR_CHECK(xrAcquireSwapchainImage(depthSwapchainInfo.swapchain, nullptr, &depthImageIndex), "Failed to acquire depth swapchain image");
+    AcquireAndWaitSwapChainImage(colorSwapchainInfo, false);
+    colorImage = colorSwapchainInfo.imageViews[colorSwapchainInfo.currentImageIndex];
+    depthImage = nullptr;
+    if (depthSwapchainInfo.swapchain != XR_NULL_HANDLE)
+    {
+        AcquireAndWaitSwapChainImage(depthSwapchainInfo, true);
+        depthImage = depthSwapchainInfo.imageViews[depthSwapchainInfo.currentImageIndex];
+    }
+}
+
+void OpenXRDisplayMgr::AcquireAndWaitSwapChainImage(SwapchainInfo& swapchainInfo, bool isDepth)
+{
+    const char* swapchainType = isDepth ? "depth" : "color";
+    uint32_t imageIndex = 0;
+    OPENXR_CHECK(xrAcquireSwapchainImage(swapchainInfo.swapchain, nullptr, &imageIndex),
+                 ("Failed to acquire " + std::string(swapchainType) + " swapchain image").c_str());
 
     XrSwapchainImageWaitInfo waitInfo{};
     waitInfo.type = XR_TYPE_SWAPCHAIN_IMAGE_WAIT_INFO;
-    waitInfo.timeout = XR_INFINITE_DURATION;
-    OPENXR_CHECK(xrWaitSwapchainImage(colorSwapchainInfo.swapchain, &waitInfo), "Failed to wait for color swapchain image");
-    OPENXR_CHECK(xrWaitSwapchainImage(depthSwapchainInfo.swapchain, &waitInfo), "Failed to wait for depth swapchain image");
+    waitInfo.timeout = SWAPCHAIN_WAIT_TIMEOUT;
+    uint32_t timeoutCount = 0;
+    XrResult result = XR_SUCCESS;
+    while ((result = xrWaitSwapchainImage(swapchainInfo.swapchain, &waitInfo)) == XR_TIMEOUT_EXPIRED)
+    {
+        ++swapchainWaitTimeoutCount;
+        if (++timeoutCount == SWAPCHAIN_WAIT_REPORTED_TIMEOUTS)
+        {
+            XR_TUT_LOG_ERROR("Still waiting for the " << swapchainType << " swapchain image after "
+                                                      << timeoutCount * (SWAPCHAIN_WAIT_TIMEOUT / 1000000) << " ms");
+        }
+    }
+    OPENXR_CHECK(result, ("Failed to wait for " + std::string(swapchainType) + " swapchain image").c_str());
+
+    swapchainInfo.currentImageIndex = imageIndex;
+}
+
+bool OpenXRDisplayMgr::IsAcquireDeferred()
+{
+    return !colorSwapchainInfos.empty() && colorSwapchainInfos[0].deferredRenderTarget;
+}
+
+void OpenXRDisplayMgr::GetDeferredRenderTargets(int viewIndex, void*& colorImage, void*& depthImage)
+{
+    colorImage = colorSwapchainInfos[viewIndex].deferredRenderTarget;
+    depthImage = depthSwapchainInfos[viewIndex].deferredRenderTarget;
+}
 
-    colorImage = colorSwapchainInfo.imageViews[colorImageIndex];
-    depthImage = depthSwapchainInfo.imageViews[depthImageIndex];
+void OpenXRDisplayMgr::AcquireAndBindDeferredRenderTargets(int viewIndex)
+{
+    SwapchainInfo& colorSwapchainInfo = colorSwapchainInfos[viewIndex];
+    SwapchainInfo& depthSwapchainInfo = depthSwapchainInfos[viewIndex];
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+    AcquireAndWaitSwapChainImage(colorSwapchainInfo, false);
+    graphicsAPI->BindDeferredRenderTarget(colorSwapchainInfo.deferredRenderTarget, colorSwapchainInfo.imageViews[colorSwapchainInfo.currentImageIndex]);
+    if (depthSwapchainInfo.swapchain != XR_NULL_HANDLE)
+    {
+        AcquireAndWaitSwapChainImage(depthSwapchainInfo, true);
+        graphicsAPI->BindDeferredRenderTarget(depthSwapchainInfo.deferredRenderTarget, depthSwapchainInfo.imageViews[depthSwapchainInfo.currentImageIndex]);
+    }
+}
+
+uint64_t OpenXRDisplayMgr::GetSwapchainWaitTimeoutCount()
+{
+    return swapchainWaitTimeoutCount;
 }
 
 void OpenXRDisplayMgr::ReleaseSwapChainImages(int viewIndex)
@@ -226,8 +319,11 @@ void OpenXRDisplayMgr::ReleaseSwapChainImages(int viewIndex)
     releaseInfo.type = XR_TYPE_SWAPCHAIN_IMAGE_RELEASE_INFO;
     OPENXR_CHECK(xrReleaseSwapchainImage(colorSwapchainInfos[viewIndex].swapchain, &releaseInfo),
                  "Failed to release Image back to the Color Swapchain");
-    OPENXR_CHECK(xrReleaseSwapchainImage(depthSwapchainInfos[viewIndex].swapchain, &releaseInfo),
-                 "Failed to release Image back to the Depth Swapchain");
+    if (depthSwapchainInfos[viewIndex].swapchain != XR_NULL_HANDLE)
+    {
+        OPENXR_CHECK(xrReleaseSwapchainImage(depthSwapchainInfos[viewIndex].swapchain, &releaseInfo),
+                     "Failed to release Image back to the Depth Swapchain");
+    }
 }
 
 int OpenXRDisplayMgr::GetCurrentViewIndex()
@@ -18,14 +18,29 @@ class OpenXRDisplayMgr
     static void CreateSwapchainImageViews();
     static void DestroySwapchainsRelatedData();
 
+    // depthImage is nullptr when the views use transient depth instead of a depth swapchain
     static void AcquireAndWaitSwapChainImages(int viewIndex, void*& colorImage, void*& depthImage);
     static void ReleaseSwapChainImages(int viewIndex);
+
+    // With a backend that supports deferred render targets, a view is recorded against stand-ins for its images,
+    // and they are only acquired and waited on right before the view is submitted
+    static bool IsAcquireDeferred();
+    static void GetDeferredRenderTargets(int viewIndex, void*& colorImage, void*& depthImage);
+    static void AcquireAndBindDeferredRenderTargets(int viewIndex);
+    // Number of times waiting for a swapchain image timed out and had to be retried
+    static uint64_t GetSwapchainWaitTimeoutCount();
+    // Waits for the image in bounded slices, see SWAPCHAIN_WAIT_TIMEOUT
+    static void AcquireAndWaitSwapChainImage(SwapchainInfo& swapchainInfo, bool isDepth);
     
     static void StartRenderingView(int viewIndex);
     static void StopRenderingView();
     
     static int GetCurrentViewIndex();
 
+    // Also used for swapchains created outside of the views, such as composition layers'
+    static void CreateSwapchainImages(const SwapchainInfo& swapchainInfo);
+    static void CreateSwapchainImageViews(SwapchainInfo& swapchainInfo, bool isDepth);
+
     static std::vector<SwapchainInfo> colorSwapchainInfos;
     static std::vector<SwapchainInfo> depthSwapchainInfos;
 
@@ -34,10 +49,13 @@ class OpenXRDisplayMgr
 
   private:
     static int currentViewIndex;
-    
+    static uint64_t swapchainWaitTimeoutCount;
+
+    // Waits are retried in slices, so a compositor that holds an image too long gets reported
+    static constexpr XrDuration SWAPCHAIN_WAIT_TIMEOUT = 5000000;
+    static constexpr uint32_t SWAPCHAIN_WAIT_REPORTED_TIMEOUTS = 20;
+
     static std::vector<int64_t> GetAvailableSwapchainFormats();
     static void CreateSwapchain(const XrSwapchainCreateInfo& baseCreateInfo, const std::vector<int64_t>& availableSwapchainFormats,
                                 const SwapchainConfig& config, SwapchainInfo& swapchainInfo);
-    static void CreateSwapchainImages(const SwapchainInfo& swapchainInfo);
-    static void CreateSwapchainImageViews(SwapchainInfo& swapchainInfo, bool isDepth);
 };
\ No newline at end of file
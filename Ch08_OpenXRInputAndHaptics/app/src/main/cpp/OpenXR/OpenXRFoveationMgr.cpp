@@ -0,0 +1,325 @@
+﻿#include "OpenXRFoveationMgr.h"
+
+#include <DebugOutput.h>
+#include <OpenXRHelper.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "Foveation/FoveationMap.h"
+#include "OpenXRCoreMgr.h"
+#include "OpenXRDisplayMgr.h"
+#include "OpenXRFrameTimingMgr.h"
+#include "OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
+#include "OpenXRRenderMgr.h"
+#include "OpenXRResolutionMgr.h"
+#include "OpenXRSessionMgr.h"
+
+FoveationSettings OpenXRFoveationMgr::m_Settings{};
+FoveationMode OpenXRFoveationMgr::m_Mode = FoveationMode::NONE;
+bool OpenXRFoveationMgr::m_SettingsDirty = false;
+bool OpenXRFoveationMgr::m_DynamicBoost = false;
+bool OpenXRFoveationMgr::m_EyeTrackingSupported = false;
+XrSwapchainCreateInfoFoveationFB OpenXRFoveationMgr::m_SwapchainCreateInfo{};
+std::vector<std::vector<void*>> OpenXRFoveationMgr::m_CompositorMapViews{};
+std::vector<OpenXRFoveationMgr::ViewDensityMap> OpenXRFoveationMgr::m_ViewDensityMaps{};
+std::vector<uint8_t> OpenXRFoveationMgr::m_Texels{};
+
+PFN_xrCreateFoveationProfileFB OpenXRFoveationMgr::xrCreateFoveationProfileFB = nullptr;
+PFN_xrDestroyFoveationProfileFB OpenXRFoveationMgr::xrDestroyFoveationProfileFB = nullptr;
+PFN_xrUpdateSwapchainFB OpenXRFoveationMgr::xrUpdateSwapchainFB = nullptr;
+
+namespace
+{
+const char* GetModeName(FoveationMode mode)
+{
+    switch (mode)
+    {
+        case FoveationMode::COMPOSITOR:
+            return "compositor";
+        case FoveationMode::FRAGMENT_DENSITY_MAP:
+            return "fragment density map";
+        case FoveationMode::NONE:
+        default:
+            return "none";
+    }
+}
+}
+
+void OpenXRFoveationMgr::Initialize()
+{
+    m_Mode = FoveationMode::NONE;
+    m_SettingsDirty = false;
+    m_DynamicBoost = false;
+
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+    if (m_Settings.level == FoveationLevel::NONE)
+    {
+        XR_TUT_LOG("Foveated rendering disabled");
+        return;
+    }
+    if (!graphicsAPI->IsFragmentDensityMapSupported())
+    {
+        XR_TUT_LOG("Foveated rendering unavailable, the device doesn't support fragment density maps");
+        return;
+    }
+
+    // The compositor's maps are tuned for the display and can follow the gaze, so they're preferred
+    if (OpenXRCoreMgr::IsExtensionEnabled(XR_FB_FOVEATION_EXTENSION_NAME) &&
+        OpenXRCoreMgr::IsExtensionEnabled(XR_FB_FOVEATION_CONFIGURATION_EXTENSION_NAME) &&
+        OpenXRCoreMgr::IsExtensionEnabled(XR_FB_SWAPCHAIN_UPDATE_STATE_EXTENSION_NAME) &&
+        OpenXRCoreMgr::IsExtensionEnabled("XR_FB_foveation_vulkan"))
+    {
+        LoadXRFunctionsPointers();
+        m_Mode = FoveationMode::COMPOSITOR;
+
+        m_EyeTrackingSupported = false;
+        if (OpenXRCoreMgr::IsExtensionEnabled(XR_META_FOVEATION_EYE_TRACKED_EXTENSION_NAME))
+        {
+            XrSystemFoveationEyeTrackedPropertiesMETA eyeTrackedProperties{};
+            eyeTrackedProperties.type = XR_TYPE_SYSTEM_FOVEATION_EYE_TRACKED_PROPERTIES_META;
+            XrSystemProperties systemProperties{};
+            systemProperties.type = XR_TYPE_SYSTEM_PROPERTIES;
+            systemProperties.next = &eyeTrackedProperties;
+            OPENXR_CHECK(xrGetSystemProperties(OpenXRCoreMgr::m_xrInstance, OpenXRCoreMgr::systemID, &systemProperties),
+                         "Failed to get OpenXR system properties");
+            m_EyeTrackingSupported = eyeTrackedProperties.supportsFoveationEyeTracked == XR_TRUE;
+        }
+
+        // The runtime's maps cover the whole swapchain image, so a scaled down render region would be foveated off center
+        if (OpenXRResolutionMgr::IsEnabled())
+        {
+            XR_TUT_LOG("Dynamic resolution disabled, it isn't compatible with compositor foveation");
+            OpenXRResolutionMgr::SetEnabled(false);
+        }
+    }
+    else
+    {
+        m_Mode = FoveationMode::FRAGMENT_DENSITY_MAP;
+        if (m_Settings.eyeTracked)
+        {
+            XR_TUT_LOG("Eye tracked foveation needs the compositor's density maps, the foveation center stays fixed");
+        }
+    }
+
+    XR_TUT_LOG("Foveated rendering mode: " << GetModeName(m_Mode) << (m_EyeTrackingSupported && m_Settings.eyeTracked ? ", eye tracked" : ""));
+}
+
+void OpenXRFoveationMgr::LoadXRFunctionsPointers()
+{
+    xrGetInstanceProcAddr(OpenXRCoreMgr::m_xrInstance, "xrCreateFoveationProfileFB",
+                          reinterpret_cast<PFN_xrVoidFunction*>(&xrCreateFoveationProfileFB));
+    xrGetInstanceProcAddr(OpenXRCoreMgr::m_xrInstance, "xrDestroyFoveationProfileFB",
+                          reinterpret_cast<PFN_xrVoidFunction*>(&xrDestroyFoveationProfileFB));
+    xrGetInstanceProcAddr(OpenXRCoreMgr::m_xrInstance, "xrUpdateSwapchainFB", reinterpret_cast<PFN_xrVoidFunction*>(&xrUpdateSwapchainFB));
+}
+
+const void* OpenXRFoveationMgr::GetColorSwapchainCreateNext()
+{
+    if (m_Mode != FoveationMode::COMPOSITOR)
+    {
+        return nullptr;
+    }
+    m_SwapchainCreateInfo = {};
+    m_SwapchainCreateInfo.type = XR_TYPE_SWAPCHAIN_CREATE_INFO_FOVEATION_FB;
+    m_SwapchainCreateInfo.flags = XR_SWAPCHAIN_CREATE_FOVEATION_FRAGMENT_DENSITY_MAP_BIT_FB;
+    return &m_SwapchainCreateInfo;
+}
+
+void OpenXRFoveationMgr::OnSwapchainsCreated()
+{
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+    const size_t viewsCount = OpenXRDisplayMgr::GetViewsCount();
+
+    if (m_Mode == FoveationMode::COMPOSITOR)
+    {
+        ApplyCompositorProfile();
+
+        m_CompositorMapViews.resize(viewsCount);
+        for (size_t viewIndex = 0; viewIndex < viewsCount; ++viewIndex)
+        {
+            const SwapchainInfo& colorSwapchainInfo = OpenXRDisplayMgr::colorSwapchainInfos[viewIndex];
+            for (uint32_t imageIndex = 0; imageIndex < static_cast<uint32_t>(colorSwapchainInfo.imageViews.size()); ++imageIndex)
+            {
+                uint32_t width = 0, height = 0;
+                void* image = OpenXRCoreMgr::openxrGraphicsAPI->GetSwapchainFoveationImage(colorSwapchainInfo.swapchain, imageIndex, width, height);
+                m_CompositorMapViews[viewIndex].push_back(image ? graphicsAPI->CreateFragmentDensityMapView(image) : nullptr);
+            }
+        }
+    }
+    else if (m_Mode == FoveationMode::FRAGMENT_DENSITY_MAP)
+    {
+        // Sized for the largest region that can be rendered, smaller ones use the top-left part of the map
+        const GraphicsAPI::Extent2D texelSize = graphicsAPI->GetFragmentDensityTexelSize();
+        m_ViewDensityMaps.resize(viewsCount);
+        for (size_t viewIndex = 0; viewIndex < viewsCount; ++viewIndex)
+        {
+            const XrViewConfigurationView& viewConfigurationView = OpenXRDisplayMgr::activeViewConfigurationViews[viewIndex];
+            const uint32_t width = (viewConfigurationView.maxImageRectWidth + texelSize.width - 1) / texelSize.width;
+            const uint32_t height = (viewConfigurationView.maxImageRectHeight + texelSize.height - 1) / texelSize.height;
+            m_ViewDensityMaps[viewIndex] = {};
+            m_ViewDensityMaps[viewIndex].view = graphicsAPI->CreateFragmentDensityMap(width, height);
+        }
+    }
+}
+
+void OpenXRFoveationMgr::ApplyCompositorProfile()
+{
+    XrFoveationLevelProfileCreateInfoFB levelProfileCreateInfo{};
+    levelProfileCreateInfo.type = XR_TYPE_FOVEATION_LEVEL_PROFILE_CREATE_INFO_FB;
+    levelProfileCreateInfo.level = static_cast<XrFoveationLevelFB>(m_Settings.level);
+    levelProfileCreateInfo.verticalOffset = m_Settings.verticalOffset;
+    levelProfileCreateInfo.dynamic = m_Settings.dynamic ? XR_FOVEATION_DYNAMIC_LEVEL_ENABLED_FB : XR_FOVEATION_DYNAMIC_DISABLED_FB;
+
+    XrFoveationEyeTrackedProfileCreateInfoMETA eyeTrackedProfileCreateInfo{};
+    eyeTrackedProfileCreateInfo.type = XR_TYPE_FOVEATION_EYE_TRACKED_PROFILE_CREATE_INFO_META;
+    if (m_EyeTrackingSupported && m_Settings.eyeTracked)
+    {
+        levelProfileCreateInfo.next = &eyeTrackedProfileCreateInfo;
+    }
+
+    XrFoveationProfileCreateInfoFB profileCreateInfo{};
+    profileCreateInfo.type = XR_TYPE_FOVEATION_PROFILE_CREATE_INFO_FB;
+    profileCreateInfo.next = &levelProfileCreateInfo;
+
+    XrFoveationProfileFB profile = XR_NULL_HANDLE;
+    OPENXR_CHECK(xrCreateFoveationProfileFB(OpenXRCoreMgr::xrSession, &profileCreateInfo, &profile), "Failed to create foveation profile");
+
+    XrSwapchainStateFoveationFB foveationState{};
+    foveationState.type = XR_TYPE_SWAPCHAIN_STATE_FOVEATION_FB;
+    foveationState.profile = profile;
+    for (const SwapchainInfo& colorSwapchainInfo : OpenXRDisplayMgr::colorSwapchainInfos)
+    {
+        OPENXR_CHECK(xrUpdateSwapchainFB(colorSwapchainInfo.swapchain, reinterpret_cast<const XrSwapchainStateBaseHeaderFB*>(&foveationState)),
+                     "Failed to update swapchain foveation state");
+    }
+
+    // The swapchains keep their own copy of the state
+    OPENXR_CHECK(xrDestroyFoveationProfileFB(profile), "Failed to destroy foveation profile");
+}
+
+void OpenXRFoveationMgr::BindViewDensityMap(int viewIndex)
+{
+    if (m_Mode == FoveationMode::NONE)
+    {
+        return;
+    }
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+
+    if (m_Mode == FoveationMode::COMPOSITOR)
+    {
+        if (viewIndex == 0 && m_SettingsDirty)
+        {
+            ApplyCompositorProfile();
+            m_SettingsDirty = false;
+        }
+        const uint32_t imageIndex = OpenXRDisplayMgr::colorSwapchainInfos[viewIndex].currentImageIndex;
+        graphicsAPI->SetFragmentDensityMap(m_CompositorMapViews[viewIndex][imageIndex]);
+        return;
+    }
+
+    if (viewIndex == 0)
+    {
+        UpdateDynamicLevel();
+    }
+
+    // Regenerated only when something it depends on changed, the field of view is fixed on most headsets
+    ViewDensityMap& densityMap = m_ViewDensityMaps[viewIndex];
+    const XrFovf& fov = OpenXRRenderMgr::views[viewIndex].fov;
+    const XrExtent2Di extent = OpenXRResolutionMgr::GetViewExtent(viewIndex);
+    const FoveationLevel level = GetEffectiveLevel();
+    if (!densityMap.generated || memcmp(&densityMap.fov, &fov, sizeof(XrFovf)) != 0 || densityMap.extent.width != extent.width ||
+        densityMap.extent.height != extent.height || densityMap.level != level || densityMap.verticalOffset != m_Settings.verticalOffset)
+    {
+        const GraphicsAPI::Extent2D texelSize = graphicsAPI->GetFragmentDensityTexelSize();
+        const XrViewConfigurationView& viewConfigurationView = OpenXRDisplayMgr::activeViewConfigurationViews[viewIndex];
+        const uint32_t mapWidth = (viewConfigurationView.maxImageRectWidth + texelSize.width - 1) / texelSize.width;
+        const uint32_t mapHeight = (viewConfigurationView.maxImageRectHeight + texelSize.height - 1) / texelSize.height;
+        FoveationMap::Generate(fov, level, m_Settings.verticalOffset, mapWidth, mapHeight,
+                               static_cast<float>(extent.width) / static_cast<float>(texelSize.width),
+                               static_cast<float>(extent.height) / static_cast<float>(texelSize.height), m_Texels);
+        graphicsAPI->SetFragmentDensityMapData(densityMap.view, m_Texels.data());
+
+        densityMap.fov = fov;
+        densityMap.extent = extent;
+        densityMap.level = level;
+        densityMap.verticalOffset = m_Settings.verticalOffset;
+        densityMap.generated = true;
+    }
+    graphicsAPI->SetFragmentDensityMap(densityMap.view);
+}
+
+void OpenXRFoveationMgr::UpdateDynamicLevel()
+{
+    const int64_t gpuFrameTimeNs = OpenXRFrameTimingMgr::GetLatestGpuFrameTime();
+    const XrDuration displayPeriod = OpenXRSessionMgr::frameState.predictedDisplayPeriod;
+    if (!m_Settings.dynamic || gpuFrameTimeNs <= 0 || displayPeriod <= 0)
+    {
+        m_DynamicBoost = false;
+        return;
+    }
+
+    const float budgetNs = static_cast<float>(displayPeriod) * OpenXRResolutionMgr::GPU_BUDGET;
+    if (static_cast<float>(gpuFrameTimeNs) > budgetNs)
+    {
+        m_DynamicBoost = true;
+    }
+    else if (static_cast<float>(gpuFrameTimeNs) < budgetNs * DYNAMIC_RELEASE_THRESHOLD)
+    {
+        m_DynamicBoost = false;
+    }
+}
+
+FoveationLevel OpenXRFoveationMgr::GetEffectiveLevel()
+{
+    if (m_DynamicBoost && m_Settings.level != FoveationLevel::NONE && m_Settings.level != FoveationLevel::HIGH)
+    {
+        return static_cast<FoveationLevel>(static_cast<uint8_t>(m_Settings.level) + 1);
+    }
+    return m_Settings.level;
+}
+
+void OpenXRFoveationMgr::SetSettings(const FoveationSettings& settings)
+{
+    m_Settings = settings;
+    m_SettingsDirty = true;
+}
+
+const FoveationSettings& OpenXRFoveationMgr::GetSettings()
+{
+    return m_Settings;
+}
+
+FoveationMode OpenXRFoveationMgr::GetMode()
+{
+    return m_Mode;
+}
+
+bool OpenXRFoveationMgr::IsActive()
+{
+    return m_Mode != FoveationMode::NONE;
+}
+
+void OpenXRFoveationMgr::Shutdown()
+{
+    GraphicsAPI* graphicsAPI = OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get();
+    for (std::vector<void*>& imageViews : m_CompositorMapViews)
+    {
+        for (void*& imageView : imageViews)
+        {
+            if (imageView)
+            {
+                graphicsAPI->DestroyImageView(imageView);
+            }
+        }
+    }
+    m_CompositorMapViews.clear();
+
+    for (ViewDensityMap& densityMap : m_ViewDensityMaps)
+    {
+        graphicsAPI->DestroyFragmentDensityMap(densityMap.view);
+    }
+    m_ViewDensityMaps.clear();
+    m_Texels.clear();
+    m_Mode = FoveationMode::NONE;
+}
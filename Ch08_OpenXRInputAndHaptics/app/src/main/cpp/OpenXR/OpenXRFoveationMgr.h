@@ -0,0 +1,79 @@
+﻿#pragma once
+#include <openxr/openxr.h>
+
+#include <vector>
+
+#include "Foveation/FoveationSettings.h"
+
+enum class FoveationMode
+{
+    NONE,
+    // The runtime owns the density maps of the color swapchains (XR_FB_foveation), eye tracked where available
+    COMPOSITOR,
+    // The density maps are generated here from the view's field of view (VK_EXT_fragment_density_map)
+    FRAGMENT_DENSITY_MAP,
+};
+
+// Foveated rendering. The periphery of each view is shaded at a lower rate through a fragment density map
+// attached to every render pass, which the compositor provides when it can and which is built here otherwise.
+class OpenXRFoveationMgr
+{
+public:
+    // Picks the mode from the enabled extensions and device features, call after the session is created
+    static void Initialize();
+
+    // Chained into the color swapchains' create info, nullptr when the compositor doesn't provide the maps
+    static const void* GetColorSwapchainCreateNext();
+    // Applies the foveation profile to the swapchains or allocates the maps, call once the image views exist
+    static void OnSwapchainsCreated();
+
+    // Sets the density map for the view's render passes, call after BeginRendering
+    static void BindViewDensityMap(int viewIndex);
+
+    // Can be changed at any time, the new settings apply from the next frame
+    static void SetSettings(const FoveationSettings& settings);
+    static const FoveationSettings& GetSettings();
+
+    static FoveationMode GetMode();
+    // Whether pipelines have to be created with a density map attachment
+    static bool IsActive();
+
+    // Releases the maps and their views. Must run before the swapchains are destroyed.
+    static void Shutdown();
+
+private:
+    struct ViewDensityMap
+    {
+        void* view = nullptr;
+        XrFovf fov{};
+        XrExtent2Di extent{};
+        FoveationLevel level = FoveationLevel::NONE;
+        float verticalOffset = 0.0f;
+        bool generated = false;
+    };
+
+    static FoveationLevel GetEffectiveLevel();
+    static void UpdateDynamicLevel();
+    static void ApplyCompositorProfile();
+    static void LoadXRFunctionsPointers();
+
+    static FoveationSettings m_Settings;
+    static FoveationMode m_Mode;
+    static bool m_SettingsDirty;
+    static bool m_DynamicBoost;
+    static bool m_EyeTrackingSupported;
+    static XrSwapchainCreateInfoFoveationFB m_SwapchainCreateInfo;
+    // Compositor mode: views of the runtime's maps, per view and swapchain image
+    static std::vector<std::vector<void*>> m_CompositorMapViews;
+    // Fragment density map mode: one map per view
+    static std::vector<ViewDensityMap> m_ViewDensityMaps;
+    static std::vector<uint8_t> m_Texels;
+
+    static PFN_xrCreateFoveationProfileFB xrCreateFoveationProfileFB;
+    static PFN_xrDestroyFoveationProfileFB xrDestroyFoveationProfileFB;
+    static PFN_xrUpdateSwapchainFB xrUpdateSwapchainFB;
+
+    // With dynamic foveation the level goes up by one while the GPU frame time is over the budget,
+    // and back once it has dropped below this fraction of it
+    static constexpr float DYNAMIC_RELEASE_THRESHOLD = 0.8f;
+};
\ No newline at end of file
@@ -0,0 +1,259 @@
+﻿#include "OpenXRFrameTimingMgr.h"
+
+#include <DebugOutput.h>
+#include <GraphicsAPI.h>
+#include "OpenXRCoreMgr.h"
+#include "OpenXRDisplayMgr.h"
+#include "OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+FrameTimingRecord OpenXRFrameTimingMgr::m_CurrentRecord{};
+int64_t OpenXRFrameTimingMgr::m_StageStartTimes[static_cast<int>(FrameStage::COUNT)] = {};
+FrameStage OpenXRFrameTimingMgr::m_StageStack[static_cast<int>(FrameStage::COUNT)] = {};
+uint32_t OpenXRFrameTimingMgr::m_StageSpanStack[static_cast<int>(FrameStage::COUNT)] = {};
+int OpenXRFrameTimingMgr::m_StageDepth = 0;
+FrameTimingRingBuffer<FrameTimingRecord, OpenXRFrameTimingMgr::RECORD_CAPACITY> OpenXRFrameTimingMgr::m_Records{};
+FrameTimingRingBuffer<GpuTimingRecord, OpenXRFrameTimingMgr::GPU_RECORD_CAPACITY> OpenXRFrameTimingMgr::m_GpuRecords{};
+uint64_t OpenXRFrameTimingMgr::m_FrameIndex = 0;
+XrTime OpenXRFrameTimingMgr::m_LastPredictedDisplayTime = 0;
+float OpenXRFrameTimingMgr::m_DeltaTime = 1.0f / 60.0f;
+uint64_t OpenXRFrameTimingMgr::m_MissedFrameCount = 0;
+int64_t OpenXRFrameTimingMgr::m_LatestGpuFrameTimeNs = 0;
+
+namespace
+{
+    const char* const STAGE_NAMES[] = {"Wait", "Begin", "Simulate", "Record", "Submit", "End"};
+}
+
+void OpenXRFrameTimingMgr::StartFrameRecord()
+{
+    m_CurrentRecord = {};
+    m_CurrentRecord.frameIndex = m_FrameIndex++;
+    m_StageDepth = 0;
+}
+
+void OpenXRFrameTimingMgr::FinishFrameRecord()
+{
+    m_Records.Push(m_CurrentRecord);
+}
+
+void OpenXRFrameTimingMgr::BeginStage(FrameStage stage)
+{
+    const int stageIndex = static_cast<int>(stage);
+    const int64_t now = GetCpuTimeNs();
+    if (m_StageDepth > 0)
+    {
+        // Pause the outer stage
+        const int outerIndex = static_cast<int>(m_StageStack[m_StageDepth - 1]);
+        m_CurrentRecord.stageDuration[outerIndex] += now - m_StageStartTimes[outerIndex];
+    }
+    uint32_t spanIndex = FrameTimingRecord::MAX_STAGE_SPANS;
+    if (m_CurrentRecord.stageSpanCount < FrameTimingRecord::MAX_STAGE_SPANS)
+    {
+        spanIndex = m_CurrentRecord.stageSpanCount++;
+        m_CurrentRecord.stageSpans[spanIndex].stage = stage;
+        m_CurrentRecord.stageSpans[spanIndex].begin = now;
+    }
+    if (m_StageDepth < static_cast<int>(FrameStage::COUNT))
+    {
+        m_StageSpanStack[m_StageDepth] = spanIndex;
+        m_StageStack[m_StageDepth++] = stage;
+    }
+
+    m_StageStartTimes[stageIndex] = now;
+    if (m_CurrentRecord.stageBegin[stageIndex] == 0)
+    {
+        m_CurrentRecord.stageBegin[stageIndex] = now;
+    }
+}
+
+void OpenXRFrameTimingMgr::EndStage(FrameStage stage)
+{
+    const int stageIndex = static_cast<int>(stage);
+    const int64_t now = GetCpuTimeNs();
+    m_CurrentRecord.stageDuration[stageIndex] += now - m_StageStartTimes[stageIndex];
+
+    if (m_StageDepth > 0 && m_StageStack[m_StageDepth - 1] == stage)
+    {
+        --m_StageDepth;
+        const uint32_t spanIndex = m_StageSpanStack[m_StageDepth];
+        if (spanIndex < FrameTimingRecord::MAX_STAGE_SPANS)
+        {
+            m_CurrentRecord.stageSpans[spanIndex].end = now;
+        }
+        if (m_StageDepth > 0)
+        {
+            // Resume the outer stage
+            m_StageStartTimes[static_cast<int>(m_StageStack[m_StageDepth - 1])] = now;
+        }
+    }
+}
+
+void OpenXRFrameTimingMgr::UpdateFrameState(const XrFrameState& frameState)
+{
+    const XrDuration period = frameState.predictedDisplayPeriod;
+    uint32_t missedFrames = 0;
+
+    if (m_LastPredictedDisplayTime != 0 && frameState.predictedDisplayTime > m_LastPredictedDisplayTime)
+    {
+        const XrDuration elapsed = frameState.predictedDisplayTime - m_LastPredictedDisplayTime;
+        m_DeltaTime = std::min(static_cast<float>(elapsed) * 1e-9f, MAX_DELTA_TIME);
+
+        // Anything beyond half a period late means the compositor skipped at least one display refresh
+        if (period > 0 && elapsed > period + period / 2)
+        {
+            missedFrames = static_cast<uint32_t>(std::llround(static_cast<double>(elapsed) / static_cast<double>(period))) - 1;
+        }
+    }
+    else if (period > 0)
+    {
+        m_DeltaTime = static_cast<float>(period) * 1e-9f;
+    }
+    m_LastPredictedDisplayTime = frameState.predictedDisplayTime;
+    m_MissedFrameCount += missedFrames;
+
+    m_CurrentRecord.predictedDisplayTime = frameState.predictedDisplayTime;
+    m_CurrentRecord.predictedDisplayPeriod = period;
+    m_CurrentRecord.deltaTime = m_DeltaTime;
+    m_CurrentRecord.missedFrames = missedFrames;
+}
+
+float OpenXRFrameTimingMgr::GetDeltaTime()
+{
+    return m_DeltaTime;
+}
+
+uint64_t OpenXRFrameTimingMgr::GetMissedFrameCount()
+{
+    return m_MissedFrameCount;
+}
+
+void OpenXRFrameTimingMgr::CollectGpuTimings()
+{
+    static std::vector<GraphicsAPI::GpuScopeTiming> gpuTimings;
+    gpuTimings.clear();
+    OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI->ResolveGpuScopes(gpuTimings);
+
+    int64_t topLevelDurationNs = 0;
+    uint64_t submissionCount = 0;
+    uint64_t lastSubmissionIndex = UINT64_MAX;
+    for (const GraphicsAPI::GpuScopeTiming& timing : gpuTimings)
+    {
+        if (timing.depth == 0)
+        {
+            topLevelDurationNs += static_cast<int64_t>(timing.endTime - timing.beginTime);
+        }
+        if (timing.submissionIndex != lastSubmissionIndex)
+        {
+            lastSubmissionIndex = timing.submissionIndex;
+            ++submissionCount;
+        }
+
+        GpuTimingRecord record;
+        record.submissionIndex = timing.submissionIndex;
+        record.cpuBeginNs = timing.cpuSubmitTime + static_cast<int64_t>(timing.beginTime);
+        record.durationNs = static_cast<int64_t>(timing.endTime - timing.beginTime);
+        record.depth = timing.depth;
+        std::strncpy(record.name, timing.name.c_str(), sizeof(record.name) - 1);
+        m_GpuRecords.Push(record);
+    }
+
+    // Each view is its own submission, so a frame costs the mean submission times the views count
+    m_LatestGpuFrameTimeNs = submissionCount > 0 ? topLevelDurationNs / static_cast<int64_t>(submissionCount) *
+                                                       static_cast<int64_t>(OpenXRDisplayMgr::GetViewsCount())
+                                                 : 0;
+}
+
+int64_t OpenXRFrameTimingMgr::GetLatestGpuFrameTime()
+{
+    return m_LatestGpuFrameTimeNs;
+}
+
+std::vector<FrameTimingRecord> OpenXRFrameTimingMgr::GetFrameRecords()
+{
+    return m_Records.Snapshot();
+}
+
+std::vector<GpuTimingRecord> OpenXRFrameTimingMgr::GetGpuRecords()
+{
+    return m_GpuRecords.Snapshot();
+}
+
+bool OpenXRFrameTimingMgr::ExportCSV(const std::string& filePath)
+{
+    std::ofstream file(filePath);
+    if (!file.is_open())
+    {
+        XR_TUT_LOG_ERROR("Failed to open frame timing file: " << filePath);
+        return false;
+    }
+
+    file << "frame,predicted_display_time_ns,predicted_display_period_ns,delta_time_s,missed_frames";
+    for (const char* stageName : STAGE_NAMES)
+    {
+        file << "," << stageName << "_begin_ns," << stageName << "_duration_ns";
+    }
+    file << "\n";
+
+    for (const FrameTimingRecord& record : m_Records.Snapshot())
+    {
+        file << record.frameIndex << "," << record.predictedDisplayTime << "," << record.predictedDisplayPeriod << ","
+             << record.deltaTime << "," << record.missedFrames;
+        for (int stageIndex = 0; stageIndex < static_cast<int>(FrameStage::COUNT); ++stageIndex)
+        {
+            file << "," << record.stageBegin[stageIndex] << "," << record.stageDuration[stageIndex];
+        }
+        file << "\n";
+    }
+
+    XR_TUT_LOG("Exported frame timing CSV: " << filePath);
+    return true;
+}
+
+bool OpenXRFrameTimingMgr::ExportChromeTrace(const std::string& filePath)
+{
+    std::ofstream file(filePath);
+    if (!file.is_open())
+    {
+        XR_TUT_LOG_ERROR("Failed to open frame timing trace file: " << filePath);
+        return false;
+    }
+
+    // Trace event format, complete events ("X") with timestamps in microseconds
+    // CPU stages go on tid 0, one event per begin/end pair so nested stages show nested, and GPU scopes on tid 1
+    file << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+    file << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}}";
+    file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"GPU\"}}";
+    for (const FrameTimingRecord& record : m_Records.Snapshot())
+    {
+        for (uint32_t spanIndex = 0; spanIndex < record.stageSpanCount; ++spanIndex)
+        {
+            const FrameStageSpan& span = record.stageSpans[spanIndex];
+            if (span.end == 0) continue;
+
+            file << ",\n{\"name\":\"" << STAGE_NAMES[static_cast<int>(span.stage)] << "\",\"cat\":\"cpu\",\"ph\":\"X\""
+                 << ",\"ts\":" << span.begin / 1000.0 << ",\"dur\":" << (span.end - span.begin) / 1000.0
+                 << ",\"pid\":0,\"tid\":0,\"args\":{\"frame\":" << record.frameIndex << ",\"missedFrames\":" << record.missedFrames << "}}";
+        }
+    }
+    for (const GpuTimingRecord& record : m_GpuRecords.Snapshot())
+    {
+        file << ",\n{\"name\":\"" << record.name << "\",\"cat\":\"gpu\",\"ph\":\"X\""
+             << ",\"ts\":" << record.cpuBeginNs / 1000.0 << ",\"dur\":" << record.durationNs / 1000.0
+             << ",\"pid\":0,\"tid\":1,\"args\":{\"submission\":" << record.submissionIndex << ",\"depth\":" << record.depth << "}}";
+    }
+    file << "\n]}\n";
+
+    XR_TUT_LOG("Exported frame timing trace: " << filePath);
+    return true;
+}
+
+int64_t OpenXRFrameTimingMgr::GetCpuTimeNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,62 @@
+﻿#pragma once
+
+#include <openxr/openxr.h>
+#include <string>
+#include <vector>
+
+#include "FrameTiming/FrameTimingRecord.h"
+#include "FrameTiming/FrameTimingRingBuffer.h"
+#include "FrameTiming/GpuTimingRecord.h"
+
+class OpenXRFrameTimingMgr
+{
+public:
+    static void StartFrameRecord();
+    static void FinishFrameRecord();
+
+    // Stages nest; the outer stage doesn't count the time spent in the inner one
+    static void BeginStage(FrameStage stage);
+    static void EndStage(FrameStage stage);
+
+    // Derives the delta time and missed frames from the predicted display times
+    static void UpdateFrameState(const XrFrameState& frameState);
+
+    static float GetDeltaTime();
+    static uint64_t GetMissedFrameCount();
+
+    // Pulls the GPU scope timings the graphics API has read back since the last call
+    static void CollectGpuTimings();
+
+    // GPU time of a frame estimated from the top-level scopes the last CollectGpuTimings call read back,
+    // 0 when nothing was read back
+    static int64_t GetLatestGpuFrameTime();
+
+    // Copies of the retained records, oldest first
+    static std::vector<FrameTimingRecord> GetFrameRecords();
+    static std::vector<GpuTimingRecord> GetGpuRecords();
+
+    static bool ExportCSV(const std::string& filePath);
+    static bool ExportChromeTrace(const std::string& filePath);
+
+    static constexpr size_t RECORD_CAPACITY = 1024;
+    static constexpr size_t GPU_RECORD_CAPACITY = 8192;
+
+private:
+    static int64_t GetCpuTimeNs();
+
+    static FrameTimingRecord m_CurrentRecord;
+    static int64_t m_StageStartTimes[static_cast<int>(FrameStage::COUNT)];
+    static FrameStage m_StageStack[static_cast<int>(FrameStage::COUNT)];
+    static uint32_t m_StageSpanStack[static_cast<int>(FrameStage::COUNT)];  // Span of each open stage, MAX_STAGE_SPANS if dropped
+    static int m_StageDepth;
+    static FrameTimingRingBuffer<FrameTimingRecord, RECORD_CAPACITY> m_Records;
+    static FrameTimingRingBuffer<GpuTimingRecord, GPU_RECORD_CAPACITY> m_GpuRecords;
+
+    static uint64_t m_FrameIndex;
+    static XrTime m_LastPredictedDisplayTime;
+    static float m_DeltaTime;
+    static uint64_t m_MissedFrameCount;
+    static int64_t m_LatestGpuFrameTimeNs;
+
+    static constexpr float MAX_DELTA_TIME = 0.1f;
+};
@@ -16,5 +16,10 @@ public:
     virtual XrSwapchainImageBaseHeader* GetSwapchainImageData(XrSwapchain swapchain, uint32_t index) = 0;
     virtual void* GetSwapchainImage(XrSwapchain swapchain, uint32_t index) = 0;
 
+    // Asks for the runtime's foveation image alongside each image of the swapchain (XR_FB_foveation).
+    // Must be called before AllocateSwapchainImagesMemory.
+    virtual void EnableSwapchainFoveationImages(XrSwapchain /*swapchain*/) {}
+    virtual void* GetSwapchainFoveationImage(XrSwapchain /*swapchain*/, uint32_t /*index*/, uint32_t& /*width*/, uint32_t& /*height*/) { return nullptr; }
+
     std::unique_ptr<GraphicsAPI> graphicsAPI;
 };
\ No newline at end of file
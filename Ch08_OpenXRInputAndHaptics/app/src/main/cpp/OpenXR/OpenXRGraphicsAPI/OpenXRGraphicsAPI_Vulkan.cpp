@@ -31,6 +31,11 @@ OpenXRGraphicsAPI_Vulkan::OpenXRGraphicsAPI_Vulkan(XrInstance xrInstance, XrSyst
     appInfo.engineVersion = 1;
     appInfo.apiVersion = VK_MAKE_VERSION(XR_VERSION_MAJOR(graphicsReqs.minApiVersionSupported),
                                          XR_VERSION_MINOR(graphicsReqs.minApiVersionSupported), 0);
+    // Optional device features such as fragment density maps are queried through Vulkan 1.1
+    if (appInfo.apiVersion < VK_API_VERSION_1_1 && graphicsReqs.maxApiVersionSupported >= XR_MAKE_VERSION(1, 1, 0))
+    {
+        appInfo.apiVersion = VK_API_VERSION_1_1;
+    }
 
     VkInstanceCreateInfo instanceCreateInfo{};
     instanceCreateInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -57,6 +62,9 @@ OpenXRGraphicsAPI_Vulkan::OpenXRGraphicsAPI_Vulkan(XrInstance xrInstance, XrSyst
     initInfo.deviceExtensions = activeDeviceExtensions;
     initInfo.instance = vkInstance;// Use the instance we created
     initInfo.physicalDevice = physicalDevice; // Use OpenXR selected device
+    initInfo.apiVersion = appInfo.apiVersion;
+    // MeshRenderer keeps a uniform slot per frame in flight, so the CPU can record a frame ahead
+    initInfo.framesInFlight = 2;
 
     graphicsAPI = std::make_unique<GraphicsAPI_Vulkan>(initInfo);
 }
@@ -132,6 +140,18 @@ XrSwapchainImageBaseHeader* OpenXRGraphicsAPI_Vulkan::AllocateSwapchainImagesMem
     swapchainImageTemplate.type = XR_TYPE_SWAPCHAIN_IMAGE_VULKAN_KHR;
     swapchainImagesMap[swapchain].resize(count, swapchainImageTemplate);
 
+    auto foveationImages = swapchainFoveationImagesMap.find(swapchain);
+    if (foveationImages != swapchainFoveationImagesMap.end())
+    {
+        XrSwapchainImageFoveationVulkanFB foveationImageTemplate{};
+        foveationImageTemplate.type = XR_TYPE_SWAPCHAIN_IMAGE_FOVEATION_VULKAN_FB;
+        foveationImages->second.resize(count, foveationImageTemplate);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            swapchainImagesMap[swapchain][i].next = &foveationImages->second[i];
+        }
+    }
+
     return reinterpret_cast<XrSwapchainImageBaseHeader*>(swapchainImagesMap[swapchain].data());
 }
 
@@ -139,6 +159,7 @@ void OpenXRGraphicsAPI_Vulkan::FreeSwapchainImagesMemory(XrSwapchain swapchain)
 {
     swapchainImagesMap[swapchain].clear();
     swapchainImagesMap.erase(swapchain);
+    swapchainFoveationImagesMap.erase(swapchain);
 }
 
 XrSwapchainImageBaseHeader* OpenXRGraphicsAPI_Vulkan::GetSwapchainImageData(XrSwapchain swapchain, uint32_t index)
@@ -149,4 +170,22 @@ XrSwapchainImageBaseHeader* OpenXRGraphicsAPI_Vulkan::GetSwapchainImageData(XrSw
 void* OpenXRGraphicsAPI_Vulkan::GetSwapchainImage(XrSwapchain swapchain, uint32_t index)
 {
     return reinterpret_cast<void*>(swapchainImagesMap[swapchain][index].image);
+}
+
+void OpenXRGraphicsAPI_Vulkan::EnableSwapchainFoveationImages(XrSwapchain swapchain)
+{
+    swapchainFoveationImagesMap[swapchain];
+}
+
+void* OpenXRGraphicsAPI_Vulkan::GetSwapchainFoveationImage(XrSwapchain swapchain, uint32_t index, uint32_t& width, uint32_t& height)
+{
+    auto foveationImages = swapchainFoveationImagesMap.find(swapchain);
+    if (foveationImages == swapchainFoveationImagesMap.end() || index >= foveationImages->second.size())
+    {
+        return nullptr;
+    }
+    const XrSwapchainImageFoveationVulkanFB& foveationImage = foveationImages->second[index];
+    width = foveationImage.width;
+    height = foveationImage.height;
+    return reinterpret_cast<void*>(foveationImage.image);
 }
\ No newline at end of file
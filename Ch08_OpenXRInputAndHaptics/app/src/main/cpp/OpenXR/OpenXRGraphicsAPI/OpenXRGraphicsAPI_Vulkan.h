@@ -14,6 +14,9 @@ public:
     XrSwapchainImageBaseHeader* GetSwapchainImageData(XrSwapchain swapchain, uint32_t index) override;
     void* GetSwapchainImage(XrSwapchain swapchain, uint32_t index) override;
 
+    void EnableSwapchainFoveationImages(XrSwapchain swapchain) override;
+    void* GetSwapchainFoveationImage(XrSwapchain swapchain, uint32_t index, uint32_t& width, uint32_t& height) override;
+
 private:
     void LoadXRFunctionsPointers(XrInstance xrInstance);
     PFN_xrGetVulkanGraphicsRequirementsKHR xrGetVulkanGraphicsRequirementsKHR = nullptr;
@@ -26,4 +29,5 @@ private:
     std::vector<std::string> GetDeviceExtensionsForOpenXR(XrInstance xrInstance, XrSystemId systemId);
 
     std::unordered_map<XrSwapchain, std::vector<XrSwapchainImageVulkanKHR>> swapchainImagesMap{};
+    std::unordered_map<XrSwapchain, std::vector<XrSwapchainImageFoveationVulkanFB>> swapchainFoveationImagesMap{};
 };
\ No newline at end of file
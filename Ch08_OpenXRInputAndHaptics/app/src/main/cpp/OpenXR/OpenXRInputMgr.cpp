@@ -2,8 +2,11 @@
 
 #include <DebugOutput.h>
 #include <OpenXRHelper.h>
-#include <XRPathUtils.h>
+#include <XrPathUtils.h>
 #include "OpenXRCoreMgr.h"
+#include "../Engine/Diagnostics/TraceLogMgr.h"
+
+#include <algorithm>
 
 ActionSetInfo OpenXRInputMgr::m_ActionSet{};
 std::vector<InteractionProfileBinding> OpenXRInputMgr::m_InteractionProfileBindings{};
@@ -14,6 +17,7 @@ XrAction OpenXRInputMgr::m_HandPoseAction = XR_NULL_HANDLE;
 XrAction OpenXRInputMgr::m_SelectAction = XR_NULL_HANDLE;
 XrAction OpenXRInputMgr::m_HapticAction = XR_NULL_HANDLE;
 XrSpace OpenXRInputMgr::m_HandSpaces[2] = {XR_NULL_HANDLE, XR_NULL_HANDLE};
+HapticState OpenXRInputMgr::m_HapticStates[2] = {};
 
 void OpenXRInputMgr::Shutdown()
 {
@@ -23,6 +27,7 @@ void OpenXRInputMgr::Shutdown()
     for (int i = 0; i < 2; ++i)
     {
         handStates[i] = {};
+        m_HapticStates[i] = {};
     }
 
     XR_TUT_LOG("OpenXRInputMgr shutdown completed");
@@ -34,9 +39,71 @@ void OpenXRInputMgr::Tick(XrTime predictedTime, XrSpace referenceSpace)
     UpdateHandStates(predictedTime, referenceSpace);
 }
 
-void OpenXRInputMgr::TriggerHapticFeedback(int handIndex, float amplitude, XrDuration duration)
+bool OpenXRInputMgr::IsValidHandIndex(int handIndex)
+{
+    if (handIndex < 0 || handIndex >= 2)
+    {
+        XR_TRACE_ERROR("OpenXRInputMgr: hand index {} is out of range", handIndex);
+        return false;
+    }
+    return true;
+}
+
+void OpenXRInputMgr::TriggerHapticFeedback(int handIndex, float amplitude, XrDuration duration, float frequency)
+{
+    if (!IsValidHandIndex(handIndex)) return;
+
+    HapticPulse pulse{};
+    pulse.amplitude = amplitude;
+    pulse.duration = duration;
+    pulse.frequency = frequency;
+
+    m_HapticStates[handIndex].QueuePulse(pulse);
+}
+
+void OpenXRInputMgr::PlayHapticPattern(int handIndex, const std::vector<HapticPulse>& pattern)
+{
+    if (!IsValidHandIndex(handIndex)) return;
+
+    HapticState& hapticState = m_HapticStates[handIndex];
+    hapticState.pattern = pattern;
+    hapticState.patternIndex = 0;
+    hapticState.segmentEndTime = 0;
+}
+
+void OpenXRInputMgr::StopHapticFeedback(int handIndex)
+{
+    if (!IsValidHandIndex(handIndex)) return;
+
+    HapticState& hapticState = m_HapticStates[handIndex];
+    hapticState.hasPendingPulse = false;
+    hapticState.pattern.clear();
+    hapticState.patternIndex = 0;
+    hapticState.stopRequested = true;
+}
+
+void OpenXRInputMgr::FlushHaptics(XrTime predictedTime)
 {
-    ApplyHapticFeedback(m_HapticAction, handIndex == 0 ? HAND_LEFT_PATH : HAND_RIGHT_PATH, amplitude, duration);
+    for (int handIndex = 0; handIndex < 2; ++handIndex)
+    {
+        HapticState& hapticState = m_HapticStates[handIndex];
+        const char* subactionPath = handIndex == 0 ? HAND_LEFT_PATH : HAND_RIGHT_PATH;
+
+        if (hapticState.stopRequested)
+        {
+            StopHapticFeedback(m_HapticAction, subactionPath);
+            hapticState.stopRequested = false;
+        }
+
+        hapticState.StepPattern(predictedTime);
+
+        if (hapticState.hasPendingPulse)
+        {
+            const HapticPulse& pulse = hapticState.pendingPulse;
+            ApplyHapticFeedback(m_HapticAction, subactionPath, pulse.amplitude, pulse.duration, pulse.frequency);
+            hapticState.hasPendingPulse = false;
+        }
+    }
 }
 
 void OpenXRInputMgr::SetupActions()
@@ -130,8 +197,16 @@ void OpenXRInputMgr::UpdateHandStates(XrTime predictedTime, XrSpace referenceSpa
         handStates[handIndex].currentSelectPressed = GetActionStateBoolean(m_SelectAction,
                                                                              handIndex == 0 ? HAND_LEFT_PATH : HAND_RIGHT_PATH);
 
+        XrSpaceVelocity spaceVelocity = {};
         handStates[handIndex].pose = GetActionStatePose(m_HandPoseAction, m_HandSpaces[handIndex],
-                                                          referenceSpace, predictedTime, &handStates[handIndex].poseActive);
+                                                          referenceSpace, predictedTime, &handStates[handIndex].poseActive,
+                                                          &spaceVelocity);
+
+        const XrSpaceVelocityFlags bothVelocitiesValid = XR_SPACE_VELOCITY_LINEAR_VALID_BIT | XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+        handStates[handIndex].velocityValid = handStates[handIndex].poseActive &&
+                                              (spaceVelocity.velocityFlags & bothVelocitiesValid) == bothVelocitiesValid;
+        handStates[handIndex].linearVelocity = spaceVelocity.linearVelocity;
+        handStates[handIndex].angularVelocity = spaceVelocity.angularVelocity;
     }
 }
 
@@ -337,7 +412,8 @@ float OpenXRInputMgr::GetActionStateFloat(XrAction action, const std::string& su
     return 0.0f;
 }
 
-XrPosef OpenXRInputMgr::GetActionStatePose(XrAction poseAction, XrSpace actionSpace, XrSpace referenceSpace, XrTime predictedTime, bool* isActive)
+XrPosef OpenXRInputMgr::GetActionStatePose(XrAction poseAction, XrSpace actionSpace, XrSpace referenceSpace, XrTime predictedTime, bool* isActive,
+                                           XrSpaceVelocity* velocity)
 {
     XrPosef pose = {{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
 
@@ -368,6 +444,13 @@ XrPosef OpenXRInputMgr::GetActionStatePose(XrAction poseAction, XrSpace actionSp
     XrSpaceLocation spaceLocation = {};
     spaceLocation.type = XR_TYPE_SPACE_LOCATION;
     spaceLocation.next = nullptr;
+    if (velocity)
+    {
+        velocity->type = XR_TYPE_SPACE_VELOCITY;
+        velocity->next = nullptr;
+        velocity->velocityFlags = 0;
+        spaceLocation.next = velocity;
+    }
     result = xrLocateSpace(actionSpace, referenceSpace, predictedTime, &spaceLocation);
 
     if (XR_SUCCEEDED(result) && (spaceLocation.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) &&
@@ -410,6 +493,26 @@ void OpenXRInputMgr::ApplyHapticFeedback(XrAction hapticAction, const std::strin
     }
 }
 
+void OpenXRInputMgr::StopHapticFeedback(XrAction hapticAction, const std::string& subactionPath)
+{
+    XrHapticActionInfo hapticActionInfo = {};
+    hapticActionInfo.type = XR_TYPE_HAPTIC_ACTION_INFO;
+    hapticActionInfo.next = nullptr;
+    hapticActionInfo.action = hapticAction;
+
+    if (!subactionPath.empty())
+    {
+        hapticActionInfo.subactionPath = XRPathUtils::StringToPath(OpenXRCoreMgr::m_xrInstance, subactionPath);
+    }
+
+    XrResult result = xrStopHapticFeedback(OpenXRCoreMgr::xrSession, &hapticActionInfo);
+
+    if (!XR_SUCCEEDED(result))
+    {
+        XR_TUT_LOG_ERROR("Failed to stop haptic feedback");
+    }
+}
+
 void OpenXRInputMgr::GetCurrentInteractionProfile(const std::string& subactionPath, std::string& profilePath)
 {
     XrPath topLevelUserPath = XRPathUtils::StringToPath(OpenXRCoreMgr::m_xrInstance, subactionPath);
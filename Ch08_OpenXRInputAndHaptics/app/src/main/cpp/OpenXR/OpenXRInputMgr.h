@@ -8,6 +8,7 @@
 #include "Input/ActionSetInfo.h"
 #include "Input/InteractionProfileBinding.h"
 #include "Input//HandState.h"
+#include "Input/HapticState.h"
 
 class OpenXRInputMgr
 {
@@ -15,7 +16,11 @@ public:
     static void Shutdown();
     static void Tick(XrTime predictedTime, XrSpace referenceSpace);
     
-    static void TriggerHapticFeedback(int handIndex, float amplitude = 0.5f, XrDuration duration = 100000000);
+    static void TriggerHapticFeedback(int handIndex, float amplitude = 0.5f, XrDuration duration = 100000000,
+                                      float frequency = XR_FREQUENCY_UNSPECIFIED);
+    static void PlayHapticPattern(int handIndex, const std::vector<HapticPulse>& pattern);
+    static void StopHapticFeedback(int handIndex);
+    static void FlushHaptics(XrTime predictedTime);
     
     static void CreateActionSet(const std::string& actionSetName, const std::string& localizedName, uint32_t priority = 0);
     static void DestroyActionSet();
@@ -37,6 +42,8 @@ private:
     static XrAction m_HapticAction;
     
     static XrSpace m_HandSpaces[2];
+
+    static HapticState m_HapticStates[2];
     
     static void UpdateHandStates(XrTime predictedTime, XrSpace referenceSpace);
     
@@ -54,11 +61,15 @@ private:
     static void SyncActions();
     static bool GetActionStateBoolean(XrAction action, const std::string& subactionPath = "", bool* changedSinceLastSync = nullptr);
     static float GetActionStateFloat(XrAction action, const std::string& subactionPath = "", bool* changedSinceLastSync = nullptr);
-    static XrPosef GetActionStatePose(XrAction poseAction, XrSpace actionSpace, XrSpace referenceSpace, XrTime predictedTime, bool* isActive = nullptr);
+    static XrPosef GetActionStatePose(XrAction poseAction, XrSpace actionSpace, XrSpace referenceSpace, XrTime predictedTime, bool* isActive = nullptr,
+                                      XrSpaceVelocity* velocity = nullptr);
     
     static void ApplyHapticFeedback(XrAction hapticAction, const std::string& subactionPath, 
                                    float amplitude, XrDuration duration = XR_MIN_HAPTIC_DURATION, 
                                    float frequency = XR_FREQUENCY_UNSPECIFIED);
+    static void StopHapticFeedback(XrAction hapticAction, const std::string& subactionPath);
+    // Logs and returns false for anything but 0 (left) and 1 (right)
+    static bool IsValidHandIndex(int handIndex);
     
     static void GetCurrentInteractionProfile(const std::string& subactionPath, std::string& profilePath);
 
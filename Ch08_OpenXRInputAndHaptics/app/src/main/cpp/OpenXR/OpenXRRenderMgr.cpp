@@ -3,9 +3,12 @@
 #include <openxr/openxr.h>
 
 #include "DebugOutput.h"
+#include "OpenXRAttachmentMgr.h"
+#include "OpenXRCompositionLayerMgr.h"
 #include "OpenXRCoreMgr.h"
 #include "OpenXRDisplayMgr.h"
 #include "OpenXRHelper.h"
+#include "OpenXRResolutionMgr.h"
 #include "OpenXRSessionMgr.h"
 #include "OpenXRSpaceMgr.h"
 
@@ -13,6 +16,8 @@
 std::vector<XrView> OpenXRRenderMgr::views{};
 XrViewState OpenXRRenderMgr::viewState{};
 RenderLayerInfo OpenXRRenderMgr::renderLayerInfo{};
+float OpenXRRenderMgr::m_DepthNearZ = 0.05f;
+float OpenXRRenderMgr::m_DepthFarZ = 1000.0f;
 
 void OpenXRRenderMgr::RefreshViewsData()
 {
@@ -40,6 +45,12 @@ void OpenXRRenderMgr::UpdateRenderLayerInfo()
     layerProjectionViewTemplate.type = XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW;
     renderLayerInfo.layerProjectionViews.resize(views.size(), layerProjectionViewTemplate);
 
+    // With depth the compositor can reproject positionally, which hides missed frames far better than rotation alone
+    const bool submitDepth = OpenXRAttachmentMgr::IsDepthSubmitted();
+    XrCompositionLayerDepthInfoKHR layerDepthInfoTemplate = {};
+    layerDepthInfoTemplate.type = XR_TYPE_COMPOSITION_LAYER_DEPTH_INFO_KHR;
+    renderLayerInfo.layerDepthInfos.resize(submitDepth ? views.size() : 0, layerDepthInfoTemplate);
+
     renderLayerInfo.projectionLayer.layerFlags =
         XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT | XR_COMPOSITION_LAYER_CORRECT_CHROMATIC_ABERRATION_BIT;
     renderLayerInfo.projectionLayer.space = OpenXRSpaceMgr::activeSpaces;
@@ -48,16 +59,38 @@ void OpenXRRenderMgr::UpdateRenderLayerInfo()
 
     for (int viewIndex = 0; viewIndex != static_cast<int>(views.size()); ++viewIndex)
     {
-        const uint32_t& width = OpenXRDisplayMgr::activeViewConfigurationViews[viewIndex].recommendedImageRectWidth;
-        const uint32_t& height = OpenXRDisplayMgr::activeViewConfigurationViews[viewIndex].recommendedImageRectHeight;
+        const XrExtent2Di extent = OpenXRResolutionMgr::GetViewExtent(viewIndex);
 
         renderLayerInfo.layerProjectionViews[viewIndex].pose = views[viewIndex].pose;
         renderLayerInfo.layerProjectionViews[viewIndex].fov = views[viewIndex].fov;
         renderLayerInfo.layerProjectionViews[viewIndex].subImage.swapchain = OpenXRDisplayMgr::colorSwapchainInfos[viewIndex].swapchain;
         renderLayerInfo.layerProjectionViews[viewIndex].subImage.imageRect.offset.x = 0;
         renderLayerInfo.layerProjectionViews[viewIndex].subImage.imageRect.offset.y = 0;
-        renderLayerInfo.layerProjectionViews[viewIndex].subImage.imageRect.extent.width = static_cast<int32_t>(width);
-        renderLayerInfo.layerProjectionViews[viewIndex].subImage.imageRect.extent.height = static_cast<int32_t>(height);
+        renderLayerInfo.layerProjectionViews[viewIndex].subImage.imageRect.extent.width = extent.width;
+        renderLayerInfo.layerProjectionViews[viewIndex].subImage.imageRect.extent.height = extent.height;
         renderLayerInfo.layerProjectionViews[viewIndex].subImage.imageArrayIndex = 0;
+        renderLayerInfo.layerProjectionViews[viewIndex].next = nullptr;
+
+        if (submitDepth)
+        {
+            XrCompositionLayerDepthInfoKHR& layerDepthInfo = renderLayerInfo.layerDepthInfos[viewIndex];
+            layerDepthInfo.subImage = renderLayerInfo.layerProjectionViews[viewIndex].subImage;
+            layerDepthInfo.subImage.swapchain = OpenXRDisplayMgr::depthSwapchainInfos[viewIndex].swapchain;
+            layerDepthInfo.minDepth = 0.0f;
+            layerDepthInfo.maxDepth = 1.0f;
+            layerDepthInfo.nearZ = m_DepthNearZ;
+            layerDepthInfo.farZ = m_DepthFarZ;
+            renderLayerInfo.layerProjectionViews[viewIndex].next = &layerDepthInfo;
+        }
     }
+
+    // The projection layer stays first, the quad and cylinder layers are composited over it
+    renderLayerInfo.layers.resize(1);
+    OpenXRCompositionLayerMgr::AppendLayers(renderLayerInfo.layers);
+}
+
+void OpenXRRenderMgr::SetDepthRange(float nearZ, float farZ)
+{
+    m_DepthNearZ = nearZ;
+    m_DepthFarZ = farZ;
 }
\ No newline at end of file
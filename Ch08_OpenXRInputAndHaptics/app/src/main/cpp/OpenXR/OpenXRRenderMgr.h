@@ -11,7 +11,15 @@ public:
     static void RefreshViewsData();
     static void UpdateRenderLayerInfo();
 
+    // Distances in meters that depth values 0 and 1 stand for, used to submit the depth swapchains to the compositor.
+    // nearZ is the larger of the two with a reversed depth range, farZ may be infinity.
+    static void SetDepthRange(float nearZ, float farZ);
+
     static std::vector<XrView> views;
     static XrViewState viewState;
     static RenderLayerInfo renderLayerInfo;
+
+private:
+    static float m_DepthNearZ;
+    static float m_DepthFarZ;
 };
\ No newline at end of file
@@ -0,0 +1,142 @@
+﻿#include "OpenXRResolutionMgr.h"
+
+#include <DebugOutput.h>
+#include "OpenXRDisplayMgr.h"
+#include <algorithm>
+#include <cmath>
+
+bool OpenXRResolutionMgr::m_Enabled = true;
+float OpenXRResolutionMgr::m_Scale = 1.0f;
+float OpenXRResolutionMgr::m_MinScale = 0.5f;
+float OpenXRResolutionMgr::m_MaxScale = 1.0f;
+float OpenXRResolutionMgr::m_UpperScaleLimit = 1.0f;
+float OpenXRResolutionMgr::m_SmoothedGpuTimeNs = 0.0f;
+uint32_t OpenXRResolutionMgr::m_SettleFramesLeft = 0;
+std::vector<XrExtent2Di> OpenXRResolutionMgr::m_ViewExtents{};
+
+void OpenXRResolutionMgr::Initialize()
+{
+    // The scale is shared by all views, so it can't go past the view with the least room above its recommended size
+    m_UpperScaleLimit = 0.0f;
+    for (const XrViewConfigurationView& view : OpenXRDisplayMgr::activeViewConfigurationViews)
+    {
+        const float widthLimit = static_cast<float>(view.maxImageRectWidth) / static_cast<float>(std::max(view.recommendedImageRectWidth, 1u));
+        const float heightLimit = static_cast<float>(view.maxImageRectHeight) / static_cast<float>(std::max(view.recommendedImageRectHeight, 1u));
+        const float viewLimit = std::max(std::min(widthLimit, heightLimit), 1.0f);
+        m_UpperScaleLimit = m_UpperScaleLimit == 0.0f ? viewLimit : std::min(m_UpperScaleLimit, viewLimit);
+    }
+    m_UpperScaleLimit = std::max(m_UpperScaleLimit, 1.0f);
+
+    m_Scale = 1.0f;
+    m_SmoothedGpuTimeNs = 0.0f;
+    m_SettleFramesLeft = 0;
+    SetScaleRange(m_MinScale, m_MaxScale);
+
+    XR_TUT_LOG("Dynamic resolution " << (m_Enabled ? "enabled" : "disabled") << ", scale range " << m_MinScale << " - " << m_MaxScale);
+}
+
+void OpenXRResolutionMgr::Update(int64_t gpuFrameTimeNs, XrDuration displayPeriod)
+{
+    if (!m_Enabled || gpuFrameTimeNs <= 0 || displayPeriod <= 0)
+    {
+        return;
+    }
+    if (m_SettleFramesLeft > 0)
+    {
+        --m_SettleFramesLeft;
+        return;
+    }
+
+    // Spikes are taken as they come, only the recovery is smoothed
+    const float gpuTimeNs = static_cast<float>(gpuFrameTimeNs);
+    if (m_SmoothedGpuTimeNs == 0.0f || gpuTimeNs > m_SmoothedGpuTimeNs)
+    {
+        m_SmoothedGpuTimeNs = gpuTimeNs;
+    }
+    else
+    {
+        m_SmoothedGpuTimeNs += (gpuTimeNs - m_SmoothedGpuTimeNs) * SMOOTHING;
+    }
+
+    // The cost follows the pixel count, which goes with the square of the scale
+    const float budgetNs = static_cast<float>(displayPeriod) * GPU_BUDGET;
+    const float idealScale = m_Scale * std::sqrt(budgetNs / m_SmoothedGpuTimeNs);
+
+    float scale = m_Scale;
+    if (m_SmoothedGpuTimeNs > budgetNs)
+    {
+        scale = std::max(idealScale, m_Scale - MAX_STEP_DOWN);
+    }
+    else if (m_SmoothedGpuTimeNs < budgetNs * GROW_THRESHOLD)
+    {
+        scale = std::min(idealScale, m_Scale + MAX_STEP_UP);
+    }
+    scale = std::min(std::max(scale, m_MinScale), m_MaxScale);
+
+    if (scale != m_Scale)
+    {
+        // Carry the estimate over to the new pixel count so the next readings aren't compared against the old one
+        m_SmoothedGpuTimeNs *= (scale * scale) / (m_Scale * m_Scale);
+        m_SettleFramesLeft = SETTLE_FRAMES;
+        m_Scale = scale;
+        UpdateViewExtents();
+    }
+}
+
+void OpenXRResolutionMgr::SetEnabled(bool enabled)
+{
+    m_Enabled = enabled;
+    if (!m_Enabled)
+    {
+        m_Scale = std::min(std::max(1.0f, m_MinScale), m_MaxScale);
+        m_SmoothedGpuTimeNs = 0.0f;
+    }
+    UpdateViewExtents();
+}
+
+bool OpenXRResolutionMgr::IsEnabled()
+{
+    return m_Enabled;
+}
+
+void OpenXRResolutionMgr::SetScaleRange(float minScale, float maxScale)
+{
+    m_MaxScale = std::min(std::max(maxScale, 0.1f), m_UpperScaleLimit);
+    m_MinScale = std::min(std::max(minScale, 0.1f), m_MaxScale);
+    m_Scale = std::min(std::max(m_Scale, m_MinScale), m_MaxScale);
+    UpdateViewExtents();
+}
+
+float OpenXRResolutionMgr::GetScale()
+{
+    return m_Scale;
+}
+
+XrExtent2Di OpenXRResolutionMgr::GetViewExtent(int viewIndex)
+{
+    if (viewIndex < 0 || viewIndex >= static_cast<int>(m_ViewExtents.size()))
+    {
+        XR_TUT_LOG_ERROR("OpenXRResolutionMgr::GetViewExtent() - Invalid view index " << viewIndex);
+        return {0, 0};
+    }
+    return m_ViewExtents[viewIndex];
+}
+
+void OpenXRResolutionMgr::UpdateViewExtents()
+{
+    const std::vector<XrViewConfigurationView>& views = OpenXRDisplayMgr::activeViewConfigurationViews;
+    m_ViewExtents.resize(views.size());
+    for (size_t viewIndex = 0; viewIndex < views.size(); ++viewIndex)
+    {
+        const XrViewConfigurationView& view = views[viewIndex];
+        const auto scaleDimension = [](uint32_t recommended, uint32_t maximum)
+        {
+            int32_t size = static_cast<int32_t>(std::lround(static_cast<float>(recommended) * m_Scale));
+            const int32_t alignment = EXTENT_ALIGNMENT;
+            size = (size + alignment / 2) / alignment * alignment;
+            return std::min(std::max(size, alignment), static_cast<int32_t>(maximum));
+        };
+        m_ViewExtents[viewIndex].width = scaleDimension(view.recommendedImageRectWidth, view.maxImageRectWidth);
+        m_ViewExtents[viewIndex].height = scaleDimension(view.recommendedImageRectHeight, view.maxImageRectHeight);
+    }
+}
\ No newline at end of file
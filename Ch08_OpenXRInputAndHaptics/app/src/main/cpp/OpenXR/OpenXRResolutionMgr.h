@@ -0,0 +1,52 @@
+﻿#pragma once
+#include <openxr/openxr.h>
+
+#include <vector>
+
+// Dynamic resolution. Swapchains are allocated at the maximum image size and every frame renders into a
+// sub-rectangle of them, scaled from the recommended size by a factor that the GPU frame time drives:
+// it drops quickly when a frame exceeds the budget and climbs back slowly once there is headroom again.
+class OpenXRResolutionMgr
+{
+public:
+    // Derives the scale range from the view configuration, call after the views info has been read
+    static void Initialize();
+
+    // Feeds the GPU time of a frame (0 when none was read back) and the display period it had to fit in
+    static void Update(int64_t gpuFrameTimeNs, XrDuration displayPeriod);
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+
+    // Scale relative to the recommended image size, the upper bound is clamped to the maximum image size
+    static void SetScaleRange(float minScale, float maxScale);
+    static float GetScale();
+
+    // Size of the rendered region of the view's swapchain images for the current scale
+    static XrExtent2Di GetViewExtent(int viewIndex);
+
+    // Fraction of the display period the GPU frame time should stay below
+    static constexpr float GPU_BUDGET = 0.85f;
+
+private:
+    static bool m_Enabled;
+    static float m_Scale;
+    static float m_MinScale;
+    static float m_MaxScale;
+    static float m_UpperScaleLimit;
+    static float m_SmoothedGpuTimeNs;
+    static uint32_t m_SettleFramesLeft;
+    static std::vector<XrExtent2Di> m_ViewExtents;
+
+    static void UpdateViewExtents();
+
+    static constexpr float MAX_STEP_DOWN = 0.1f;
+    static constexpr float MAX_STEP_UP = 0.02f;
+    // The scale only grows once the frame time is below this fraction of the budget, so it doesn't oscillate
+    static constexpr float GROW_THRESHOLD = 0.8f;
+    static constexpr float SMOOTHING = 0.1f;
+    // GPU timings are read back a few frames late, so after a change the scale is held until they reflect it
+    static constexpr uint32_t SETTLE_FRAMES = 4;
+    // Extents are rounded to a multiple of this, which also keeps the rect from changing by a pixel every frame
+    static constexpr int32_t EXTENT_ALIGNMENT = 8;
+};
\ No newline at end of file
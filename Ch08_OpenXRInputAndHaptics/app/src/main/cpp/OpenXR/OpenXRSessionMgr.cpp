@@ -1,6 +1,9 @@
 ﻿// ReSharper disable CppClangTidyClangDiagnosticSwitchEnum
 #include "OpenXRSessionMgr.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "DebugOutput.h"
 #include "OpenXRCoreMgr.h"
 #include "OpenXRRenderMgr.h"
@@ -9,6 +12,22 @@ XrSessionState OpenXRSessionMgr::m_xrSessionState = XR_SESSION_STATE_UNKNOWN;
 bool OpenXRSessionMgr::m_IsSessionRunning = false;
 XrFrameState OpenXRSessionMgr::frameState{};
 
+PFN_xrEnumerateDisplayRefreshRatesFB OpenXRSessionMgr::xrEnumerateDisplayRefreshRatesFB = nullptr;
+PFN_xrGetDisplayRefreshRateFB OpenXRSessionMgr::xrGetDisplayRefreshRateFB = nullptr;
+PFN_xrRequestDisplayRefreshRateFB OpenXRSessionMgr::xrRequestDisplayRefreshRateFB = nullptr;
+std::vector<float> OpenXRSessionMgr::m_AvailableRefreshRates{};
+float OpenXRSessionMgr::m_DisplayRefreshRate = 0.0f;
+bool OpenXRSessionMgr::m_AdaptiveRefreshRate = true;
+bool OpenXRSessionMgr::m_RefreshRateChangePending = false;
+float OpenXRSessionMgr::m_RequestedRefreshRate = 0.0f;
+uint32_t OpenXRSessionMgr::m_PendingFrameCount = 0;
+uint32_t OpenXRSessionMgr::m_WindowFrameCount = 0;
+uint32_t OpenXRSessionMgr::m_WindowMissedFrameCount = 0;
+int64_t OpenXRSessionMgr::m_WindowMaxGpuTimeNs = 0;
+uint64_t OpenXRSessionMgr::m_LastMissedFrameCount = 0;
+uint32_t OpenXRSessionMgr::m_WindowsSinceChange = 0;
+uint32_t OpenXRSessionMgr::m_StepUpHoldWindows = OpenXRSessionMgr::STEP_UP_HOLD_WINDOWS;
+
 void OpenXRSessionMgr::PollEvent()
 {
     XrEventDataBuffer eventDataBuffer{};
@@ -26,6 +45,12 @@ void OpenXRSessionMgr::PollEvent()
                 OnSessionChanged(sessionStateChanged);
                 break;
             }
+            case XR_TYPE_EVENT_DATA_DISPLAY_REFRESH_RATE_CHANGED_FB:
+            {
+                auto* refreshRateChanged = reinterpret_cast<XrEventDataDisplayRefreshRateChangedFB*>(&eventDataBuffer);
+                OnDisplayRefreshRateChanged(refreshRateChanged);
+                break;
+            }
             default:
             {
                 XR_TUT_LOG("OpenXR event data type: " << eventDataBuffer.type);
@@ -103,6 +128,203 @@ bool OpenXRSessionMgr::IsShouldRender()
            && (m_xrSessionState == XR_SESSION_STATE_FOCUSED || m_xrSessionState == XR_SESSION_STATE_VISIBLE);
 }
 
+void OpenXRSessionMgr::InitializeDisplayRefreshRate()
+{
+    m_AvailableRefreshRates.clear();
+    m_DisplayRefreshRate = 0.0f;
+    m_RefreshRateChangePending = false;
+    m_PendingFrameCount = 0;
+    m_StepUpHoldWindows = STEP_UP_HOLD_WINDOWS;
+    ResetRefreshRateWindow();
+    if (!OpenXRCoreMgr::IsExtensionEnabled(XR_FB_DISPLAY_REFRESH_RATE_EXTENSION_NAME))
+    {
+        XR_TUT_LOG("Display refresh rate control unavailable, the runtime paces frames on its own");
+        return;
+    }
+
+    xrGetInstanceProcAddr(OpenXRCoreMgr::m_xrInstance, "xrEnumerateDisplayRefreshRatesFB",
+                          reinterpret_cast<PFN_xrVoidFunction*>(&xrEnumerateDisplayRefreshRatesFB));
+    xrGetInstanceProcAddr(OpenXRCoreMgr::m_xrInstance, "xrGetDisplayRefreshRateFB", reinterpret_cast<PFN_xrVoidFunction*>(&xrGetDisplayRefreshRateFB));
+    xrGetInstanceProcAddr(OpenXRCoreMgr::m_xrInstance, "xrRequestDisplayRefreshRateFB",
+                          reinterpret_cast<PFN_xrVoidFunction*>(&xrRequestDisplayRefreshRateFB));
+
+    uint32_t refreshRateCount = 0;
+    OPENXR_CHECK(xrEnumerateDisplayRefreshRatesFB(OpenXRCoreMgr::xrSession, 0, &refreshRateCount, nullptr),
+                 "Failed to enumerate display refresh rates");
+    m_AvailableRefreshRates.resize(refreshRateCount);
+    OPENXR_CHECK(xrEnumerateDisplayRefreshRatesFB(OpenXRCoreMgr::xrSession, refreshRateCount, &refreshRateCount, m_AvailableRefreshRates.data()),
+                 "Failed to enumerate display refresh rates");
+    std::sort(m_AvailableRefreshRates.begin(), m_AvailableRefreshRates.end());
+    OPENXR_CHECK(xrGetDisplayRefreshRateFB(OpenXRCoreMgr::xrSession, &m_DisplayRefreshRate), "Failed to get display refresh rate");
+
+    std::string refreshRates;
+    for (float refreshRate : m_AvailableRefreshRates)
+    {
+        refreshRates += std::to_string(static_cast<int>(refreshRate + 0.5f)) + " ";
+    }
+    XR_TUT_LOG("Display refresh rate " << m_DisplayRefreshRate << " Hz, available: " << refreshRates);
+}
+
+const std::vector<float>& OpenXRSessionMgr::GetAvailableRefreshRates()
+{
+    return m_AvailableRefreshRates;
+}
+
+float OpenXRSessionMgr::GetDisplayRefreshRate()
+{
+    return m_DisplayRefreshRate;
+}
+
+bool OpenXRSessionMgr::RequestDisplayRefreshRate(float refreshRate)
+{
+    if (!xrRequestDisplayRefreshRateFB || m_AvailableRefreshRates.empty() ||
+        std::fabs(m_AvailableRefreshRates[FindNearestRefreshRate(refreshRate)] - refreshRate) > REFRESH_RATE_TOLERANCE_HZ)
+    {
+        XR_TUT_LOG_ERROR("Display refresh rate " << refreshRate << " Hz can't be requested");
+        return false;
+    }
+    // Request the exact value the runtime enumerated
+    refreshRate = m_AvailableRefreshRates[FindNearestRefreshRate(refreshRate)];
+
+    const XrResult result = xrRequestDisplayRefreshRateFB(OpenXRCoreMgr::xrSession, refreshRate);
+    if (XR_FAILED(result))
+    {
+        XR_TUT_LOG_ERROR("Failed to request display refresh rate " << refreshRate << " Hz: " << result);
+        return false;
+    }
+    XR_TUT_LOG("Requested display refresh rate " << refreshRate << " Hz");
+    m_RefreshRateChangePending = std::fabs(refreshRate - m_DisplayRefreshRate) > REFRESH_RATE_TOLERANCE_HZ;
+    m_RequestedRefreshRate = refreshRate;
+    m_PendingFrameCount = 0;
+    ResetRefreshRateWindow();
+    return true;
+}
+
+void OpenXRSessionMgr::SetAdaptiveRefreshRate(bool enabled)
+{
+    m_AdaptiveRefreshRate = enabled;
+    ResetRefreshRateWindow();
+}
+
+bool OpenXRSessionMgr::IsAdaptiveRefreshRate()
+{
+    return m_AdaptiveRefreshRate;
+}
+
+void OpenXRSessionMgr::OnDisplayRefreshRateChanged(const XrEventDataDisplayRefreshRateChangedFB* refreshRateChanged)
+{
+    XR_TUT_LOG("Display refresh rate changed from " << refreshRateChanged->fromDisplayRefreshRate << " Hz to "
+                                                    << refreshRateChanged->toDisplayRefreshRate << " Hz");
+    m_DisplayRefreshRate = refreshRateChanged->toDisplayRefreshRate;
+    m_RefreshRateChangePending = false;
+    // Frames around the switch are paced irregularly, they say nothing about the new rate
+    ResetRefreshRateWindow();
+}
+
+void OpenXRSessionMgr::UpdatePendingRefreshRateChange()
+{
+    // Some runtimes switch without sending the event, or never switch at all. Poll the current rate once per window
+    // and stop waiting after a few of them, so the policy doesn't stay frozen.
+    ++m_PendingFrameCount;
+    if (m_PendingFrameCount % POLICY_WINDOW_FRAMES != 0)
+    {
+        return;
+    }
+
+    float currentRefreshRate = m_DisplayRefreshRate;
+    if (xrGetDisplayRefreshRateFB && XR_FAILED(xrGetDisplayRefreshRateFB(OpenXRCoreMgr::xrSession, &currentRefreshRate)))
+    {
+        currentRefreshRate = m_DisplayRefreshRate;
+    }
+
+    const bool reached = std::fabs(currentRefreshRate - m_RequestedRefreshRate) <= REFRESH_RATE_TOLERANCE_HZ;
+    if (!reached && m_PendingFrameCount < POLICY_WINDOW_FRAMES * PENDING_TIMEOUT_WINDOWS)
+    {
+        return;
+    }
+
+    if (reached)
+    {
+        XR_TUT_LOG("Display refresh rate is now " << currentRefreshRate << " Hz");
+    }
+    else
+    {
+        XR_TUT_LOG_ERROR("Display refresh rate change to " << m_RequestedRefreshRate << " Hz timed out, staying at " << currentRefreshRate << " Hz");
+    }
+    m_DisplayRefreshRate = currentRefreshRate;
+    m_RefreshRateChangePending = false;
+    ResetRefreshRateWindow();
+}
+
+size_t OpenXRSessionMgr::FindNearestRefreshRate(float refreshRate)
+{
+    size_t nearest = 0;
+    for (size_t i = 1; i < m_AvailableRefreshRates.size(); ++i)
+    {
+        if (std::fabs(m_AvailableRefreshRates[i] - refreshRate) < std::fabs(m_AvailableRefreshRates[nearest] - refreshRate))
+        {
+            nearest = i;
+        }
+    }
+    return nearest;
+}
+
+void OpenXRSessionMgr::ResetRefreshRateWindow()
+{
+    m_WindowFrameCount = 0;
+    m_WindowMissedFrameCount = 0;
+    m_WindowMaxGpuTimeNs = 0;
+    m_WindowsSinceChange = 0;
+}
+
+void OpenXRSessionMgr::UpdateRefreshRatePolicy(uint64_t missedFrameCount, int64_t gpuFrameTimeNs)
+{
+    const uint64_t missedFrames = missedFrameCount - std::min(m_LastMissedFrameCount, missedFrameCount);
+    m_LastMissedFrameCount = missedFrameCount;
+    if (m_RefreshRateChangePending)
+    {
+        UpdatePendingRefreshRateChange();
+        return;
+    }
+    if (!m_AdaptiveRefreshRate || m_AvailableRefreshRates.size() < 2)
+    {
+        return;
+    }
+
+    ++m_WindowFrameCount;
+    m_WindowMissedFrameCount += missedFrames > 0 ? 1 : 0;
+    m_WindowMaxGpuTimeNs = std::max(m_WindowMaxGpuTimeNs, gpuFrameTimeNs);
+    if (m_WindowFrameCount < POLICY_WINDOW_FRAMES)
+    {
+        return;
+    }
+
+    const auto current = m_AvailableRefreshRates.begin() + FindNearestRefreshRate(m_DisplayRefreshRate);
+    const bool sustainedMisses = static_cast<float>(m_WindowMissedFrameCount) >= static_cast<float>(m_WindowFrameCount) * STEP_DOWN_MISS_FRACTION;
+    const bool cleanWindow = m_WindowMissedFrameCount == 0;
+    const int64_t maxGpuTimeNs = m_WindowMaxGpuTimeNs;
+    const uint32_t windowsSinceChange = m_WindowsSinceChange + 1;
+    ResetRefreshRateWindow();
+    m_WindowsSinceChange = windowsSinceChange;
+
+    if (sustainedMisses && current != m_AvailableRefreshRates.begin())
+    {
+        // Each fall back after stepping up makes the next attempt wait longer, so a rate that can't be held isn't retried every few seconds
+        m_StepUpHoldWindows = std::min(m_StepUpHoldWindows * 2, static_cast<uint32_t>(MAX_STEP_UP_HOLD_WINDOWS));
+        RequestDisplayRefreshRate(*(current - 1));
+        return;
+    }
+
+    if (cleanWindow && windowsSinceChange >= m_StepUpHoldWindows && current + 1 != m_AvailableRefreshRates.end())
+    {
+        const float higherPeriodNs = 1e9f / *(current + 1);
+        if (maxGpuTimeNs > 0 && static_cast<float>(maxGpuTimeNs) < higherPeriodNs * STEP_UP_HEADROOM)
+        {
+            RequestDisplayRefreshRate(*(current + 1));
+        }
+    }
+}
+
 bool OpenXRSessionMgr::IsShouldProcessInput()
 {
     return m_IsSessionRunning && m_xrSessionState == XR_SESSION_STATE_FOCUSED;
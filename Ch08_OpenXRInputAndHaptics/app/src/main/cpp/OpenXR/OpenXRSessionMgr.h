@@ -1,6 +1,9 @@
 ﻿#pragma once
 #include <openxr/openxr.h>
 
+#include <cstdint>
+#include <vector>
+
 class OpenXRSessionMgr
 {
 public:
@@ -13,9 +16,59 @@ public:
     static void BeginFrame();
     static void EndFrame(bool rendered);
 
+    // Display refresh rate control (XR_FB_display_refresh_rate). Without the extension the runtime keeps its
+    // own rate and the available rates are empty. Initialize after the session is created.
+    static void InitializeDisplayRefreshRate();
+    static const std::vector<float>& GetAvailableRefreshRates();
+    static float GetDisplayRefreshRate();
+    // Asks for one of the available rates, the change takes effect when the runtime reports it through an event
+    static bool RequestDisplayRefreshRate(float refreshRate);
+    // Lets the rate step down after sustained missed frames and back up once the GPU has headroom at the higher rate
+    static void SetAdaptiveRefreshRate(bool enabled);
+    static bool IsAdaptiveRefreshRate();
+    // Feeds the adaptive policy once per frame with the total missed frames so far and the latest GPU frame time
+    static void UpdateRefreshRatePolicy(uint64_t missedFrameCount, int64_t gpuFrameTimeNs);
+
     static XrFrameState frameState;
 
 private:
+    static void OnDisplayRefreshRateChanged(const XrEventDataDisplayRefreshRateChangedFB* refreshRateChanged);
+    static void ResetRefreshRateWindow();
+    static void UpdatePendingRefreshRateChange();
+    // Index of the available rate closest to refreshRate, the runtime may report rates that differ in the last bits
+    static size_t FindNearestRefreshRate(float refreshRate);
+
     static XrSessionState m_xrSessionState;
     static bool m_IsSessionRunning;
+
+    static PFN_xrEnumerateDisplayRefreshRatesFB xrEnumerateDisplayRefreshRatesFB;
+    static PFN_xrGetDisplayRefreshRateFB xrGetDisplayRefreshRateFB;
+    static PFN_xrRequestDisplayRefreshRateFB xrRequestDisplayRefreshRateFB;
+    static std::vector<float> m_AvailableRefreshRates;
+    static float m_DisplayRefreshRate;
+    static bool m_AdaptiveRefreshRate;
+    static bool m_RefreshRateChangePending;
+    static float m_RequestedRefreshRate;
+    static uint32_t m_PendingFrameCount;
+
+    // Adaptive policy state, evaluated over windows of frames
+    static uint32_t m_WindowFrameCount;
+    static uint32_t m_WindowMissedFrameCount;
+    static int64_t m_WindowMaxGpuTimeNs;
+    static uint64_t m_LastMissedFrameCount;
+    static uint32_t m_WindowsSinceChange;
+    static uint32_t m_StepUpHoldWindows;
+
+    static constexpr uint32_t POLICY_WINDOW_FRAMES = 90;
+    // A window with at least this fraction of missed frames counts as a sustained miss
+    static constexpr float STEP_DOWN_MISS_FRACTION = 0.1f;
+    // Stepping up needs the GPU frame time to fit in this fraction of the higher rate's period
+    static constexpr float STEP_UP_HEADROOM = 0.75f;
+    // Clean windows needed before stepping up, doubled every time the rate has to step down again
+    static constexpr uint32_t STEP_UP_HOLD_WINDOWS = 3;
+    static constexpr uint32_t MAX_STEP_UP_HOLD_WINDOWS = 48;
+    // A requested change that no event confirms is given up after this many windows, keeping whatever rate the runtime reports
+    static constexpr uint32_t PENDING_TIMEOUT_WINDOWS = 4;
+    // Rates closer than this are the same rate
+    static constexpr float REFRESH_RATE_TOLERANCE_HZ = 0.5f;
 };
\ No newline at end of file
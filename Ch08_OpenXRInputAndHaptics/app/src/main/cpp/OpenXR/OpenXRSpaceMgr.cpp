@@ -4,6 +4,7 @@
 #include "OpenXRHelper.h"
 
 XrSpace OpenXRSpaceMgr::activeSpaces = XR_NULL_HANDLE;
+XrSpace OpenXRSpaceMgr::viewSpace = XR_NULL_HANDLE;
 
 void OpenXRSpaceMgr::CreateReferenceSpace()
 {
@@ -14,9 +15,14 @@ void OpenXRSpaceMgr::CreateReferenceSpace()
     referenceSpaceCreateInfo.poseInReferenceSpace = XrPosef{{0.0f, 0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 0.0f}};
     OPENXR_CHECK(xrCreateReferenceSpace(OpenXRCoreMgr::xrSession, &referenceSpaceCreateInfo, &activeSpaces),
                  "Failed to create OpenXR local reference space");
+
+    referenceSpaceCreateInfo.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_VIEW;
+    OPENXR_CHECK(xrCreateReferenceSpace(OpenXRCoreMgr::xrSession, &referenceSpaceCreateInfo, &viewSpace),
+                 "Failed to create OpenXR view reference space");
 }
 
 void OpenXRSpaceMgr::DestroyReferenceSpace()
 {
+    OPENXR_CHECK(xrDestroySpace(viewSpace), "Failed to destroy Space.");
     OPENXR_CHECK(xrDestroySpace(activeSpaces), "Failed to destroy Space.");
 }
\ No newline at end of file
@@ -7,4 +7,6 @@ public:
     static void CreateReferenceSpace();
     static void DestroyReferenceSpace();
     static XrSpace activeSpaces;
+    // Follows the head, for content that stays in front of the user
+    static XrSpace viewSpace;
 };
\ No newline at end of file
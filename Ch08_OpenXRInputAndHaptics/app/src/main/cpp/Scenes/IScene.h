@@ -0,0 +1,16 @@
+#pragma once
+
+class Scene;
+
+// An application scene: fills an engine Scene with its objects, simulates it once per frame and updates it once
+// per rendered view
+class IScene {
+public:
+    virtual ~IScene() = default;
+
+    virtual void Initialize() = 0;
+    virtual void Simulate(float deltaTime) = 0;
+    // deltaTime is the frame's for the first view and 0 for the others, so time only advances once per frame
+    virtual void Update(float deltaTime) = 0;
+    virtual Scene* GetScene() const = 0;
+};
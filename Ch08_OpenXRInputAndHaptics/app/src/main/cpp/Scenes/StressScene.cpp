@@ -0,0 +1,159 @@
+#include "StressScene.h"
+#include "../Engine/Core/GameObject.h"
+#include "../Engine/Components/Core/Transform.h"
+#include "../Engine/Components/Rendering/MeshRenderer.h"
+#include "../Engine/Components/Rendering/Material.h"
+#include "../Engine/Components/Rendering/Camera.h"
+#include "../Engine/Assets/AssetLoaderMgr.h"
+#include "../Engine/Components/XRDevices/XRHmdDriver.h"
+#include "../Engine/Rendering/Mesh/CubeMesh.h"
+#include "../Engine/Rendering/Mesh/MeshCache.h"
+#include "../Engine/Rendering/Mesh/MeshSimplifier.h"
+#include "../Engine/Rendering/Mesh/SphereMesh.h"
+#include "../Application/Components/StressObjectMotion.h"
+#include "../OpenXR/OpenXRCoreMgr.h"
+#include "../OpenXR/OpenXRGraphicsAPI/OpenXRGraphicsAPI.h"
+#include <DebugOutput.h>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+StressScene::StressScene(const StressSceneConfig& config)
+    : m_config(config), m_scene(std::make_unique<Scene>("StressScene_" + config.name)) {}
+
+StressScene::~StressScene() {}
+
+void StressScene::Initialize()
+{
+    m_randomState = m_config.seed != 0 ? m_config.seed : 1;
+    CreateSceneObjects();
+}
+
+void StressScene::Simulate(float deltaTime)
+{
+    m_scene->Simulate(deltaTime);
+}
+
+void StressScene::Update(float deltaTime)
+{
+    m_scene->Update(deltaTime);
+}
+
+float StressScene::NextRandom()
+{
+    // xorshift32 rather than <random> distributions, whose output differs between standard libraries
+    m_randomState ^= m_randomState << 13;
+    m_randomState ^= m_randomState >> 17;
+    m_randomState ^= m_randomState << 5;
+    return static_cast<float>(m_randomState >> 8) / static_cast<float>(1 << 24);
+}
+
+void StressScene::CreateSceneObjects()
+{
+    const float pi = 3.14159265358979f;
+
+    GameObject* cameraObject = m_scene->CreateGameObject("Camera");
+    Transform* cameraTransform = cameraObject->AddComponent<Transform>();
+    cameraTransform->SetPosition({0.0f, 0.0f, 0.0f});
+    cameraTransform->SetRotation({0.0f, 0.0f, 0.0f, 1.0f});
+    Camera* camera = cameraObject->AddComponent<Camera>();
+    camera->SetProjectionParameters(0.05f, 1000.0f);
+    cameraObject->AddComponent<XRHmdDriver>();
+
+    // Cubes and spheres of increasing tessellation, so the unique mesh count also varies the vertex load. Their
+    // levels of detail and packed vertices come from the mesh cache build step, and from the cache itself once
+    // a run wrote it.
+    const uint32_t lodLevelCount = m_config.generateLods ? MeshSimplifier::DEFAULT_MAX_LEVEL_COUNT : 0;
+    const VertexLayout layout = m_config.packedVertices ? VertexLayout::GetCompact(OpenXRCoreMgr::openxrGraphicsAPI->graphicsAPI.get())
+                                                        : VertexLayout::GetStandard();
+    // One file per configuration, so switching between them doesn't rebuild the caches every run
+    const std::string cacheSuffix = std::string(m_config.packedVertices ? "_packed" : "") + (lodLevelCount > 0 ? "_lods" : "") + ".meshcache";
+    const std::string cacheDirectory = m_config.meshCacheDirectory;
+    auto buildMesh = [lodLevelCount, layout, cacheDirectory, cacheSuffix](uint32_t i)
+    {
+        std::function<std::shared_ptr<IMesh>()> build;
+        std::string cacheName;
+        if (i % 4 == 0)
+        {
+            build = []() { return std::make_shared<CubeMesh>(0.2f); };
+            cacheName = "cube";
+        }
+        else
+        {
+            const uint32_t segments = std::min(8u + 4u * i, 64u);
+            build = [segments]() { return std::make_shared<SphereMesh>(0.1f, segments, segments / 2); };
+            cacheName = "sphere" + std::to_string(segments);
+        }
+        if (cacheDirectory.empty())
+        {
+            return MeshCache::Build(build(), layout, lodLevelCount);
+        }
+        return MeshCache::LoadOrBuild(cacheDirectory + "/stress_" + cacheName + cacheSuffix, build, layout, lodLevelCount);
+    };
+
+    // Streamed meshes are built on the loader threads; the objects show the first mesh until theirs is ready
+    std::vector<std::shared_ptr<IMesh>> meshes;
+    std::vector<AssetHandle<std::shared_ptr<IMesh>>> streamedMeshes;
+    const uint32_t meshCount = std::max(m_config.uniqueMeshCount, 1u);
+    for (uint32_t i = 0; i < meshCount; ++i)
+    {
+        if (m_config.streamMeshes && i > 0)
+        {
+            streamedMeshes.push_back(AssetLoaderMgr::CreateMeshAsync([buildMesh, i]() { return buildMesh(i); }));
+            meshes.push_back(meshes[0]);
+        }
+        else
+        {
+            streamedMeshes.emplace_back();
+            meshes.push_back(buildMesh(i));
+        }
+    }
+
+    std::vector<XrVector4f> colors;
+    const uint32_t materialCount = std::max(m_config.uniqueMaterialCount, 1u);
+    for (uint32_t i = 0; i < materialCount; ++i)
+    {
+        const float hue = 2.0f * pi * static_cast<float>(i) / static_cast<float>(materialCount);
+        colors.push_back({0.5f + 0.4f * std::cos(hue), 0.5f + 0.4f * std::cos(hue - 2.094f), 0.5f + 0.4f * std::cos(hue + 2.094f), 1.0f});
+    }
+
+    const uint32_t dynamicCount = static_cast<uint32_t>(std::lround(std::min(std::max(m_config.dynamicFraction, 0.0f), 1.0f) * static_cast<float>(m_config.objectCount)));
+
+    for (uint32_t i = 0; i < m_config.objectCount; ++i)
+    {
+        // Spread the objects through a shell in front of the viewer, between 1 and 6 meters away
+        const float azimuth = (NextRandom() - 0.5f) * pi;
+        const float elevation = (NextRandom() - 0.5f) * pi * 0.5f;
+        const float distance = 1.0f + 5.0f * NextRandom();
+        const XrVector3f position = {distance * std::cos(elevation) * std::sin(azimuth), distance * std::sin(elevation),
+                                     -distance * std::cos(elevation) * std::cos(azimuth)};
+        const float scale = 0.5f + NextRandom();
+
+        GameObject* object = m_scene->CreateGameObject("StressObject_" + std::to_string(i));
+        object->AddComponent<Transform>(position, XrQuaternionf{0.0f, 0.0f, 0.0f, 1.0f}, XrVector3f{scale, scale, scale});
+
+        MeshRenderer* renderer = object->AddComponent<MeshRenderer>();
+        if (streamedMeshes[i % meshCount].IsValid())
+        {
+            renderer->SetMeshAsync(streamedMeshes[i % meshCount], meshes[i % meshCount]);
+        }
+        else
+        {
+            renderer->SetMesh(meshes[i % meshCount]);
+        }
+        Material* material = object->AddComponent<Material>("VertexShader.spv", "PixelShader.spv", VULKAN);
+        material->SetColor(colors[i % materialCount]);
+        material->SetFeatures(m_config.shaderFeatures);
+
+        // Spread the dynamic objects evenly rather than taking the first ones
+        if (static_cast<uint64_t>(i) * dynamicCount / m_config.objectCount != static_cast<uint64_t>(i + 1) * dynamicCount / m_config.objectCount)
+        {
+            object->AddComponent<StressObjectMotion>(2.0f * pi * NextRandom(), 0.05f + 0.15f * NextRandom(), 0.5f + 1.5f * NextRandom());
+        }
+    }
+
+    XR_TUT_LOG("StressScene::CreateSceneObjects() - " << m_config.name << ": " << m_config.objectCount << " objects, " << meshCount << " meshes, "
+               << materialCount << " materials, " << dynamicCount << " dynamic");
+}
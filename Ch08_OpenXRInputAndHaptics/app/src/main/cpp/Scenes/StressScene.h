@@ -0,0 +1,29 @@
+#pragma once
+
+#include "IScene.h"
+#include "StressSceneConfig.h"
+#include "../Engine/Core/Scene.h"
+#include <cstdint>
+#include <memory>
+
+// Procedurally generated scene for performance work. The same config always produces the same scene.
+class StressScene : public IScene {
+public:
+    explicit StressScene(const StressSceneConfig& config);
+    ~StressScene() override;
+
+    void Initialize() override;
+    void Simulate(float deltaTime) override;
+    void Update(float deltaTime) override;
+    Scene* GetScene() const override { return m_scene.get(); }
+
+    const StressSceneConfig& GetConfig() const { return m_config; }
+
+private:
+    StressSceneConfig m_config;
+    std::unique_ptr<Scene> m_scene;
+    uint32_t m_randomState = 1;
+
+    void CreateSceneObjects();
+    float NextRandom();
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Parameters of a procedurally generated benchmark scene
+struct StressSceneConfig
+{
+    std::string name = "default";
+    uint32_t objectCount = 500;
+    uint32_t uniqueMeshCount = 8;      // Distinct meshes shared round-robin between the objects
+    uint32_t uniqueMaterialCount = 8;  // Distinct material colors shared round-robin between the objects
+    float dynamicFraction = 0.25f;     // Fraction of the objects whose transform changes every frame
+    uint32_t seed = 1;
+    bool packedVertices = false;       // Store the meshes in the compact vertex layout instead of float32
+    bool generateLods = false;         // Give the meshes simplified levels of detail
+    std::string meshCacheDirectory;    // Where the meshes are cached with their levels of detail; empty builds them every run
+    bool streamMeshes = false;         // Build all but the first mesh on the asset loader threads while the scene runs
+    uint32_t shaderFeatures = 0;       // ShaderFeature bits enabled on every material
+};
@@ -4,6 +4,7 @@
 #include "../Engine/Components/Rendering/MeshRenderer.h"
 #include "../Engine/Components/Rendering/Material.h"
 #include "../Engine/Components/Rendering/Camera.h"
+#include "../Engine/Components/Rendering/CompositionLayerPanel.h"
 #include "../Engine/Components/Rendering/RenderSettings.h"
 #include "../Engine/Components/XRDevices/XRHmdDriver.h"
 #include "../Engine/Rendering/Mesh/CubeMesh.h"
@@ -22,6 +23,11 @@ void TableFloorScene::Initialize()
     CreateSceneObjects();
 }
 
+void TableFloorScene::Simulate(float deltaTime)
+{
+    m_scene->Simulate(deltaTime);
+}
+
 void TableFloorScene::Update(float deltaTime)
 {
     m_scene->Update(deltaTime);
@@ -39,6 +45,7 @@ void TableFloorScene::CreateSceneObjects()
 
     Camera* camera = cameraObject->AddComponent<Camera>();
     camera->SetProjectionParameters(0.05f, 1000.0f);
+    camera->SetReversedZ(true);
 
     RenderSettings settings;
     settings.width = 1024;
@@ -73,6 +80,19 @@ void TableFloorScene::CreateSceneObjects()
     Material* tableMaterial = tableObject->AddComponent<Material>("VertexShader.spv", "PixelShader.spv", VULKAN);
     tableMaterial->SetColor({0.6f, 0.6f, 0.4f, 1.0f});
 
+    // Rendered once into its own layer, the compositor presents it at display resolution from then on
+    GameObject* panelObject = m_scene->CreateGameObject("InfoPanel");
+    panelObject->AddComponent<Transform>(XrVector3f{0.0f, -m_viewHeightM + 1.4f, -1.5f});
+    CompositionLayerCreateInfo panelCreateInfo;
+    panelCreateInfo.shape = CompositionLayerShape::CYLINDER;
+    panelCreateInfo.width = 512;
+    panelCreateInfo.height = 256;
+    panelCreateInfo.radius = 1.5f;
+    panelCreateInfo.centralAngle = 0.5f;
+    panelCreateInfo.aspectRatio = 2.0f;
+    CompositionLayerPanel* panel = panelObject->AddComponent<CompositionLayerPanel>(panelCreateInfo);
+    panel->SetClearColor({0.1f, 0.1f, 0.15f, 0.8f});
+
     GameObject* testControllerHapticsObject = m_scene->CreateGameObject("TestControllerHaptics");
     testControllerHapticsObject->AddComponent<TestControllerHaptics>();
 
@@ -1,16 +1,18 @@
 #pragma once
 
+#include "IScene.h"
 #include "../Engine/Core/Scene.h"
 #include <GraphicsAPI.h>
 
-class TableFloorScene {
+class TableFloorScene : public IScene {
 public:
     TableFloorScene();
-    ~TableFloorScene();
+    ~TableFloorScene() override;
 
-    void Initialize();
-    void Update(float deltaTime);
-    Scene* GetScene() const { return m_scene.get(); }
+    void Initialize() override;
+    void Simulate(float deltaTime) override;
+    void Update(float deltaTime) override;
+    Scene* GetScene() const override { return m_scene.get(); }
     
     void SetViewHeight(float heightInMeters) { m_viewHeightM = heightInMeters; }
 
@@ -1,14 +1,21 @@
 #include <DebugOutput.h>
 #include "Application/OpenXRTutorial.h"
+#include "Engine/Diagnostics/TraceLogMgr.h"
 
 static void OpenXRTutorial_Main(GraphicsAPI_Type apiType)
 {
+    TraceLogMgr::Start();
+
     XR_TUT_LOG("OpenXR Tutorial Ch08_OpenXRInputAndHaptics");
 
     XR_TUT_LOG("Graphics API Type: " << apiType);
 
-    OpenXRTutorial app(apiType);
-    app.Run();
+    {
+        OpenXRTutorial app(apiType);
+        app.Run();
+    }
+
+    TraceLogMgr::Stop();
 }
 
 #if defined(__ANDROID__)
@@ -130,7 +130,12 @@ public:
         UINT,
         UVEC2,
         UVEC3,
-        UVEC4
+        UVEC4,
+        // Packed types, expanded to float by the vertex input stage
+        HALF2,
+        HALF4,
+        SNORM16x4,
+        SNORM_10_10_10_2  // x, y, z in 10 bits each from the low bits up, w in the top 2 bits
     };
     enum class PrimitiveTopology : uint8_t {
         POINT_LIST = 0,
@@ -331,6 +336,10 @@ public:
         size_t bufferOffset;
         size_t bufferSize;
     };
+    struct SpecializationConstant {
+        uint32_t constantID;  // layout(constant_id = X)
+        uint32_t value;       // 32-bit scalar; bools are 0 or 1
+    };
     struct PipelineCreateInfo {
         std::vector<void*> shaders;
         VertexInputState vertexInputState;
@@ -342,6 +351,11 @@ public:
         std::vector<int64_t> colorFormats;
         int64_t depthFormat;
         std::vector<DescriptorInfo> layout;
+        std::vector<SpecializationConstant> specializationConstants;  // Applied to every stage; IDs a stage doesn't declare are ignored
+        bool fragmentDensityMap = false;  // The render pass reads the density map set with SetFragmentDensityMap
+        // Depth isn't loaded or stored, clear it within the pass. With multisampleState.rasterisationSamples above 1 the
+        // color attachments are treated the same way and resolved into the views set with SetResolveAttachments.
+        bool transientDepth = false;
     };
 
     struct SwapchainCreateInfo {
@@ -377,6 +391,7 @@ public:
         bool colorAttachment;
         bool depthAttachment;
         bool sampled;
+        bool transient = false;  // Only ever an attachment within one render pass; lazily allocated where the device allows it
     };
 
     struct ImageViewCreateInfo {
@@ -456,6 +471,15 @@ public:
         Extent2D extent;
     };
 
+    struct GpuScopeTiming {
+        std::string name;
+        uint64_t submissionIndex;
+        int64_t cpuSubmitTime;  // Steady clock nanoseconds when the command buffer was submitted
+        uint64_t beginTime;     // GPU nanoseconds relative to the first timestamp of the submission
+        uint64_t endTime;
+        uint32_t depth;
+    };
+
 public:
     virtual ~GraphicsAPI() = default;
 
@@ -490,6 +514,27 @@ public:
 
     virtual void BeginRendering() = 0;
     virtual void EndRendering() = 0;
+    // Blocks until the GPU has finished all submitted work, e.g. before tearing down swapchains
+    virtual void WaitForIdle() {}
+
+    // The GPU timeline counts submissions: each EndRendering signals a value one higher than the previous one.
+    // Work recorded now finishes at GetRecordingValue(), which is the value to remember for resources used by it;
+    // once GetCompletedValue() reached that value the GPU is done with them. Without a timeline everything is complete.
+    // Backends with a timeline defer the Destroy* calls until then, so objects can be destroyed while frames are in flight.
+    virtual uint64_t GetRecordingValue() { return 0; }
+    virtual uint64_t GetCompletedValue() { return 0; }
+    // Blocks until the GPU reached a submitted value, or timeoutNs passed; returns whether the value was reached
+    virtual bool WaitForValue(uint64_t /*value*/, uint64_t /*timeoutNs*/ = UINT64_MAX) { return true; }
+    // Frames the CPU may record while the GPU still runs earlier ones. Data the CPU rewrites every frame needs a copy
+    // per frame in flight; the frame recorded now can use copy GetRecordingValue() % GetFramesInFlight().
+    virtual uint32_t GetFramesInFlight() { return 1; }
+
+    // The 32-bit types are always supported; packed types depend on the device
+    virtual bool IsVertexTypeSupported(VertexType type) { return type <= VertexType::UVEC4; }
+    // Highest sample count usable for both color and depth attachments
+    virtual uint32_t GetMaxSampleCount() { return 1; }
+    // Buffer descriptors of uniform buffers start at multiples of this
+    virtual size_t GetUniformBufferOffsetAlignment() { return 256; }
 
     virtual void SetBufferData(void* buffer, size_t offset, size_t size, void* data) = 0;
 
@@ -499,6 +544,9 @@ public:
     virtual void SetRenderAttachments(void** colorViews, size_t colorViewCount, void* depthStencilView, uint32_t width, uint32_t height, void* pipeline) = 0;
     virtual void SetViewports(Viewport* viewports, size_t count) = 0;
     virtual void SetScissors(Rect2D* scissors, size_t count) = 0;
+    // Single sampled views the color attachments of multisampled pipelines resolve into, one per color attachment.
+    // They apply to every following SetRenderAttachments until changed.
+    virtual void SetResolveAttachments(void** /*resolveViews*/, size_t /*count*/) {}
 
     virtual void SetPipeline(void* pipeline) = 0;
     virtual void SetDescriptor(const DescriptorInfo& descriptorInfo) = 0;
@@ -508,6 +556,49 @@ public:
     virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) = 0;
     virtual void Draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0) = 0;
 
+    // GPU profiling scopes. Timings are resolved a few submissions later, so reading them never waits on the GPU.
+    virtual void BeginGpuScope(const char* /*name*/) {}
+    virtual void EndGpuScope() {}
+    virtual void ResolveGpuScopes(std::vector<GpuScopeTiming>& /*timings*/) {}
+
+    // Fragment density maps, used for foveated rendering. A density map is an R8G8 image with one texel per
+    // GetFragmentDensityTexelSize() block of the framebuffer; 255 shades every pixel, 128 every other one on that axis.
+    virtual bool IsFragmentDensityMapSupported() { return false; }
+    virtual Extent2D GetFragmentDensityTexelSize() { return {0, 0}; }
+    // Returns the view of a new density map, which starts out at full density
+    virtual void* CreateFragmentDensityMap(uint32_t /*width*/, uint32_t /*height*/) { return nullptr; }
+    virtual void DestroyFragmentDensityMap(void*& /*densityMapView*/) {}
+    // Records the upload into the current frame, call it between BeginRendering and the first SetRenderAttachments,
+    // or before ResolveDeferredRenderTargets when the passes are deferred
+    virtual void SetFragmentDensityMapData(void* /*densityMapView*/, const void* /*data*/) {}
+    // View of a density map image owned by someone else, such as the runtime; destroy it with DestroyImageView
+    virtual void* CreateFragmentDensityMapView(void* /*image*/) { return nullptr; }
+    // Density map attached by SetRenderAttachments to pipelines created with fragmentDensityMap
+    virtual void SetFragmentDensityMap(void* /*densityMapView*/) {}
+
+    // Deferred render targets stand in for image views that aren't known while recording, such as swapchain images
+    // acquired just before submission. Clears and draws against them are recorded into secondary command buffers,
+    // which ResolveDeferredRenderTargets replays into the frame once BindDeferredRenderTarget supplied the real views.
+    virtual bool IsDeferredRenderTargetSupported() { return false; }
+    virtual void* CreateDeferredRenderTarget() { return nullptr; }
+    virtual void DestroyDeferredRenderTarget(void*& /*renderTarget*/) {}
+    // The binding lasts until the next ResolveDeferredRenderTargets
+    virtual void BindDeferredRenderTarget(void* /*renderTarget*/, void* /*imageView*/) {}
+    // Call it before EndRendering; passes reading a density map use the one set at this point
+    virtual void ResolveDeferredRenderTargets() {}
+
+    // Parallel recording splits the draws of a frame into chunks recorded by several threads at once. Between
+    // BeginParallelRecording and EndParallelRecording each chunk is recorded between BeginThreadRecording and
+    // EndThreadRecording on one thread, where the draw state calls (SetRenderAttachments to Draw) go into the chunk.
+    // A chunk draws into one set of attachments; clears and GPU scopes stay on the thread that calls
+    // BeginParallelRecording. EndParallelRecording executes the chunks in order, as if they were recorded serially.
+    // Threads passing different threadIndex values, below GetRecordingThreadCount, may record at the same time.
+    virtual uint32_t GetRecordingThreadCount() { return 1; }
+    virtual void BeginParallelRecording(uint32_t /*chunkCount*/) {}
+    virtual void BeginThreadRecording(uint32_t /*threadIndex*/, uint32_t /*chunkIndex*/) {}
+    virtual void EndThreadRecording() {}
+    virtual void EndParallelRecording() {}
+
 protected:
     virtual const std::vector<int64_t> GetSupportedColorSwapchainFormats() = 0;
     virtual const std::vector<int64_t> GetSupportedDepthSwapchainFormats() = 0;
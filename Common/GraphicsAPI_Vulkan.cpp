@@ -4,6 +4,9 @@
 #include <GraphicsAPI_Vulkan.h>
 
 #if defined(XR_USE_GRAPHICS_API_VULKAN)
+#include <chrono>
+#include <cstring>
+#include <thread>
 
 #define VULKAN_CHECK(x, y)                                                                         \
     {                                                                                              \
@@ -68,6 +71,14 @@ static VkFormat ToVkFormat(GraphicsAPI::VertexType type)
             return VK_FORMAT_R32G32B32_UINT;
         case GraphicsAPI::VertexType::UVEC4:
             return VK_FORMAT_R32G32B32A32_UINT;
+        case GraphicsAPI::VertexType::HALF2:
+            return VK_FORMAT_R16G16_SFLOAT;
+        case GraphicsAPI::VertexType::HALF4:
+            return VK_FORMAT_R16G16B16A16_SFLOAT;
+        case GraphicsAPI::VertexType::SNORM16x4:
+            return VK_FORMAT_R16G16B16A16_SNORM;
+        case GraphicsAPI::VertexType::SNORM_10_10_10_2:
+            return VK_FORMAT_A2B10G10R10_SNORM_PACK32;
         default:
             return VK_FORMAT_UNDEFINED;
     }
@@ -147,13 +158,32 @@ GraphicsAPI_Vulkan::GraphicsAPI_Vulkan(const VulkanInitInfo &initInfo)
     VkPhysicalDeviceFeatures features;
     vkGetPhysicalDeviceFeatures(physicalDevice, &features);
 
+    // Optional extensions the renderer can make use of, on top of the ones the caller asked for
+    std::vector<const char *> deviceExtensions = initInfo.deviceExtensions;
+    CheckFragmentDensityMapSupport(initInfo.apiVersion, deviceExtensions);
+    CheckTimelineSemaphoreSupport(initInfo.apiVersion, deviceExtensions);
+
+    // Chain the features of the optional extensions that were found
+    void *deviceFeatures = nullptr;
+    if (fragmentDensityMapSupported)
+    {
+        fragmentDensityMapFeatures.pNext = deviceFeatures;
+        deviceFeatures = &fragmentDensityMapFeatures;
+    }
+    if (timelineSemaphoreSupported)
+    {
+        timelineSemaphoreFeatures.pNext = deviceFeatures;
+        deviceFeatures = &timelineSemaphoreFeatures;
+    }
+
     // Create logical device
     VkDeviceCreateInfo deviceCI{};
     deviceCI.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceCI.pNext = deviceFeatures;
     deviceCI.queueCreateInfoCount = static_cast<uint32_t>(deviceQueueCIs.size());
     deviceCI.pQueueCreateInfos = deviceQueueCIs.data();
-    deviceCI.enabledExtensionCount = static_cast<uint32_t>(initInfo.deviceExtensions.size());
-    deviceCI.ppEnabledExtensionNames = initInfo.deviceExtensions.data();
+    deviceCI.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+    deviceCI.ppEnabledExtensionNames = deviceExtensions.data();
     deviceCI.pEnabledFeatures = &features;
 
     VULKAN_CHECK(vkCreateDevice(physicalDevice, &deviceCI, nullptr, &device), "Failed to create Device.");
@@ -168,21 +198,97 @@ GraphicsAPI_Vulkan::GraphicsAPI_Vulkan(const VulkanInitInfo &initInfo)
     cmdPoolCI.queueFamilyIndex = queueFamilyIndex;
     VULKAN_CHECK(vkCreateCommandPool(device, &cmdPoolCI, nullptr, &cmdPool), "Failed to create CommandPool");
 
-    // Create command buffer
-    VkCommandBufferAllocateInfo cmdBufferAI{};
-    cmdBufferAI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    cmdBufferAI.commandPool = cmdPool;
-    cmdBufferAI.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    cmdBufferAI.commandBufferCount = 1;
-    VULKAN_CHECK(vkAllocateCommandBuffers(device, &cmdBufferAI, &cmdBuffer), "Failed to allocate CommandBuffer");
+    // Create a command buffer and fence per frame in flight
+    framesInFlight = std::min(std::max(initInfo.framesInFlight, 1u), maxFramesInFlight);
+    frameContexts.resize(framesInFlight);
+    for (FrameContext &frame : frameContexts)
+    {
+        VkCommandBufferAllocateInfo cmdBufferAI{};
+        cmdBufferAI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cmdBufferAI.commandPool = cmdPool;
+        cmdBufferAI.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cmdBufferAI.commandBufferCount = 1;
+        VULKAN_CHECK(vkAllocateCommandBuffers(device, &cmdBufferAI, &frame.cmdBuffer), "Failed to allocate CommandBuffer");
+
+        VkFenceCreateInfo fenceCI{};
+        fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        fenceCI.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+        VULKAN_CHECK(vkCreateFence(device, &fenceCI, nullptr, &frame.fence), "Failed to create Fence.");
+    }
+    cmdBuffer = frameContexts[frameIndex].cmdBuffer;
+
+    // Create the timeline semaphore every submission signals, falling back to the fences if it's unavailable
+    if (timelineSemaphoreSupported)
+    {
+        getSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(
+            device, timelineSemaphoreCore ? "vkGetSemaphoreCounterValue" : "vkGetSemaphoreCounterValueKHR");
+        waitSemaphores = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(device, timelineSemaphoreCore ? "vkWaitSemaphores" : "vkWaitSemaphoresKHR");
+        timelineSemaphoreSupported = getSemaphoreCounterValue && waitSemaphores;
+    }
+    if (timelineSemaphoreSupported)
+    {
+        VkSemaphoreTypeCreateInfo semaphoreTypeCI{};
+        semaphoreTypeCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        semaphoreTypeCI.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        semaphoreTypeCI.initialValue = 0;
+        VkSemaphoreCreateInfo semaphoreCI{};
+        semaphoreCI.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreCI.pNext = &semaphoreTypeCI;
+        VULKAN_CHECK(vkCreateSemaphore(device, &semaphoreCI, nullptr, &timelineSemaphore), "Failed to create timeline Semaphore.");
+    }
+
+    // Create timestamp query pools for GPU profiling, if the graphics queue supports timestamps
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+    const uint32_t timestampValidBits = queueFamilyProperties[queueFamilyIndex].timestampValidBits;
+    gpuProfilerSupported = timestampValidBits > 0 && physicalDeviceProperties.limits.timestampPeriod > 0.0f;
 
-    // Create fence
-    VkFenceCreateInfo fenceCI{};
-    fenceCI.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceCI.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-    VULKAN_CHECK(vkCreateFence(device, &fenceCI, nullptr, &fence), "Failed to create Fence.");
+    const VkSampleCountFlags sampleCounts =
+        physicalDeviceProperties.limits.framebufferColorSampleCounts & physicalDeviceProperties.limits.framebufferDepthSampleCounts;
+    while ((sampleCounts & (maxSampleCount << 1)) != 0 && maxSampleCount < VK_SAMPLE_COUNT_64_BIT)
+    {
+        maxSampleCount <<= 1;
+    }
+    uniformBufferOffsetAlignment = static_cast<size_t>(std::max<VkDeviceSize>(physicalDeviceProperties.limits.minUniformBufferOffsetAlignment, 1));
+    if (gpuProfilerSupported)
+    {
+        timestampPeriod = physicalDeviceProperties.limits.timestampPeriod;
+        timestampMask = timestampValidBits >= 64 ? ~0ULL : ((1ULL << timestampValidBits) - 1);
+        gpuProfilerFrames.resize(gpuProfilerFrameCount);
+        for (GpuProfilerFrame &frame : gpuProfilerFrames)
+        {
+            VkQueryPoolCreateInfo queryPoolCI{};
+            queryPoolCI.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryPoolCI.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryPoolCI.queryCount = gpuProfilerMaxQueries;
+            VULKAN_CHECK(vkCreateQueryPool(device, &queryPoolCI, nullptr, &frame.queryPool), "Failed to create timestamp QueryPool.");
+        }
+    }
 
     // Create descriptor pool
+    descriptorPool = CreateDescriptorPool(VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT);
+
+    // One command and descriptor pool per recording thread and frame in flight, so the threads never share a pool.
+    // Their command buffers are only used for one frame, which lets the pools be reset as a whole instead of buffer by buffer.
+    const uint32_t coreCount = std::thread::hardware_concurrency();
+    recordingThreadCount = std::min(std::max(coreCount, 1u), static_cast<uint32_t>(maxRecordingThreads));
+    for (FrameContext &frame : frameContexts)
+    {
+        frame.recordingContexts.resize(recordingThreadCount);
+        for (RecordingContext &context : frame.recordingContexts)
+        {
+            VkCommandPoolCreateInfo contextCmdPoolCI{};
+            contextCmdPoolCI.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            contextCmdPoolCI.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            contextCmdPoolCI.queueFamilyIndex = queueFamilyIndex;
+            VULKAN_CHECK(vkCreateCommandPool(device, &contextCmdPoolCI, nullptr, &context.cmdPool), "Failed to create recording thread CommandPool");
+            context.descriptorPool = CreateDescriptorPool(0);
+        }
+    }
+}
+
+VkDescriptorPool GraphicsAPI_Vulkan::CreateDescriptorPool(VkDescriptorPoolCreateFlags flags)
+{
     uint32_t maxSets = 1024;
     std::vector<VkDescriptorPoolSize> poolSizes{{VK_DESCRIPTOR_TYPE_SAMPLER, 16 * maxSets},
                                                 {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 16 * maxSets},
@@ -192,20 +298,56 @@ GraphicsAPI_Vulkan::GraphicsAPI_Vulkan(const VulkanInitInfo &initInfo)
 
     VkDescriptorPoolCreateInfo descPoolCI{};
     descPoolCI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    descPoolCI.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    descPoolCI.flags = flags;
     descPoolCI.maxSets = maxSets;
     descPoolCI.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
     descPoolCI.pPoolSizes = poolSizes.data();
-    VULKAN_CHECK(vkCreateDescriptorPool(device, &descPoolCI, nullptr, &descriptorPool), "Failed to create DescriptorPool");
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    VULKAN_CHECK(vkCreateDescriptorPool(device, &descPoolCI, nullptr, &pool), "Failed to create DescriptorPool");
+    return pool;
 }
 
 GraphicsAPI_Vulkan::~GraphicsAPI_Vulkan()
 {
+    // Also empties the deletion queue
+    WaitForIdle();
+
+    while (!fragmentDensityMaps.empty())
+    {
+        void *densityMapView = (void *)fragmentDensityMaps.begin()->first;
+        DestroyFragmentDensityMap(densityMapView);
+    }
+
     vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+    for (FrameContext &frame : frameContexts)
+    {
+        for (RecordingContext &context : frame.recordingContexts)
+        {
+            // Destroying the pools frees what was allocated from them
+            vkDestroyDescriptorPool(device, context.descriptorPool, nullptr);
+            vkDestroyCommandPool(device, context.cmdPool, nullptr);
+        }
+        vkDestroyFence(device, frame.fence, nullptr);
+    }
 
-    vkDestroyFence(device, fence, nullptr);
+    if (timelineSemaphore)
+    {
+        vkDestroySemaphore(device, timelineSemaphore, nullptr);
+    }
+
+    for (GpuProfilerFrame &frame : gpuProfilerFrames)
+    {
+        vkDestroyQueryPool(device, frame.queryPool, nullptr);
+    }
 
-    vkFreeCommandBuffers(device, cmdPool, 1, &cmdBuffer);
+    for (FrameContext &frame : frameContexts)
+    {
+        if (!frame.secondaryCmdBuffers.empty())
+        {
+            vkFreeCommandBuffers(device, cmdPool, static_cast<uint32_t>(frame.secondaryCmdBuffers.size()), frame.secondaryCmdBuffers.data());
+        }
+        vkFreeCommandBuffers(device, cmdPool, 1, &frame.cmdBuffer);
+    }
     vkDestroyCommandPool(device, cmdPool, nullptr);
 
     vkDestroyDevice(device, nullptr);
@@ -384,7 +526,7 @@ void *GraphicsAPI_Vulkan::CreateImage(const ImageCreateInfo &imageCI)
     vkImageCI.arrayLayers = imageCI.arrayLayers;
     vkImageCI.samples = VkSampleCountFlagBits(imageCI.sampleCount);
     vkImageCI.tiling = VK_IMAGE_TILING_OPTIMAL;
-    vkImageCI.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+    vkImageCI.usage = (imageCI.transient ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT) |
                       (imageCI.colorAttachment ? VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT : 0) |
                       (imageCI.depthAttachment ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT : 0);
     vkImageCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
@@ -404,8 +546,14 @@ void *GraphicsAPI_Vulkan::CreateImage(const ImageCreateInfo &imageCI)
 
     VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties{};
     vkGetPhysicalDeviceMemoryProperties(physicalDevice, &physicalDeviceMemoryProperties);
-    MemoryTypeFromProperties(physicalDeviceMemoryProperties, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                             &allocateInfo.memoryTypeIndex);
+    // Tilers keep transient attachments on chip and only back lazily allocated memory if they ever need to
+    if (!imageCI.transient ||
+        !MemoryTypeFromProperties(physicalDeviceMemoryProperties, memoryRequirements.memoryTypeBits,
+                                  VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT, &allocateInfo.memoryTypeIndex))
+    {
+        MemoryTypeFromProperties(physicalDeviceMemoryProperties, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                 &allocateInfo.memoryTypeIndex);
+    }
 
     VULKAN_CHECK(vkAllocateMemory(device, &allocateInfo, nullptr, &memory), "Failed to allocate Memory.");
     VULKAN_CHECK(vkBindImageMemory(device, image, memory, 0), "Failed to bind Memory to Image.");
@@ -419,11 +567,13 @@ void *GraphicsAPI_Vulkan::CreateImage(const ImageCreateInfo &imageCI)
 void GraphicsAPI_Vulkan::DestroyImage(void *&image)
 {
     VkImage vkImage = (VkImage)image;
-    VkDeviceMemory memory = imageResources[vkImage].first;
-    vkFreeMemory(device, memory, nullptr);
-    vkDestroyImage(device, vkImage, nullptr);
-    imageResources.erase(vkImage);
-    imageStates.erase(vkImage);
+    Retire([this, vkImage]()
+           {
+               VkDeviceMemory memory = imageResources[vkImage].first;
+               vkFreeMemory(device, memory, nullptr);
+               vkDestroyImage(device, vkImage, nullptr);
+               imageResources.erase(vkImage);
+               imageStates.erase(vkImage); });
     image = nullptr;
 }
 
@@ -452,8 +602,10 @@ void *GraphicsAPI_Vulkan::CreateImageView(const ImageViewCreateInfo &imageViewCI
 void GraphicsAPI_Vulkan::DestroyImageView(void *&imageView)
 {
     VkImageView vkImageView = (VkImageView)imageView;
-    vkDestroyImageView(device, vkImageView, nullptr);
-    imageViewResources.erase(vkImageView);
+    Retire([this, vkImageView]()
+           {
+               vkDestroyImageView(device, vkImageView, nullptr);
+               imageViewResources.erase(vkImageView); });
     imageView = nullptr;
 }
 
@@ -488,7 +640,9 @@ void *GraphicsAPI_Vulkan::CreateSampler(const SamplerCreateInfo &samplerCI)
 
 void GraphicsAPI_Vulkan::DestroySampler(void *&sampler)
 {
-    vkDestroySampler(device, (VkSampler)sampler, nullptr);
+    VkSampler vkSampler = (VkSampler)sampler;
+    Retire([this, vkSampler]()
+           { vkDestroySampler(device, vkSampler, nullptr); });
     sampler = nullptr;
 }
 
@@ -534,10 +688,24 @@ void *GraphicsAPI_Vulkan::CreateBuffer(const BufferCreateInfo &bufferCI)
 void GraphicsAPI_Vulkan::DestroyBuffer(void *&buffer)
 {
     VkBuffer vkBuffer = (VkBuffer)buffer;
-    VkDeviceMemory memory = bufferResources[vkBuffer].first;
-    vkFreeMemory(device, memory, nullptr);
-    vkDestroyBuffer(device, vkBuffer, nullptr);
-    bufferResources.erase(vkBuffer);
+    // A later buffer can reuse the handle, it must not be mistaken for the one still bound
+    if (mainRecordingState.boundVertexBuffer == vkBuffer) mainRecordingState.boundVertexBuffer = VK_NULL_HANDLE;
+    if (mainRecordingState.boundIndexBuffer == vkBuffer) mainRecordingState.boundIndexBuffer = VK_NULL_HANDLE;
+    // Between frames only the frames that bound the buffer hold on to it. While a frame is recorded, draws collected
+    // for the recording threads may still bind it, so it waits for that frame.
+    auto useValue = bufferUseValues.find(vkBuffer);
+    uint64_t value = recordingFrame ? GetRecordingValue() : 0;
+    if (useValue != bufferUseValues.end())
+    {
+        value = std::max(value, useValue->second);
+        bufferUseValues.erase(useValue);
+    }
+    Retire(value, [this, vkBuffer]()
+           {
+               VkDeviceMemory memory = bufferResources[vkBuffer].first;
+               vkFreeMemory(device, memory, nullptr);
+               vkDestroyBuffer(device, vkBuffer, nullptr);
+               bufferResources.erase(vkBuffer); });
     buffer = nullptr;
 }
 
@@ -568,15 +736,19 @@ void *GraphicsAPI_Vulkan::CreatePipeline(const PipelineCreateInfo &pipelineCI)
     // RenderPass
     std::vector<VkAttachmentDescription> attachmentDescriptions{};
     std::vector<VkAttachmentReference> colorAttachmentReferences{};
+    std::vector<VkAttachmentReference> resolveAttachmentReferences{};
     VkAttachmentReference depthAttachmentReference;
+    // Multisampled color only lives for the pass and is resolved into single sampled attachments at its end
+    const VkSampleCountFlagBits sampleCount = static_cast<VkSampleCountFlagBits>(std::max(pipelineCI.multisampleState.rasterisationSamples, 1u));
+    const bool multisampled = sampleCount != VK_SAMPLE_COUNT_1_BIT;
     for (const auto &colorFormat : pipelineCI.colorFormats)
     {
         attachmentDescriptions.push_back({
             static_cast<VkAttachmentDescriptionFlags>(0),
             static_cast<VkFormat>(colorFormat),
-            static_cast<VkSampleCountFlagBits>(1),
-            VK_ATTACHMENT_LOAD_OP_LOAD,
-            VK_ATTACHMENT_STORE_OP_STORE,
+            sampleCount,
+            multisampled ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_LOAD,
+            multisampled ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE,
             VK_ATTACHMENT_LOAD_OP_DONT_CARE,
             VK_ATTACHMENT_STORE_OP_DONT_CARE,
             VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
@@ -589,9 +761,9 @@ void *GraphicsAPI_Vulkan::CreatePipeline(const PipelineCreateInfo &pipelineCI)
         attachmentDescriptions.push_back({
             static_cast<VkAttachmentDescriptionFlags>(0),
             static_cast<VkFormat>(pipelineCI.depthFormat),
-            static_cast<VkSampleCountFlagBits>(1),
-            VK_ATTACHMENT_LOAD_OP_LOAD,
-            VK_ATTACHMENT_STORE_OP_STORE,
+            sampleCount,
+            pipelineCI.transientDepth ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : VK_ATTACHMENT_LOAD_OP_LOAD,
+            pipelineCI.transientDepth ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE,
             VK_ATTACHMENT_LOAD_OP_DONT_CARE,
             VK_ATTACHMENT_STORE_OP_DONT_CARE,
             VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
@@ -599,6 +771,42 @@ void *GraphicsAPI_Vulkan::CreatePipeline(const PipelineCreateInfo &pipelineCI)
         });
         depthAttachmentReference = {static_cast<uint32_t>(attachmentDescriptions.size() - 1), VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
     }
+    for (size_t i = 0; multisampled && i < pipelineCI.colorFormats.size(); i++)
+    {
+        // Fully written by the resolve, so nothing is loaded
+        attachmentDescriptions.push_back({
+            static_cast<VkAttachmentDescriptionFlags>(0),
+            static_cast<VkFormat>(pipelineCI.colorFormats[i]),
+            VK_SAMPLE_COUNT_1_BIT,
+            VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            VK_ATTACHMENT_STORE_OP_STORE,
+            VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        });
+        resolveAttachmentReferences.push_back({static_cast<uint32_t>(attachmentDescriptions.size() - 1), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+    }
+    // The density map goes last, SetRenderAttachments appends it in the same place
+    const bool useFragmentDensityMap = pipelineCI.fragmentDensityMap && fragmentDensityMapSupported;
+    VkRenderPassFragmentDensityMapCreateInfoEXT fragmentDensityMapCI{};
+    fragmentDensityMapCI.sType = VK_STRUCTURE_TYPE_RENDER_PASS_FRAGMENT_DENSITY_MAP_CREATE_INFO_EXT;
+    if (useFragmentDensityMap)
+    {
+        attachmentDescriptions.push_back({
+            static_cast<VkAttachmentDescriptionFlags>(0),
+            VK_FORMAT_R8G8_UNORM,
+            static_cast<VkSampleCountFlagBits>(1),
+            VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            VK_IMAGE_LAYOUT_FRAGMENT_DENSITY_MAP_OPTIMAL_EXT,
+            VK_IMAGE_LAYOUT_FRAGMENT_DENSITY_MAP_OPTIMAL_EXT,
+        });
+        fragmentDensityMapCI.fragmentDensityMapAttachment = {static_cast<uint32_t>(attachmentDescriptions.size() - 1),
+                                                             VK_IMAGE_LAYOUT_FRAGMENT_DENSITY_MAP_OPTIMAL_EXT};
+    }
 
     VkSubpassDescription subpassDescription;
     subpassDescription.flags = static_cast<VkSubpassDescriptionFlags>(0);
@@ -607,24 +815,26 @@ void *GraphicsAPI_Vulkan::CreatePipeline(const PipelineCreateInfo &pipelineCI)
     subpassDescription.pInputAttachments = nullptr;
     subpassDescription.colorAttachmentCount = static_cast<uint32_t>(colorAttachmentReferences.size());
     subpassDescription.pColorAttachments = colorAttachmentReferences.data();
-    subpassDescription.pResolveAttachments = nullptr;
+    subpassDescription.pResolveAttachments = multisampled ? resolveAttachmentReferences.data() : nullptr;
     subpassDescription.pDepthStencilAttachment = pipelineCI.depthFormat ? &depthAttachmentReference : nullptr;
     subpassDescription.preserveAttachmentCount = 0;
     subpassDescription.pPreserveAttachments = nullptr;
 
+    // Frames in flight share the transient attachments, the writes of the previous frame have to land before these
     VkSubpassDependency subpassDependency;
     subpassDependency.srcSubpass = VK_SUBPASS_EXTERNAL;
     subpassDependency.dstSubpass = 0;
-    subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    subpassDependency.srcAccessMask = VkAccessFlagBits(0);
-    subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    subpassDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    subpassDependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    subpassDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    subpassDependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                      VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
     subpassDependency.dependencyFlags = VkDependencyFlagBits(0);
 
     VkRenderPass renderPass{};
     VkRenderPassCreateInfo renderPassCI;
     renderPassCI.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-    renderPassCI.pNext = nullptr;
+    renderPassCI.pNext = useFragmentDensityMap ? &fragmentDensityMapCI : nullptr;
     renderPassCI.flags = 0;
     renderPassCI.attachmentCount = static_cast<uint32_t>(attachmentDescriptions.size());
     renderPassCI.pAttachments = attachmentDescriptions.data();
@@ -638,6 +848,15 @@ void *GraphicsAPI_Vulkan::CreatePipeline(const PipelineCreateInfo &pipelineCI)
     std::vector<VkDescriptorSetLayoutBinding> descSetLayouBindings;
     for (const DescriptorInfo &descInfo : pipelineCI.layout)
     {
+        // A binding listed once per stage that uses it becomes one binding visible to all those stages
+        auto sameBinding = std::find_if(descSetLayouBindings.begin(), descSetLayouBindings.end(),
+                                        [&descInfo](const VkDescriptorSetLayoutBinding &binding) { return binding.binding == descInfo.bindingIndex; });
+        if (sameBinding != descSetLayouBindings.end())
+        {
+            sameBinding->stageFlags |= static_cast<VkShaderStageFlags>(1 << (uint32_t)descInfo.stage);
+            continue;
+        }
+
         VkDescriptorSetLayoutBinding descSetLayouBinding;
         descSetLayouBinding.binding = descInfo.bindingIndex;
         descSetLayouBinding.descriptorType = ToVkDescrtiptorType(descInfo);
@@ -667,6 +886,20 @@ void *GraphicsAPI_Vulkan::CreatePipeline(const PipelineCreateInfo &pipelineCI)
     PLCI.pPushConstantRanges = nullptr;
     VULKAN_CHECK(vkCreatePipelineLayout(device, &PLCI, nullptr, &pipelineLayout), "Failed to create PipelineLayout.");
 
+    // Specialization constants, shared by all stages
+    std::vector<VkSpecializationMapEntry> specializationEntries;
+    std::vector<uint32_t> specializationData;
+    for (const SpecializationConstant &constant : pipelineCI.specializationConstants)
+    {
+        specializationEntries.push_back({constant.constantID, static_cast<uint32_t>(specializationData.size() * sizeof(uint32_t)), sizeof(uint32_t)});
+        specializationData.push_back(constant.value);
+    }
+    VkSpecializationInfo specializationInfo;
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationEntries.size());
+    specializationInfo.pMapEntries = specializationEntries.data();
+    specializationInfo.dataSize = specializationData.size() * sizeof(uint32_t);
+    specializationInfo.pData = specializationData.data();
+
     // ShaderStages
     std::vector<VkPipelineShaderStageCreateInfo> vkShaderStages;
     vkShaderStages.reserve(pipelineCI.shaders.size());
@@ -680,7 +913,7 @@ void *GraphicsAPI_Vulkan::CreatePipeline(const PipelineCreateInfo &pipelineCI)
         shaderStageCI.stage = static_cast<VkShaderStageFlagBits>(1 << (uint32_t)shaderResources[shaderModule].type);
         shaderStageCI.module = shaderModule;
         shaderStageCI.pName = "main";
-        shaderStageCI.pSpecializationInfo = nullptr;
+        shaderStageCI.pSpecializationInfo = specializationEntries.empty() ? nullptr : &specializationInfo;
         vkShaderStages.push_back(shaderStageCI);
     }
 
@@ -854,20 +1087,32 @@ void *GraphicsAPI_Vulkan::CreatePipeline(const PipelineCreateInfo &pipelineCI)
 void GraphicsAPI_Vulkan::DestroyPipeline(void *&pipeline)
 {
     VkPipeline vkPipeline = (VkPipeline)pipeline;
-    VkPipelineLayout pipelineLayout = std::get<0>(pipelineResources[vkPipeline]);
-    VkDescriptorSetLayout descSetLayout = std::get<1>(pipelineResources[vkPipeline]);
-    VkRenderPass renderPass = std::get<2>(pipelineResources[vkPipeline]);
-    vkDestroyRenderPass(device, renderPass, nullptr);
-    vkDestroyDescriptorSetLayout(device, descSetLayout, nullptr);
-    vkDestroyPipeline(device, vkPipeline, nullptr);
-    pipelineResources.erase(vkPipeline);
+    Retire([this, vkPipeline]()
+           {
+               VkPipelineLayout pipelineLayout = std::get<0>(pipelineResources[vkPipeline]);
+               VkDescriptorSetLayout descSetLayout = std::get<1>(pipelineResources[vkPipeline]);
+               VkRenderPass renderPass = std::get<2>(pipelineResources[vkPipeline]);
+               vkDestroyRenderPass(device, renderPass, nullptr);
+               vkDestroyDescriptorSetLayout(device, descSetLayout, nullptr);
+               vkDestroyPipeline(device, vkPipeline, nullptr);
+               pipelineResources.erase(vkPipeline); });
     pipeline = nullptr;
 }
 
 void GraphicsAPI_Vulkan::BeginRendering()
 {
-    VULKAN_CHECK(vkWaitForFences(device, 1, &fence, true, UINT64_MAX), "Failed to wait for Fence");
-    VULKAN_CHECK(vkResetFences(device, 1, &fence), "Failed to reset Fence.")
+    // The frame reuses the command buffer and pools of the submission framesInFlight back, only that has to finish.
+    // The desktop swapchain has a single pair of semaphores, so with it the previous submission has to finish too.
+    frameIndex = static_cast<uint32_t>((submittedValue + 1) % framesInFlight);
+    FrameContext &frameContext = frameContexts[frameIndex];
+    WaitForValue(acquireSemaphore ? submittedValue : frameContext.submittedValue);
+    if (!timelineSemaphoreSupported)
+    {
+        VULKAN_CHECK(vkResetFences(device, 1, &frameContext.fence), "Failed to reset Fence.")
+    }
+    cmdBuffer = frameContext.cmdBuffer;
+    DestroyRetiredObjects();
+    recordingFrame = true;
 
     // VULKAN_CHECK(vkResetDescriptorPool(device, descriptorPool, VkDescriptorPoolResetFlags(0)), "Failed to rest DescriptorPool")
     for (const auto &descSet : cmdBufferDescriptorSets[cmdBuffer])
@@ -890,6 +1135,43 @@ void GraphicsAPI_Vulkan::BeginRendering()
     beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
     beginInfo.pInheritanceInfo = nullptr;
     VULKAN_CHECK(vkBeginCommandBuffer(cmdBuffer, &beginInfo), "Failed to begin CommandBuffer.");
+    mainRecordingState.cmdBuffer = cmdBuffer;
+    mainRecordingState.boundVertexBuffer = VK_NULL_HANDLE;
+    mainRecordingState.boundIndexBuffer = VK_NULL_HANDLE;
+
+    // The secondary command buffers and descriptor sets of the slot's last frame finished with it
+    frameContext.secondaryCmdBuffersUsed = 0;
+    for (RecordingContext &context : frameContext.recordingContexts)
+    {
+        if (context.cmdBuffersUsed > 0)
+        {
+            VULKAN_CHECK(vkResetCommandPool(device, context.cmdPool, 0), "Failed to reset recording thread CommandPool.");
+            VULKAN_CHECK(vkResetDescriptorPool(device, context.descriptorPool, 0), "Failed to reset recording thread DescriptorPool.");
+            context.cmdBuffersUsed = 0;
+        }
+        context.usedBuffers.clear();
+    }
+    deferredPasses.clear();
+    deferredPassOpen = false;
+    pendingAttachmentClears.clear();
+
+    if (gpuProfilerSupported)
+    {
+        // The pools outnumber the frames in flight, so this pool's previous submission finished at the latest with
+        // the wait above; ReadGpuProfilerFrame drops the scopes if its results aren't available anyway
+        gpuProfilerFrameIndex = (gpuProfilerFrameIndex + 1) % gpuProfilerFrameCount;
+        GpuProfilerFrame &frame = gpuProfilerFrames[gpuProfilerFrameIndex];
+        if (frame.pending)
+        {
+            ReadGpuProfilerFrame(frame);
+        }
+        vkCmdResetQueryPool(cmdBuffer, frame.queryPool, 0, gpuProfilerMaxQueries);
+        frame.queryCount = 0;
+        frame.scopes.clear();
+        frame.submissionIndex = gpuSubmissionCount++;
+        gpuScopeStack.clear();
+        gpuProfilerRecording = true;
+    }
 
     if (currentDesktopSwapchainImage)
     {
@@ -912,6 +1194,11 @@ void GraphicsAPI_Vulkan::BeginRendering()
 
 void GraphicsAPI_Vulkan::EndRendering()
 {
+    if (!deferredPasses.empty())
+    {
+        ResolveDeferredRenderTargets();
+    }
+
     if (inRenderPass)
     {
         vkCmdEndRenderPass(cmdBuffer);
@@ -936,22 +1223,160 @@ void GraphicsAPI_Vulkan::EndRendering()
                              &barrier);
     }
 
+    while (!gpuScopeStack.empty())
+    {
+        EndGpuScope();
+    }
+
     VULKAN_CHECK(vkEndCommandBuffer(cmdBuffer), "Failed to end CommandBuffer.");
 
     VkPipelineStageFlags waitDstStageMask = VkPipelineStageFlagBits::VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 
+    // The timeline semaphore is signalled next to the binary one presenting waits on; values of binary ones are ignored
+    const uint64_t signalValue = submittedValue + 1;
+    VkSemaphore signalSemaphores[2];
+    uint64_t signalValues[2] = {0, 0};
+    uint32_t signalSemaphoreCount = 0;
+    if (submitSemaphore)
+    {
+        signalSemaphores[signalSemaphoreCount++] = submitSemaphore;
+    }
+    if (timelineSemaphoreSupported)
+    {
+        signalValues[signalSemaphoreCount] = signalValue;
+        signalSemaphores[signalSemaphoreCount++] = timelineSemaphore;
+    }
+
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo{};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineSubmitInfo.pNext = nullptr;
+    timelineSubmitInfo.waitSemaphoreValueCount = 0;
+    timelineSubmitInfo.pWaitSemaphoreValues = nullptr;
+    timelineSubmitInfo.signalSemaphoreValueCount = signalSemaphoreCount;
+    timelineSubmitInfo.pSignalSemaphoreValues = signalValues;
+
     VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.pNext = nullptr;
+    submitInfo.pNext = timelineSemaphoreSupported ? &timelineSubmitInfo : nullptr;
     submitInfo.waitSemaphoreCount = acquireSemaphore ? 1 : 0;
     submitInfo.pWaitSemaphores = acquireSemaphore ? &acquireSemaphore : nullptr;
     submitInfo.pWaitDstStageMask = acquireSemaphore ? &waitDstStageMask : nullptr;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &cmdBuffer;
-    submitInfo.signalSemaphoreCount = submitSemaphore ? 1 : 0;
-    submitInfo.pSignalSemaphores = submitSemaphore ? &submitSemaphore : nullptr;
+    submitInfo.signalSemaphoreCount = signalSemaphoreCount;
+    submitInfo.pSignalSemaphores = signalSemaphoreCount > 0 ? signalSemaphores : nullptr;
+
+    FrameContext &frameContext = GetFrameContext();
+    VULKAN_CHECK(vkQueueSubmit(queue, 1, &submitInfo, timelineSemaphoreSupported ? VK_NULL_HANDLE : frameContext.fence), "Failed to submit to Queue.");
+    frameContext.submittedValue = signalValue;
+    submittedValue = signalValue;
+    recordingFrame = false;
+
+    if (gpuProfilerRecording)
+    {
+        GpuProfilerFrame &frame = gpuProfilerFrames[gpuProfilerFrameIndex];
+        frame.cpuSubmitTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        frame.pending = frame.queryCount > 0;
+        gpuProfilerRecording = false;
+    }
+}
+
+void GraphicsAPI_Vulkan::WaitForIdle()
+{
+    VULKAN_CHECK(vkDeviceWaitIdle(device), "Failed to wait for Device to be idle.");
+    completedValue = submittedValue;
+    DestroyRetiredObjects();
+}
+
+uint64_t GraphicsAPI_Vulkan::GetCompletedValue()
+{
+    if (completedValue == submittedValue)
+    {
+        return completedValue;
+    }
+
+    if (timelineSemaphoreSupported)
+    {
+        uint64_t value = 0;
+        VULKAN_CHECK(getSemaphoreCounterValue(device, timelineSemaphore, &value), "Failed to get timeline Semaphore value.");
+        completedValue = std::max(completedValue, value);
+    }
+    else
+    {
+        // Each frame in flight has its fence; values are complete up to the oldest submission still running
+        uint64_t value = submittedValue;
+        for (const FrameContext &frame : frameContexts)
+        {
+            if (frame.submittedValue > completedValue && vkGetFenceStatus(device, frame.fence) != VK_SUCCESS)
+            {
+                value = std::min(value, frame.submittedValue - 1);
+            }
+        }
+        completedValue = std::max(completedValue, value);
+    }
+    return completedValue;
+}
+
+bool GraphicsAPI_Vulkan::WaitForValue(uint64_t value, uint64_t timeoutNs)
+{
+    if (value <= completedValue)
+    {
+        return true;
+    }
+    if (value > submittedValue)
+    {
+        // Nothing would ever signal it
+        std::cerr << "ERROR: VULKAN: Waiting for timeline value " << value << " that was never submitted." << std::endl;
+        return false;
+    }
+
+    VkResult result = VK_SUCCESS;
+    if (timelineSemaphoreSupported)
+    {
+        VkSemaphoreWaitInfo waitInfo{};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.pNext = nullptr;
+        waitInfo.flags = 0;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &timelineSemaphore;
+        waitInfo.pValues = &value;
+        result = waitSemaphores(device, &waitInfo, timeoutNs);
+    }
+    else
+    {
+        // Every submission after completedValue is still in one of the frame contexts
+        std::vector<VkFence> fences;
+        for (const FrameContext &frame : frameContexts)
+        {
+            if (frame.submittedValue > completedValue && frame.submittedValue <= value)
+            {
+                fences.push_back(frame.fence);
+            }
+        }
+        if (!fences.empty())
+        {
+            result = vkWaitForFences(device, static_cast<uint32_t>(fences.size()), fences.data(), true, timeoutNs);
+        }
+    }
+    if (result == VK_TIMEOUT)
+    {
+        return false;
+    }
+    VULKAN_CHECK(result, "Failed to wait for timeline value.");
+    completedValue = value;
+    return true;
+}
 
-    VULKAN_CHECK(vkQueueSubmit(queue, 1, &submitInfo, fence), "Failed to submit to Queue.");
+bool GraphicsAPI_Vulkan::IsVertexTypeSupported(VertexType type)
+{
+    const VkFormat format = ToVkFormat(type);
+    if (format == VK_FORMAT_UNDEFINED)
+        return false;
+
+    // A2B10G10R10_SNORM in particular is optional for vertex buffers
+    VkFormatProperties formatProperties{};
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
+    return (formatProperties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT) != 0;
 }
 
 void GraphicsAPI_Vulkan::SetBufferData(void *buffer, size_t offset, size_t size, void *data)
@@ -971,6 +1396,14 @@ void GraphicsAPI_Vulkan::SetBufferData(void *buffer, size_t offset, size_t size,
 
 void GraphicsAPI_Vulkan::ClearColor(void *imageView, float r, float g, float b, float a)
 {
+    VkClearAttachment clear{};
+    clear.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    clear.clearValue.color = {{r, g, b, a}};
+    if (ClearPassAttachment(imageView, clear))
+    {
+        return;
+    }
+
     const ImageViewCreateInfo &imageViewCI = imageViewResources[(VkImageView)imageView];
 
     VkClearColorValue clearColor;
@@ -1018,6 +1451,14 @@ void GraphicsAPI_Vulkan::ClearColor(void *imageView, float r, float g, float b,
 
 void GraphicsAPI_Vulkan::ClearDepth(void *imageView, float d)
 {
+    VkClearAttachment clear{};
+    clear.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+    clear.clearValue.depthStencil = {d, 0};
+    if (ClearPassAttachment(imageView, clear))
+    {
+        return;
+    }
+
     const ImageViewCreateInfo &imageViewCI = imageViewResources[(VkImageView)imageView];
 
     VkClearDepthStencilValue clearDepth;
@@ -1064,21 +1505,56 @@ void GraphicsAPI_Vulkan::ClearDepth(void *imageView, float d)
 void GraphicsAPI_Vulkan::SetRenderAttachments(void **colorViews, size_t colorViewCount, void *depthStencilView, uint32_t width, uint32_t height,
                                               void *pipeline)
 {
+    const auto &pipelineResource = pipelineResources.at((VkPipeline)pipeline);
+    VkRenderPass renderPass = std::get<2>(pipelineResource);
+
+    // Same order as the attachment descriptions of CreatePipeline
+    std::vector<void *> attachments(colorViews, colorViews + colorViewCount);
+    if (depthStencilView)
+    {
+        attachments.push_back(depthStencilView);
+    }
+    const size_t clearableAttachmentCount = attachments.size();
+    if (std::get<3>(pipelineResource).multisampleState.rasterisationSamples > 1)
+    {
+        if (resolveAttachments.size() != colorViewCount)
+        {
+            std::cerr << "ERROR: VULKAN: A multisampled pipeline needs one resolve attachment per color attachment." << std::endl;
+        }
+        attachments.insert(attachments.end(), resolveAttachments.begin(), resolveAttachments.end());
+    }
+
+    if (threadRecordingContext)
+    {
+        SetChunkRenderAttachments(std::move(attachments), clearableAttachmentCount, width, height, pipeline);
+        return;
+    }
+
+    if (std::find_if(attachments.begin(), attachments.end(), [this](void *attachment) { return FindDeferredRenderTarget(attachment) != nullptr; }) !=
+        attachments.end())
+    {
+        BeginDeferredPass(std::move(attachments), clearableAttachmentCount, width, height, pipeline);
+        return;
+    }
+    EndDeferredPass();
+
     if (inRenderPass)
     {
         vkCmdEndRenderPass(cmdBuffer);
     }
 
-    VkRenderPass renderPass = std::get<2>(pipelineResources[(VkPipeline)pipeline]);
-
     std::vector<VkImageView> vkImageViews;
-    for (size_t i = 0; i < colorViewCount; i++)
+    for (void *attachment : attachments)
     {
-        vkImageViews.push_back((VkImageView)colorViews[i]);
+        vkImageViews.push_back((VkImageView)attachment);
     }
-    if (depthStencilView)
+    if (std::get<3>(pipelineResource).fragmentDensityMap && fragmentDensityMapSupported)
     {
-        vkImageViews.push_back((VkImageView)depthStencilView);
+        if (currentFragmentDensityMap == VK_NULL_HANDLE)
+        {
+            std::cerr << "ERROR: VULKAN: The pipeline reads a fragment density map, but none is set." << std::endl;
+        }
+        vkImageViews.push_back(currentFragmentDensityMap);
     }
 
     VkFramebuffer framebuffer{};
@@ -1107,6 +1583,12 @@ void GraphicsAPI_Vulkan::SetRenderAttachments(void **colorViews, size_t colorVie
     renderPassBegin.pClearValues = nullptr;
     vkCmdBeginRenderPass(cmdBuffer, &renderPassBegin, VK_SUBPASS_CONTENTS_INLINE);
     inRenderPass = true;
+    ApplyPendingClears(cmdBuffer, attachments, clearableAttachmentCount, width, height);
+}
+
+void GraphicsAPI_Vulkan::SetResolveAttachments(void **resolveViews, size_t count)
+{
+    resolveAttachments.assign(resolveViews, resolveViews + count);
 }
 
 void GraphicsAPI_Vulkan::SetViewports(Viewport *viewports, size_t count)
@@ -1119,7 +1601,7 @@ void GraphicsAPI_Vulkan::SetViewports(Viewport *viewports, size_t count)
         vkViewports.push_back({viewport.x, viewport.y, viewport.width, viewport.height, viewport.minDepth, viewport.maxDepth});
     }
 
-    vkCmdSetViewport(cmdBuffer, 0, static_cast<uint32_t>(vkViewports.size()), vkViewports.data());
+    vkCmdSetViewport(GetRecordingState().cmdBuffer, 0, static_cast<uint32_t>(vkViewports.size()), vkViewports.data());
 }
 void GraphicsAPI_Vulkan::SetScissors(Rect2D *scissors, size_t count)
 {
@@ -1131,16 +1613,18 @@ void GraphicsAPI_Vulkan::SetScissors(Rect2D *scissors, size_t count)
         vkRect2D.push_back({{scissor.offset.x, scissor.offset.y}, {scissor.extent.width, scissor.extent.height}});
     }
 
-    vkCmdSetScissor(cmdBuffer, 0, static_cast<uint32_t>(vkRect2D.size()), vkRect2D.data());
+    vkCmdSetScissor(GetRecordingState().cmdBuffer, 0, static_cast<uint32_t>(vkRect2D.size()), vkRect2D.data());
 }
 void GraphicsAPI_Vulkan::SetPipeline(void *pipeline)
 {
-    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, (VkPipeline)pipeline);
-    setPipeline = (VkPipeline)pipeline;
+    RecordingState &state = GetRecordingState();
+    vkCmdBindPipeline(state.cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, (VkPipeline)pipeline);
+    state.pipeline = (VkPipeline)pipeline;
 }
 
 void GraphicsAPI_Vulkan::SetDescriptor(const DescriptorInfo &descriptorInfo)
 {
+    std::vector<std::tuple<VkWriteDescriptorSet, VkDescriptorBufferInfo, VkDescriptorImageInfo>> &writeDescSets = GetRecordingState().writeDescSets;
     VkWriteDescriptorSet writeDescSet;
     writeDescSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     writeDescSet.pNext = nullptr;
@@ -1158,7 +1642,7 @@ void GraphicsAPI_Vulkan::SetDescriptor(const DescriptorInfo &descriptorInfo)
     {
         VkDescriptorBufferInfo &descBufferInfo = std::get<1>(writeDescSets.back());
         VkBuffer buffer = (VkBuffer)descriptorInfo.resource;
-        const BufferCreateInfo &bufferCI = bufferResources[buffer].second;
+        MarkBufferUsed(buffer);
         descBufferInfo.buffer = buffer;
         descBufferInfo.offset = descriptorInfo.bufferOffset;
         descBufferInfo.range = descriptorInfo.bufferSize;
@@ -1189,21 +1673,23 @@ void GraphicsAPI_Vulkan::SetDescriptor(const DescriptorInfo &descriptorInfo)
 
 void GraphicsAPI_Vulkan::UpdateDescriptors()
 {
-    VkPipelineLayout pipelineLayout = std::get<0>(pipelineResources[(VkPipeline)setPipeline]);
-    VkDescriptorSetLayout descSetLayout = std::get<1>(pipelineResources[(VkPipeline)setPipeline]);
-    PipelineCreateInfo pipelinCI = std::get<3>(pipelineResources[(VkPipeline)setPipeline]);
+    // Recording threads only read the resource maps, so they are searched rather than indexed
+    RecordingState &state = GetRecordingState();
+    const auto &pipelineResource = pipelineResources.at(state.pipeline);
+    VkPipelineLayout pipelineLayout = std::get<0>(pipelineResource);
+    VkDescriptorSetLayout descSetLayout = std::get<1>(pipelineResource);
 
     VkDescriptorSet descSet{};
     VkDescriptorSetAllocateInfo descSetAI;
     descSetAI.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     descSetAI.pNext = nullptr;
-    descSetAI.descriptorPool = descriptorPool;
+    descSetAI.descriptorPool = threadRecordingContext ? threadRecordingContext->descriptorPool : descriptorPool;
     descSetAI.descriptorSetCount = 1;
     descSetAI.pSetLayouts = &descSetLayout;
     VULKAN_CHECK(vkAllocateDescriptorSets(device, &descSetAI, &descSet), "Failed to allocate DescriptorSet.");
 
     std::vector<VkWriteDescriptorSet> vkWriteDescSets;
-    for (auto &writeDescSet : writeDescSets)
+    for (auto &writeDescSet : state.writeDescSets)
     {
         VkWriteDescriptorSet &vkWriteDescSet = std::get<0>(writeDescSet);
         VkDescriptorBufferInfo &vkDescBufferInfo = std::get<1>(writeDescSet);
@@ -1225,40 +1711,865 @@ void GraphicsAPI_Vulkan::UpdateDescriptors()
         vkWriteDescSets.push_back(vkWriteDescSet);
     }
     vkUpdateDescriptorSets(device, static_cast<uint32_t>(vkWriteDescSets.size()), vkWriteDescSets.data(), 0, nullptr);
-    writeDescSets.clear();
+    state.writeDescSets.clear();
 
-    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descSet, 0, nullptr);
-    cmdBufferDescriptorSets[cmdBuffer].push_back({descSet});
+    vkCmdBindDescriptorSets(state.cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descSet, 0, nullptr);
+    if (!threadRecordingContext)
+    {
+        cmdBufferDescriptorSets[cmdBuffer].push_back({descSet});
+    }
 }
 
 void GraphicsAPI_Vulkan::SetVertexBuffers(void **vertexBuffers, size_t count)
 {
+    // Meshes sharing an arena bind it once per command buffer
+    RecordingState &state = GetRecordingState();
+    if (count == 1 && (VkBuffer)vertexBuffers[0] == state.boundVertexBuffer)
+    {
+        return;
+    }
+    state.boundVertexBuffer = count == 1 ? (VkBuffer)vertexBuffers[0] : VK_NULL_HANDLE;
+
     std::vector<VkBuffer> vkBuffers;
     std::vector<VkDeviceSize> offsets;
     for (size_t i = 0; i < count; i++)
     {
+        MarkBufferUsed((VkBuffer)vertexBuffers[i]);
         vkBuffers.push_back((VkBuffer)vertexBuffers[i]);
         offsets.push_back(0);
     }
 
-    vkCmdBindVertexBuffers(cmdBuffer, 0, static_cast<uint32_t>(vkBuffers.size()), vkBuffers.data(), offsets.data());
+    vkCmdBindVertexBuffers(state.cmdBuffer, 0, static_cast<uint32_t>(vkBuffers.size()), vkBuffers.data(), offsets.data());
 }
 
 void GraphicsAPI_Vulkan::SetIndexBuffer(void *indexBuffer)
 {
-    const BufferCreateInfo &bufferCI = bufferResources[(VkBuffer)indexBuffer].second;
+    RecordingState &state = GetRecordingState();
+    if ((VkBuffer)indexBuffer == state.boundIndexBuffer)
+    {
+        return;
+    }
+    state.boundIndexBuffer = (VkBuffer)indexBuffer;
+    MarkBufferUsed((VkBuffer)indexBuffer);
+
+    const BufferCreateInfo &bufferCI = bufferResources.at((VkBuffer)indexBuffer).second;
     VkIndexType type = bufferCI.stride == 4 ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
-    vkCmdBindIndexBuffer(cmdBuffer, (VkBuffer)indexBuffer, 0, type);
+    vkCmdBindIndexBuffer(state.cmdBuffer, (VkBuffer)indexBuffer, 0, type);
 }
 
 void GraphicsAPI_Vulkan::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
 {
-    vkCmdDrawIndexed(cmdBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+    vkCmdDrawIndexed(GetRecordingState().cmdBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
 
 void GraphicsAPI_Vulkan::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
 {
-    vkCmdDraw(cmdBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+    vkCmdDraw(GetRecordingState().cmdBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+}
+
+void GraphicsAPI_Vulkan::BeginGpuScope(const char *name)
+{
+    // The scope stack belongs to the main thread, recording threads are covered by the scope around the chunks
+    if (!gpuProfilerRecording || threadRecordingContext)
+    {
+        return;
+    }
+
+    // Keep room for the end timestamp of every open scope; scopes that don't fit are skipped
+    GpuProfilerFrame &frame = gpuProfilerFrames[gpuProfilerFrameIndex];
+    if (frame.queryCount + gpuScopeStack.size() + 2 > gpuProfilerMaxQueries)
+    {
+        gpuScopeStack.push_back(UINT32_MAX);
+        return;
+    }
+
+    vkCmdWriteTimestamp(mainRecordingState.cmdBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame.queryPool, frame.queryCount);
+    frame.scopes.push_back({name, frame.queryCount++, UINT32_MAX, static_cast<uint32_t>(gpuScopeStack.size())});
+    gpuScopeStack.push_back(static_cast<uint32_t>(frame.scopes.size() - 1));
+}
+
+void GraphicsAPI_Vulkan::EndGpuScope()
+{
+    if (!gpuProfilerRecording || threadRecordingContext || gpuScopeStack.empty())
+    {
+        return;
+    }
+
+    const uint32_t scopeIndex = gpuScopeStack.back();
+    gpuScopeStack.pop_back();
+    if (scopeIndex == UINT32_MAX)
+    {
+        return;
+    }
+
+    GpuProfilerFrame &frame = gpuProfilerFrames[gpuProfilerFrameIndex];
+    vkCmdWriteTimestamp(mainRecordingState.cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame.queryPool, frame.queryCount);
+    frame.scopes[scopeIndex].endQuery = frame.queryCount++;
+}
+
+void GraphicsAPI_Vulkan::ResolveGpuScopes(std::vector<GpuScopeTiming> &timings)
+{
+    timings.insert(timings.end(), std::make_move_iterator(resolvedGpuScopes.begin()), std::make_move_iterator(resolvedGpuScopes.end()));
+    resolvedGpuScopes.clear();
+}
+
+void GraphicsAPI_Vulkan::ReadGpuProfilerFrame(GpuProfilerFrame &frame)
+{
+    frame.pending = false;
+
+    std::vector<uint64_t> timestamps(frame.queryCount);
+    VkResult result = vkGetQueryPoolResults(device, frame.queryPool, 0, frame.queryCount, timestamps.size() * sizeof(uint64_t), timestamps.data(),
+                                            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS)
+    {
+        // Never wait for the results; a frame that isn't available yet is dropped
+        return;
+    }
+
+    const uint64_t baseTimestamp = timestamps[0];
+    for (const GpuProfilerScope &scope : frame.scopes)
+    {
+        if (scope.endQuery == UINT32_MAX)
+        {
+            continue;
+        }
+
+        GpuScopeTiming timing;
+        timing.name = scope.name;
+        timing.submissionIndex = frame.submissionIndex;
+        timing.cpuSubmitTime = frame.cpuSubmitTime;
+        timing.beginTime = static_cast<uint64_t>(static_cast<double>((timestamps[scope.beginQuery] - baseTimestamp) & timestampMask) * timestampPeriod);
+        timing.endTime = static_cast<uint64_t>(static_cast<double>((timestamps[scope.endQuery] - baseTimestamp) & timestampMask) * timestampPeriod);
+        timing.depth = scope.depth;
+        resolvedGpuScopes.push_back(timing);
+    }
+
+    if (resolvedGpuScopes.size() > gpuProfilerMaxResolvedScopes)
+    {
+        resolvedGpuScopes.erase(resolvedGpuScopes.begin(), resolvedGpuScopes.end() - gpuProfilerMaxResolvedScopes);
+    }
+}
+
+void GraphicsAPI_Vulkan::Retire(std::function<void()> &&destroy)
+{
+    Retire(recordingFrame ? submittedValue + 1 : submittedValue, std::move(destroy));
+}
+
+void GraphicsAPI_Vulkan::Retire(uint64_t value, std::function<void()> &&destroy)
+{
+    // The queue is drained front to back, an object behind a later value only waits a little longer
+    if (retiredObjects.empty() && value <= GetCompletedValue())
+    {
+        destroy();
+        return;
+    }
+    retiredObjects.push_back({value, std::move(destroy)});
+}
+
+void GraphicsAPI_Vulkan::DestroyRetiredObjects()
+{
+    const uint64_t value = GetCompletedValue();
+    while (!retiredObjects.empty() && retiredObjects.front().value <= value)
+    {
+        // Moved out first, destroying can retire more objects
+        std::function<void()> destroy = std::move(retiredObjects.front().destroy);
+        retiredObjects.pop_front();
+        destroy();
+    }
+}
+
+void GraphicsAPI_Vulkan::MarkBufferUsed(VkBuffer buffer)
+{
+    if (threadRecordingContext)
+    {
+        threadRecordingContext->usedBuffers.push_back(buffer);
+        return;
+    }
+    bufferUseValues[buffer] = GetRecordingValue();
+}
+
+bool GraphicsAPI_Vulkan::IsDeviceExtensionAvailable(const char *extensionName)
+{
+    uint32_t extensionCount = 0;
+    VULKAN_CHECK(vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr), "Failed to enumerate Device Extensions.");
+    std::vector<VkExtensionProperties> extensionProperties(extensionCount);
+    VULKAN_CHECK(vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, extensionProperties.data()),
+                 "Failed to enumerate Device Extensions.");
+    return std::any_of(extensionProperties.begin(), extensionProperties.end(), [extensionName](const VkExtensionProperties &extension)
+                       { return strcmp(extension.extensionName, extensionName) == 0; });
+}
+
+void GraphicsAPI_Vulkan::CheckFragmentDensityMapSupport(uint32_t apiVersion, std::vector<const char *> &deviceExtensions)
+{
+    // The features and texel size can only be queried through the Vulkan 1.1 entry points
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+    if (apiVersion < VK_API_VERSION_1_1 || physicalDeviceProperties.apiVersion < VK_API_VERSION_1_1)
+    {
+        return;
+    }
+
+    if (!IsDeviceExtensionAvailable(VK_EXT_FRAGMENT_DENSITY_MAP_EXTENSION_NAME))
+    {
+        return;
+    }
+
+    // Swapchain images aren't subsampled, so the density map must work with regular attachments
+    fragmentDensityMapFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_DENSITY_MAP_FEATURES_EXT;
+    VkPhysicalDeviceFeatures2 features2{};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &fragmentDensityMapFeatures;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+    if (!fragmentDensityMapFeatures.fragmentDensityMap || !fragmentDensityMapFeatures.fragmentDensityMapNonSubsampledImages)
+    {
+        return;
+    }
+    fragmentDensityMapFeatures.pNext = nullptr;
+    fragmentDensityMapFeatures.fragmentDensityMapDynamic = VK_FALSE;
+
+    // A map must cover the framebuffer at the largest texel size, so that's the size maps are laid out with
+    VkPhysicalDeviceFragmentDensityMapPropertiesEXT fragmentDensityMapProperties{};
+    fragmentDensityMapProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FRAGMENT_DENSITY_MAP_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2 properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &fragmentDensityMapProperties;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+    fragmentDensityTexelSize = {fragmentDensityMapProperties.maxFragmentDensityTexelSize.width,
+                                fragmentDensityMapProperties.maxFragmentDensityTexelSize.height};
+
+    if (std::find_if(deviceExtensions.begin(), deviceExtensions.end(), [](const char *extension)
+                     { return strcmp(extension, VK_EXT_FRAGMENT_DENSITY_MAP_EXTENSION_NAME) == 0; }) == deviceExtensions.end())
+    {
+        deviceExtensions.push_back(VK_EXT_FRAGMENT_DENSITY_MAP_EXTENSION_NAME);
+    }
+    fragmentDensityMapSupported = true;
+}
+
+void GraphicsAPI_Vulkan::CheckTimelineSemaphoreSupport(uint32_t apiVersion, std::vector<const char *> &deviceExtensions)
+{
+    // Core in Vulkan 1.2; before that the extension needs the 1.1 entry points to query its feature
+    VkPhysicalDeviceProperties physicalDeviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+    if (apiVersion < VK_API_VERSION_1_1 || physicalDeviceProperties.apiVersion < VK_API_VERSION_1_1)
+    {
+        return;
+    }
+    timelineSemaphoreCore = apiVersion >= VK_API_VERSION_1_2 && physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_2;
+    if (!timelineSemaphoreCore && !IsDeviceExtensionAvailable(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME))
+    {
+        return;
+    }
+
+    timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+    VkPhysicalDeviceFeatures2 features2{};
+    features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features2.pNext = &timelineSemaphoreFeatures;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+    if (!timelineSemaphoreFeatures.timelineSemaphore)
+    {
+        return;
+    }
+    timelineSemaphoreFeatures.pNext = nullptr;
+
+    if (!timelineSemaphoreCore && std::find_if(deviceExtensions.begin(), deviceExtensions.end(), [](const char *extension)
+                                               { return strcmp(extension, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME) == 0; }) == deviceExtensions.end())
+    {
+        deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+    }
+    timelineSemaphoreSupported = true;
+}
+
+void *GraphicsAPI_Vulkan::CreateFragmentDensityMap(uint32_t width, uint32_t height)
+{
+    if (!fragmentDensityMapSupported)
+    {
+        return nullptr;
+    }
+
+    FragmentDensityMap densityMap;
+    densityMap.width = width;
+    densityMap.height = height;
+
+    VkImageCreateInfo vkImageCI{};
+    vkImageCI.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    vkImageCI.imageType = VK_IMAGE_TYPE_2D;
+    vkImageCI.format = VK_FORMAT_R8G8_UNORM;
+    vkImageCI.extent = {width, height, 1};
+    vkImageCI.mipLevels = 1;
+    vkImageCI.arrayLayers = 1;
+    vkImageCI.samples = VK_SAMPLE_COUNT_1_BIT;
+    vkImageCI.tiling = VK_IMAGE_TILING_OPTIMAL;
+    vkImageCI.usage = VK_IMAGE_USAGE_FRAGMENT_DENSITY_MAP_BIT_EXT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    vkImageCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    vkImageCI.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    VULKAN_CHECK(vkCreateImage(device, &vkImageCI, nullptr, &densityMap.image), "Failed to create fragment density map Image.");
+
+    VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties{};
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &physicalDeviceMemoryProperties);
+
+    VkMemoryRequirements memoryRequirements{};
+    vkGetImageMemoryRequirements(device, densityMap.image, &memoryRequirements);
+    VkMemoryAllocateInfo allocateInfo{};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize = memoryRequirements.size;
+    MemoryTypeFromProperties(physicalDeviceMemoryProperties, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                             &allocateInfo.memoryTypeIndex);
+    VULKAN_CHECK(vkAllocateMemory(device, &allocateInfo, nullptr, &densityMap.memory), "Failed to allocate Memory.");
+    VULKAN_CHECK(vkBindImageMemory(device, densityMap.image, densityMap.memory, 0), "Failed to bind Memory to Image.");
+
+    const VkDeviceSize dataSize = static_cast<VkDeviceSize>(width) * height * 2;
+    VkBufferCreateInfo stagingBufferCI{};
+    stagingBufferCI.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    stagingBufferCI.size = dataSize;
+    stagingBufferCI.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    stagingBufferCI.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VULKAN_CHECK(vkCreateBuffer(device, &stagingBufferCI, nullptr, &densityMap.stagingBuffer), "Failed to create fragment density map staging Buffer.");
+
+    vkGetBufferMemoryRequirements(device, densityMap.stagingBuffer, &memoryRequirements);
+    allocateInfo.allocationSize = memoryRequirements.size;
+    MemoryTypeFromProperties(physicalDeviceMemoryProperties, memoryRequirements.memoryTypeBits,
+                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &allocateInfo.memoryTypeIndex);
+    VULKAN_CHECK(vkAllocateMemory(device, &allocateInfo, nullptr, &densityMap.stagingMemory), "Failed to allocate Memory.");
+    VULKAN_CHECK(vkBindBufferMemory(device, densityMap.stagingBuffer, densityMap.stagingMemory, 0), "Failed to bind Memory to Buffer.");
+
+    void *mappedData = nullptr;
+    VULKAN_CHECK(vkMapMemory(device, densityMap.stagingMemory, 0, dataSize, 0, &mappedData), "Can not map Buffer.");
+    if (mappedData)
+    {
+        memset(mappedData, 0xFF, static_cast<size_t>(dataSize));
+    }
+    vkUnmapMemory(device, densityMap.stagingMemory);
+
+    imageStates[densityMap.image] = VK_IMAGE_LAYOUT_UNDEFINED;
+    VkImageView imageView = (VkImageView)CreateFragmentDensityMapView((void *)densityMap.image);
+    fragmentDensityMaps[imageView] = densityMap;
+    return (void *)imageView;
+}
+
+void GraphicsAPI_Vulkan::DestroyFragmentDensityMap(void *&densityMapView)
+{
+    auto it = fragmentDensityMaps.find((VkImageView)densityMapView);
+    if (it == fragmentDensityMaps.end())
+    {
+        return;
+    }
+
+    const FragmentDensityMap densityMap = it->second;
+    fragmentDensityMaps.erase(it);
+
+    if (currentFragmentDensityMap == (VkImageView)densityMapView)
+    {
+        currentFragmentDensityMap = VK_NULL_HANDLE;
+    }
+    DestroyImageView(densityMapView);
+    Retire([this, densityMap]()
+           {
+               vkDestroyBuffer(device, densityMap.stagingBuffer, nullptr);
+               vkFreeMemory(device, densityMap.stagingMemory, nullptr);
+               vkDestroyImage(device, densityMap.image, nullptr);
+               vkFreeMemory(device, densityMap.memory, nullptr);
+               imageStates.erase(densityMap.image); });
+}
+
+void GraphicsAPI_Vulkan::SetFragmentDensityMapData(void *densityMapView, const void *data)
+{
+    auto it = fragmentDensityMaps.find((VkImageView)densityMapView);
+    if (it == fragmentDensityMaps.end())
+    {
+        return;
+    }
+
+    // A frame still in flight may be copying from the staging buffer. A second upload in the frame being recorded
+    // can overwrite it, both copies then write the new contents.
+    FragmentDensityMap &densityMap = it->second;
+    if (densityMap.uploadValue <= submittedValue)
+    {
+        WaitForValue(densityMap.uploadValue);
+    }
+    const VkDeviceSize dataSize = static_cast<VkDeviceSize>(densityMap.width) * densityMap.height * 2;
+    void *mappedData = nullptr;
+    VULKAN_CHECK(vkMapMemory(device, densityMap.stagingMemory, 0, dataSize, 0, &mappedData), "Can not map Buffer.");
+    if (mappedData && data)
+    {
+        memcpy(mappedData, data, static_cast<size_t>(dataSize));
+    }
+    vkUnmapMemory(device, densityMap.stagingMemory);
+
+    UploadFragmentDensityMap(densityMap);
+}
+
+void *GraphicsAPI_Vulkan::CreateFragmentDensityMapView(void *image)
+{
+    ImageViewCreateInfo imageViewCI;
+    imageViewCI.image = image;
+    imageViewCI.type = ImageViewCreateInfo::Type::SRV;
+    imageViewCI.view = ImageViewCreateInfo::View::TYPE_2D;
+    imageViewCI.format = VK_FORMAT_R8G8_UNORM;
+    imageViewCI.aspect = ImageViewCreateInfo::Aspect::COLOR_BIT;
+    imageViewCI.baseMipLevel = 0;
+    imageViewCI.levelCount = 1;
+    imageViewCI.baseArrayLayer = 0;
+    imageViewCI.layerCount = 1;
+    return CreateImageView(imageViewCI);
+}
+
+void GraphicsAPI_Vulkan::SetFragmentDensityMap(void *densityMapView)
+{
+    currentFragmentDensityMap = (VkImageView)densityMapView;
+
+    // A new map has never been uploaded, its staging buffer holds the initial full density contents.
+    // Views of maps owned by the runtime aren't in fragmentDensityMaps and are left as they are.
+    auto it = fragmentDensityMaps.find(currentFragmentDensityMap);
+    if (it != fragmentDensityMaps.end() && imageStates[it->second.image] == VK_IMAGE_LAYOUT_UNDEFINED)
+    {
+        UploadFragmentDensityMap(it->second);
+    }
+}
+
+void GraphicsAPI_Vulkan::UploadFragmentDensityMap(FragmentDensityMap &densityMap)
+{
+    if (inRenderPass)
+    {
+        vkCmdEndRenderPass(cmdBuffer);
+        inRenderPass = false;
+    }
+
+    VkImageMemoryBarrier imageBarrier{};
+    imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    imageBarrier.srcAccessMask = VkAccessFlagBits(0);
+    imageBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageBarrier.oldLayout = imageStates[densityMap.image];
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    imageBarrier.image = densityMap.image;
+    imageBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_FRAGMENT_DENSITY_PROCESS_BIT_EXT, VK_PIPELINE_STAGE_TRANSFER_BIT, VkDependencyFlagBits(0), 0,
+                         nullptr, 0, nullptr, 1, &imageBarrier);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = {densityMap.width, densityMap.height, 1};
+    vkCmdCopyBufferToImage(cmdBuffer, densityMap.stagingBuffer, densityMap.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    densityMap.uploadValue = GetRecordingValue();
+
+    imageBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    imageBarrier.dstAccessMask = VK_ACCESS_FRAGMENT_DENSITY_MAP_READ_BIT_EXT;
+    imageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    imageBarrier.newLayout = VK_IMAGE_LAYOUT_FRAGMENT_DENSITY_MAP_OPTIMAL_EXT;
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_DENSITY_PROCESS_BIT_EXT, VkDependencyFlagBits(0), 0,
+                         nullptr, 0, nullptr, 1, &imageBarrier);
+    imageStates[densityMap.image] = VK_IMAGE_LAYOUT_FRAGMENT_DENSITY_MAP_OPTIMAL_EXT;
+}
+
+void *GraphicsAPI_Vulkan::CreateDeferredRenderTarget()
+{
+    std::unique_ptr<DeferredRenderTarget> renderTarget = std::make_unique<DeferredRenderTarget>();
+    void *handle = renderTarget.get();
+    deferredRenderTargets[handle] = std::move(renderTarget);
+    return handle;
+}
+
+void GraphicsAPI_Vulkan::DestroyDeferredRenderTarget(void *&renderTarget)
+{
+    deferredRenderTargets.erase(renderTarget);
+    renderTarget = nullptr;
+}
+
+void GraphicsAPI_Vulkan::BindDeferredRenderTarget(void *renderTarget, void *imageView)
+{
+    DeferredRenderTarget *deferredRenderTarget = FindDeferredRenderTarget(renderTarget);
+    if (!deferredRenderTarget)
+    {
+        std::cerr << "ERROR: VULKAN: Binding an unknown deferred render target." << std::endl;
+        return;
+    }
+    deferredRenderTarget->boundView = (VkImageView)imageView;
+}
+
+void GraphicsAPI_Vulkan::ResolveDeferredRenderTargets()
+{
+    EndDeferredPass();
+    ExecuteDeferredPasses();
+
+    // Targets cleared after their last pass, or never drawn to, are cleared like any other image. Transient images
+    // have nothing to keep outside of a pass, so their leftover clears are dropped.
+    std::vector<std::pair<VkImageView, VkClearAttachment>> leftoverClears;
+    for (const auto &pendingClear : pendingAttachmentClears)
+    {
+        const DeferredRenderTarget *renderTarget = FindDeferredRenderTarget(pendingClear.first);
+        if (renderTarget && renderTarget->boundView)
+        {
+            leftoverClears.push_back({renderTarget->boundView, pendingClear.second});
+        }
+    }
+    pendingAttachmentClears.clear();
+    for (const auto &leftoverClear : leftoverClears)
+    {
+        const VkClearValue &clearValue = leftoverClear.second.clearValue;
+        if (leftoverClear.second.aspectMask == VK_IMAGE_ASPECT_COLOR_BIT)
+        {
+            ClearColor(leftoverClear.first, clearValue.color.float32[0], clearValue.color.float32[1], clearValue.color.float32[2],
+                       clearValue.color.float32[3]);
+        }
+        else
+        {
+            ClearDepth(leftoverClear.first, clearValue.depthStencil.depth);
+        }
+    }
+
+    for (auto &deferredRenderTarget : deferredRenderTargets)
+    {
+        deferredRenderTarget.second->boundView = VK_NULL_HANDLE;
+    }
+}
+
+void GraphicsAPI_Vulkan::ExecuteDeferredPasses()
+{
+    if (inRenderPass)
+    {
+        vkCmdEndRenderPass(cmdBuffer);
+        inRenderPass = false;
+    }
+
+    for (const DeferredPass &pass : deferredPasses)
+    {
+        std::vector<VkImageView> vkImageViews;
+        for (void *attachment : pass.attachments)
+        {
+            const DeferredRenderTarget *renderTarget = FindDeferredRenderTarget(attachment);
+            vkImageViews.push_back(renderTarget ? renderTarget->boundView : (VkImageView)attachment);
+        }
+        if (std::find(vkImageViews.begin(), vkImageViews.end(), VK_NULL_HANDLE) != vkImageViews.end())
+        {
+            std::cerr << "ERROR: VULKAN: A deferred render target was resolved without a bound image view, its pass is dropped." << std::endl;
+            continue;
+        }
+        if (pass.fragmentDensityMap)
+        {
+            if (currentFragmentDensityMap == VK_NULL_HANDLE)
+            {
+                std::cerr << "ERROR: VULKAN: The pipeline reads a fragment density map, but none is set." << std::endl;
+                continue;
+            }
+            vkImageViews.push_back(currentFragmentDensityMap);
+        }
+
+        VkFramebuffer framebuffer{};
+        VkFramebufferCreateInfo framebufferCI{};
+        framebufferCI.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebufferCI.renderPass = pass.renderPass;
+        framebufferCI.attachmentCount = static_cast<uint32_t>(vkImageViews.size());
+        framebufferCI.pAttachments = vkImageViews.data();
+        framebufferCI.width = pass.width;
+        framebufferCI.height = pass.height;
+        framebufferCI.layers = 1;
+        VULKAN_CHECK(vkCreateFramebuffer(device, &framebufferCI, nullptr, &framebuffer), "Failed to create Framebuffer");
+        cmdBufferFramebuffers[cmdBuffer].push_back(framebuffer);
+
+        VkRenderPassBeginInfo renderPassBegin{};
+        renderPassBegin.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassBegin.renderPass = pass.renderPass;
+        renderPassBegin.framebuffer = framebuffer;
+        renderPassBegin.renderArea.offset = {0, 0};
+        renderPassBegin.renderArea.extent = {pass.width, pass.height};
+        vkCmdBeginRenderPass(cmdBuffer, &renderPassBegin, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        vkCmdExecuteCommands(cmdBuffer, static_cast<uint32_t>(pass.secondaryCmdBuffers.size()), pass.secondaryCmdBuffers.data());
+        vkCmdEndRenderPass(cmdBuffer);
+    }
+    deferredPasses.clear();
+}
+
+GraphicsAPI_Vulkan::DeferredRenderTarget *GraphicsAPI_Vulkan::FindDeferredRenderTarget(void *imageView)
+{
+    if (deferredRenderTargets.empty())
+    {
+        return nullptr;
+    }
+    auto it = deferredRenderTargets.find(imageView);
+    return it != deferredRenderTargets.end() ? it->second.get() : nullptr;
+}
+
+bool GraphicsAPI_Vulkan::IsLastDeferredPass(const std::vector<void *> &attachments, uint32_t width, uint32_t height, bool fragmentDensityMap) const
+{
+    if (deferredPasses.empty())
+    {
+        return false;
+    }
+    const DeferredPass &lastPass = deferredPasses.back();
+    return lastPass.attachments == attachments && lastPass.width == width && lastPass.height == height &&
+           lastPass.fragmentDensityMap == fragmentDensityMap;
+}
+
+void GraphicsAPI_Vulkan::BeginDeferredPass(std::vector<void *> &&attachments, size_t clearableAttachmentCount, uint32_t width, uint32_t height,
+                                           void *pipeline)
+{
+    if (inRenderPass)
+    {
+        vkCmdEndRenderPass(cmdBuffer);
+        inRenderPass = false;
+    }
+
+    const auto &pipelineResource = pipelineResources[(VkPipeline)pipeline];
+    const bool fragmentDensityMap = std::get<3>(pipelineResource).fragmentDensityMap && fragmentDensityMapSupported;
+
+    // Draws into the same attachments as the last pass go into it, in the open secondary command buffer or a new one
+    // after it; render passes made by CreatePipeline for the same attachment formats are compatible, so any of them
+    // can execute it
+    const bool continueLastPass = IsLastDeferredPass(attachments, width, height, fragmentDensityMap);
+    if (continueLastPass && deferredPassOpen)
+    {
+        return;
+    }
+    EndDeferredPass();
+
+    if (!continueLastPass)
+    {
+        DeferredPass pass;
+        pass.renderPass = std::get<2>(pipelineResource);
+        pass.attachments = std::move(attachments);
+        pass.clearableAttachmentCount = clearableAttachmentCount;
+        pass.width = width;
+        pass.height = height;
+        pass.fragmentDensityMap = fragmentDensityMap;
+        deferredPasses.push_back(std::move(pass));
+    }
+
+    DeferredPass &openPass = deferredPasses.back();
+    FrameContext &frame = GetFrameContext();
+    VkCommandBuffer secondaryCmdBuffer = BeginSecondaryCmdBuffer(cmdPool, frame.secondaryCmdBuffers, frame.secondaryCmdBuffersUsed, openPass.renderPass);
+    openPass.secondaryCmdBuffers.push_back(secondaryCmdBuffer);
+    mainRecordingState.cmdBuffer = secondaryCmdBuffer;
+    mainRecordingState.boundVertexBuffer = VK_NULL_HANDLE;
+    mainRecordingState.boundIndexBuffer = VK_NULL_HANDLE;
+    deferredPassOpen = true;
+
+    ApplyPendingClears(secondaryCmdBuffer, openPass.attachments, openPass.clearableAttachmentCount, width, height);
+}
+
+void GraphicsAPI_Vulkan::EndDeferredPass()
+{
+    if (!deferredPassOpen)
+    {
+        return;
+    }
+    VULKAN_CHECK(vkEndCommandBuffer(mainRecordingState.cmdBuffer), "Failed to end secondary CommandBuffer.");
+    mainRecordingState.cmdBuffer = cmdBuffer;
+    mainRecordingState.boundVertexBuffer = VK_NULL_HANDLE;
+    mainRecordingState.boundIndexBuffer = VK_NULL_HANDLE;
+    deferredPassOpen = false;
+}
+
+VkCommandBuffer GraphicsAPI_Vulkan::BeginSecondaryCmdBuffer(VkCommandPool pool, std::vector<VkCommandBuffer> &cmdBuffers, size_t &cmdBuffersUsed,
+                                                            VkRenderPass renderPass)
+{
+    if (cmdBuffersUsed == cmdBuffers.size())
+    {
+        VkCommandBufferAllocateInfo cmdBufferAI{};
+        cmdBufferAI.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cmdBufferAI.commandPool = pool;
+        cmdBufferAI.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        cmdBufferAI.commandBufferCount = 1;
+        VkCommandBuffer secondaryCmdBuffer = VK_NULL_HANDLE;
+        VULKAN_CHECK(vkAllocateCommandBuffers(device, &cmdBufferAI, &secondaryCmdBuffer), "Failed to allocate secondary CommandBuffer");
+        cmdBuffers.push_back(secondaryCmdBuffer);
+    }
+    VkCommandBuffer secondaryCmdBuffer = cmdBuffers[cmdBuffersUsed++];
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = renderPass;
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = VK_NULL_HANDLE;  // Not known until the targets are bound
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+    VULKAN_CHECK(vkBeginCommandBuffer(secondaryCmdBuffer, &beginInfo), "Failed to begin secondary CommandBuffer.");
+    return secondaryCmdBuffer;
+}
+
+bool GraphicsAPI_Vulkan::IsTransientImageView(void *imageView)
+{
+    auto imageViewResource = imageViewResources.find((VkImageView)imageView);
+    if (imageViewResource == imageViewResources.end())
+    {
+        return false;
+    }
+    auto imageResource = imageResources.find((VkImage)imageViewResource->second.image);
+    return imageResource != imageResources.end() && imageResource->second.second.transient;
+}
+
+bool GraphicsAPI_Vulkan::ClearPassAttachment(void *imageView, const VkClearAttachment &clear)
+{
+    if (!FindDeferredRenderTarget(imageView) && !IsTransientImageView(imageView))
+    {
+        return false;
+    }
+
+    pendingAttachmentClears[imageView] = clear;
+    if (deferredPassOpen)
+    {
+        const DeferredPass &openPass = deferredPasses.back();
+        ApplyPendingClears(mainRecordingState.cmdBuffer, openPass.attachments, openPass.clearableAttachmentCount, openPass.width, openPass.height);
+    }
+    return true;
+}
+
+void GraphicsAPI_Vulkan::ApplyPendingClears(VkCommandBuffer commandBuffer, const std::vector<void *> &attachments, size_t clearableAttachmentCount,
+                                            uint32_t width, uint32_t height)
+{
+    if (pendingAttachmentClears.empty())
+    {
+        return;
+    }
+
+    VkClearRect clearRect{};
+    clearRect.rect = {{0, 0}, {width, height}};
+    clearRect.baseArrayLayer = 0;
+    clearRect.layerCount = 1;
+    for (size_t i = 0; i < clearableAttachmentCount; i++)
+    {
+        auto pendingClear = pendingAttachmentClears.find(attachments[i]);
+        if (pendingClear == pendingAttachmentClears.end())
+        {
+            continue;
+        }
+        // Color attachments come first, so the index is the color attachment's; depth ignores it
+        VkClearAttachment attachmentClear = pendingClear->second;
+        attachmentClear.colorAttachment = static_cast<uint32_t>(i);
+        vkCmdClearAttachments(commandBuffer, 1, &attachmentClear, 1, &clearRect);
+        pendingAttachmentClears.erase(pendingClear);
+    }
+}
+
+bool GraphicsAPI_Vulkan::HasPendingClears(const std::vector<void *> &attachments, size_t clearableAttachmentCount) const
+{
+    for (size_t i = 0; i < clearableAttachmentCount; i++)
+    {
+        if (pendingAttachmentClears.count(attachments[i]) != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+thread_local GraphicsAPI_Vulkan::RecordingContext *GraphicsAPI_Vulkan::threadRecordingContext = nullptr;
+
+void GraphicsAPI_Vulkan::BeginParallelRecording(uint32_t chunkCount)
+{
+    // Chunks are only ever written by the thread recording them, so they're all made up front
+    parallelChunks.clear();
+    parallelChunks.resize(chunkCount);
+}
+
+void GraphicsAPI_Vulkan::BeginThreadRecording(uint32_t threadIndex, uint32_t chunkIndex)
+{
+    std::vector<RecordingContext> &recordingContexts = GetFrameContext().recordingContexts;
+    if (threadIndex >= recordingContexts.size() || chunkIndex >= parallelChunks.size())
+    {
+        std::cerr << "ERROR: VULKAN: Recording thread " << threadIndex << " or chunk " << chunkIndex << " is out of range." << std::endl;
+        return;
+    }
+    RecordingContext &context = recordingContexts[threadIndex];
+    context.chunkIndex = chunkIndex;
+    context.state = RecordingState();
+    threadRecordingContext = &context;
+}
+
+void GraphicsAPI_Vulkan::EndThreadRecording()
+{
+    RecordingContext *context = threadRecordingContext;
+    if (!context)
+    {
+        return;
+    }
+    if (context->state.cmdBuffer)
+    {
+        VULKAN_CHECK(vkEndCommandBuffer(context->state.cmdBuffer), "Failed to end recording thread CommandBuffer.");
+    }
+    threadRecordingContext = nullptr;
+}
+
+void GraphicsAPI_Vulkan::SetChunkRenderAttachments(std::vector<void *> &&attachments, size_t clearableAttachmentCount, uint32_t width, uint32_t height,
+                                                   void *pipeline)
+{
+    RecordingContext &context = *threadRecordingContext;
+    ParallelChunk &chunk = parallelChunks[context.chunkIndex];
+    if (chunk.cmdBuffer)
+    {
+        if (chunk.attachments != attachments || chunk.width != width || chunk.height != height)
+        {
+            std::cerr << "ERROR: VULKAN: A parallel recording chunk draws into one set of attachments, later draws keep using the first." << std::endl;
+        }
+        return;
+    }
+
+    auto pipelineResource = pipelineResources.find((VkPipeline)pipeline);
+    if (pipelineResource == pipelineResources.end())
+    {
+        std::cerr << "ERROR: VULKAN: Unknown pipeline in a parallel recording chunk." << std::endl;
+        return;
+    }
+    chunk.cmdBuffer = BeginSecondaryCmdBuffer(context.cmdPool, context.cmdBuffers, context.cmdBuffersUsed, std::get<2>(pipelineResource->second));
+    chunk.pipeline = pipeline;
+    chunk.attachments = std::move(attachments);
+    chunk.clearableAttachmentCount = clearableAttachmentCount;
+    chunk.width = width;
+    chunk.height = height;
+    context.state.cmdBuffer = chunk.cmdBuffer;
+}
+
+void GraphicsAPI_Vulkan::EndParallelRecording()
+{
+    // The chunks join the deferred passes behind whatever the main thread recorded so far. Clears requested before
+    // them go into a secondary command buffer of the main thread ahead of the chunk.
+    EndDeferredPass();
+    for (RecordingContext &context : GetFrameContext().recordingContexts)
+    {
+        for (VkBuffer buffer : context.usedBuffers)
+        {
+            MarkBufferUsed(buffer);
+        }
+        context.usedBuffers.clear();
+    }
+    const ParallelChunk *lastChunk = nullptr;
+    for (ParallelChunk &chunk : parallelChunks)
+    {
+        if (!chunk.cmdBuffer)
+        {
+            continue;
+        }
+        const bool fragmentDensityMap = std::get<3>(pipelineResources[(VkPipeline)chunk.pipeline]).fragmentDensityMap && fragmentDensityMapSupported;
+        if (!IsLastDeferredPass(chunk.attachments, chunk.width, chunk.height, fragmentDensityMap) ||
+            HasPendingClears(chunk.attachments, chunk.clearableAttachmentCount))
+        {
+            BeginDeferredPass(std::vector<void *>(chunk.attachments), chunk.clearableAttachmentCount, chunk.width, chunk.height, chunk.pipeline);
+            EndDeferredPass();
+        }
+        deferredPasses.back().secondaryCmdBuffers.push_back(chunk.cmdBuffer);
+        lastChunk = &chunk;
+    }
+
+    const bool deferred = std::any_of(deferredPasses.begin(), deferredPasses.end(), [this](const DeferredPass &pass)
+                                      {
+                                          return std::any_of(pass.attachments.begin(), pass.attachments.end(),
+                                                             [this](void *attachment) { return FindDeferredRenderTarget(attachment) != nullptr; });
+                                      });
+    if (!deferred)
+    {
+        // Nothing waits for a binding, so the chunks go into the frame right away, in order with the inline passes
+        ExecuteDeferredPasses();
+    }
+    else if (lastChunk)
+    {
+        // Later commands of the main thread, such as the end of a GPU scope, land after the chunks
+        BeginDeferredPass(std::vector<void *>(lastChunk->attachments), lastChunk->clearableAttachmentCount, lastChunk->width, lastChunk->height,
+                          lastChunk->pipeline);
+    }
+    parallelChunks.clear();
 }
 
 const std::vector<int64_t> GraphicsAPI_Vulkan::GetSupportedColorSwapchainFormats()
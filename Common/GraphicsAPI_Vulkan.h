@@ -7,14 +7,21 @@
 #pragma once
 #include <GraphicsAPI.h>
 
+#include <deque>
+#include <functional>
+
 #if defined(XR_USE_GRAPHICS_API_VULKAN)
 
 // Structure to pass Vulkan initialization data (without OpenXR dependencies)
 struct VulkanInitInfo {
     std::vector<const char*> instanceExtensions;
     std::vector<const char*> deviceExtensions;
+    uint32_t apiVersion = VK_API_VERSION_1_0;       // Version the instance was created with, gates optional 1.1 features
     VkInstance instance = VK_NULL_HANDLE;           // Pre-created instance (optional)
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE; // Pre-selected physical device (optional)
+    // Frames the CPU may record ahead of the GPU, up to GraphicsAPI_Vulkan::maxFramesInFlight. Callers asking for more
+    // than one must not rewrite per-frame data in place, see GraphicsAPI::GetFramesInFlight().
+    uint32_t framesInFlight = 1;
 };
 
 class GraphicsAPI_Vulkan : public GraphicsAPI {
@@ -52,6 +59,16 @@ public:
 
     virtual void BeginRendering() override;
     virtual void EndRendering() override;
+    virtual void WaitForIdle() override;
+
+    virtual uint64_t GetRecordingValue() override { return submittedValue + 1; }
+    virtual uint64_t GetCompletedValue() override;
+    virtual bool WaitForValue(uint64_t value, uint64_t timeoutNs = UINT64_MAX) override;
+    virtual uint32_t GetFramesInFlight() override { return framesInFlight; }
+
+    virtual bool IsVertexTypeSupported(VertexType type) override;
+    virtual uint32_t GetMaxSampleCount() override { return maxSampleCount; }
+    virtual size_t GetUniformBufferOffsetAlignment() override { return uniformBufferOffsetAlignment; }
 
     virtual void SetBufferData(void* buffer, size_t offset, size_t size, void* data) override;
 
@@ -61,6 +78,7 @@ public:
     virtual void SetRenderAttachments(void** colorViews, size_t colorViewCount, void* depthStencilView, uint32_t width, uint32_t height, void* pipeline) override;
     virtual void SetViewports(Viewport* viewports, size_t count) override;
     virtual void SetScissors(Rect2D* scissors, size_t count) override;
+    virtual void SetResolveAttachments(void** resolveViews, size_t count) override;
 
     virtual void SetPipeline(void* pipeline) override;
     virtual void SetDescriptor(const DescriptorInfo& descriptorInfo) override;
@@ -69,6 +87,30 @@ public:
     virtual void SetIndexBuffer(void* indexBuffer) override;    virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0) override;
     virtual void Draw(uint32_t vertexCount, uint32_t instanceCount = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0) override;
 
+    virtual void BeginGpuScope(const char* name) override;
+    virtual void EndGpuScope() override;
+    virtual void ResolveGpuScopes(std::vector<GpuScopeTiming>& timings) override;
+
+    virtual bool IsFragmentDensityMapSupported() override { return fragmentDensityMapSupported; }
+    virtual Extent2D GetFragmentDensityTexelSize() override { return fragmentDensityTexelSize; }
+    virtual void* CreateFragmentDensityMap(uint32_t width, uint32_t height) override;
+    virtual void DestroyFragmentDensityMap(void*& densityMapView) override;
+    virtual void SetFragmentDensityMapData(void* densityMapView, const void* data) override;
+    virtual void* CreateFragmentDensityMapView(void* image) override;
+    virtual void SetFragmentDensityMap(void* densityMapView) override;
+
+    virtual bool IsDeferredRenderTargetSupported() override { return true; }
+    virtual void* CreateDeferredRenderTarget() override;
+    virtual void DestroyDeferredRenderTarget(void*& renderTarget) override;
+    virtual void BindDeferredRenderTarget(void* renderTarget, void* imageView) override;
+    virtual void ResolveDeferredRenderTargets() override;
+
+    virtual uint32_t GetRecordingThreadCount() override { return recordingThreadCount; }
+    virtual void BeginParallelRecording(uint32_t chunkCount) override;
+    virtual void BeginThreadRecording(uint32_t threadIndex, uint32_t chunkIndex) override;
+    virtual void EndThreadRecording() override;
+    virtual void EndParallelRecording() override;
+
     // Getter methods for OpenXR integration
     VkInstance GetInstance() const { return instance; }
     VkPhysicalDevice GetPhysicalDevice() const { return physicalDevice; }
@@ -81,6 +123,116 @@ private:
     virtual const std::vector<int64_t> GetSupportedColorSwapchainFormats() override;
     virtual const std::vector<int64_t> GetSupportedDepthSwapchainFormats() override;
 
+    struct GpuProfilerScope {
+        std::string name;
+        uint32_t beginQuery;
+        uint32_t endQuery;
+        uint32_t depth;
+    };
+    struct GpuProfilerFrame {
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+        uint32_t queryCount = 0;
+        uint64_t submissionIndex = 0;
+        int64_t cpuSubmitTime = 0;
+        bool pending = false;
+        std::vector<GpuProfilerScope> scopes;
+    };
+    void ReadGpuProfilerFrame(GpuProfilerFrame& frame);
+
+    struct FragmentDensityMap {
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkBuffer stagingBuffer = VK_NULL_HANDLE;  // Host visible copy of the contents, uploaded by SetFragmentDensityMapData
+        VkDeviceMemory stagingMemory = VK_NULL_HANDLE;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint64_t uploadValue = 0;  // Timeline value of the frame whose copy last read the staging buffer
+    };
+    void CheckFragmentDensityMapSupport(uint32_t apiVersion, std::vector<const char*>& deviceExtensions);
+    void CheckTimelineSemaphoreSupport(uint32_t apiVersion, std::vector<const char*>& deviceExtensions);
+    bool IsDeviceExtensionAvailable(const char* extensionName);
+    void UploadFragmentDensityMap(FragmentDensityMap& densityMap);
+
+    struct DeferredRenderTarget {
+        VkImageView boundView = VK_NULL_HANDLE;
+    };
+    struct DeferredPass {
+        std::vector<VkCommandBuffer> secondaryCmdBuffers;  // Executed in order within the one render pass
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+        std::vector<void*> attachments;  // Color, depth then resolve views, any of which can be deferred render targets
+        size_t clearableAttachmentCount = 0;  // Color and depth
+        uint32_t width = 0;
+        uint32_t height = 0;
+        bool fragmentDensityMap = false;
+    };
+    DeferredRenderTarget* FindDeferredRenderTarget(void* imageView);
+    bool IsLastDeferredPass(const std::vector<void*>& attachments, uint32_t width, uint32_t height, bool fragmentDensityMap) const;
+    void BeginDeferredPass(std::vector<void*>&& attachments, size_t clearableAttachmentCount, uint32_t width, uint32_t height, void* pipeline);
+    void EndDeferredPass();
+    bool IsTransientImageView(void* imageView);
+    // Clears of deferred render targets and transient images happen inside the pass that uses them
+    bool ClearPassAttachment(void* imageView, const VkClearAttachment& clear);
+    void ApplyPendingClears(VkCommandBuffer commandBuffer, const std::vector<void*>& attachments, size_t clearableAttachmentCount, uint32_t width,
+                            uint32_t height);
+    bool HasPendingClears(const std::vector<void*>& attachments, size_t clearableAttachmentCount) const;
+    // Records every deferred pass into cmdBuffer, with the bound views standing in for deferred render targets
+    void ExecuteDeferredPasses();
+
+    // Destroy* calls hand their objects to the deletion queue, which destroys them once the GPU finished the last
+    // submission that could have used them: the one being recorded, or the previous one between frames. Between
+    // frames, buffers wait for the submission that last bound them instead, so one unused for a few frames goes right away.
+    struct RetiredObject {
+        uint64_t value = 0;
+        std::function<void()> destroy;
+    };
+    void Retire(std::function<void()>&& destroy);
+    void Retire(uint64_t value, std::function<void()>&& destroy);
+    void DestroyRetiredObjects();
+    // Stamps the buffer with the frame being recorded; recording threads collect theirs until EndParallelRecording
+    void MarkBufferUsed(VkBuffer buffer);
+
+    // Draw state of one recording thread
+    struct RecordingState {
+        VkCommandBuffer cmdBuffer = VK_NULL_HANDLE;
+        // Last buffers bound to cmdBuffer, redundant binds are skipped
+        VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+        VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        std::vector<std::tuple<VkWriteDescriptorSet, VkDescriptorBufferInfo, VkDescriptorImageInfo>> writeDescSets;
+    };
+    // Pools of one parallel recording thread, reset as a whole once the frame using them finished
+    struct RecordingContext {
+        VkCommandPool cmdPool = VK_NULL_HANDLE;
+        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        std::vector<VkCommandBuffer> cmdBuffers;
+        size_t cmdBuffersUsed = 0;
+        uint32_t chunkIndex = 0;
+        RecordingState state;
+        std::vector<VkBuffer> usedBuffers;
+    };
+    struct ParallelChunk {
+        VkCommandBuffer cmdBuffer = VK_NULL_HANDLE;  // Begun by the first SetRenderAttachments of the chunk
+        void* pipeline = nullptr;
+        std::vector<void*> attachments;
+        size_t clearableAttachmentCount = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+    // Everything a frame records into, reused once the GPU finished the last submission of the same slot
+    struct FrameContext {
+        VkCommandBuffer cmdBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;  // Only used to track submissions when timeline semaphores aren't supported
+        uint64_t submittedValue = 0;     // Timeline value of the last submission of cmdBuffer
+        std::vector<VkCommandBuffer> secondaryCmdBuffers;
+        size_t secondaryCmdBuffersUsed = 0;
+        std::vector<RecordingContext> recordingContexts;  // One per parallel recording thread
+    };
+    FrameContext& GetFrameContext() { return frameContexts[frameIndex]; }
+    RecordingState& GetRecordingState() { return threadRecordingContext ? threadRecordingContext->state : mainRecordingState; }
+    VkDescriptorPool CreateDescriptorPool(VkDescriptorPoolCreateFlags flags);
+    VkCommandBuffer BeginSecondaryCmdBuffer(VkCommandPool pool, std::vector<VkCommandBuffer>& cmdBuffers, size_t& cmdBuffersUsed, VkRenderPass renderPass);
+    void SetChunkRenderAttachments(std::vector<void*>&& attachments, size_t clearableAttachmentCount, uint32_t width, uint32_t height, void* pipeline);
+
 private:
     VkInstance instance{};
     VkPhysicalDevice physicalDevice{};
@@ -88,12 +240,34 @@ private:
     uint32_t queueFamilyIndex = 0xFFFFFFFF;
     uint32_t queueIndex = 0xFFFFFFFF;
     VkQueue queue{};
-    VkFence fence{};
+
+    // GPU timeline: EndRendering signals submittedValue, completedValue caches the highest value known to be reached
+    bool timelineSemaphoreSupported = false;
+    bool timelineSemaphoreCore = false;  // Vulkan 1.2 entry points, otherwise the VK_KHR_timeline_semaphore ones
+    VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures{};
+    VkSemaphore timelineSemaphore = VK_NULL_HANDLE;
+    PFN_vkGetSemaphoreCounterValueKHR getSemaphoreCounterValue = nullptr;
+    PFN_vkWaitSemaphoresKHR waitSemaphores = nullptr;
+    uint64_t submittedValue = 0;
+    uint64_t completedValue = 0;
+    bool recordingFrame = false;  // Between BeginRendering and EndRendering
+    std::deque<RetiredObject> retiredObjects;  // In the order of their values
+
+    // The CPU records frame submittedValue + 1 while the GPU may still run up to framesInFlight - 1 older ones. Each
+    // frame takes the slot of its timeline value, so BeginRendering only waits for the frame framesInFlight back.
+    // With the default of one it waits for the previous frame.
+    static constexpr uint32_t maxFramesInFlight = 2;
+    uint32_t framesInFlight = 1;
+    std::vector<FrameContext> frameContexts;
+    uint32_t frameIndex = 0;
 
     VkCommandPool cmdPool{};
-    VkCommandBuffer cmdBuffer{};
+    VkCommandBuffer cmdBuffer{};  // The current frame's, see frameContexts
     VkDescriptorPool descriptorPool;
 
+    // Draw state of the main thread goes to cmdBuffer, or the secondary command buffer of the open deferred pass
+    RecordingState mainRecordingState;
+
     std::vector<const char*> activeInstanceLayers{};
     std::vector<const char*> activeInstanceExtensions{};
     std::vector<const char*> activeDeviceLayer{};
@@ -110,16 +284,52 @@ private:
     std::unordered_map<VkImageView, ImageViewCreateInfo> imageViewResources;
 
     std::unordered_map<VkBuffer, std::pair<VkDeviceMemory, BufferCreateInfo>> bufferResources;
+    std::unordered_map<VkBuffer, uint64_t> bufferUseValues;  // Only written by the main thread
 
     std::unordered_map<VkShaderModule, ShaderCreateInfo> shaderResources;
     std::unordered_map<VkPipeline, std::tuple<VkPipelineLayout, VkDescriptorSetLayout, VkRenderPass, PipelineCreateInfo>> pipelineResources;
 
     std::unordered_map<VkCommandBuffer, std::vector<VkFramebuffer>> cmdBufferFramebuffers;
     bool inRenderPass = false;
+    std::vector<void*> resolveAttachments;
+    uint32_t maxSampleCount = 1;
+    size_t uniformBufferOffsetAlignment = 256;
 
-    VkPipeline setPipeline = VK_NULL_HANDLE;
     std::unordered_map<VkCommandBuffer, std::vector<VkDescriptorSet>> cmdBufferDescriptorSets;
-    std::vector<std::tuple<VkWriteDescriptorSet, VkDescriptorBufferInfo, VkDescriptorImageInfo>> writeDescSets;
+
+    // Timestamp queries: one pool per in-flight submission, read back when the pool comes around again
+    static constexpr uint32_t gpuProfilerFrameCount = 4;
+    static_assert(gpuProfilerFrameCount > maxFramesInFlight, "A query pool is read back once its frame is no longer in flight");
+    static constexpr uint32_t gpuProfilerMaxQueries = 512;
+    static constexpr size_t gpuProfilerMaxResolvedScopes = 8192;
+    bool gpuProfilerSupported = false;
+    float timestampPeriod = 1.0f;
+    uint64_t timestampMask = 0;
+    std::vector<GpuProfilerFrame> gpuProfilerFrames;
+    uint32_t gpuProfilerFrameIndex = 0;
+    uint64_t gpuSubmissionCount = 0;
+    bool gpuProfilerRecording = false;
+    std::vector<uint32_t> gpuScopeStack;
+    std::vector<GpuScopeTiming> resolvedGpuScopes;
+
+    // VK_EXT_fragment_density_map, enabled when the device can use it with regular (non-subsampled) attachments
+    bool fragmentDensityMapSupported = false;
+    Extent2D fragmentDensityTexelSize = {0, 0};
+    VkPhysicalDeviceFragmentDensityMapFeaturesEXT fragmentDensityMapFeatures{};
+    std::unordered_map<VkImageView, FragmentDensityMap> fragmentDensityMaps;
+    VkImageView currentFragmentDensityMap = VK_NULL_HANDLE;
+
+    // Deferred render targets; secondary command buffers are reused once the frame reached its timeline value
+    std::unordered_map<void*, std::unique_ptr<DeferredRenderTarget>> deferredRenderTargets;
+    std::vector<DeferredPass> deferredPasses;
+    bool deferredPassOpen = false;
+    std::unordered_map<void*, VkClearAttachment> pendingAttachmentClears;  // Requested before any pass used the attachment
+
+    // Parallel recording; the context of the calling thread is set between BeginThreadRecording and EndThreadRecording
+    static constexpr uint32_t maxRecordingThreads = 8;
+    uint32_t recordingThreadCount = 0;
+    std::vector<ParallelChunk> parallelChunks;
+    static thread_local RecordingContext* threadRecordingContext;
 
 };
 #endif
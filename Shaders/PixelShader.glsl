@@ -1,11 +1,21 @@
 #version 450
+// Set per pipeline through specialization constants; the branches they select are folded away
+layout(constant_id = 0) const bool HALF_LAMBERT = false;
+
 layout(location = 0) in flat uvec2 i_TexCoord;
+#ifndef UNLIT
 layout(location = 1) in vec3 i_Normal;
+#endif
 layout(location = 2) in flat vec3 i_Color;
 layout(location = 0) out vec4 o_Color;
 
 void main() {
     uint i = i_TexCoord.x;
-    float light = 0.1 + 0.9 * clamp(i_Normal.g, 0.0, 1.0);
+#ifdef UNLIT
+    o_Color = vec4(i_Color.rgb, 1.0);
+#else
+    float diffuse = HALF_LAMBERT ? pow(0.5 * i_Normal.g + 0.5, 2.0) : clamp(i_Normal.g, 0.0, 1.0);
+    float light = 0.1 + 0.9 * diffuse;
     o_Color = vec4(light * i_Color.rgb, 1.0);
+#endif
 }
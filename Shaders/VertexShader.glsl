@@ -11,11 +11,16 @@ layout(std140, binding = 0) uniform CameraConstants {
     vec4 pad3;
 };
 
+// Compiled with UNLIT defined for materials without lighting; normals are then neither fetched nor passed on
 layout(location = 0) in vec4 a_Position;
+#ifndef UNLIT
 layout(location = 1) in vec3 a_Normal;
+#endif
 
 layout(location = 0) out flat uvec2 o_TexCoord;
+#ifndef UNLIT
 layout(location = 1) out vec3 o_Normal;
+#endif
 layout(location = 2) out flat vec3 o_Color;
 
 void main() {
@@ -24,7 +29,9 @@ void main() {
     int face = gl_VertexIndex / 6;
     o_TexCoord = uvec2(face, 0);
     
+#ifndef UNLIT
     o_Normal = (model * vec4(a_Normal, 0.0)).xyz;
+#endif
     
     o_Color = color.rgb;
 }
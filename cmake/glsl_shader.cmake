@@ -42,7 +42,7 @@ function(glsl_spv_shader)
         ENTRY_POINT
         TARGET_ENV
     )
-    set(multiValueArgs EXTRA_DEPENDS)
+    set(multiValueArgs EXTRA_DEPENDS DEFINES)
     cmake_parse_arguments(
         _glsl_spv
         "${options}"
@@ -51,6 +51,12 @@ function(glsl_spv_shader)
         ${ARGN}
     )
 
+    # Preprocessor definitions, for compiling several variants of one source
+    set(_glsl_spv_DEFINE_FLAGS)
+    foreach(define ${_glsl_spv_DEFINES})
+        list(APPEND _glsl_spv_DEFINE_FLAGS "-D${define}")
+    endforeach()
+
     if(GLSL_COMPILER)
         add_custom_command(
             OUTPUT "${_glsl_spv_OUTPUT}"
@@ -62,6 +68,7 @@ function(glsl_spv_shader)
                 $<IF:$<OR:$<CONFIG:Debug>,$<CONFIG:RelWithDebInfo>>,-g,>
                 $<IF:$<CONFIG:Debug>,-O0,-O>
                 "--target-env=${_glsl_spv_TARGET_ENV}"
+                ${_glsl_spv_DEFINE_FLAGS}
                 "${_glsl_spv_INPUT}"
             MAIN_DEPENDENCY "${_glsl_spv_INPUT}"
             DEPENDS "${_glsl_spv_INPUT}" ${_glsl_spv_EXTRA_DEPENDS}
@@ -79,6 +86,7 @@ function(glsl_spv_shader)
                 $<$<CONFIG:Debug>:-Od>
                 $<$<CONFIG:Release>:-g0>
                 "--target-env" "${_glsl_spv_TARGET_ENV}"
+                ${_glsl_spv_DEFINE_FLAGS}
                 -V
                 "${_glsl_spv_INPUT}"
             MAIN_DEPENDENCY "${_glsl_spv_INPUT}"
@@ -90,7 +98,8 @@ function(glsl_spv_shader)
         # Use the precompiled .spv files
         get_filename_component(glsl_src_dir "${_glsl_spv_INPUT}" DIRECTORY)
 
-        get_filename_component(glsl_name_we "${_glsl_spv_INPUT}" NAME_WE)
+        # Named after the output, so variants find their own precompiled file
+        get_filename_component(glsl_name_we "${_glsl_spv_OUTPUT}" NAME_WE)
         set(precompiled_file ${glsl_src_dir}/${glsl_name_we}.spv)
         configure_file("${precompiled_file}" "${_glsl_spv_OUTPUT}" COPYONLY)
     else()